@@ -17,6 +17,8 @@
 #include "MDPDistribution.h"
 #include "real.h"
 
+class RandomNumberGenerator;
+
 template <typename StateType, typename ActionType>
 class AbstractPolicy {
  public:
@@ -33,6 +35,15 @@ class AbstractPolicy {
     Serror("Not implented\n");
     exit(-1);
   }
+  /// Return a copy of the policy that draws random numbers from rng,
+  /// so that it can be used in another thread. The copy is required
+  /// to be freed by the user!
+  virtual AbstractPolicy<StateType, ActionType>* Clone(
+      RandomNumberGenerator* rng) const {
+    Serror("Not implemented\n");
+    exit(-1);
+    return NULL;
+  }
 };
 
 #endif  // SRC_ALGORITHMS_ABSTRACTPOLICY_H_
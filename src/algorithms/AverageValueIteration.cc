@@ -74,6 +74,7 @@ void AverageValueIteration::ComputeStateValues(real threshold, int max_iter) {
   real d2Delta = 0.0;
   Delta = 0.0;
   int stuck_count = 0;
+  kernel.Synchronise(*mdp);
   do {
     baseline = 0.0;
     if (RELATIVE) {
@@ -87,16 +88,15 @@ void AverageValueIteration::ComputeStateValues(real threshold, int max_iter) {
       int c_a_max = 0;
       for (int a = 0; a < n_actions; a++) {
         real S = 0.0;
-        DiscreteStateSet next = mdp->getNextStates(s, a);
-        for (DiscreteStateSet::iterator i = next.begin(); i != next.end();
-             ++i) {
-          int s2 = *i;
-          real P = mdp->getTransitionProbability(s, a, s2);
+        real R_sa = kernel.getExpectedReward(s, a);
+        for (int i = kernel.RowBegin(s, a); i < kernel.RowEnd(s, a); ++i) {
+          int s2 = kernel.getNextState(i);
+          real P = kernel.getProbability(i);
           real R;
           if (SYNCHRONOUS) {
-            R = mdp->getExpectedReward(s, a) + pV[s2] - baseline;
+            R = R_sa + pV[s2] - baseline;
           } else {
-            R = mdp->getExpectedReward(s, a) + V[s2] - baseline;
+            R = R_sa + V[s2] - baseline;
           }
           S += P * R;
         }
@@ -129,12 +129,9 @@ void AverageValueIteration::ComputeStateValues(real threshold, int max_iter) {
       }
       for (int s = 0; s < n_states; s++) {
         // calculate new p_b
-        DiscreteStateSet next = mdp->getNextStates(s, a_max[s]);
-        for (DiscreteStateSet::iterator i = next.begin(); i != next.end();
-             ++i) {
-          int s2 = *i;
-          real P = mdp->getTransitionProbability(s, a_max[s], s2);
-          p_tmp[s2] += p_b[s] * P;
+        for (int i = kernel.RowBegin(s, a_max[s]);
+             i < kernel.RowEnd(s, a_max[s]); ++i) {
+          p_tmp[kernel.getNextState(i)] += p_b[s] * kernel.getProbability(i);
         }
       }
       for (int s = 0; s < n_states; s++) {
@@ -14,6 +14,7 @@
 #define AVERAGE_VALUE_ITERATION_H
 
 #include <vector>
+#include "CompiledDiscreteMDP.h"
 #include "DiscreteMDP.h"
 #include "ValueIteration.h"
 #include "real.h"
@@ -23,6 +24,7 @@ class AverageValueIteration {
   const bool RELATIVE;
   const bool SYNCHRONOUS;
   const DiscreteMDP* mdp;
+  CompiledDiscreteMDP kernel;  ///< compiled snapshot of the MDP
   int n_states;
   int n_actions;
   bool max_iter_reached;
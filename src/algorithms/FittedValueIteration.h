@@ -15,6 +15,7 @@
 #include "BasisSet.h"
 #include "BayesianMultivariateRegression.h"
 #include "Environment.h"
+#include "EnvironmentBatch.h"
 #include "Matrix.h"
 
 ///*Fitted Value Iteration Algorithm*/
@@ -76,6 +77,13 @@ class FittedValueIteration {
     weights = Vector(dim);
     sampleSelection();
   }
+  /** Iterate until the weights change by less than threshold.
+
+      If the environment has batched dynamics, the M sampled
+      transitions of every state and action are simulated together, in
+      one EnvironmentBatch step per iteration. Otherwise, they are
+      simulated one at a time with the environment itself.
+   */
   const void Update(real threshold = 0.000001, int max_iter = -1) {
     real distance;
     Vector phi, next_state;
@@ -83,19 +91,43 @@ class FittedValueIteration {
     Vector pW(dim);
     weights = pW;
     int n_iter = 0;
+    // lane (i * n_actions + a) * M + j is the j-th sample of a in state i
+    EnvironmentBatch* batch = NULL;
+    std::vector<int> actions;
+    if (EnvironmentBatch::HasBatchDynamics(*environment)) {
+      batch = new EnvironmentBatch(*environment, N * n_actions * M, lrandom());
+      actions.resize(N * n_actions * M);
+      for (int lane = 0; lane < (int)actions.size(); ++lane) {
+        actions[lane] = (lane / M) % n_actions;
+      }
+    }
     do {
       distance = 0.1;
 
+      if (batch) {
+        for (int lane = 0; lane < (int)actions.size(); ++lane) {
+          batch->setState(lane, states[lane / (n_actions * M)]);
+        }
+        batch->Act(actions);
+      }
       for (int i = 0; i < N; ++i) {
         Vector V(n_actions);
         for (int a = 0; a < n_actions; ++a) {
           V[a] = 0.0;
 
           for (int j = 0; j < M; ++j) {
-            environment->Reset();
-            environment->setState(states[i]);
-            bool final = environment->Act(a);
-            real r = environment->getReward();
+            bool final;
+            real r;
+            if (batch) {
+              int lane = (i * n_actions + a) * M + j;
+              final = !batch->getEndsim(lane);
+              r = batch->getReward(lane);
+            } else {
+              environment->Reset();
+              environment->setState(states[i]);
+              final = environment->Act(a);
+              r = environment->getReward();
+            }
             if (final) {
               phi = BasisModelCreation(states[i]);
               next_state = regression_t[a]->generate(phi);
@@ -123,6 +155,7 @@ class FittedValueIteration {
         sampleSelection();
       }
     } while (distance > threshold && max_iter != 0);
+    delete batch;
     printf("#ValueIteration::ComputeStateValues Exiting at d:%f, n:%d\n",
            distance, n_iter);
   }
@@ -21,7 +21,8 @@ LSPI::LSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_,
       max_iteration(max_iteration_),
       bfs(bfs_),
       Samples(Samples_),
-      policy(n_dimension, n_actions, bfs) {
+      policy(n_dimension, n_actions, bfs),
+      n_threads(1) {
   assert(gamma >= 0 && gamma <= 1);
   n_basis = n_actions * (bfs->size() + 1);
   algorithm = 1;
@@ -42,7 +43,8 @@ LSPI::LSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_,
       algorithm(algorithm_),
       bfs(bfs_),
       Samples(Samples_),
-      policy(n_dimension, n_actions, bfs) {
+      policy(n_dimension, n_actions, bfs),
+      n_threads(1) {
   assert(gamma >= 0 && gamma <= 1);
   assert(algorithm >= 1 && algorithm <= 2);
   n_basis = n_actions * (bfs->size() + 1);
@@ -94,28 +96,24 @@ Vector LSPI::BasisFunction(const Vector& state, int action) {
 //  return phi;
 //}
 
-void LSPI::LSTDQ() {
-  Vector Phi_;
-  Vector Phi;
-  Matrix res;
-
-  A = Matrix::Unity(n_basis, n_basis) * 1e-6;
-  b.Clear();
+/** LSTDQ on all rollouts.
 
+    The next actions are chosen by the current policy. The features of
+    all transitions are then evaluated in a batch, and A is
+    accumulated with n_threads threads.
+ */
+void LSPI::LSTDQ() {
+  LSTDQBatch batch;
   for (int i = 0; i < Samples->getNRollouts(); ++i) {
     for (int j = 0; j < Samples->getNSamples(i); ++j) {
-      Phi_ = BasisFunction(Samples->getState(i, j), Samples->getAction(i, j));
-      if (Samples->getEndsim(i, j)) {
-        res = OuterProduct(Phi_, Phi_);
-      } else {
-        Phi = BasisFunction(Samples->getNextState(i, j),
-                            policy.SelectAction(Samples->getNextState(i, j)));
-        res = OuterProduct(Phi_, (Phi_ - (Phi * gamma)));
-      }
-      A += res;
-      b += Phi_ * Samples->getReward(i, j);
+      bool endsim = Samples->getEndsim(i, j);
+      Vector next_state = Samples->getNextState(i, j);
+      int next_action = endsim ? 0 : policy.SelectAction(next_state);
+      batch.Add(Samples->getState(i, j), Samples->getAction(i, j),
+                Samples->getReward(i, j), next_state, next_action, endsim);
     }
   }
+  batch.Calculate(*bfs, n_actions, gamma, 1e-6, A, b, n_threads);
   const Matrix w_ = A.Inverse_LU();
   w = w_ * b;
 }
@@ -124,31 +122,26 @@ void LSPI::LSTDQ(const Vector& state, const int& action, const real& reward,
                  const bool& update) {
   Vector Phi_;
   Vector Phi;
-  Matrix res;
 
   Phi_ = BasisFunction(state, action);
   if (endsim) {
-    res = OuterProduct(Phi_, Phi_);
+    A.AddOuterProduct(Phi_, Phi_);
   } else {
     Phi = BasisFunction(state_, action_);
-    res = OuterProduct(Phi_, (Phi_ - (Phi * gamma)));
+    A.AddOuterProduct(Phi_, Phi_ - (Phi * gamma));
   }
-
-  A += res;
   b += Phi_ * reward;
 
   const Matrix w_ = A.Inverse_LU();
   w = w_ * b;
 }
 void LSPI::Update() { policy.Update(w); }
+/// LSTDQ with recursive (Sherman-Morrison) updates of the inverse
 void LSPI::LSTDQ_OPT() {
   Vector Phi_;
   Vector Phi;
   Vector Phi_dif;
-  Matrix res;
-  real d = 0.000001;
-  A = Matrix::Unity(n_basis, n_basis) * (1 / d);
-  b.Clear();
+  RecursiveLSTDQ recursive(n_basis);
 
   for (int i = 0; i < Samples->getNRollouts(); ++i) {
     for (int j = 0; j < Samples->getNSamples(i); ++j) {
@@ -160,15 +153,10 @@ void LSPI::LSTDQ_OPT() {
                             policy.SelectAction(Samples->getNextState(i, j)));
         Phi_dif = Phi_ - (Phi * gamma);
       }
-      res = OuterProduct(Phi_, Phi_dif);
-      const Matrix p = A;
-      real v = Product(p * Phi_, Phi_dif);
-      A -= (((A * res) * A) / (v + 1));
-      b += Phi_ * Samples->getReward(i, j);
+      recursive.AddSample(Phi_, Phi_dif, Samples->getReward(i, j));
     }
   }
-  const Matrix w_ = A;
-  w = w_ * b;
+  w = recursive.getWeights();
 }
 
 void LSPI::PolicyIteration() {
@@ -16,8 +16,10 @@
 #include <vector>
 #include "BasisSet.h"
 #include "ContinuousPolicy.h"
+#include "LSTDQBatch.h"
 #include "Matrix.h"
 #include "RandomPolicy.h"
+#include "RecursiveLSTDQ.h"
 #include "Rollout.h"
 #include "Vector.h"
 #include "real.h"
@@ -37,6 +39,7 @@ class LSPI {
   RBFBasisSet* bfs;
   Rollout<Vector, int, AbstractPolicy<Vector, int> >* Samples;
   FixedContinuousPolicy policy;
+  int n_threads;  ///< number of threads for building A
 
  public:
   LSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_,
@@ -58,6 +61,8 @@ class LSPI {
   void Update();
   real getValue(const Vector& state, int action);
   FixedContinuousPolicy& ReturnPolicy() { return policy; }
+  /// Set the number of threads used by LSTDQ() (0 for all)
+  void setNumberOfThreads(int n_threads_) { n_threads = n_threads_; }
 };
 
 #endif
@@ -18,7 +18,8 @@ LSTDQ::LSTDQ(real gamma_, int n_dimension_, int n_actions_, RBFBasisSet& bfs_,
       n_actions(n_actions_),
       bfs(bfs_),
       Samples(Samples_),
-      policy(n_dimension, n_actions, &bfs) {
+      policy(n_dimension, n_actions, &bfs),
+      n_threads(1) {
   assert(gamma >= 0 && gamma <= 1);
   n_basis = n_actions * (bfs.size() + 1);
   algorithm = 1;
@@ -35,7 +36,8 @@ LSTDQ::LSTDQ(real gamma_, int n_dimension_, int n_actions_, int algorithm_,
       algorithm(algorithm_),
       bfs(bfs_),
       Samples(Samples_),
-      policy(n_dimension, n_actions, &bfs) {
+      policy(n_dimension, n_actions, &bfs),
+      n_threads(1) {
   assert(gamma >= 0 && gamma <= 1);
   assert(algorithm >= 1 && algorithm <= 2);
   n_basis = n_actions * (bfs.size() + 1);
@@ -58,46 +60,35 @@ Vector LSTDQ::BasisFunction(const Vector& state, int action) const {
   return Phi;
 }
 
-void LSTDQ::Calculate() {
-  Vector Phi_;
-  Vector Phi;
-  Matrix res;
-  A = Matrix::Unity(n_basis, n_basis) * 1e-6;
-  b.Clear();
+/** Calculate the weights from all samples.
 
+    The features of all transitions are evaluated in a batch, and A is
+    accumulated with n_threads threads.
+ */
+void LSTDQ::Calculate() {
+  LSTDQBatch batch;
   for (uint i = 0; i < Samples.size(); ++i) {
     // logmsg ("Trajectory %d\n", i);
     if (Samples.length(i) <= 0) {
       Swarning("sample legnth %d is %d\n", i, Samples.length(i));
     }
     for (int t = 0; t < (int)Samples.length(i) - 1; ++t) {
-      Vector s_t = Samples.state(i, t);
-      int a_t = Samples.action(i, t);
-      Phi_ = BasisFunction(s_t, a_t);
-      if (Samples.terminated(i) && t >= (int)Samples.length(i) - 3) {
-        res = OuterProduct(Phi_, Phi_);
-      } else {
-        Vector s2 = Samples.state(i, t + 1);
-        // int a2 = policy.SelectAction(s2);
-        int a2 = Samples.action(i, t + 1);
-        Phi = BasisFunction(s2, a2);
-        res = OuterProduct(Phi_, (Phi_ - (Phi * gamma)));
-      }
-      A += res;
-      b += Phi_ * Samples.reward(i, t);
+      bool endsim = Samples.terminated(i) && t >= (int)Samples.length(i) - 3;
+      // int a2 = policy.SelectAction(s2);
+      batch.Add(Samples.state(i, t), Samples.action(i, t),
+                Samples.reward(i, t), Samples.state(i, t + 1),
+                Samples.action(i, t + 1), endsim);
     }
   }
+  batch.Calculate(bfs, n_actions, gamma, 1e-6, A, b, n_threads);
   const Matrix w_ = A.Inverse_LU();
   w = w_ * b;
 }
+/// Calculate the weights with recursive (Sherman-Morrison) updates
 void LSTDQ::Calculate_Opt() {
   Vector Phi_;
   Vector Phi;
-  Vector Phi_dif;
-  Matrix res;
-  real d = 0.000001;
-  A = Matrix::Unity(n_basis, n_basis) * (1 / d);
-  b.Clear();
+  RecursiveLSTDQ recursive(n_basis);
 
   for (uint i = 0; i < Samples.size(); ++i) {
     // logmsg ("Trajectory %d\n", i);
@@ -106,16 +97,10 @@ void LSTDQ::Calculate_Opt() {
       Phi_ = BasisFunction(Samples.state(i, t), Samples.action(i, t));
       Vector s = Samples.state(i, t + 1);
       Phi = BasisFunction(s, policy.SelectAction(s));
-      Phi_dif = Phi_ - (Phi * gamma);
-      res = OuterProduct(Phi_, Phi_dif);
-      const Matrix p = A;
-      real v = Product(p * Phi_, Phi_dif);
-      A -= (((A * res) * A) / (v + 1));
-      b += Phi_ * Samples.reward(i, t);
+      recursive.AddSample(Phi_, Phi_ - (Phi * gamma), Samples.reward(i, t));
     }
   }
-  const Matrix w_ = A;
-  w = w_ * b;
+  w = recursive.getWeights();
 }
 
 /// This seems to return zero all the time!
@@ -17,8 +17,10 @@
 #include "BasisSet.h"
 #include "ContinuousPolicy.h"
 #include "Demonstrations.h"
+#include "LSTDQBatch.h"
 #include "Matrix.h"
 #include "RandomPolicy.h"
+#include "RecursiveLSTDQ.h"
 #include "Vector.h"
 #include "real.h"
 
@@ -35,6 +37,7 @@ class LSTDQ {
   RBFBasisSet& bfs;
   Demonstrations<Vector, int>& Samples;
   FixedContinuousPolicy policy;
+  int n_threads;  ///< number of threads for building A
 
  public:
   LSTDQ(real gamma_, int n_dimension_, int n_actions_, RBFBasisSet& bfs_,
@@ -48,6 +51,8 @@ class LSTDQ {
   void Calculate();
   void Calculate_Opt();
   void Reset();
+  /// Set the number of threads used by Calculate (0 for all)
+  void setNumberOfThreads(int n_threads_) { n_threads = n_threads_; }
   real getValue(const Vector& state, int action) const;
   real getValue(const Vector& state) const {
     real V = getValue(state, 0);
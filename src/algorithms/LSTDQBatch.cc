@@ -0,0 +1,150 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "LSTDQBatch.h"
+
+void LSTDQBatch::Clear() {
+  states.clear();
+  actions.clear();
+  rewards.clear();
+  next_states.clear();
+  next_actions.clear();
+  terminal.clear();
+}
+
+/** Add a transition.
+
+    If endsim is true, the next state is terminal: its value is zero,
+    and next_state and next_action are ignored.
+ */
+void LSTDQBatch::Add(const Vector& state, int action, real reward,
+                     const Vector& next_state, int next_action, bool endsim) {
+  states.push_back(state);
+  actions.push_back(action);
+  rewards.push_back(reward);
+  next_states.push_back(endsim ? state : next_state);
+  next_actions.push_back(endsim ? action : next_action);
+  terminal.push_back(endsim);
+}
+
+/// The features, with a leading bias, of rows order[begin..end-1] of F
+static Matrix BiasedFeatures(const Matrix& F, const std::vector<int>& order,
+                             int begin, int end) {
+  int n_features = F.Columns() + 1;
+  Matrix Phi(end - begin, n_features);
+  for (int k = begin; k < end; ++k) {
+    Phi(k - begin, 0) = 1.0;
+    for (int i = 1; i < n_features; ++i) {
+      Phi(k - begin, i) = F(order[k], i - 1);
+    }
+  }
+  return Phi;
+}
+
+/// Add scale * block to A, starting at (row, column)
+static void AddBlock(Matrix& A, int row, int column, const Matrix& block,
+                     real scale) {
+  for (int i = 0; i < block.Rows(); ++i) {
+    for (int j = 0; j < block.Columns(); ++j) {
+      A(row + i, column + j) += scale * block(i, j);
+    }
+  }
+}
+
+/** Calculate the LSTDQ statistics of the batch.
+
+    The features of each action have a bias followed by the features
+    of bfs, as in LSTDQ::BasisFunction. Only the block of the taken
+    action is non-zero in the features of a sample, so A is built from
+    blocks: the block of each action a gets the products of the
+    features of the samples taking a, and the block of each pair
+    (a, a') of action and next action gets the products with the next
+    state features of the non-terminal samples of that pair.
+
+    \param bfs the state features
+    \param n_actions the number of actions
+    \param gamma the discount factor
+    \param regularisation the diagonal \f$\delta\f$ added to A
+    \param A the LSTDQ matrix
+    \param b the LSTDQ vector
+    \param n_threads the number of threads to use
+ */
+void LSTDQBatch::Calculate(const RBFBasisSet& bfs, int n_actions, real gamma,
+                           real regularisation, Matrix& A, Vector& b,
+                           int n_threads) const {
+  int n_features = bfs.size() + 1;
+  int n_basis = n_actions * n_features;
+  int T = size();
+  A = Matrix::Unity(n_basis, n_basis) * regularisation;
+  b = Vector::Null(n_basis);
+  if (T == 0) {
+    return;
+  }
+  int n_dimension = states[0].Size();
+  Matrix X(T, n_dimension);
+  Matrix X_next(T, n_dimension);
+  for (int t = 0; t < T; ++t) {
+    for (int j = 0; j < n_dimension; ++j) {
+      X(t, j) = states[t](j);
+      X_next(t, j) = next_states[t](j);
+    }
+  }
+  Matrix F;
+  Matrix F_next;
+  bfs.Evaluate(X, F, n_threads);
+  bfs.Evaluate(X_next, F_next, n_threads);
+
+  // Sort the samples by action, and then by next action, with the
+  // terminal samples of each action last. The samples of group g are
+  // order[start[g]..start[g+1]-1].
+  int n_groups = n_actions + 1;
+  std::vector<int> start(n_actions * n_groups + 1, 0);
+  for (int t = 0; t < T; ++t) {
+    int next = terminal[t] ? n_actions : next_actions[t];
+    start[actions[t] * n_groups + next + 1]++;
+  }
+  for (int g = 0; g < n_actions * n_groups; ++g) {
+    start[g + 1] += start[g];
+  }
+  std::vector<int> order(T);
+  std::vector<int> position(start.begin(), start.end() - 1);
+  for (int t = 0; t < T; ++t) {
+    int next = terminal[t] ? n_actions : next_actions[t];
+    order[position[actions[t] * n_groups + next]++] = t;
+  }
+
+  for (int a = 0; a < n_actions; ++a) {
+    int begin = start[a * n_groups];
+    int end = start[(a + 1) * n_groups];
+    if (begin == end) {
+      continue;
+    }
+    int offset = n_features * a;
+    Matrix Phi = BiasedFeatures(F, order, begin, end);
+    AddBlock(A, offset, offset, TransposeProduct(Phi, Phi, n_threads), 1.0);
+    for (int k = begin; k < end; ++k) {
+      for (int i = 0; i < n_features; ++i) {
+        b(offset + i) += Phi(k - begin, i) * rewards[order[k]];
+      }
+    }
+    for (int a2 = 0; a2 < n_actions; ++a2) {
+      int pair_begin = start[a * n_groups + a2];
+      int pair_end = start[a * n_groups + a2 + 1];
+      if (pair_begin == pair_end) {
+        continue;
+      }
+      Matrix Phi_pair = BiasedFeatures(F, order, pair_begin, pair_end);
+      Matrix Phi_next = BiasedFeatures(F_next, order, pair_begin, pair_end);
+      AddBlock(A, offset, n_features * a2,
+               TransposeProduct(Phi_pair, Phi_next, n_threads), -gamma);
+    }
+  }
+}
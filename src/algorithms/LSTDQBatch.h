@@ -0,0 +1,50 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef LSTDQ_BATCH_H
+#define LSTDQ_BATCH_H
+
+#include <vector>
+#include "BasisSet.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "real.h"
+
+/** A batch of transitions for LSTDQ.
+
+    The transitions are collected first. The features of all states
+    and next states are then evaluated at once, so that the blocks of
+    \f[
+    A = \delta I + \Phi^\top (\Phi - \gamma \Phi'), \qquad b = \Phi^\top r
+    \f]
+    are matrix products over the samples of each action and each pair
+    of action and next action, which are split among threads.
+ */
+class LSTDQBatch {
+ protected:
+  std::vector<Vector> states;
+  std::vector<int> actions;
+  std::vector<real> rewards;
+  std::vector<Vector> next_states;
+  std::vector<int> next_actions;
+  std::vector<bool> terminal;
+ public:
+  void Clear();
+  void Add(const Vector& state, int action, real reward,
+           const Vector& next_state, int next_action, bool endsim);
+  /// The number of transitions
+  int size() const { return (int)states.size(); }
+  void Calculate(const RBFBasisSet& bfs, int n_actions, real gamma,
+                 real regularisation, Matrix& A, Vector& b,
+                 int n_threads = 1) const;
+};
+
+#endif
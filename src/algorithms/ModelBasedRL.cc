@@ -21,6 +21,7 @@ ModelBasedRL::ModelBasedRL(int n_states_, int n_actions_, real gamma_,
       gamma(gamma_),
       epsilon(epsilon_),
       model(model_),
+      sweeping(NULL),
       rng(rng_),
       use_value_iteration(use_value_iteration_),
       total_steps(0) {
@@ -42,6 +43,25 @@ ModelBasedRL::~ModelBasedRL() {
   printf("# V expected\n");
 #endif
   delete value_iteration;
+  delete sweeping;
+}
+
+/** Plan incrementally with prioritized sweeping.
+
+    After each observed transition, only the changed state-action pair
+    is re-read from the model. States are then backed up in order of
+    priority until the residual falls below the threshold, or until
+    max_backups backups or max_time seconds have been spent.
+ */
+void ModelBasedRL::UsePrioritizedSweeping(real threshold, int max_backups,
+                                          real max_time) {
+  sweeping_threshold = threshold;
+  sweeping_max_backups = max_backups;
+  sweeping_max_time = max_time;
+  if (!sweeping) {
+    mdp = model->getMeanMDP();
+    sweeping = new PrioritizedSweeping(mdp, gamma);
+  }
 }
 
 void ModelBasedRL::Reset() {
@@ -52,13 +72,23 @@ void ModelBasedRL::Reset() {
 /// Full observation
 real ModelBasedRL::Observe(int state, int action, real reward, int next_state,
                            int next_action) {
-  if (state >= 0) model->AddTransition(state, action, reward, next_state);
+  if (state >= 0) {
+    model->AddTransition(state, action, reward, next_state);
+    if (sweeping) {
+      sweeping->Update(state, action);
+    }
+  }
   return 0.0;
 }
 
 /// Partial observation
 real ModelBasedRL::Observe(real reward, int next_state, int next_action) {
-  if (state >= 0) model->AddTransition(state, action, reward, next_state);
+  if (state >= 0) {
+    model->AddTransition(state, action, reward, next_state);
+    if (sweeping) {
+      sweeping->Update(state, action);
+    }
+  }
   state = next_state;
   action = next_action;
   total_steps++;
@@ -71,10 +101,26 @@ int ModelBasedRL::Act(real reward, int next_state) {
   assert(next_state >= 0 && next_state < n_states);
 
   // update the model
-  if (state >= 0) model->AddTransition(state, action, reward, next_state);
+  if (state >= 0) {
+    model->AddTransition(state, action, reward, next_state);
+    if (sweeping) {
+      sweeping->Update(state, action);
+    }
+  }
   state = next_state;
 
-  if (use_value_iteration) {
+  if (sweeping) {
+    const DiscreteMDP* mean_mdp = model->getMeanMDP();
+    if (mean_mdp != mdp) {
+      mdp = mean_mdp;
+      sweeping->setMDP(mdp);
+    }
+    sweeping->Sweep(sweeping_threshold, sweeping_max_backups,
+                    sweeping_max_time);
+    for (int i = 0; i < n_actions; i++) {
+      tmpQ[i] = sweeping->getValue(next_state, i);
+    }
+  } else if (use_value_iteration) {
     // if (mdp) {
     // delete mdp;
     //}
@@ -21,6 +21,7 @@
 #include "ExplorationPolicy.h"
 #include "MDPModel.h"
 #include "RandomNumberGenerator.h"
+#include "PrioritizedSweeping.h"
 #include "ValueIteration.h"
 
 /**
@@ -44,6 +45,10 @@ class ModelBasedRL : public OnlineAlgorithm<int, int> {
   MDPModel* model;
   const DiscreteMDP* mdp;
   ValueIteration* value_iteration;
+  PrioritizedSweeping* sweeping;  ///< incremental planner, if used
+  real sweeping_threshold;        ///< residual threshold for sweeping
+  int sweeping_max_backups;       ///< backup budget per step for sweeping
+  real sweeping_max_time;         ///< time budget per step for sweeping
   std::vector<real> tmpQ;
   RandomNumberGenerator* rng;
   bool use_value_iteration;
@@ -70,7 +75,9 @@ class ModelBasedRL : public OnlineAlgorithm<int, int> {
   virtual int Act(real reward, int next_state);
 
   virtual real getValue(int state, int action) {
-    if (use_value_iteration) {
+    if (sweeping) {
+      return sweeping->getValue(state, action);
+    } else if (use_value_iteration) {
       return value_iteration->getValue(state, action);
     } else {
       return 0.0;
@@ -79,8 +86,18 @@ class ModelBasedRL : public OnlineAlgorithm<int, int> {
 
   virtual void setFixedRewards(const Matrix& rewards) {
     model->setFixedRewards(rewards);
-    value_iteration->ComputeStateValues(1e-6, -1);
+    if (sweeping) {
+      sweeping->ComputeStateValues(sweeping_threshold);
+    } else {
+      value_iteration->ComputeStateValues(1e-6, -1);
+    }
   }
+
+  void UsePrioritizedSweeping(real threshold = 1e-6, int max_backups = -1,
+                              real max_time = -1);
+
+  /// Set the number of threads used for planning
+  void setNumberOfThreads(int n) { value_iteration->setNumberOfThreads(n); }
 };
 
 /*@}*/
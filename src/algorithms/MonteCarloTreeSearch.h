@@ -12,25 +12,114 @@
 #ifndef MONTE_CARLO_TREE_SEARCH_H
 #define MONTE_CARLO_TREE_SEARCH_H
 
+#include "CounterBasedRNG.h"
 #include "MersenneTwister.h"
 #include "RandomNumberFile.h"
 #include "RandomNumberGenerator.h"
 
 #include "RandomPolicy.h"
 
+#include <atomic>
+#include <functional>
 #include <limits>
+#include <mutex>
+#include "EasyClock.h"
 #include "Environment.h"
+#include "EnvironmentBatch.h"
 #include "Grid.h"
 #include "Matrix.h"
+#include "NodePool.h"
+#include "ParallelFor.h"
 #include "Random.h"
+#include "SearchStatistics.h"
+#include "TranspositionTable.h"
 #include "real.h"
 
 /** The original UCT Monte Carlo Tree Seach algorithm.
 
-
+    The search can use several threads, in one of two ways:
+
+    - ROOT_PARALLEL: every thread grows its own tree from the current
+    state, with its share of the rollouts. The statistics of the root
+    actions are then merged, weighting each tree by its visit counts.
+
+    - TREE_PARALLEL: all threads grow the same tree. Node statistics
+    are atomic, and a thread going down the tree adds a virtual loss
+    to each node on its path, so that the other threads tend to
+    explore different paths until the simulation is backed up.
+
+    Each thread simulates with its own Worker: a clone of the
+    environment, a clone of the rollout policy and an independent
+    random number stream. The first worker uses the environment,
+    policy and generator given to the constructor, so that a search
+    with one thread is the same as the sequential algorithm.
+
+    SelectAction(state, deadline) searches until a deadline instead of
+    for a fixed number of rollouts. With tree reuse, the subtree of
+    the chosen action becomes the root of the next search, if the
+    next state is close enough to the state of that child.
+
+    With a transposition table, states are mapped to keys, e.g. grid
+    cells, and paths that reach states with the same key at the same
+    depth share a node. The tree then becomes a directed acyclic
+    graph. The rewards of the transitions are stored with the edges,
+    and simulations are backed up along the path they took.
+
+    Nodes, their edges and their states are kept in an Arena for each
+    worker, so that threads make nodes without locking. The edges of
+    a node are one contiguous array, with one edge per action. The
+    whole tree is freed at once by clearing the arenas; a reused
+    subtree is first copied to a spare arena, which then takes the
+    place of the arena of the first worker.
+
+    With several leaf rollouts, each new leaf is evaluated by the mean
+    return of that many rollouts. If the environment has batched
+    dynamics, each worker simulates them in lockstep in an
+    EnvironmentBatch, and otherwise one after the other.
  */
 template <class S, class A>
 class MonteCarloTreeSearch {
+ public:
+  /// How the rollouts are split over threads
+  enum ParallelMode { ROOT_PARALLEL, TREE_PARALLEL };
+  struct Node;
+  /// The transition of an action, and the node it leads to
+  struct Edge {
+    std::atomic<Node*> child;  // NULL until the action is tried.
+    double reward;             // Reward received for the action.
+    Edge() : child(NULL), reward(0.0) {}
+  };
+  /// Storage for nodes, with their edges and states
+  struct Arena {
+    NodePool<Node> nodes;
+    NodePool<Edge> edges;
+    NodePool<real> states;
+    void Clear() {
+      nodes.Clear();
+      edges.Clear();
+      states.Clear();
+    }
+    void Swap(Arena& other) {
+      nodes.Swap(other.nodes);
+      edges.Swap(other.edges);
+      states.Swap(other.states);
+    }
+  };
+  /// The models a thread uses for its simulations
+  struct Worker {
+    ContinuousStateEnvironment* environment;  // The environment model.
+    AbstractPolicy<S, A>* policy;             // The rollout policy.
+    RandomNumberGenerator* rng;               // Random Number generator.
+    Arena* arena;                  // Where the thread makes nodes.
+    S state;                       // The state of a node.
+    std::vector<Node*> path;       // Nodes of the current simulation.
+    std::vector<double> rewards;   // Rewards along the path.
+    EnvironmentBatch* batch;       // Leaf rollouts, made when first used.
+    std::vector<int> actions;      // Actions of the leaf rollouts.
+  };
+  /// Maps states to transposition table keys
+  typedef std::function<ulong(const S&)> StateHash;
+
  private:
   real gamma;                               // Discount factor.
   ContinuousStateEnvironment* environment;  // The environment model.
@@ -38,208 +127,58 @@ class MonteCarloTreeSearch {
   AbstractPolicy<S, A>& policy;
   int MaxDepth;   // Maximum tree depth.
   int NRollouts;  // Number of sampled rollouts.
+  int n_leaf_rollouts;  // Number of rollouts from each new leaf.
+  bool batch_leaves;    // Whether leaf rollouts are simulated in a batch.
   int nActions;
+  int n_dimensions;              // Size of a state.
+  int n_threads;                 // Number of threads.
+  ParallelMode parallel_mode;    // How to use the threads.
+  real virtual_loss;             // Value of a simulation in progress.
+  bool use_virtual_loss;         // Whether threads share the current tree.
+  std::vector<Worker> workers;   // One per thread.
+  std::vector<CounterBasedRNG*> worker_rngs;  // Generators of the clones.
+  bool reuse_tree;             // Whether to keep the subtree of the action.
+  real reuse_tolerance;        // Maximum L1 distance of a reused root state.
+  int last_action;             // Action chosen in the last search.
+  SearchStatistics statistics;  // Statistics of the last search.
+  StateHash state_hash;        // Keys of the transposition table.
+  bool use_table;              // Whether nodes are shared in this search.
+  TranspositionTable<Node> table;  // Shared nodes.
+  std::mutex table_mutex;          // Held while using the table.
+  Arena spare;                     // Where a reused subtree is copied.
 
  public:
+  /** A state in the tree.
+
+      The statistics stay with the node, rather than in separate
+      arrays, so that threads can update them while other threads
+      add nodes to the arenas.
+   */
   struct Node {
-    int depth;  // Depth
-    S state;
-    double reward;  // Reward received during the transition from the father's
-                    // state
-    Node* father;  // Contains the previous state at the trajectory.
-    MonteCarloTreeSearch& tree;
+    std::atomic<int> nVisits;        // Number of visits
+    std::atomic<int> nVirtual;       // Number of simulations in progress
+    std::atomic<double> totalValue;  // Sum of the values
+    int depth;                       // Depth
     bool terminal;  // Represents if the node is a terminal state.
-    bool leaf;  // Represents if the specific node is a leaf or not
-
-    double epsilon;
-
-    std::vector<Node*> children;  // Pointer to the childrens
-    int nVisits;      // Number of visits
-    double aveValue;  // Mean Value
-
-    // Constructor
-    Node(const int& depth_, const S& state_, const double& reward_,
-         MonteCarloTreeSearch::Node* const father_, MonteCarloTreeSearch& tree_,
-         const bool& terminal_ = false)
-        : depth(depth_),
-          state(state_),  // Node's state representation.
-          reward(reward_),  // Reward received during the transition from the
-                            // father node.
-          father(father_),  // Father node.
-          tree(tree_),
-          terminal(terminal_) {
-      epsilon = 1E-06;
-      aveValue = 0;
-      nVisits = 0;
-      leaf = true;
-      children.resize(tree.nActions, NULL);
-    }
-
-    Node(const S& state_, MonteCarloTreeSearch& tree_)
-        : state(state_),  // Node's state representation.
-          tree(tree_) {
-      depth = 0;
-      reward = 0;
-      father = NULL;
-      terminal = false;
-      aveValue = 0;
-      nVisits = 0;
-      leaf = true;
-      children.resize(tree.nActions, NULL);
-    }
-
-    // Destructor
-    ~Node() {
-      for (int i = 0; i < tree.nActions; ++i) delete children[i];
-    }
-
-    void selectAction() {
-      Node* cur = this;
-      double RollingValue = 0;
-
-      // Selection phase (we cross the tree according to the UCT)
-      // printf("UCT Search\n");
-      while (cur->isLeaf() == false) {
-        cur = cur->UCTsearch();  // Tree policy
-      }
-
-      if (cur->isTerminal() == true) {
-        RollingValue = cur->getReward();
-      } else {
-        // Expansion phase
-        //	while(cur->getDepth()+1 < tree.MaxDepth && cur->isTerminal() ==
-        //false) {
-        cur = cur->expand();
-        //}
-        RollingValue = rollOut(cur->state);
-      }
-
-      // Backpropagation phase
-      while (cur != NULL) {
-        cur->updateStats(RollingValue);
-        RollingValue = cur->getReward() + tree.gamma * RollingValue;
-        cur = cur->father;
-      }
-    }
+    real* state;    // The state, in the arena.
+    Edge* edges;    // One for each action, in the arena.
+    Node* copy;     // Where the node was copied to, when reusing the tree.
+    std::mutex mutex;  // Held while expanding
+
+    Node(int depth_, bool terminal_, real* state_, Edge* edges_)
+        : nVisits(0),
+          nVirtual(0),
+          totalValue(0.0),
+          depth(depth_),
+          terminal(terminal_),
+          state(state_),
+          edges(edges_),
+          copy(NULL) {}
 
-    // Tree expansion
-    Node* expand() {
-      std::vector<int> Unvisited;  // Pointer to the childrens
-      int action;
-      // The unvisited children are declared
-      for (action = 0; action < tree.nActions; ++action) {
-        if (children[action] == NULL) {
-          Unvisited.push_back(action);
-        }
-      }
-      //  printf("Action selection\n");
-      // We select one child (uniform) randomly among the unvisited children.
-      if (Unvisited.empty()) {
-        real bestValue = -1000000000;
-        for (int i = 0; i < tree.nActions; i++) {
-          real curValue =
-              (children[i]->getReward() + tree.gamma * children[i]->aveValue) +
-              1000 * sqrt((sqrt(2) * log(nVisits)) /
-                          (children[i]->nVisits));  // UCT Search
-          if (curValue > bestValue) {
-            action = i;
-            bestValue = curValue;
-          }
-        }
-      } else {
-        action = Unvisited[tree.rng->discrete_uniform(Unvisited.size())];
-      }
-      tree.environment->Reset();
-      tree.environment->setState(state);
-      bool running = tree.environment->Act(action);
-      S child_state = tree.environment->getState();
-      real reward = tree.environment->getReward();
-
-      children[action] = new Node(depth + 1, child_state, reward, this, tree,
-                                  !running);  // The specific child is created
-
-      return children[action];
-    }
-
-    // Tree policy
-    Node* UCTsearch() {
-      real bestValue = -1000000000000;
-      Node* selected = NULL;
-      for (int i = 0; i < tree.nActions; ++i) {
-        real curValue =
-            (children[i]->getReward() + tree.gamma * children[i]->aveValue) +
-            1000 * sqrt((log(nVisits)) / (children[i]->nVisits));  // UCT Search
-        if (curValue > bestValue) {
-          selected = children[i];
-          bestValue = curValue;
-        }
-      }
-      return selected;
-    }
-    double rollOut(S state_) {
-      int t = 0;
-      int horizon = 1000;  // tree.MaxDepth - depth;
-      tree.environment->Reset();
-      tree.environment->setState(state_);
-      tree.policy.Reset();
-      bool running = true;
-      real discount = 1.0;
-      real total_reward = 0.0;
-      real discounted_reward = 0.0;
-
-      real reward = 0.0;
-      do {
-        // get current state
-        S state = tree.environment->getState();
-
-        // choose an action using Random policy
-        tree.policy.Observe(reward, state);
-        A action = tree.policy.SelectAction();
-
-        // execute the selected action
-        running = tree.environment->Act(action);
-
-        // get reward
-        reward = tree.environment->getReward();
-
-        total_reward += reward;
-        discounted_reward += discount * reward;
-
-        discount *= tree.gamma;
-
-        ++t;
-        if (t >= horizon) {
-          running = false;
-        }
-      } while (running);
-      // printf("Gamma = %f, discounted_reward =
-      // %f\n",tree.gamma,discounted_reward);
-      return discounted_reward;
-    }
     bool isTerminal() { return terminal; }
-    bool isRoot() {
-      if (father == NULL)
-        return true;
-      else
-        return false;
-    }
-    bool isLeaf() {
-      for (int action = 0; action < tree.nActions; ++action) {
-        if (children[action] == NULL) {
-          return true;
-        }
-      }
-      return false;
-    }
     int getDepth() { return depth; }
-    double getReward() { return reward; }
-    double getValue() { return aveValue; }
-    void setFather(Node* father_) { father = father_; }
-    void setState(S state_) { state = state_; }
-    void updateStats(double value) {
-      nVisits++;
-      aveValue += (value - aveValue) / nVisits;  // Mean value
-    }
+    /// Number of visits, including simulations in progress
+    int Visits() { return nVisits + nVirtual; }
   };
 
   // Constructor
@@ -253,43 +192,609 @@ class MonteCarloTreeSearch {
         rng(rng_),
         policy(policy_),
         MaxDepth(MaxDepth_),
-        NRollouts(NRollouts_) {
+        NRollouts(NRollouts_),
+        n_leaf_rollouts(1),
+        batch_leaves(false),
+        n_threads(1),
+        parallel_mode(TREE_PARALLEL),
+        virtual_loss(1.0),
+        use_virtual_loss(false),
+        reuse_tree(false),
+        reuse_tolerance(0.0),
+        last_action(-1),
+        use_table(false),
+        root(NULL) {
     nActions = environment->getNActions();
+    n_dimensions = environment->getState().Size();
+    Worker worker = {environment, &policy, rng, new Arena,
+                     environment->getState()};
+    workers.push_back(worker);
   };
 
   // Destructor
-  ~MonteCarloTreeSearch() { delete root; };
+  ~MonteCarloTreeSearch() {
+    FreeTree();
+    ClearWorkers();
+    delete workers[0].batch;
+    delete workers[0].arena;
+  };
 
-  int SelectAction(S state_) {
-    root = new Node(0, state_, 0.0, NULL, *this);
+  /** Use n_threads threads for the search, or all hardware threads if
+      n_threads <= 0.
+
+      This clones the environment and the policy once for each
+      additional thread, so it should be called again if the
+      environment changes. The clone random number streams are split
+      from a seed drawn from the search generator.
+   */
+  void setNumberOfThreads(int n_threads_, ParallelMode mode = TREE_PARALLEL) {
+    FreeTree();
+    ClearWorkers();
+    n_threads = ResolveNumberOfThreads(n_threads_);
+    parallel_mode = mode;
+    CounterBasedRNG master(rng->random());
+    for (int k = 1; k < n_threads; ++k) {
+      CounterBasedRNG* worker_rng = new CounterBasedRNG(master.Split(k));
+      worker_rngs.push_back(worker_rng);
+      Worker worker = {environment->Clone(), policy.Clone(worker_rng),
+                       worker_rng, new Arena, environment->getState()};
+      workers.push_back(worker);
+    }
+  }
+
+  /** Evaluate each new leaf by the mean discounted return of
+      n_leaf_rollouts rollouts, simulated in lockstep.
+
+      The rollouts of a worker share its policy, which is asked for
+      the action of each rollout in turn, so it should only depend on
+      the last observation.
+   */
+  void setLeafRollouts(int n_leaf_rollouts_) {
+    assert(n_leaf_rollouts_ > 0);
+    n_leaf_rollouts = n_leaf_rollouts_;
+    batch_leaves = EnvironmentBatch::HasBatchDynamics(*environment);
+    for (uint k = 0; k < workers.size(); ++k) {
+      delete workers[k].batch;
+      workers[k].batch = NULL;
+    }
+  }
+
+  /// Set the value that a simulation in progress counts as
+  void setVirtualLoss(real virtual_loss_) { virtual_loss = virtual_loss_; }
+
+  /** Keep the subtree of the chosen action for the next search.
+
+      The subtree is used if the next state is within L1 distance
+      tolerance of the state of the child, which is then replaced by
+      the actual state. For deterministic environments the tolerance
+      can be zero. Trees are not reused in root parallel searches.
+   */
+  void setTreeReuse(bool reuse_tree_, real tolerance = 0.0) {
+    reuse_tree = reuse_tree_;
+    reuse_tolerance = tolerance;
+    if (!reuse_tree) {
+      FreeTree();
+    }
+  }
+
+  /** Share the nodes of states with the same key at the same depth.
+
+      At most capacity nodes are kept in the table. A capacity of zero
+      turns the table off. The table is not used in root parallel
+      searches, where the trees are independent.
+   */
+  void setTranspositionTable(StateHash state_hash_, int capacity) {
+    FreeTree();
+    state_hash = state_hash_;
+    table.Resize(capacity);
+  }
+
+  /// Share the nodes of states in the same grid cell at the same depth
+  void setTranspositionTable(const EvenGrid& grid, int capacity) {
+    setTranspositionTable(
+        [grid](const S& state) { return (ulong)grid.getInterval(state); },
+        capacity);
+  }
+
+  /// Search with NRollouts rollouts
+  int SelectAction(S state_) { return Search(state_, NRollouts, 0.0); }
+
+  /** Search until the monotonic clock (GetMonotonicTime()) reaches
+      the deadline, and return the best action found so far.
+
+      Each thread checks the clock after each rollout, and does at
+      least one rollout.
+   */
+  int SelectAction(S state_, double deadline) {
+    return Search(state_, -1, deadline);
+  }
+
+  /// Statistics of the last search
+  const SearchStatistics& getStatistics() const { return statistics; }
 
-    for (int i = 0; i < NRollouts; ++i) {
-      root->selectAction();
+ protected:
+  std::vector<std::vector<Node*> > levels;
+  Node* root;
+
+  /// Make a node in the arena, with room for its state
+  Node* MakeNode(Arena& arena, int depth, bool terminal) {
+    real* state = arena.states.Get(arena.states.NewArray(n_dimensions));
+    Edge* edges = arena.edges.Get(arena.edges.NewArray(nActions));
+    return arena.nodes.Get(arena.nodes.New(depth, terminal, state, edges));
+  }
+
+  /// Copy state_ to the node
+  void setState(Node* node, const S& state_) {
+    for (int i = 0; i < n_dimensions; ++i) {
+      node->state[i] = state_[i];
     }
+  }
 
-    int sel_action = 0;
-    double bestValue =
-        root->children[0]->reward + gamma * root->children[0]->aveValue;
+  /// The state of the node, in the scratch state of the worker
+  const S& getState(Worker& worker, Node* node) {
+    for (int i = 0; i < n_dimensions; ++i) {
+      worker.state[i] = node->state[i];
+    }
+    return worker.state;
+  }
+
+  /// Make a node in the arena of the worker, or find one in the table
+  Node* NewNode(Worker& worker, int depth, const S& state_, bool terminal) {
+    if (!use_table) {
+      Node* node = MakeNode(*worker.arena, depth, terminal);
+      setState(node, state_);
+      return node;
+    }
+    ulong key = state_hash(state_);
+    std::lock_guard<std::mutex> lock(table_mutex);
+    Node* node = table.Find(key, depth);
+    if (node == NULL) {
+      node = MakeNode(*worker.arena, depth, terminal);
+      setState(node, state_);
+      table.Insert(key, depth, node);
+    }
+    return node;
+  }
 
-    // Find the best among the available actions
-    for (int action = 1; action < nActions; ++action) {
-      double curValue = root->children[action]->reward +
-                        gamma * root->children[action]->aveValue;
+  /// Whether some action of the node has not been tried
+  bool isLeaf(Node* node) {
+    for (int action = 0; action < nActions; ++action) {
+      if (node->edges[action].child.load() == NULL) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Mean value, counting simulations in progress as virtual losses
+  double getValue(Node* node) {
+    int n = node->Visits();
+    if (n == 0) {
+      return 0;
+    }
+    return (node->totalValue - node->nVirtual * virtual_loss) / n;
+  }
+
+  void updateStats(Node* node, double value) {
+    double total = node->totalValue.load();
+    while (!node->totalValue.compare_exchange_weak(total, total + value)) {
+    }
+    node->nVisits++;
+    if (use_virtual_loss) node->nVirtual--;
+  }
+
+  /// Run one simulation from node, and return the depth it reached
+  int Simulate(Worker& worker, Node* node) {
+    std::vector<Node*>& path = worker.path;
+    std::vector<double>& path_rewards = worker.rewards;
+    path.clear();
+    path_rewards.clear();
+    Node* cur = node;
+    double RollingValue = 0;
+
+    // Selection phase (we cross the tree according to the UCT)
+    if (use_virtual_loss) cur->nVirtual++;
+    path.push_back(cur);
+    while (isLeaf(cur) == false) {
+      int action = UCTsearch(cur);  // Tree policy
+      path_rewards.push_back(cur->edges[action].reward);
+      cur = cur->edges[action].child;
+      if (use_virtual_loss) cur->nVirtual++;
+      path.push_back(cur);
+    }
+
+    // The value of a terminal state is zero
+    if (cur->isTerminal() == false) {
+      // Expansion phase
+      int action = expand(worker, cur);
+      path_rewards.push_back(cur->edges[action].reward);
+      cur = cur->edges[action].child;
+      path.push_back(cur);
+      if (cur->isTerminal() == false) {
+        RollingValue = (n_leaf_rollouts > 1) ? BatchRollOut(worker, cur)
+                                             : rollOut(worker, cur);
+      }
+    }
+
+    // Backpropagation phase, along the path taken
+    for (int i = (int)path.size() - 1; i >= 0; --i) {
+      updateStats(path[i], RollingValue);
+      if (i > 0) {
+        RollingValue = path_rewards[i - 1] + gamma * RollingValue;
+      }
+    }
+    return (int)path.size() - 1;
+  }
+
+  /** Tree expansion: simulate an untried action, and return it.
+
+      The new child carries a virtual loss if threads share the tree.
+      In a graph, the child may be an existing node.
+   */
+  int expand(Worker& worker, Node* node) {
+    std::lock_guard<std::mutex> lock(node->mutex);
+    std::vector<int> Unvisited;
+    int action;
+    // The unvisited children are declared
+    for (action = 0; action < nActions; ++action) {
+      if (node->edges[action].child.load() == NULL) {
+        Unvisited.push_back(action);
+      }
+    }
+    // Another thread may have expanded the last child in the meantime,
+    // in which case we simply go down one more step.
+    if (Unvisited.empty()) {
+      action = UCTsearch(node);
+      if (use_virtual_loss) node->edges[action].child.load()->nVirtual++;
+      return action;
+    }
+    // We select one child (uniform) randomly among the unvisited children.
+    action = Unvisited[worker.rng->discrete_uniform(Unvisited.size())];
+    worker.environment->Reset();
+    worker.environment->setState(getState(worker, node));
+    bool running = worker.environment->Act(action);
+    real reward = worker.environment->getReward();
+
+    Node* child = NewNode(worker, node->depth + 1,
+                          worker.environment->getState(), !running);
+    if (use_virtual_loss) child->nVirtual++;
+    node->edges[action].reward = reward;
+    node->edges[action].child = child;
+
+    return action;
+  }
+
+  // Tree policy: the action with the highest upper confidence bound
+  int UCTsearch(Node* node) {
+    real bestValue = -1000000000000;
+    int selected = -1;
+    int N = node->Visits();
+    for (int i = 0; i < nActions; ++i) {
+      Edge& edge = node->edges[i];
+      Node* child = edge.child;
+      int n = child->Visits();
+      real curValue = (edge.reward + gamma * getValue(child)) +
+                      1000 * sqrt((log(N)) / n);  // UCT Search
       if (curValue > bestValue) {
-        sel_action = action;
+        selected = i;
         bestValue = curValue;
       }
     }
+    return selected;
+  }
+
+  double rollOut(Worker& worker, Node* node) {
+    int t = 0;
+    int horizon = 1000;  // MaxDepth - depth;
+    worker.environment->Reset();
+    worker.environment->setState(getState(worker, node));
+    worker.policy->Reset();
+    bool running = true;
+    real discount = 1.0;
+    real total_reward = 0.0;
+    real discounted_reward = 0.0;
+
+    real reward = 0.0;
+    do {
+      // get current state
+      S state = worker.environment->getState();
+
+      // choose an action using Random policy
+      worker.policy->Observe(reward, state);
+      A action = worker.policy->SelectAction();
+
+      // execute the selected action
+      running = worker.environment->Act(action);
+
+      // get reward
+      reward = worker.environment->getReward();
+
+      total_reward += reward;
+      discounted_reward += discount * reward;
+
+      discount *= gamma;
+
+      ++t;
+      if (t >= horizon) {
+        running = false;
+      }
+    } while (running);
+    return discounted_reward;
+  }
+
+  /** The mean discounted return of n_leaf_rollouts rollouts from
+      the node, simulated in lockstep with the batch of the worker if
+      the environment has batched dynamics.
+   */
+  double BatchRollOut(Worker& worker, Node* node) {
+    if (!batch_leaves) {
+      double total = 0.0;
+      for (int i = 0; i < n_leaf_rollouts; ++i) {
+        total += rollOut(worker, node);
+      }
+      return total / n_leaf_rollouts;
+    }
+    int horizon = 1000;  // as in rollOut()
+    if (worker.batch == NULL) {
+      worker.batch = new EnvironmentBatch(
+          *worker.environment, n_leaf_rollouts, worker.rng->random());
+      worker.actions.resize(n_leaf_rollouts);
+    }
+    EnvironmentBatch& batch = *worker.batch;
+    batch.setState(getState(worker, node));
+    worker.policy->Reset();
+    real discount = 1.0;
+    real discounted_reward = 0.0;
+    bool running = true;
+    for (int t = 0; t < horizon && running; ++t) {
+      for (int i = 0; i < n_leaf_rollouts; ++i) {
+        if (batch.getEndsim(i)) {
+          continue;
+        }
+        for (int d = 0; d < n_dimensions; ++d) {
+          worker.state[d] = batch.getStates(d)[i];
+        }
+        worker.policy->Observe(batch.getReward(i), worker.state);
+        worker.actions[i] = worker.policy->SelectAction();
+      }
+      running = batch.Act(worker.actions);
+      // lanes that had already stopped get no reward
+      for (int i = 0; i < n_leaf_rollouts; ++i) {
+        discounted_reward += discount * batch.getReward(i);
+      }
+      discount *= gamma;
+    }
+    return discounted_reward / n_leaf_rollouts;
+  }
+
+  /** Run simulate(worker) on each thread, n_rollouts times in total,
+      or until the deadline if n_rollouts < 0.
+
+      Each thread uses the random number stream of its worker. The
+      depth and number of rollouts are added to the statistics.
+   */
+  template <typename F>
+  void RunRollouts(int n_rollouts, double deadline, F simulate) {
+    std::vector<int> rollouts(n_threads, 0);
+    std::vector<int> depths(n_threads, 0);
+    auto run = [&](int block, int begin, int end) {
+      ScopedRandomNumberGenerator scope(
+          block ? workers[block].rng : getThreadRandomNumberGenerator());
+      bool running = (begin < end);
+      while (running) {
+        int depth = simulate(block);
+        if (depth > depths[block]) {
+          depths[block] = depth;
+        }
+        rollouts[block]++;
+        running = (n_rollouts >= 0) ? (++begin < end)
+                                    : (GetMonotonicTime() < deadline);
+      }
+    };
+    if (n_rollouts >= 0) {
+      ParallelFor(n_rollouts, n_threads, run);
+    } else {
+      ParallelFor(n_threads, n_threads, run);
+    }
+    for (int k = 0; k < n_threads; ++k) {
+      statistics.n_rollouts += rollouts[k];
+      if (depths[k] > statistics.depth) {
+        statistics.depth = depths[k];
+      }
+    }
+  }
+
+  /// Make the root for state_, reusing the last subtree if possible
+  void MakeRoot(const S& state_) {
+    if (root && reuse_tree && last_action >= 0) {
+      Node* child = root->edges[last_action].child;
+      if (child && !child->isTerminal()) {
+        real distance = 0.0;
+        for (int i = 0; i < n_dimensions; ++i) {
+          distance += fabs(child->state[i] - state_[i]);
+        }
+        if (distance <= reuse_tolerance) {
+          statistics.reused_visits = child->nVisits;
+          root = CopySubtree(child);
+          setState(root, state_);
+          return;
+        }
+      }
+    }
+    FreeTree();
+    root = NewNode(workers[0], 0, state_, false);
+  }
+
+  /** Copy the nodes reachable from node to the spare arena, and free
+      the others.
+
+      The spare arena becomes the arena of the first worker, and the
+      transposition table is filled again with the copies.
+   */
+  Node* CopySubtree(Node* node) {
+    table.Clear();
+    std::vector<Node*> stack;
+    CopyNode(node);
+    stack.push_back(node);
+    while (!stack.empty()) {
+      Node* original = stack.back();
+      stack.pop_back();
+      for (int action = 0; action < nActions; ++action) {
+        Edge& edge = original->edges[action];
+        Node* child = edge.child;
+        original->copy->edges[action].reward = edge.reward;
+        if (child == NULL) {
+          continue;
+        }
+        if (child->copy == NULL) {
+          CopyNode(child);
+          stack.push_back(child);
+        }
+        original->copy->edges[action].child = child->copy;
+      }
+    }
+    Node* subtree = node->copy;
+    for (uint k = 0; k < workers.size(); ++k) {
+      workers[k].arena->Clear();
+    }
+    spare.Swap(*workers[0].arena);
+    return subtree;
+  }
+
+  /// Copy the node, without its children, to the spare arena
+  void CopyNode(Node* node) {
+    Node* copy = MakeNode(spare, node->depth, node->terminal);
+    for (int i = 0; i < n_dimensions; ++i) {
+      copy->state[i] = node->state[i];
+    }
+    copy->nVisits = node->nVisits.load();
+    copy->totalValue = node->totalValue.load();
+    node->copy = copy;
+    if (use_table) {
+      table.Insert(state_hash(getState(workers[0], copy)), copy->depth, copy);
+    }
+  }
+
+  /// Free the tree, and empty the transposition table
+  void FreeTree() {
+    root = NULL;
+    for (uint k = 0; k < workers.size(); ++k) {
+      workers[k].arena->Clear();
+    }
+    table.Clear();
+  }
+
+  /// Number of nodes in the arenas
+  int NumberOfNodes() {
+    int n_nodes = 0;
+    for (uint k = 0; k < workers.size(); ++k) {
+      n_nodes += workers[k].arena->nodes.size();
+    }
+    return n_nodes;
+  }
+
+  /// Search with n_rollouts rollouts, or until the deadline if n_rollouts < 0
+  int Search(const S& state_, int n_rollouts, double deadline) {
+    double start_time = GetMonotonicTime();
+    statistics = SearchStatistics();
+    int sel_action;
+    if (n_threads > 1 && parallel_mode == ROOT_PARALLEL) {
+      use_table = false;
+      sel_action = RootParallelSearch(state_, n_rollouts, deadline);
+    } else {
+      use_table = (table.Capacity() > 0);
+      MakeRoot(state_);
+      use_virtual_loss = (n_threads > 1);
+      RunRollouts(n_rollouts, deadline, [&](int block) {
+        return Simulate(workers[block], root);
+      });
+      use_virtual_loss = false;
+
+      sel_action = -1;
+      double bestValue = -std::numeric_limits<double>::infinity();
+
+      // Find the best among the available actions
+      for (int action = 0; action < nActions; ++action) {
+        Node* child = root->edges[action].child;
+        if (child == NULL) {
+          continue;
+        }
+        double curValue = root->edges[action].reward + gamma * getValue(child);
+        if (curValue > bestValue) {
+          sel_action = action;
+          bestValue = curValue;
+        }
+      }
+      statistics.tree_size = NumberOfNodes();
+      if (reuse_tree) {
+        last_action = sel_action;
+      } else {
+        FreeTree();
+      }
+    }
     environment->Reset();
     environment->setState(state_);
-
-    delete root;
-
+    statistics.elapsed = GetMonotonicTime() - start_time;
     return sel_action;
-  };
-
- protected:
-  std::vector<std::vector<Node*> > levels;
-  Node* root;
+  }
+
+  /// Grow one tree per thread, and merge the root statistics
+  int RootParallelSearch(const S& state_, int n_rollouts, double deadline) {
+    FreeTree();
+    std::vector<Node*> roots(n_threads, (Node*)NULL);
+    for (int k = 0; k < n_threads; ++k) {
+      roots[k] = NewNode(workers[k], 0, state_, false);
+    }
+    RunRollouts(n_rollouts, deadline, [&](int block) {
+      return Simulate(workers[block], roots[block]);
+    });
+
+    // Each root action value is weighted by its number of visits
+    std::vector<int> visits(nActions, 0);
+    std::vector<double> values(nActions, 0.0);
+    for (int k = 0; k < n_threads; ++k) {
+      for (int action = 0; action < nActions; ++action) {
+        Edge& edge = roots[k]->edges[action];
+        Node* child = edge.child;
+        if (child == NULL) {
+          continue;
+        }
+        visits[action] += child->nVisits;
+        values[action] +=
+            child->nVisits * (edge.reward + gamma * getValue(child));
+      }
+    }
+    statistics.tree_size = NumberOfNodes();
+    FreeTree();
+
+    int sel_action = -1;
+    double bestValue = -std::numeric_limits<double>::infinity();
+    for (int action = 0; action < nActions; ++action) {
+      if (visits[action] == 0) {
+        continue;
+      }
+      double curValue = values[action] / visits[action];
+      if (curValue > bestValue) {
+        sel_action = action;
+        bestValue = curValue;
+      }
+    }
+    return sel_action;
+  }
+
+  /// Free the clones made for the additional threads
+  void ClearWorkers() {
+    for (uint k = 1; k < workers.size(); ++k) {
+      delete workers[k].environment;
+      delete workers[k].policy;
+      delete workers[k].arena;
+      delete workers[k].batch;
+    }
+    workers.resize(1);
+    for (uint k = 0; k < worker_rngs.size(); ++k) {
+      delete worker_rngs[k];
+    }
+    worker_rngs.clear();
+  }
 };
 #endif
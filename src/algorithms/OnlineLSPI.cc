@@ -19,7 +19,8 @@ OnlineLSPI::OnlineLSPI(real gamma_, real Delta_, int n_dimension_,
       n_actions(n_actions_),
       max_iteration(max_iteration_),
       bfs(bfs_),
-      policy(n_dimension, n_actions, bfs) {
+      policy(n_dimension, n_actions, bfs),
+      recursive(n_actions_ * (bfs_->size() + 1)) {
   assert(gamma >= 0 && gamma <= 1);
   n_basis = n_actions * (bfs->size() + 1);
   algorithm = 1;
@@ -39,7 +40,8 @@ OnlineLSPI::OnlineLSPI(real gamma_, real Delta_, int n_dimension_,
       max_iteration(max_iteration_),
       algorithm(algorithm_),
       bfs(bfs_),
-      policy(n_dimension, n_actions, bfs) {
+      policy(n_dimension, n_actions, bfs),
+      recursive(n_actions_ * (bfs_->size() + 1)) {
   assert(gamma >= 0 && gamma <= 1);
   assert(algorithm >= 1 && algorithm <= 2);
   n_basis = n_actions * (bfs->size() + 1);
@@ -77,19 +79,17 @@ void OnlineLSPI::LSTDQ(const Vector& state, const int& action,
                        const bool& update) {
   Vector Phi_;
   Vector Phi;
-  Matrix res;
 
   Phi_ = BasisFunction(state, action);
   if (endsim) {
-    res = OuterProduct(Phi_, Phi_);
+    A.AddOuterProduct(Phi_, Phi_);
   } else {
     Phi = BasisFunction(state_, action_);
-    res = OuterProduct(Phi_, (Phi_ - (Phi * gamma)));
+    A.AddOuterProduct(Phi_, Phi_ - (Phi * gamma));
   }
-
-  A += res;
   b += Phi_ * reward;
 }
+/// Add a sample, updating the inverse of A in O(k^2)
 void OnlineLSPI::LSTDQ_OPT(const Vector& state, const int& action,
                            const real& reward, const Vector& state_,
                            const int& action_, const bool& endsim,
@@ -97,10 +97,6 @@ void OnlineLSPI::LSTDQ_OPT(const Vector& state, const int& action,
   Vector Phi_;
   Vector Phi;
   Vector Phi_dif;
-  Matrix res;
-  real d = 0.000001;
-  A = Matrix::Unity(n_basis, n_basis) * (1 / d);
-  b.Clear();
 
   Phi_ = BasisFunction(state, action);
   if (endsim) {
@@ -109,24 +105,21 @@ void OnlineLSPI::LSTDQ_OPT(const Vector& state, const int& action,
     Phi = BasisFunction(state_, action_);
     Phi_dif = Phi_ - (Phi * gamma);
   }
-  res = OuterProduct(Phi_, Phi_dif);
-  const Matrix p = A;
-  real v = Product(p * Phi_, Phi_dif);
-  A -= (((A * res) * A) / (v + 1));
-  b += Phi_ * reward;
+  recursive.AddSample(Phi_, Phi_dif, reward);
 }
 void OnlineLSPI::Update() {
   if (algorithm == 1) {
     const Matrix w_ = A.Inverse_LU();
     w = w_ * b;
   } else if (algorithm == 2) {
-    const Matrix w_ = A;
-    w = w_ * b;
+    // reuse the current inverse
+    w = recursive.getWeights();
   }
   policy.Update(w);
 }
 void OnlineLSPI::Reset() {
   A = Matrix::Unity(n_basis, n_basis) * 1e-6;
+  recursive.Reset();
   b = Vector::Null(n_basis);
   w = Vector::Null(n_basis);
 }
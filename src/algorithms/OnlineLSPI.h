@@ -18,6 +18,7 @@
 #include "ContinuousPolicy.h"
 #include "Matrix.h"
 #include "RandomPolicy.h"
+#include "RecursiveLSTDQ.h"
 #include "Rollout.h"
 #include "Vector.h"
 #include "real.h"
@@ -36,6 +37,7 @@ class OnlineLSPI {
   Vector w;
   RBFBasisSet* bfs;
   FixedContinuousPolicy policy;
+  RecursiveLSTDQ recursive;  ///< the inverse of A, for algorithm 2
 
  public:
   OnlineLSPI(real gamma_, real Delta_, int n_dimension_, int n_actions_,
@@ -58,6 +60,10 @@ class OnlineLSPI {
   void Update();
   real getValue(const Vector& state, int action);
   FixedContinuousPolicy& ReturnPolicy() { return policy; }
+  /// Discount old samples by a factor in (0, 1] (algorithm 2 only)
+  void setForgettingFactor(real forgetting) {
+    recursive.setForgettingFactor(forgetting);
+  }
 };
 
 #endif
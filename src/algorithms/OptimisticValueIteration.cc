@@ -28,6 +28,7 @@ OptimisticValueIteration::OptimisticValueIteration(const DiscreteMDPCounts* mdp,
   this->mdp = mdp;
   this->gamma = gamma;
   this->baseline = baseline;
+  n_threads = 1;
   n_actions = mdp->getNActions();
   n_states = mdp->getNStates();
   Reset();
@@ -82,6 +83,7 @@ void OptimisticValueIteration::ComputeStateValuesAugmentedMDP(real delta,
   augmented_mdp.Check();
 
   ValueIteration vi(&augmented_mdp, gamma);
+  vi.setNumberOfThreads(n_threads);
   vi.ComputeStateValues(threshold, max_iter);
   for (int s = 0; s < n_states; s++) {
     int a_aug = 0;
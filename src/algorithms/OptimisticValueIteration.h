@@ -16,6 +16,7 @@
 #include <vector>
 #include "DiscreteMDPCounts.h"
 #include "DiscretePolicy.h"
+#include "ParallelFor.h"
 #include "real.h"
 
 /** Optimistic value iteration.
@@ -31,6 +32,7 @@ class OptimisticValueIteration {
   Vector V;  ///< state values
   Matrix Q;  ///< state-action value
   real baseline;
+  int n_threads;  ///< number of threads used by value iteration
 
   OptimisticValueIteration(const DiscreteMDPCounts* mdp, real gamma,
                            real baseline = 0.0);
@@ -50,6 +52,10 @@ class OptimisticValueIteration {
                                              int max_iter = -1) {
     ComputeStateValuesAugmentedMDP(delta, 1.0, threshold, max_iter);
   }
+  /// Set the number of threads (all hardware threads if n <= 0)
+  inline void setNumberOfThreads(int n) {
+    n_threads = ResolveNumberOfThreads(n);
+  }
   inline real getValue(int state, int action) { return Q(state, action); }
   inline real getValue(int state) { return V(state); }
   inline Matrix getValues() { return Q; }
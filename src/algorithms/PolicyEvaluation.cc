@@ -21,7 +21,11 @@
 PolicyEvaluation::PolicyEvaluation(FixedDiscretePolicy* policy_,
                                    const DiscreteMDP* mdp_, real gamma_,
                                    real baseline_)
-    : policy(policy_), mdp(mdp_), gamma(gamma_), baseline(baseline_) {
+    : policy(policy_),
+      mdp(mdp_),
+      gamma(gamma_),
+      baseline(baseline_),
+      n_threads(1) {
   assert(mdp);
   assert(gamma >= 0 && gamma <= 1);
 
@@ -47,10 +51,43 @@ PolicyEvaluation::~PolicyEvaluation() {}
     threshold - exit when difference in Q is smaller than the threshold
     max_iter - exit when the number of iterations reaches max_iter
 
+    With a single thread, values are updated in place (Gauss-Seidel).
+    With more threads, each sweep computes the new values of a block of
+    states from the previous values (Jacobi), so the number of
+    iterations may differ from the serial version, but not the fixed
+    point. The result does not depend on the number of threads.
 */
 void PolicyEvaluation::ComputeStateValues(real threshold, int max_iter) {
   assert(policy);
   int n_iter = 0;
+  if (n_threads > 1) {
+    kernel.Synchronise(*mdp);
+    Vector pV(n_states);
+    Vector dV(n_states);
+    do {
+      pV = V;
+      ParallelFor(n_states, n_threads, [&](int block, int begin, int end) {
+        for (int s = begin; s < end; s++) {
+          real V_s = 0.0;
+          for (int a = 0; a < n_actions; a++) {
+            V_s += policy->getActionProbability(s, a) * getValue(s, a, pV);
+          }
+          dV[s] = pV[s] - V_s;
+          V[s] = V_s;
+        }
+      });
+      Delta = 0.0;
+      for (int s = 0; s < n_states; s++) {
+        Delta += fabs(dV[s]);
+      }
+      if (max_iter > 0) {
+        max_iter--;
+      }
+      n_iter++;
+    } while ((Delta >= threshold) && max_iter != 0);
+    printf("Exiting at delta = %f, after %d iter\n", Delta, n_iter);
+    return;
+  }
   do {
     Delta = 0.0;
     for (int s = 0; s < n_states; s++) {
@@ -111,15 +148,18 @@ void PolicyEvaluation::RecomputeStateValuesFeatureExpectation() {
 }
 
 /// Get the value of a particular state-action pair
+///
+/// The MDP is read through a compiled snapshot, which is only rebuilt
+/// when the MDP changes.
 real PolicyEvaluation::getValue(int state, int action) const {
-  real V_next = 0.0;
-  // for (int s2=0; s2<n_states; s2++) {
-  DiscreteStateSet next = mdp->getNextStates(state, action);
-  for (DiscreteStateSet::iterator i = next.begin(); i != next.end(); ++i) {
-    int s2 = *i;
-    real P = mdp->getTransitionProbability(state, action, s2);
-    V_next += P * V[s2];
-  }
-  real V_s = mdp->getExpectedReward(state, action) + gamma * V_next - baseline;
+  kernel.Synchronise(*mdp);
+  return getValue(state, action, V);
+}
+
+/// Get the value of a state-action pair given next state values W,
+/// assuming that the snapshot of the MDP is current.
+real PolicyEvaluation::getValue(int state, int action, const Vector& W) const {
+  real V_next = kernel.ExpectedNextValue(state, action, W);
+  real V_s = kernel.getExpectedReward(state, action) + gamma * V_next - baseline;
   return V_s;
 }
@@ -14,11 +14,17 @@
 #define POLICY_EVALUATION_H
 
 #include <vector>
+#include "CompiledDiscreteMDP.h"
 #include "DiscreteMDP.h"
 #include "DiscretePolicy.h"
+#include "ParallelFor.h"
 #include "real.h"
 
 class PolicyEvaluation {
+ protected:
+  mutable CompiledDiscreteMDP kernel;  ///< compiled snapshot of the MDP
+  real getValue(int state, int action, const Vector& W) const;
+
  public:
   FixedDiscretePolicy* policy;
   const DiscreteMDP* mdp;
@@ -29,6 +35,7 @@ class PolicyEvaluation {
   Vector V;
   real Delta;
   real baseline;
+  int n_threads;  ///< number of threads for the sweeps
   PolicyEvaluation(FixedDiscretePolicy* policy_, const DiscreteMDP* mdp_,
                    real gamma_, real baseline_ = 0.0);
   virtual ~PolicyEvaluation();
@@ -37,6 +44,10 @@ class PolicyEvaluation {
                                                     int max_iter = -1);
   virtual void RecomputeStateValuesFeatureExpectation();
   inline void SetPolicy(FixedDiscretePolicy* policy_) { policy = policy_; }
+  /// Set the number of threads (all hardware threads if n <= 0)
+  inline void setNumberOfThreads(int n) {
+    n_threads = ResolveNumberOfThreads(n);
+  }
   void Reset();
   real getValue(int state, int action) const;
   inline real getValue(int state) const { return V[state]; }
@@ -0,0 +1,199 @@
+// -*- Mode: c++ -*-
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "PrioritizedSweeping.h"
+#include <cassert>
+#include <cmath>
+#include "EasyClock.h"
+#include "MathFunctions.h"
+
+PrioritizedSweeping::PrioritizedSweeping(const DiscreteMDP* mdp, real gamma,
+                                         real baseline) {
+  assert(mdp);
+  assert(gamma >= 0 && gamma <= 1);
+  this->mdp = mdp;
+  this->gamma = gamma;
+  this->baseline = baseline;
+  n_actions = mdp->getNActions();
+  n_states = mdp->getNStates();
+  Reset();
+}
+
+PrioritizedSweeping::~PrioritizedSweeping() {}
+
+/// Set all values to zero and re-read the MDP.
+void PrioritizedSweeping::Reset() {
+  V.Resize(n_states);
+  V.Clear();
+  Q.Resize(n_states, n_actions);
+  Q.Clear();
+  Delta = 0.0;
+  n_backups = 0;
+  Rebuild();
+}
+
+/// Use another MDP, keeping the current values as a starting point.
+void PrioritizedSweeping::setMDP(const DiscreteMDP* mdp_) {
+  assert(mdp_->getNStates() == n_states);
+  assert(mdp_->getNActions() == n_actions);
+  mdp = mdp_;
+  Rebuild();
+}
+
+/** Re-read the whole MDP.
+
+    All states are queued with infinite priority, so the next sweep
+    backs up every state at least once.
+ */
+void PrioritizedSweeping::Rebuild() {
+  int N = n_states * n_actions;
+  next_state.assign(N, std::vector<int>());
+  probability.assign(N, std::vector<real>());
+  R.assign(N, 0.0);
+  predecessors.assign(n_states, std::vector<std::pair<int, real> >());
+  for (int s = 0; s < n_states; ++s) {
+    for (int a = 0; a < n_actions; ++a) {
+      ReadRow(s, a);
+    }
+  }
+  queue = std::priority_queue<Entry>();
+  priority.assign(n_states, 0.0);
+  for (int s = 0; s < n_states; ++s) {
+    AddPriority(s, INF);
+  }
+}
+
+/// Re-read the transitions and reward of (s,a), updating the predecessors.
+void PrioritizedSweeping::ReadRow(int s, int a) {
+  int ID = getID(s, a);
+  std::vector<int>& next = next_state[ID];
+  for (uint i = 0; i < next.size(); ++i) {
+    std::vector<std::pair<int, real> >& pred = predecessors[next[i]];
+    for (uint j = 0; j < pred.size(); ++j) {
+      if (pred[j].first == ID) {
+        pred[j] = pred.back();
+        pred.pop_back();
+        break;
+      }
+    }
+  }
+  next.clear();
+  probability[ID].clear();
+  const DiscreteStateSet& next_set = mdp->getNextStates(s, a);
+  for (DiscreteStateSet::const_iterator i = next_set.begin();
+       i != next_set.end(); ++i) {
+    int s2 = *i;
+    real P = mdp->getTransitionProbability(s, a, s2);
+    if (P > 0) {
+      next.push_back(s2);
+      probability[ID].push_back(P);
+      predecessors[s2].push_back(std::make_pair(ID, P));
+    }
+  }
+  R[ID] = mdp->getExpectedReward(s, a);
+}
+
+/// Raise the priority of state s by p.
+void PrioritizedSweeping::AddPriority(int s, real p) {
+  if (p <= 0) {
+    return;
+  }
+  priority[s] += p;
+  queue.push(Entry(priority[s], s));
+}
+
+/// Back up all actions of state s and return the change in its value.
+real PrioritizedSweeping::Backup(int s) {
+  for (int a = 0; a < n_actions; ++a) {
+    int ID = getID(s, a);
+    const std::vector<int>& next = next_state[ID];
+    const std::vector<real>& P = probability[ID];
+    real V_next = 0.0;
+    for (uint i = 0; i < next.size(); ++i) {
+      V_next += P[i] * V(next[i]);
+    }
+    Q(s, a) = R[ID] - baseline + gamma * V_next;
+  }
+  real V_s = Max(n_actions, &Q(s, 0));
+  real dV = V_s - V(s);
+  V(s) = V_s;
+  return dV;
+}
+
+/** Notify the planner that the model has changed at (s,a).
+
+    The row is re-read from the MDP and s is queued with its new Bellman
+    residual as priority.
+ */
+void PrioritizedSweeping::Update(int s, int a) {
+  ReadRow(s, a);
+  int ID = getID(s, a);
+  real V_next = 0.0;
+  for (uint i = 0; i < next_state[ID].size(); ++i) {
+    V_next += probability[ID][i] * V(next_state[ID][i]);
+  }
+  Q(s, a) = R[ID] - baseline + gamma * V_next;
+  AddPriority(s, fabs(Max(n_actions, &Q(s, 0)) - V(s)));
+}
+
+/** Back up states in order of priority.
+
+    The sweep stops when the highest priority is below the threshold,
+    after max_backups backups, or after max_time seconds, whichever
+    comes first. Negative budgets mean no limit. States that were not
+    processed stay in the queue for the next sweep.
+
+    \return the number of backups performed.
+ */
+int PrioritizedSweeping::Sweep(real threshold, int max_backups,
+                               real max_time) {
+  double start = GetMonotonicTime();
+  n_backups = 0;
+  Delta = 0.0;
+  while (!queue.empty()) {
+    Entry top = queue.top();
+    int s = top.second;
+    if (top.first != priority[s]) {
+      // stale entry: the state has been re-queued or backed up since
+      queue.pop();
+      continue;
+    }
+    Delta = top.first;
+    if (Delta < threshold) {
+      break;
+    }
+    if (max_backups >= 0 && n_backups >= max_backups) {
+      break;
+    }
+    if (max_time >= 0 && GetMonotonicTime() - start >= max_time) {
+      break;
+    }
+    queue.pop();
+    priority[s] = 0.0;
+    real dV = fabs(Backup(s));
+    n_backups++;
+    if (dV > 0) {
+      const std::vector<std::pair<int, real> >& pred = predecessors[s];
+      for (uint i = 0; i < pred.size(); ++i) {
+        AddPriority(pred[i].first / n_actions, gamma * pred[i].second * dV);
+      }
+    }
+  }
+  if (queue.empty()) {
+    Delta = 0.0;
+  }
+  return n_backups;
+}
+
+/// Create the greedy policy with respect to the calculated value function.
+FixedDiscretePolicy* PrioritizedSweeping::getPolicy() const {
+  return new FixedDiscretePolicy(n_states, n_actions, Q);
+}
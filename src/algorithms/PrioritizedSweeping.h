@@ -0,0 +1,96 @@
+// -*- Mode: c++ -*-
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PRIORITIZED_SWEEPING_H
+#define PRIORITIZED_SWEEPING_H
+
+#include <queue>
+#include <utility>
+#include <vector>
+#include "DiscreteMDP.h"
+#include "DiscretePolicy.h"
+#include "Matrix.h"
+#include "Vector.h"
+#include "real.h"
+
+/** Asynchronous value iteration with prioritized sweeping.
+
+    Instead of sweeping over all states, this planner keeps a priority
+    queue of states whose values may be out of date. The priority of a
+    state is an estimate of its Bellman residual: whenever the value of
+    a state \f$s'\f$ changes by \f$\Delta\f$, each predecessor \f$s\f$
+    with \f$P(s'|s,a) > 0\f$ has its priority increased by \f$\gamma
+    P(s'|s,a) |\Delta|\f$.
+
+    When the model changes in a single state-action pair, call
+    Update(s, a): only that row is re-read from the MDP and only its
+    state is queued, so that the cost of re-planning after a new
+    observation depends on how far the change propagates rather than on
+    the size of the state space.
+
+    The planner keeps its own copy of the transition rows, together with
+    the predecessor graph. Changes to the MDP that are not reported
+    through Update() are only picked up by Rebuild().
+ */
+class PrioritizedSweeping {
+ protected:
+  typedef std::pair<real, int> Entry;  ///< (priority, state)
+  const DiscreteMDP* mdp;              ///< pointer to the MDP
+  std::vector<std::vector<int> > next_state;    ///< next states of each (s,a)
+  std::vector<std::vector<real> > probability;  ///< probabilities of each (s,a)
+  std::vector<real> R;                          ///< expected reward of (s,a)
+  /// predecessors of each state, as (s,a) IDs and probabilities
+  std::vector<std::vector<std::pair<int, real> > > predecessors;
+  std::priority_queue<Entry> queue;  ///< states to update
+  std::vector<real> priority;        ///< current priority of each state
+  inline int getID(int s, int a) const {
+    assert(s >= 0 && s < n_states);
+    assert(a >= 0 && a < n_actions);
+    return s * n_actions + a;
+  }
+  void ReadRow(int s, int a);
+  void AddPriority(int s, real p);
+  real Backup(int s);
+
+ public:
+  real gamma;     ///< discount factor
+  int n_states;   ///< number of states
+  int n_actions;  ///< number of actions
+  Vector V;       ///< state values
+  Matrix Q;       ///< state-action values
+  real Delta;     ///< priority of the next state in the queue
+  real baseline;  ///< baseline reward
+  int n_backups;  ///< number of backups performed in the last sweep
+  PrioritizedSweeping(const DiscreteMDP* mdp, real gamma,
+                      real baseline = 0.0);
+  ~PrioritizedSweeping();
+  void Reset();
+  void Rebuild();
+  void setMDP(const DiscreteMDP* mdp_);
+  void Update(int s, int a);
+  int Sweep(real threshold, int max_backups = -1, real max_time = -1);
+  /// Plan from scratch, queueing all states
+  void ComputeStateValues(real threshold, int max_backups = -1) {
+    Rebuild();
+    Sweep(threshold, max_backups);
+  }
+  inline void setDiscount(real gamma_) {
+    assert(gamma_ >= 0.0 && gamma_ <= 1.0);
+    gamma = gamma_;
+  }
+  inline real getValue(int state, int action) const { return Q(state, action); }
+  inline real getValue(int state) const { return V(state); }
+  /// Number of states waiting to be updated
+  inline int getQueueSize() const { return (int)queue.size(); }
+  FixedDiscretePolicy* getPolicy() const;
+};
+
+#endif
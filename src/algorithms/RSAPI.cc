@@ -10,6 +10,7 @@
  ***************************************************************************/
 
 #include "RSAPI.h"
+#include "EnvironmentBatch.h"
 #include "GeometricDistribution.h"
 #include "RandomNumberGenerator.h"
 
@@ -41,11 +42,71 @@ Rollout<Vector, int, AbstractPolicy<Vector, int> >* RolloutState::NewRollout(
   return rollout;
 }
 
-/// Extend all rollouts by T
+/** Extend all rollouts by T.
+
+    The rollouts are sampled again from their start state. If the
+    environment has batched dynamics, they are simulated in lockstep
+    in an EnvironmentBatch: after its start action, each rollout takes
+    the action of its policy in its own current state. If T < 0, each
+    rollout stops with probability \f$1 - \gamma\f$ after every step,
+    as in Rollout::Sample(). Otherwise, each rollout is sampled in
+    turn with the environment itself.
+ */
 void RolloutState::ExtendAllRollouts(const int T) {
-  for (uint i = 0; i < rollouts.size(); ++i) {
-    // logmsg("performing %d-th rollout for state\n", i);
-    rollouts[i]->Sample(T);
+  int n_rollouts = rollouts.size();
+  if (!EnvironmentBatch::HasBatchDynamics(*environment)) {
+    for (int i = 0; i < n_rollouts; ++i) {
+      rollouts[i]->Sample(T);
+    }
+    return;
+  }
+  if (n_rollouts == 0) {
+    return;
+  }
+  EnvironmentBatch batch(*environment, n_rollouts, lrandom());
+  batch.Reset();
+  for (int i = 0; i < n_rollouts; ++i) {
+    Rollout<Vector, int, AbstractPolicy<Vector, int> >* rollout = rollouts[i];
+    batch.setState(i, rollout->start_state);
+    rollout->total_reward = 0;
+    rollout->discounted_reward = 0;
+    rollout->running = true;
+  }
+  std::vector<int> actions(n_rollouts);
+  real discount_factor = 1;
+  for (int t = 0; (t < T || T < 0) && batch.NRunning() > 0; ++t) {
+    for (int i = 0; i < n_rollouts; ++i) {
+      Rollout<Vector, int, AbstractPolicy<Vector, int> >* rollout = rollouts[i];
+      if (!rollout->running) {
+        continue;
+      }
+      if (t == 0) {
+        actions[i] = rollout->start_action;
+      } else {
+        rollout->policy->setState(rollout->end_state);
+        actions[i] = rollout->policy->SelectAction();
+      }
+    }
+    batch.Act(actions);
+    for (int i = 0; i < n_rollouts; ++i) {
+      Rollout<Vector, int, AbstractPolicy<Vector, int> >* rollout = rollouts[i];
+      if (!rollout->running) {
+        continue;
+      }
+      real reward = batch.getReward(i);
+      rollout->end_state = batch.getState(i);
+      rollout->running = !batch.getEndsim(i);
+      rollout->T++;
+      rollout->total_reward += reward;
+      rollout->discounted_reward += reward * discount_factor;
+      if (T < 0 && rollout->running && urandom() < 1.0 - gamma) {
+        rollout->running = false;
+        batch.Stop(i);
+      }
+    }
+    if (T >= 0) {
+      discount_factor *= gamma;
+    }
   }
 }
 
@@ -276,7 +337,7 @@ std::pair<Vector, bool> RolloutState::BestGroupAction(real delta) {
     TODO This does not work at the moment.
  */
 
-void RolloutState::Bootstrap(KDTree<RolloutState>& tree, real L) {
+void RolloutState::Bootstrap(FlatKDTree<RolloutState>& tree, real L) {
   Vector Q_U((int)environment->getNActions());  // Upper bound on Q
   Vector Q_L((int)environment->getNActions());  // Lower bound on Q
   Vector N(
@@ -288,13 +349,11 @@ void RolloutState::Bootstrap(KDTree<RolloutState>& tree, real L) {
     if (rollout->running) {
       error_bound = exp(rollout->T * log_gamma);
       Vector s_T = rollout->end_state;
-      OrderedFixedList<KDNode> knn_list = tree.FindKNearestNeighbours(s_T, 3);
+      std::vector<FlatKDTree<RolloutState>::ObjectNeighbour> knn;
+      tree.FindKNearestObjects(s_T, 3, knn);
 #if 0
-            std::list<std::pair<real, KDNode*> >::iterator knn_iter;
-            for (knn_iter = knn_list.S.begin();
-                 knn_iter != knn_list.S.end();
-                 ++knn_iter) {
-                KDNode* node = knn_iter->second;
+            for (uint k = 0; k < knn.size(); ++k) {
+                RolloutState* state = knn[k].second;
             }
 #endif
     }
@@ -474,10 +533,12 @@ real RSAPI::LipschitzBound() {
 
 void RSAPI::Bootstrap() {
   /// Make a KNN tree.
-  KDTree<RolloutState> tree(environment->getNStates());
+  FlatKDTree<RolloutState> tree(environment->getNStates());
+  tree.Reserve(states.size());
   for (uint i = 0; i < states.size(); ++i) {
     tree.AddVectorObject(states[i]->start_state, states[i]);
   }
+  tree.Rebuild();
 
 #if 0
     for (uint i=0; i<states.size(); ++i) {
@@ -16,7 +16,7 @@
 #include "AbstractPolicy.h"
 #include "Classifier.h"
 #include "Environment.h"
-#include "KDTree.h"
+#include "FlatKDTree.h"
 #include "Rollout.h"
 #include "Vector.h"
 
@@ -47,7 +47,7 @@ class RolloutState {
   int BestHighProbabilityAction(real delta);
   int BestEmpiricalAction(real delta);
   std::pair<Vector, bool> BestGroupAction(real delta);
-  void Bootstrap(KDTree<RolloutState>& tree, real L);
+  void Bootstrap(FlatKDTree<RolloutState>& tree, real L);
   real Gap();
 };
 
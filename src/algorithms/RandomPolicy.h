@@ -29,6 +29,9 @@ class RandomPolicy : public AbstractPolicy<Vector, int> {
                        const Vector& next_state) {}
   virtual void Observe(real r, const Vector& next_state) {}
   virtual void Reset() {}
+  virtual RandomPolicy* Clone(RandomNumberGenerator* rng_) const {
+    return new RandomPolicy(n_actions, rng_);
+  }
 };
 
 class DiscreteRandomPolicy : public AbstractPolicy<int, int> {
@@ -45,5 +48,8 @@ class DiscreteRandomPolicy : public AbstractPolicy<int, int> {
                        const int& next_state) {}
   virtual void Observe(real r, const int& next_state) {}
   virtual void Reset() {}
+  virtual DiscreteRandomPolicy* Clone(RandomNumberGenerator* rng_) const {
+    return new DiscreteRandomPolicy(n_actions, rng_);
+  }
 };
 #endif
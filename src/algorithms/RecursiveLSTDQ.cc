@@ -0,0 +1,92 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "RecursiveLSTDQ.h"
+#include <cmath>
+#include "debug.h"
+
+RecursiveLSTDQ::RecursiveLSTDQ(int n_basis_, real regularisation_,
+                               real forgetting_)
+    : n_basis(n_basis_),
+      regularisation(regularisation_),
+      forgetting(forgetting_),
+      u(n_basis_),
+      v(n_basis_) {
+  assert(n_basis > 0);
+  assert(regularisation > 0);
+  assert(forgetting > 0 && forgetting <= 1);
+  Reset();
+}
+
+/// Forget all samples, so that \f$A = \delta I\f$ and \f$b = 0\f$.
+void RecursiveLSTDQ::Reset() {
+  A_inverse = Matrix::Unity(n_basis, n_basis) * (1.0 / regularisation);
+  b = Vector::Null(n_basis);
+  w = Vector::Null(n_basis);
+  valid_weights = true;
+}
+
+/** Add a sample.
+
+    This sets \f$A \leftarrow \lambda A + \phi d^\top\f$ and \f$b
+    \leftarrow \lambda b + \phi r\f$.
+
+    \param phi the features of the state-action pair
+    \param difference \f$d = \phi - \gamma \phi'\f$, or just \f$\phi\f$
+    if the next state is terminal.
+    \param reward the reward
+ */
+void RecursiveLSTDQ::AddSample(const Vector& phi, const Vector& difference,
+                               real reward) {
+  assert(phi.Size() == n_basis && difference.Size() == n_basis);
+  // u = A^{-1} phi, v' = d' A^{-1}
+  for (int i = 0; i < n_basis; ++i) {
+    real u_i = 0.0;
+    for (int j = 0; j < n_basis; ++j) {
+      u_i += A_inverse(i, j) * phi(j);
+    }
+    u(i) = u_i;
+  }
+  v.Clear();
+  for (int i = 0; i < n_basis; ++i) {
+    real d_i = difference(i);
+    if (d_i != 0.0) {
+      for (int j = 0; j < n_basis; ++j) {
+        v(j) += d_i * A_inverse(i, j);
+      }
+    }
+  }
+  real denominator = forgetting + Product(difference, u);
+  if (fabs(denominator) < 1e-12) {
+    Swarning("Singular update, skipping sample\n");
+    return;
+  }
+  real scale = 1.0 / forgetting;
+  for (int i = 0; i < n_basis; ++i) {
+    real u_i = u(i) / denominator;
+    for (int j = 0; j < n_basis; ++j) {
+      A_inverse(i, j) = (A_inverse(i, j) - u_i * v(j)) * scale;
+    }
+  }
+  for (int i = 0; i < n_basis; ++i) {
+    b(i) = forgetting * b(i) + phi(i) * reward;
+  }
+  valid_weights = false;
+}
+
+/// The weights \f$A^{-1} b\f$, computed in \f$O(k^2)\f$ from the inverse.
+const Vector& RecursiveLSTDQ::getWeights() {
+  if (!valid_weights) {
+    w = A_inverse * b;
+    valid_weights = true;
+  }
+  return w;
+}
@@ -0,0 +1,54 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef RECURSIVE_LSTDQ_H
+#define RECURSIVE_LSTDQ_H
+
+#include "Matrix.h"
+#include "Vector.h"
+#include "real.h"
+
+/** Recursive least-squares LSTDQ.
+
+    Instead of \f$A = \delta I + \sum_t \phi_t (\phi_t - \gamma
+    \phi'_t)^\top\f$, this keeps \f$A^{-1}\f$, which is updated with
+    the Sherman-Morrison formula after each sample in \f$O(k^2)\f$
+    for \f$k\f$ features. With a forgetting factor \f$\lambda < 1\f$,
+    the statistics are discounted by \f$\lambda\f$ before each sample,
+    so that old samples (collected under older policies) fade away.
+ */
+class RecursiveLSTDQ {
+ protected:
+  int n_basis;           ///< number of features
+  real regularisation;   ///< initial diagonal \f$\delta\f$ of A
+  real forgetting;       ///< forgetting factor \f$\lambda\f$
+  Matrix A_inverse;      ///< \f$A^{-1}\f$
+  Vector b;              ///< \f$\sum_t \phi_t r_t\f$
+  Vector w;              ///< weights
+  bool valid_weights;    ///< whether w is up to date
+  Vector u;              ///< scratch space for \f$A^{-1} \phi\f$
+  Vector v;              ///< scratch space for \f$A^{-\top} d\f$
+ public:
+  RecursiveLSTDQ(int n_basis_, real regularisation_ = 1e-6,
+                 real forgetting_ = 1.0);
+  void Reset();
+  void AddSample(const Vector& phi, const Vector& difference, real reward);
+  const Vector& getWeights();
+  /// The current inverse of A
+  const Matrix& getInverse() const { return A_inverse; }
+  void setForgettingFactor(real forgetting_) {
+    assert(forgetting_ > 0 && forgetting_ <= 1);
+    forgetting = forgetting_;
+  }
+  real getForgettingFactor() const { return forgetting; }
+};
+
+#endif
@@ -52,7 +52,7 @@ SampleBasedRL::SampleBasedRL(int n_states_, int n_actions_, real gamma_,
   // mdp_list[0] = model->getMeanMDP();
   for (int i = 0; i < max_samples; ++i) {
     printf("# Generating sampled MDP\n");
-    mdp_list[i] = model->generate();
+    mdp_list[i] = rng ? model->generate(*rng) : model->generate();
     weights[i] = w_i;
     value_iteration[i] = new ValueIteration(mdp_list[i], gamma);
   }
@@ -124,7 +124,7 @@ real SampleBasedRL::Observe(real reward, int next_state, int next_action) {
 void SampleBasedRL::Resample() {
   for (int i = 0; i < max_samples; ++i) {
     delete mdp_list[i];
-    mdp_list[i] = model->generate();
+    mdp_list[i] = rng ? model->generate(*rng) : model->generate();
 #if 0
     logmsg("Generating MDP model %d\n", i);
     for (int s = 0; s < n_states; ++s) {
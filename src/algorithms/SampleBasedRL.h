@@ -132,6 +132,13 @@ class SampleBasedRL : public OnlineAlgorithm<int, int> {
     sampling_threshold = sampling_threshold_;
     assert(sampling_threshold >= 0.0 && sampling_threshold <= 1.0);
   }
+
+  /// Set the number of threads used for planning in each sampled model
+  void setNumberOfThreads(int n) {
+    for (uint i = 0; i < value_iteration.size(); ++i) {
+      value_iteration[i]->setNumberOfThreads(n);
+    }
+  }
 };
 
 /// @}
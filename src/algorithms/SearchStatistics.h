@@ -0,0 +1,26 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SEARCH_STATISTICS_H
+#define SEARCH_STATISTICS_H
+
+/// What a Monte Carlo planner did for its last decision
+struct SearchStatistics {
+  int n_rollouts;     ///< number of rollouts completed
+  int tree_size;      ///< number of tree nodes, or of visited table entries
+  int depth;          ///< maximum depth reached by the tree policy
+  int reused_visits;  ///< visits of the root carried over from before
+  double elapsed;     ///< seconds taken by the search
+  SearchStatistics()
+      : n_rollouts(0), tree_size(0), depth(0), reused_visits(0), elapsed(0) {}
+};
+
+#endif
@@ -0,0 +1,129 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "SparseLSTDQ.h"
+
+SparseLSTDQ::SparseLSTDQ(real gamma_, int n_actions_, BasisSet& bfs_,
+                         Demonstrations<Vector, int>& Samples_)
+    : gamma(gamma_),
+      n_actions(n_actions_),
+      n_features(bfs_.size() + 1),
+      n_basis(n_actions_ * (bfs_.size() + 1)),
+      bfs(bfs_),
+      Samples(Samples_),
+      A(n_basis, n_basis),
+      b(n_basis),
+      w(n_basis),
+      tolerance(1e-9),
+      max_iterations(-1),
+      solver_iterations(0) {
+  assert(gamma >= 0 && gamma <= 1);
+  assert(n_actions > 0);
+}
+
+/// Put the non-zero features of (state, action) in phi
+void SparseLSTDQ::BasisFunction(const Vector& state, int action,
+                                SparseVector& phi) {
+  assert(action >= 0 && action < n_actions);
+  bfs.Evaluate(state, phi_state);
+  int offset = n_features * action;
+  phi.Clear();
+  phi.Add(offset, 1.0);
+  for (int k = 0; k < phi_state.Size(); ++k) {
+    phi.Add(offset + phi_state.index[k] + 1, phi_state.value[k]);
+  }
+}
+
+/** Estimate the weights from the samples.
+
+    The next action of each transition is the one in the data, or the
+    greedy action with respect to the current weights if greedy is
+    true. The last transition of a terminated trajectory enters the
+    terminal state, whose value is zero.
+ */
+void SparseLSTDQ::Calculate(bool greedy) {
+  SparseVector phi;
+  SparseVector phi_next;
+  SparseVector difference;
+  A.Clear();
+  b.Clear();
+  for (int i = 0; i < n_basis; ++i) {
+    A.Add(i, i, 1e-6);
+  }
+  for (uint i = 0; i < Samples.size(); ++i) {
+    int T = (int)Samples.length(i);
+    for (int t = 0; t < T - 1; ++t) {
+      BasisFunction(Samples.state(i, t), Samples.action(i, t), phi);
+      difference = phi;
+      if (!(Samples.terminated(i) && t == T - 2)) {
+        const Vector& s2 = Samples.state(i, t + 1);
+        int a2 = greedy ? GreedyAction(s2) : Samples.action(i, t + 1);
+        BasisFunction(s2, a2, phi_next);
+        for (int k = 0; k < phi_next.Size(); ++k) {
+          difference.Add(phi_next.index[k], -gamma * phi_next.value[k]);
+        }
+      }
+      A.AddOuterProduct(phi, difference);
+      real r = Samples.reward(i, t);
+      for (int k = 0; k < phi.Size(); ++k) {
+        b(phi.index[k]) += phi.value[k] * r;
+      }
+    }
+  }
+  solver_iterations = LSQR(A, b, w, tolerance, max_iterations);
+}
+
+/** Alternate between LSTDQ and greedy improvement.
+
+    Stops when the weights change by less than Delta, in L2 norm.
+
+    \return the number of iterations.
+ */
+int SparseLSTDQ::PolicyIteration(real Delta, int max_policy_iterations) {
+  int iteration = 0;
+  real change = INF;
+  while (iteration < max_policy_iterations && change >= Delta) {
+    Vector previous = w;
+    Calculate(iteration > 0);
+    change = (w - previous).L2Norm();
+    ++iteration;
+  }
+  return iteration;
+}
+
+real SparseLSTDQ::getValue(const Vector& state, int action) {
+  SparseVector phi;
+  BasisFunction(state, action, phi);
+  return phi.Product(w);
+}
+
+/// The value of the greedy action
+real SparseLSTDQ::getValue(const Vector& state) {
+  return getValue(state, GreedyAction(state));
+}
+
+int SparseLSTDQ::GreedyAction(const Vector& state) {
+  bfs.Evaluate(state, phi_state);
+  int best = 0;
+  real best_value = -INF;
+  for (int a = 0; a < n_actions; ++a) {
+    int offset = n_features * a;
+    real Q = w(offset);
+    for (int k = 0; k < phi_state.Size(); ++k) {
+      Q += phi_state.value[k] * w(offset + phi_state.index[k] + 1);
+    }
+    if (Q > best_value) {
+      best_value = Q;
+      best = a;
+    }
+  }
+  return best;
+}
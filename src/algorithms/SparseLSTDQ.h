@@ -0,0 +1,66 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SPARSE_LSTDQ_H
+#define SPARSE_LSTDQ_H
+
+#include "BasisSet.h"
+#include "Demonstrations.h"
+#include "SparseMatrix.h"
+#include "Vector.h"
+#include "real.h"
+
+/** LSTDQ with sparse features.
+
+    The features of a state-action pair are the features of the state
+    in the block of the action, preceded by a bias, as in LSTDQ. Only
+    the non-zero features are stored, so that each sample adds a
+    sparse outer product to \f$A\f$, and the system \f$A w = b\f$ is
+    solved iteratively with LSQR, warm-started from the previous
+    weights. This makes large tile codings practical.
+ */
+class SparseLSTDQ {
+ protected:
+  real gamma;        ///< discount factor
+  int n_actions;     ///< number of actions
+  int n_features;    ///< number of features per action, including the bias
+  int n_basis;       ///< total number of features
+  BasisSet& bfs;     ///< state features
+  Demonstrations<Vector, int>& Samples;  ///< the data
+  SparseMatrix A;
+  Vector b;
+  Vector w;
+  real tolerance;           ///< solver tolerance
+  int max_iterations;       ///< maximum number of solver iterations
+  int solver_iterations;    ///< solver iterations in the last calculation
+  SparseVector phi_state;   ///< scratch space for the state features
+ public:
+  SparseLSTDQ(real gamma_, int n_actions_, BasisSet& bfs_,
+              Demonstrations<Vector, int>& Samples_);
+  void BasisFunction(const Vector& state, int action, SparseVector& phi);
+  void Calculate(bool greedy = false);
+  int PolicyIteration(real Delta, int max_policy_iterations);
+  real getValue(const Vector& state, int action);
+  real getValue(const Vector& state);
+  int GreedyAction(const Vector& state);
+  const Vector& getWeights() const { return w; }
+  /// The number of non-zero entries of A
+  int getNonZeros() { return A.NonZeros(); }
+  /// The number of LSQR iterations used by the last calculation
+  int getSolverIterations() const { return solver_iterations; }
+  /// Set the LSQR tolerance and iteration limit (-1 for no limit)
+  void setSolverTolerance(real tolerance_, int max_iterations_ = -1) {
+    tolerance = tolerance_;
+    max_iterations = max_iterations_;
+  }
+};
+
+#endif
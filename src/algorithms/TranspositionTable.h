@@ -0,0 +1,107 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include <vector>
+#include "real.h"
+
+/** A fixed-size table of search nodes, indexed by a state key and a depth.
+
+    A tree search looks up each new state here before making a node
+    for it, so that paths which reach the same state at the same depth
+    share one node, and the tree becomes a directed acyclic graph.
+
+    Each bucket holds two entries. The first keeps the more visited of
+    the nodes that went through the bucket, and the second always
+    takes the newest node. A node that is pushed out of the table is
+    not destroyed: it stays in the graph, but is no longer shared.
+
+    Entries are stamped with the generation of the table, so that
+    clearing it only takes a new generation.
+
+    T must have an nVisits member. The table does not own the nodes.
+ */
+template <typename T>
+class TranspositionTable {
+ protected:
+  struct Entry {
+    ulong key;
+    int depth;
+    uint generation;
+    T* node;
+  };
+  std::vector<Entry> entries;  ///< two per bucket
+  int n_buckets;               ///< number of buckets
+  uint generation;             ///< entries of other generations are empty
+  /// Whether the entry holds a node of this generation
+  bool Used(const Entry& entry) const {
+    return entry.node && entry.generation == generation;
+  }
+  /// The first entry of the bucket of key at depth
+  Entry* Bucket(ulong key, int depth) {
+    unsigned long long z = (unsigned long long)key * 0x9e3779b97f4a7c15ULL +
+                           (unsigned long long)depth;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return &entries[2 * (int)(z % (unsigned long long)n_buckets)];
+  }
+
+ public:
+  /// Make a table with space for capacity nodes
+  TranspositionTable(int capacity = 0) : generation(0) { Resize(capacity); }
+  /// Make space for capacity nodes, emptying the table
+  void Resize(int capacity) {
+    n_buckets = (capacity + 1) / 2;
+    entries.resize(2 * n_buckets);
+    for (uint i = 0; i < entries.size(); ++i) {
+      entries[i].node = NULL;
+    }
+  }
+  /// Remove all nodes
+  void Clear() { generation++; }
+  /// The number of nodes the table can hold
+  int Capacity() const { return (int)entries.size(); }
+  /// The node for key at depth, or NULL
+  T* Find(ulong key, int depth) {
+    if (n_buckets == 0) {
+      return NULL;
+    }
+    Entry* bucket = Bucket(key, depth);
+    for (int i = 0; i < 2; ++i) {
+      if (Used(bucket[i]) && bucket[i].key == key &&
+          bucket[i].depth == depth) {
+        return bucket[i].node;
+      }
+    }
+    return NULL;
+  }
+  /// Add the node for key at depth, possibly pushing another one out
+  void Insert(ulong key, int depth, T* node) {
+    if (n_buckets == 0) {
+      return;
+    }
+    Entry* bucket = Bucket(key, depth);
+    Entry entry = {key, depth, generation, node};
+    if (!Used(bucket[0])) {
+      bucket[0] = entry;
+      return;
+    }
+    if (Used(bucket[1]) && bucket[1].node->nVisits > bucket[0].node->nVisits) {
+      bucket[0] = bucket[1];
+    }
+    bucket[1] = entry;
+  }
+};
+
+#endif
@@ -82,6 +82,9 @@ class UCRL2 : public OnlineAlgorithm<int, int> {
     value_iteration->ComputeStateValuesKnownRewards(confidence_interval, 1e-6,
                                                     -1);
   }
+
+  /// Set the number of threads used for planning
+  void setNumberOfThreads(int n) { value_iteration->setNumberOfThreads(n); }
 };
 
 /*@}*/
@@ -17,10 +17,12 @@
 #include "RandomNumberGenerator.h"
 
 #include <limits>
+#include "EasyClock.h"
 #include "Environment.h"
 #include "Grid.h"
 #include "Matrix.h"
 #include "Random.h"
+#include "SearchStatistics.h"
 #include "real.h"
 
 template <class S, class A>
@@ -39,6 +41,8 @@ class UCTMC {
   int nActions;        // Number of available actions.
   Matrix Q;            // State-Actions values.
   Matrix C;            // Counters.
+  int n_visited;       // Number of state-action cells with a non-zero count.
+  SearchStatistics statistics;  // Statistics of the last search.
  public:
   UCTMC(const real& gamma_, const real& c_uct_,
         ContinuousStateEnvironment* environment_, RandomNumberGenerator* rng_,
@@ -52,7 +56,8 @@ class UCTMC {
         learning_rate(learning_rate_),
         lambda(lambda_),
         MaxDepth(MaxDepth_),
-        NRollouts(NRollouts_) {
+        NRollouts(NRollouts_),
+        n_visited(0) {
     nActions = environment->getNActions();
 
     Q = Matrix(discretize.getNIntervals(), nActions);
@@ -66,10 +71,14 @@ class UCTMC {
   void UCT_Reset() {
     Q = Matrix(discretize.getNIntervals(), nActions);
     C = Matrix(discretize.getNIntervals(), nActions);
+    n_visited = 0;
   };
 
   real UCT_Search(S state, int depth, bool terminal) {
     if (depth >= MaxDepth || terminal) {
+      if (depth > statistics.depth) {
+        statistics.depth = depth;
+      }
       return 0.0;
     }
     int index = discretize.getInterval(state);
@@ -96,6 +105,9 @@ class UCTMC {
     real reward = environment->getReward();
 
     SampleReturn = reward + gamma * UCT_Search(nextState, depth + 1, !running);
+    if (C(index, bestAction) == 0) {
+      n_visited++;
+    }
     C(index, bestAction) += 1;
     Q(index, bestAction) +=
         (SampleReturn - Q(index, bestAction)) / C(index, bestAction);
@@ -107,7 +119,31 @@ class UCTMC {
         lambda * SampleReturn + (1 - lambda) * Q(index, bestAction);
     return LambdaReturn;
   };
-  int PlanPolicy(const S& state) {
+  /// Plan with NRollouts rollouts
+  int PlanPolicy(const S& state) { return Plan(state, NRollouts, 0.0); }
+
+  /** Plan until the monotonic clock (GetMonotonicTime()) reaches the
+      deadline, and return the best action found so far.
+
+      The clock is checked after each rollout, and at least one
+      rollout is done. The statistics are kept across calls until
+      UCT_Reset(), so that the search for the next state starts with
+      everything learnt so far.
+   */
+  int PlanPolicy(const S& state, double deadline) {
+    return Plan(state, -1, deadline);
+  }
+
+  /// Statistics of the last call to PlanPolicy()
+  const SearchStatistics& getStatistics() const { return statistics; }
+
+ protected:
+  /// Plan with n_rollouts rollouts, or until the deadline if n_rollouts < 0
+  int Plan(const S& state, int n_rollouts, double deadline) {
+    double start_time = GetMonotonicTime();
+    int index = discretize.getInterval(state);
+    statistics = SearchStatistics();
+    statistics.reused_visits = (int)C.RowSum(index);
     int rollouts = 0;
 
     do {
@@ -115,10 +151,14 @@ class UCTMC {
       environment->Reset();
       environment->setState(state);
       rollouts++;
-    } while (rollouts < NRollouts);
+    } while ((n_rollouts >= 0) ? (rollouts < n_rollouts)
+                               : (GetMonotonicTime() < deadline));
+
+    statistics.n_rollouts = rollouts;
+    statistics.tree_size = n_visited;
+    statistics.elapsed = GetMonotonicTime() - start_time;
 
     int bestAction = 0;
-    int index = discretize.getInterval(state);
     real bestValue = Q(index, 0);
 
     for (int a = 1; a < nActions; ++a) {
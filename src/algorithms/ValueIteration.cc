@@ -25,6 +25,7 @@ ValueIteration::ValueIteration(const DiscreteMDP* mdp, real gamma,
   this->mdp = mdp;
   this->gamma = gamma;
   this->baseline = baseline;
+  n_threads = 1;
   n_actions = mdp->getNActions();
   n_states = mdp->getNStates();
   Reset();
@@ -62,24 +63,23 @@ ValueIteration::~ValueIteration() {}
         max_iter to -1 means there is no limit to the number of iterations.
 */
 void ValueIteration::ComputeStateValuesStandard(real threshold, int max_iter) {
+  const CompiledDiscreteMDP& M = getKernel();
   int n_iter = 0;
   do {
-    Delta = 0.0;
     pV = V;
-    for (int s = 0; s < n_states; s++) {
-      for (int a = 0; a < n_actions; a++) {
-        real V_next_sa = 0.0;
-        const DiscreteStateSet& next = mdp->getNextStates(s, a);
-        for (DiscreteStateSet::iterator i = next.begin(); i != next.end();
-             ++i) {
-          int s2 = *i;
-          real P = mdp->getTransitionProbability(s, a, s2);
-          V_next_sa += P * pV(s2);
+    ParallelFor(n_states, n_threads, [&](int block, int begin, int end) {
+      for (int s = begin; s < end; s++) {
+        for (int a = 0; a < n_actions; a++) {
+          real V_next_sa = M.ExpectedNextValue(s, a, pV);
+          Q(s, a) = M.getExpectedReward(s, a) - baseline + gamma * V_next_sa;
         }
-        Q(s, a) = mdp->getExpectedReward(s, a) - baseline + gamma * V_next_sa;
+        V(s) = Max(n_actions, &Q(s, 0));
+        dV(s) = V(s) - pV(s);
       }
-      V(s) = Max(Q.getRow(s));
-      Delta += fabs(V(s) - pV(s));
+    });
+    Delta = 0.0;
+    for (int s = 0; s < n_states; s++) {
+      Delta += fabs(dV(s));
     }
 
     if (max_iter > 0) {
@@ -94,42 +94,42 @@ void ValueIteration::ComputeStateValuesStandard(real threshold, int max_iter) {
 /** Compute values only partially.
 */
 void ValueIteration::PartialUpdate(real step_size) {
+  const CompiledDiscreteMDP& M = getKernel();
   pV = V;
-  for (int s = 0; s < n_states; s++) {
-    for (int a = 0; a < n_actions; a++) {
-      real Q_sa = 0.0;
-      const DiscreteStateSet& next = mdp->getNextStates(s, a);
-      for (DiscreteStateSet::iterator i = next.begin(); i != next.end(); ++i) {
-        int s2 = *i;
-        real P = mdp->getTransitionProbability(s, a, s2);
-        real R = mdp->getExpectedReward(s, a) - baseline;
-        Q_sa += P * (R + gamma * pV(s2));
+  ParallelFor(n_states, n_threads, [&](int block, int begin, int end) {
+    for (int s = begin; s < end; s++) {
+      for (int a = 0; a < n_actions; a++) {
+        real Q_sa = 0.0;
+        real R = M.getExpectedReward(s, a) - baseline;
+        for (int i = M.RowBegin(s, a); i < M.RowEnd(s, a); ++i) {
+          Q_sa += M.getProbability(i) * (R + gamma * pV(M.getNextState(i)));
+        }
+        Q(s, a) = (1.0 - step_size) * Q(s, a) + step_size * Q_sa;
       }
-      Q(s, a) = (1.0 - step_size) * Q(s, a) + step_size * Q_sa;
+      V(s) = Max(n_actions, &Q(s, 0));
     }
-    V(s) = Max(Q.getRow(s));
-  }
+  });
 }
 
 /** Compute values only partially.
 */
 void ValueIteration::PartialUpdateOnPolicy(real step_size) {
+  const CompiledDiscreteMDP& M = getKernel();
   pV = V;
-  for (int s = 0; s < n_states; s++) {
-    int a_policy = ArgMax(Q.getRow(s));
-    for (int a = 0; a < n_actions; a++) {
-      real Q_sa = 0.0;
-      const DiscreteStateSet& next = mdp->getNextStates(s, a);
-      for (DiscreteStateSet::iterator i = next.begin(); i != next.end(); ++i) {
-        int s2 = *i;
-        real P = mdp->getTransitionProbability(s, a, s2);
-        real R = mdp->getExpectedReward(s, a) - baseline;
-        Q_sa += P * (R + gamma * pV(s2));
+  ParallelFor(n_states, n_threads, [&](int block, int begin, int end) {
+    for (int s = begin; s < end; s++) {
+      int a_policy = ArgMax(n_actions, &Q(s, 0));
+      for (int a = 0; a < n_actions; a++) {
+        real Q_sa = 0.0;
+        real R = M.getExpectedReward(s, a) - baseline;
+        for (int i = M.RowBegin(s, a); i < M.RowEnd(s, a); ++i) {
+          Q_sa += M.getProbability(i) * (R + gamma * pV(M.getNextState(i)));
+        }
+        Q(s, a) = (1.0 - step_size) * Q(s, a) + step_size * Q_sa;
       }
-      Q(s, a) = (1.0 - step_size) * Q(s, a) + step_size * Q_sa;
+      V(s) = Q(s, a_policy);
     }
-    V(s) = Q(s, a_policy);
-  }
+  });
 }
 
 /** Compute state values using value iteration with action elimination.
@@ -155,41 +155,44 @@ void ValueIteration::PartialUpdateOnPolicy(real step_size) {
 */
 void ValueIteration::ComputeStateValuesElimination(real threshold,
                                                    int max_iter) {
+  const CompiledDiscreteMDP& M = getKernel();
   int n_iter = 0;
   dQ.Clear();
   do {
-    Delta = 0.0;
     pV = V;
     pQ = Q;
-    for (int s = 0; s < n_states; s++) {
-      for (int a = 0; a < n_actions; a++) {
-        if (dQ(s, a) < 0) continue;
-        real Q_sa = 0.0;
-        const DiscreteStateSet& next = mdp->getNextStates(s, a);
-        for (DiscreteStateSet::iterator i = next.begin(); i != next.end();
-             ++i) {
-          int s2 = *i;
-          real P = mdp->getTransitionProbability(s, a, s2);
-          real R = mdp->getExpectedReward(s, a) - baseline;
-          Q_sa += P * (R + gamma * pV(s2));
+    ParallelFor(n_states, n_threads, [&](int block, int begin, int end) {
+      for (int s = begin; s < end; s++) {
+        for (int a = 0; a < n_actions; a++) {
+          if (dQ(s, a) < 0) continue;
+          real Q_sa = 0.0;
+          real R = M.getExpectedReward(s, a) - baseline;
+          for (int i = M.RowBegin(s, a); i < M.RowEnd(s, a); ++i) {
+            Q_sa += M.getProbability(i) * (R + gamma * pV(M.getNextState(i)));
+          }
+          Q(s, a) = Q_sa;
         }
-        Q(s, a) = Q_sa;
+        V(s) = Max(n_actions, &Q(s, 0));
+        dV(s) = V(s) - pV(s);
       }
-      V(s) = Max(Q.getRow(s));
-      dV(s) = V(s) - pV(s);
+    });
+    Delta = 0.0;
+    for (int s = 0; s < n_states; s++) {
       Delta += fabs(dV(s));
     }
 
     real scale = Span(dV) * gamma / (1.0 - gamma);
-    for (int s = 0; s < n_states; s++) {
-      for (int a = 0; a < n_actions; a++) {
-        if (dQ(s, a) < 0) continue;
-        dQ(s, a) = scale + Q(s, a) - V(s);
-        // if (dQ(s,a) < 0) {
-        // printf ("State %d: eliminated action %d\n", s, a);
-        //}
+    ParallelFor(n_states, n_threads, [&](int block, int begin, int end) {
+      for (int s = begin; s < end; s++) {
+        for (int a = 0; a < n_actions; a++) {
+          if (dQ(s, a) < 0) continue;
+          dQ(s, a) = scale + Q(s, a) - V(s);
+          // if (dQ(s,a) < 0) {
+          // printf ("State %d: eliminated action %d\n", s, a);
+          //}
+        }
       }
-    }
+    });
     if (max_iter > 0) {
       max_iter--;
     }
@@ -205,27 +208,25 @@ void ValueIteration::ComputeStateValuesElimination(real threshold,
         or when the given number of max_iter iterations is reached. Setting
         max_iter to -1 means there is no limit to the number of iterations.
 
-    This version updates the current values immediately
+    This version updates the current values immediately, so it always
+    runs on a single thread.
 */
 void ValueIteration::ComputeStateValuesAsynchronous(real threshold,
                                                     int max_iter) {
+  const CompiledDiscreteMDP& M = getKernel();
   int n_iter = 0;
   do {
     Delta = 0.0;
     for (int s = 0; s < n_states; s++) {
       for (int a = 0; a < n_actions; a++) {
         real Q_sa = 0.0;
-        const DiscreteStateSet& next = mdp->getNextStates(s, a);
-        for (DiscreteStateSet::iterator i = next.begin(); i != next.end();
-             ++i) {
-          int s2 = *i;
-          real P = mdp->getTransitionProbability(s, a, s2);
-          real R = mdp->getExpectedReward(s, a) - baseline;
-          Q_sa += P * (R + gamma * V(s2));
+        real R = M.getExpectedReward(s, a) - baseline;
+        for (int i = M.RowBegin(s, a); i < M.RowEnd(s, a); ++i) {
+          Q_sa += M.getProbability(i) * (R + gamma * V(M.getNextState(i)));
         }
         Q(s, a) = Q_sa;
       }
-      V(s) = Max(Q.getRow(s));
+      V(s) = Max(n_actions, &Q(s, 0));
       Delta += fabs(V(s) - pV(s));
       pV(s) = V(s);
     }
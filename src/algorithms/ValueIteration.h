@@ -14,16 +14,35 @@
 #define VALUE_ITERATION_H
 
 #include <vector>
+#include "CompiledDiscreteMDP.h"
 #include "DiscreteMDP.h"
 #include "DiscretePolicy.h"
 #include "Matrix.h"
+#include "ParallelFor.h"
 #include "Vector.h"
 #include "real.h"
 
-/** A value iteration algorithm for discrete MDPs */
+/** A value iteration algorithm for discrete MDPs.
+
+    The sweeps read the MDP through a CompiledDiscreteMDP snapshot, which
+    is only recompiled when the MDP has changed since the last call.
+
+    The synchronous sweeps can be split over several threads, each
+    updating a contiguous block of states from the previous values
+    pV. Since every state is computed exactly as in the serial sweep, and
+    Delta is summed in state order afterwards, the results do not depend
+    on the number of threads.
+ */
 class ValueIteration {
  protected:
-  const DiscreteMDP* mdp;  ///< pointer to the MDP
+  const DiscreteMDP* mdp;      ///< pointer to the MDP
+  CompiledDiscreteMDP kernel;  ///< compiled snapshot of the MDP
+  /// Recompile the snapshot if the MDP has changed
+  inline const CompiledDiscreteMDP& getKernel() {
+    kernel.Synchronise(*mdp);
+    return kernel;
+  }
+
  public:
   real gamma;     ///< discount factor
   int n_states;   ///< number of states
@@ -36,6 +55,7 @@ class ValueIteration {
   Matrix pQ;      ///< previous state-action values
   real Delta;
   real baseline;
+  int n_threads;  ///< number of threads for synchronous sweeps
   ValueIteration(const DiscreteMDP* mdp, real gamma, real baseline = 0.0);
   ~ValueIteration();
   void Reset();
@@ -49,6 +69,10 @@ class ValueIteration {
   void ComputeStateValuesAsynchronous(real threshold, int max_iter = -1);
   void ComputeStateValuesElimination(real threshold, int max_iter = -1);
   void ComputeStateActionValues(real threshold, int max_iter = -1);
+  /// Set the number of threads (all hardware threads if n <= 0)
+  inline void setNumberOfThreads(int n) {
+    n_threads = ResolveNumberOfThreads(n);
+  }
   /// Set the MDP to something else
   inline void setMDP(const DiscreteMDP* mdp_) { mdp = mdp_; }
   inline void setDiscount(real gamma_) {
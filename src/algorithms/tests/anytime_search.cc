@@ -0,0 +1,115 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Check that UCTMC and MonteCarloTreeSearch return close to their
+    deadline, and that the MonteCarloTreeSearch subtree of the chosen
+    action is reused on a deterministic MountainCar.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include "EasyClock.h"
+#include "MersenneTwister.h"
+#include "MonteCarloTreeSearch.h"
+#include "MountainCar.h"
+#include "RandomPolicy.h"
+#include "UCTMC.h"
+
+typedef MonteCarloTreeSearch<Vector, int> MCTS;
+
+/// Check the statistics of a search that had the given time budget
+int CheckStatistics(const char* name, const SearchStatistics& statistics,
+                    double budget, int min_rollouts) {
+  int errors = 0;
+  printf("%s: %d rollouts, %d nodes, depth %d, reused %d visits, %f s\n", name,
+         statistics.n_rollouts, statistics.tree_size, statistics.depth,
+         statistics.reused_visits, statistics.elapsed);
+  // one rollout of 1000 steps may be started just before the deadline
+  if (statistics.elapsed > budget + 0.05) {
+    fprintf(stderr, "%s: took %f s for a budget of %f s\n", name,
+            statistics.elapsed, budget);
+    errors++;
+  }
+  if (statistics.n_rollouts < min_rollouts || statistics.tree_size < 1 ||
+      statistics.depth < 1) {
+    fprintf(stderr, "%s: did not search\n", name);
+    errors++;
+  }
+  return errors;
+}
+
+int main(int argc, char** argv) {
+  int errors = 0;
+  real gamma = 0.99;
+  double budget = 0.02;
+  int n_steps = 5;
+
+  MersenneTwisterRNG rng;
+  rng.manualSeed(4321);
+  MountainCar environment;
+  environment.setRandomness(0.0);
+  MountainCar model;
+  model.setRandomness(0.0);
+  RandomPolicy policy(environment.getNActions(), &rng);
+  // Reset() may start next to the goal, where there is nothing to search
+  Vector start(2);
+  start[0] = -0.5;
+  start[1] = 0.0;
+
+  // UCTMC keeps its statistics from one decision to the next
+  EvenGrid grid(model.StateLowerBound(), model.StateUpperBound(), 20);
+  UCTMC<Vector, int> uctmc(gamma, 1.0, &model, &rng, grid, 0.1, 1.0, 100,
+                           1000);
+  environment.Reset();
+  environment.setState(start);
+  for (int t = 0; t < n_steps; ++t) {
+    Vector state = environment.getState();
+    model.setState(state);
+    int action = uctmc.PlanPolicy(state, GetMonotonicTime() + budget);
+    errors += CheckStatistics("UCTMC", uctmc.getStatistics(), budget, 1);
+    environment.Act(action);
+  }
+
+  for (int n_threads = 1; n_threads <= 2; ++n_threads) {
+    MCTS mcts(gamma, &model, &rng, policy);
+    mcts.setTreeReuse(true);
+    if (n_threads > 1) {
+      mcts.setNumberOfThreads(n_threads);
+    }
+    environment.Reset();
+    environment.setState(start);
+    for (int t = 0; t < n_steps; ++t) {
+      Vector state = environment.getState();
+      int action = mcts.SelectAction(state, GetMonotonicTime() + budget);
+      const SearchStatistics& statistics = mcts.getStatistics();
+      errors += CheckStatistics("MCTS", statistics, budget, n_threads);
+      if (t > 0 && statistics.reused_visits == 0) {
+        fprintf(stderr, "MCTS: the subtree was not reused\n");
+        errors++;
+      }
+      if (statistics.tree_size < statistics.n_rollouts) {
+        fprintf(stderr, "MCTS: %d nodes after %d rollouts\n",
+                statistics.tree_size, statistics.n_rollouts);
+        errors++;
+      }
+      environment.Act(action);
+    }
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
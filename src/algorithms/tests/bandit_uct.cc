@@ -166,9 +166,7 @@ int main(int argc, char** argv) {
       if (new_root) {
         new_tree->MakeRoot(new_root, verbose);
       } else {
-        delete new_tree;
-        new_tree =
-            new BeliefTree<BanditBelief>(belief, 0, n_states, n_actions, gamma);
+        new_tree->Reset(belief, 0);
       }
 
       // update state
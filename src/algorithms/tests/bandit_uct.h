@@ -14,10 +14,13 @@
 
 #include "BetaDistribution.h"
 #include "EasyClock.h"
+#include "NodePool.h"
 #include "PolicyEvaluation.h"
 #include "Random.h"
+#include "SingularDistribution.h"
 #include "ValueIteration.h"
 
+#include <algorithm>
 #include <list>
 #include <set>
 #include <vector>
@@ -174,16 +177,42 @@ class BeliefTree {
  public:
   class Edge;
 
+  /// The outgoing edges of a node, which are contiguous in the tree
+  class EdgeSet {
+   public:
+    /// Goes through the edges, giving pointers to them
+    class iterator {
+     protected:
+      Edge* edge;
+
+     public:
+      iterator(Edge* edge_) : edge(edge_) {}
+      Edge* operator*() const { return edge; }
+      iterator& operator++() {
+        ++edge;
+        return *this;
+      }
+      bool operator==(const iterator& rhs) const { return edge == rhs.edge; }
+      bool operator!=(const iterator& rhs) const { return edge != rhs.edge; }
+    };
+    Edge* first;  ///< the first edge
+    int n;        ///< the number of edges
+    EdgeSet() : first(NULL), n(0) {}
+    iterator begin() const { return iterator(first); }
+    iterator end() const { return iterator(first + n); }
+    int size() const { return n; }
+  };
+
   /// Node class
   ///
-  /// Contains a list of edges and an incoming edge.
+  /// Contains a set of edges and an incoming edge.
   /// It summarises the total reward and probability.
   /// It also contains upper and lower bounds on the future return.
   class Node {
    public:
     BanditBelief belief;
     int state;
-    std::list<Edge*> outs;
+    EdgeSet outs;
     Edge* in_edge;
     int index;
     int depth;
@@ -193,8 +222,9 @@ class BeliefTree {
     real U_c;             ///< current upper bound
     real L;               ///< lower bound
     real p;               ///< probability of reaching node
+    Node* copy;           ///< where the node was copied to
     /// Constructor only sets up the probability
-    Node() : p(1.0) {}
+    Node() : in_edge(NULL), R(0.0), p(1.0), copy(NULL) {}
     Node* GetParent() {
       if (in_edge) {
         return in_edge->src;
@@ -224,22 +254,43 @@ class BeliefTree {
     real r;     ///< reward received
     real p;     ///< probability of path component
     real GetEdgeProbability() { return p; }
-    Edge(Node* src_, Node* dst_, int a_, real r_, real p_)
-        : src(src_), dst(dst_), a(a_), r(r_), p(p_) {}
+    Edge() : src(NULL), dst(NULL), a(-1), r(0.0), p(0.0) {}
   };
 
   Node* root;
 
-  std::list<Node*> nodes;  ///< a list of nodes for book-keeping purposes
-  // std::list<Edge*> edges; ///< a list of edges for book-keeping purposes
+  std::vector<Node*> nodes;  ///< a list of nodes for book-keeping purposes
 
   int n_states;
   int n_actions;
+  int n_rewards;  ///< number of possible rewards
+  /// The number of edges a node can have
+  int MaxEdges() const { return n_actions * n_rewards * std::max(n_states, 1); }
   real gamma;
+
+ protected:
+  NodePool<Node> node_pool;  ///< where nodes are stored
+  NodePool<Edge> edge_pool;  ///< where edges are stored
+  NodePool<Node> spare_nodes;  ///< where a new root's subtree is copied
+  NodePool<Edge> spare_edges;
+
+ public:
   BeliefTree(BanditBelief prior, int state, int n_states_, int n_actions_,
              real gamma_)
-      : n_states(n_states_), n_actions(n_actions_), gamma(gamma_) {
-    root = new Node;
+      : n_states(n_states_), n_actions(n_actions_), n_rewards(2),
+        gamma(gamma_) {
+    Reset(prior, state);
+  }
+
+  ~BeliefTree() { DeleteDensities(); }
+
+  /// Start again from a single node, keeping the memory of the tree
+  void Reset(BanditBelief prior, int state) {
+    DeleteDensities();
+    nodes.clear();
+    node_pool.Clear();
+    edge_pool.Clear();
+    root = node_pool.Get(node_pool.New());
     root->belief = prior;
     root->state = state;
     root->index = 0;
@@ -249,16 +300,6 @@ class BeliefTree {
     nodes.push_back(root);
   }
 
-  ~BeliefTree() {
-    DeleteDensities();
-
-    for (typename std::list<Node*>::iterator i = nodes.begin();
-         i != nodes.end(); ++i) {
-      Node* n = *i;
-      DeleteNode(n);
-    }
-  }
-
   // Should be called after created MDPs are discarded
   void DeleteDensities() {
     for (std::vector<Distribution*>::iterator i = densities.begin();
@@ -266,12 +307,13 @@ class BeliefTree {
       Distribution* d = *i;
       delete d;
     }
+    densities.clear();
   }
 
   int GetNumberOfLeafNodes() {
     int n_leaf_nodes = 0;
     // leaf ndoes are state nodes
-    for (typename std::list<Node*>::iterator i = nodes.begin();
+    for (typename std::vector<Node*>::iterator i = nodes.begin();
          i != nodes.end(); ++i) {
       Node* node = *i;
       if (node->outs.size() == 0) {
@@ -282,9 +324,19 @@ class BeliefTree {
   }
 
   /// Return the newly created node
+  ///
+  /// The edges of a node are allocated together, for all the actions,
+  /// rewards and states, when the first one is added.
   Node* ExpandAction(Node* selected_node, int a, real r, int s,
                      int verbose = 0) {
-    Node* next = new Node;
+    int n_edges = MaxEdges();
+    EdgeSet& outs = selected_node->outs;
+    if (outs.first == NULL) {
+      outs.first = edge_pool.Get(edge_pool.NewArray(n_edges));
+    }
+    assert(outs.n < n_edges);
+
+    Node* next = node_pool.Get(node_pool.New());
     next->belief = selected_node->belief;
     next->state = s;
     next->index = nodes.size();
@@ -299,22 +351,19 @@ class BeliefTree {
     next->belief.update(selected_node->state, a, r, s);  // update the belif
 
     // save the edge connecting the previous node to the next
-    Edge* next_edge = new Edge(selected_node,
-                               next,  // was: nodes[nodes.size()-1],
-                               a,  // action taken
-                               r,  // reward observed
-                               p   // probability given previous node and action
-                               );
-    // edges.push_back(next_edge);
+    Edge* next_edge = outs.first + outs.n++;
+    next_edge->src = selected_node;
+    next_edge->dst = next;
+    next_edge->a = a;  // action taken
+    next_edge->r = r;  // reward observed
+    next_edge->p = p;  // probability given previous node and action
 
     if (verbose >= 100) {
       printf("Added edge  %d --(%d %f %f)-> %d\n", next_edge->src->index,
              next_edge->a, next_edge->r, next_edge->p, next_edge->dst->index);
     }
 
-    // save the edge to the list of output edges of the previous node
     // and as an input edge of the next node
-    selected_node->outs.push_back(next_edge);
     next->in_edge = next_edge;
 
     // save the node
@@ -326,7 +375,7 @@ class BeliefTree {
 
   /// Find the next node
   Node* FindObservation(Node* src, int a, real r, int s, int verbose = 0) {
-    for (typename std::list<Edge*>::iterator j = src->outs.begin();
+    for (typename EdgeSet::iterator j = src->outs.begin();
          j != src->outs.end(); ++j) {
       Edge* edge = *j;
       if (edge->a == a && edge->r == r && edge->dst->state == s) {
@@ -337,6 +386,10 @@ class BeliefTree {
     return NULL;
   }
   /// Cut a tree, making node i the root
+  ///
+  /// The subtree of the node is copied to the spare storage, which
+  /// then replaces the storage of the tree, so that the rest of the
+  /// tree is freed at once.
   void MakeRoot(Node* node, int verbose = 0) {
     Node* parent = node->GetParent();
     if (!parent) {
@@ -346,66 +399,66 @@ class BeliefTree {
       return;  // node is already the root node
     }
 
-    RecursiveDeleteExcept(root, node);
-    root = node;
+    CopyNode(node);
+    root = node->copy;
     root->index = 0;
     root->depth = 0;
     root->in_edge = NULL;
-    UpdateNodes(root, 0);
+    CopySubtree(node, 0);
+
+    // keep the nodes in the order they were made
+    std::vector<Node*> copies;
+    for (typename std::vector<Node*>::iterator i = nodes.begin();
+         i != nodes.end(); ++i) {
+      Node* copy = (*i)->copy;
+      if (copy) {
+        copies.push_back(copy);
+      }
+    }
+    nodes.swap(copies);
+    node_pool.Clear();
+    edge_pool.Clear();
+    node_pool.Swap(spare_nodes);
+    edge_pool.Swap(spare_edges);
+  }
+
+  /// Copy the node to the spare storage, without its edges
+  void CopyNode(Node* node) {
+    node->copy = spare_nodes.Get(spare_nodes.New(*node));
+    node->copy->outs = EdgeSet();
   }
 
-  /// Update index and depth information of nodes
+  /// Copy the subtree below a node that has already been copied
   ///
   /// Fills out index numbers in a depth-first manner.
   /// This if index1 > index2, depth1 >= depth2
-  int UpdateNodes(Node* node, int index) {
-    int depth = node->depth;
-    for (typename std::list<Edge*>::iterator j = node->outs.begin();
-         j != node->outs.end(); ++j) {
-      Edge* edge = *j;
-      Node* next = edge->dst;
-      next->index = ++index;
-      next->depth = depth + 1;
+  int CopySubtree(Node* node, int index) {
+    Node* copy = node->copy;
+    if (node->outs.size() > 0) {
+      copy->outs.first = spare_edges.Get(spare_edges.NewArray(MaxEdges()));
     }
-
-    for (typename std::list<Edge*>::iterator j = node->outs.begin();
+    for (typename EdgeSet::iterator j = node->outs.begin();
          j != node->outs.end(); ++j) {
       Edge* edge = *j;
       Node* next = edge->dst;
-      index = UpdateNodes(next, index);
+      CopyNode(next);
+      next->copy->index = ++index;
+      next->copy->depth = copy->depth + 1;
+      Edge* next_edge = copy->outs.first + copy->outs.n++;
+      *next_edge = *edge;
+      next_edge->src = copy;
+      next_edge->dst = next->copy;
+      next->copy->in_edge = next_edge;
     }
-    return index;
-  }
 
-  /// Delete a node and outgoing edges
-  ///
-  /// Assumes later nodes are deleted first,
-  /// otherwise edge data is lost.
-  void DeleteNode(Node* node) {
-    assert(node);
-    for (typename std::list<Edge*>::iterator j = node->outs.begin();
+    for (typename EdgeSet::iterator j = node->outs.begin();
          j != node->outs.end(); ++j) {
       Edge* edge = *j;
-      delete edge;
+      index = CopySubtree(edge->dst, index);
     }
-    delete node;
+    return index;
   }
 
-  void RecursiveDeleteExcept(Node* node, Node* exception) {
-    if (node == exception) {
-      return;
-    }
-    for (typename std::list<Edge*>::iterator j = node->outs.begin();
-         j != node->outs.end(); ++j) {
-      Edge* edge = *j;
-      Node* next = edge->dst;
-      if (next != NULL && next != exception) {
-        RecursiveDeleteExcept(next, exception);
-      }
-    }
-    DeleteNode(node);
-    nodes.remove(node);
-  }
   /// Expand a node in the tree
   void Expand(Node* node, int verbose = 0) {
     for (int a = 0; a < n_actions; a++) {
@@ -428,14 +481,14 @@ class BeliefTree {
     return a;
   }
 
-  std::list<Node*>& getNodes() { return nodes; }
+  std::vector<Node*>& getNodes() { return nodes; }
 
   DiscreteMDP CreateMeanMDP(real gamma, int verbose = 0) {
     int n_nodes = nodes.size();
     int terminal = n_nodes;
 
     // clear mean MDP
-    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL, NULL);
+    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL);
 
     // no reward in the first state
     {
@@ -446,7 +499,7 @@ class BeliefTree {
       }
     }
 
-    for (typename std::list<Node*>::iterator i = nodes.begin();
+    for (typename std::vector<Node*>::iterator i = nodes.begin();
          i != nodes.end(); ++i) {
       Node* node = *i;
       int n_edges = node->outs.size();
@@ -454,7 +507,7 @@ class BeliefTree {
         printf("Node %d has %d outgoing edges\n", node->index, n_edges);
       }
       // loop for internal nodes
-      for (typename std::list<Edge*>::iterator j = node->outs.begin();
+      for (typename EdgeSet::iterator j = node->outs.begin();
            j != node->outs.end(); ++j) {
         Edge* edge = *j;
         Distribution* reward_density = new SingularDistribution(edge->r);
@@ -506,7 +559,7 @@ class BeliefTree {
     if (verbose >= 90) {
       printf("Creating MDP with %d nodes\n", n_nodes);
     }
-    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL, NULL);
+    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL);
     // assume MDP is cleared
     // no reward in the first state
     {
@@ -517,14 +570,14 @@ class BeliefTree {
       }
     }
 
-    for (typename std::list<Node*>::iterator i = nodes.begin();
+    for (typename std::vector<Node*>::iterator i = nodes.begin();
          i != nodes.end(); ++i) {
       Node* node = *i;
       int n_edges = node->outs.size();
       if (verbose >= 90) {
         printf("Node %d has %d outgoing edges\n", node->index, n_edges);
       }
-      for (typename std::list<Edge*>::iterator j = node->outs.begin();
+      for (typename EdgeSet::iterator j = node->outs.begin();
            j != node->outs.end(); ++j) {
         Edge* edge = *j;
         Distribution* reward_density = new SingularDistribution(edge->r);
@@ -601,7 +654,7 @@ int MakeDecision(BeliefTree<BanditBelief>& new_tree,
 
 typedef BeliefTree<BanditBelief>::Node BeliefTreeNode;
 typedef BeliefTree<BanditBelief>::Edge BeliefTreeEdge;
-typedef std::list<BeliefTreeNode*> BTNodeSet;
-typedef std::list<BeliefTreeEdge*> BTEdgeSet;
+typedef std::vector<BeliefTreeNode*> BTNodeSet;
+typedef BeliefTree<BanditBelief>::EdgeSet BTEdgeSet;
 
 #endif
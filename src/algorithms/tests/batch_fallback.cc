@@ -0,0 +1,110 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Run fitted value iteration and RSAPI rollouts on an environment
+    with batched dynamics, and on one that has neither batched
+    dynamics nor Clone(), which must be simulated one step at a time.
+*/
+
+#ifdef MAKE_MAIN
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "EnvironmentBatch.h"
+#include "FittedValueIteration.h"
+#include "LinearDynamicQuadratic.h"
+#include "MersenneTwister.h"
+#include "MountainCar.h"
+#include "RSAPI.h"
+#include "RandomPolicy.h"
+
+/// Run a few iterations of fitted value iteration
+int TestFVI(ContinuousStateEnvironment* environment) {
+  int errors = 0;
+  int n_states = environment->getNStates();
+  int n_actions = environment->getNActions();
+  int m = n_states + 1;
+  std::vector<BayesianMultivariateRegression*> regression_t(n_actions);
+  Matrix S0 = Matrix::Unity(n_states, n_states);
+  for (int a = 0; a < n_actions; ++a) {
+    regression_t[a] =
+        new BayesianMultivariateRegression(m, n_states, S0, 1.0, 1.0, false);
+  }
+  FittedValueIteration<Vector, int> FVI(0.9, 50, 2, 4, environment,
+                                        regression_t, NULL);
+  FVI.Update(1e-6, 3);
+  real value = FVI.getValue(environment->getState());
+  printf("%s: %s, V = %f\n", environment->Name(),
+         EnvironmentBatch::HasBatchDynamics(*environment) ? "batched"
+                                                          : "unbatched",
+         value);
+  if (std::isnan(value)) {
+    fprintf(stderr, "%s: FVI value is NaN\n", environment->Name());
+    errors++;
+  }
+  for (int a = 0; a < n_actions; ++a) {
+    delete regression_t[a];
+  }
+  return errors;
+}
+
+/// Extend a few rollouts from the current state
+int TestRollouts(ContinuousStateEnvironment* environment,
+                 RandomNumberGenerator* rng) {
+  int errors = 0;
+  int n_actions = environment->getNActions();
+  RandomPolicy policy(n_actions, rng);
+  Vector start = environment->getState();
+  RolloutState state(environment, &policy, start, 0.9);
+  for (int a = 0; a < n_actions; ++a) {
+    for (int k = 0; k < 10; ++k) {
+      state.NewRollout(&policy, a);
+    }
+  }
+  int T = 20;
+  state.ExtendAllRollouts(T);
+  for (uint i = 0; i < state.rollouts.size(); ++i) {
+    Rollout<Vector, int, AbstractPolicy<Vector, int> >* rollout =
+        state.rollouts[i];
+    if (rollout->T < 1 || rollout->T > T ||
+        std::isnan(rollout->discounted_reward)) {
+      fprintf(stderr, "%s: rollout %d has %d steps and return %f\n",
+              environment->Name(), i, rollout->T, rollout->discounted_reward);
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main(int argc, char** argv) {
+  int errors = 0;
+  MersenneTwisterRNG rng;
+  rng.manualSeed(1234);
+  std::vector<ContinuousStateEnvironment*> environments;
+  environments.push_back(new MountainCar());
+  environments.push_back(new LinearDynamicQuadratic());
+  for (uint i = 0; i < environments.size(); ++i) {
+    environments[i]->Reset();
+    errors += TestFVI(environments[i]);
+    environments[i]->Reset();
+    errors += TestRollouts(environments[i], &rng);
+    delete environments[i];
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
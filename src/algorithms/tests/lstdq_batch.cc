@@ -0,0 +1,110 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Check the batched LSTDQ statistics, with one and several threads,
+    against summing the outer products of one sample at a time.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include "EasyClock.h"
+#include "LSTDQBatch.h"
+#include "Random.h"
+
+/// The features of (state, action), as in LSTDQ::BasisFunction
+Vector BasisFunction(RBFBasisSet& bfs, int n_actions, const Vector& state,
+                     int action) {
+  bfs.Evaluate(state);
+  Vector Phi(n_actions * (bfs.size() + 1));
+  Phi[(bfs.size() + 1) * action] = 1.0;
+  for (int i = 0; i < bfs.size(); ++i) {
+    Phi[(bfs.size() + 1) * action + i + 1] = bfs.F(i);
+  }
+  return Phi;
+}
+
+int main(int argc, char** argv) {
+  int T = 5000;
+  if (argc > 1) {
+    T = atoi(argv[1]);
+  }
+  int n_dimension = 2;
+  int n_actions = 3;
+  int n_centers = 25;
+  real gamma = 0.95;
+  int errors = 0;
+
+  RBFBasisSet bfs;
+  for (int i = 0; i < n_centers; ++i) {
+    Vector c(n_dimension);
+    for (int j = 0; j < n_dimension; ++j) {
+      c(j) = urandom();
+    }
+    bfs.AddCenter(c, 0.2);
+  }
+  int n_basis = n_actions * (n_centers + 1);
+
+  LSTDQBatch batch;
+  Matrix A_sample = Matrix::Unity(n_basis, n_basis) * 1e-6;
+  Vector b_sample(n_basis);
+  Vector s(n_dimension);
+  Vector s2(n_dimension);
+  double start_time = GetCPU();
+  for (int t = 0; t < T; ++t) {
+    for (int j = 0; j < n_dimension; ++j) {
+      s(j) = urandom();
+      s2(j) = urandom();
+    }
+    int a = urandom(0, n_actions);
+    int a2 = urandom(0, n_actions);
+    real r = urandom();
+    bool endsim = (t % 50 == 49);
+    batch.Add(s, a, r, s2, a2, endsim);
+
+    Vector Phi_ = BasisFunction(bfs, n_actions, s, a);
+    if (endsim) {
+      A_sample += OuterProduct(Phi_, Phi_);
+    } else {
+      Vector Phi = BasisFunction(bfs, n_actions, s2, a2);
+      A_sample += OuterProduct(Phi_, Phi_ - Phi * gamma);
+    }
+    b_sample += Phi_ * r;
+  }
+  double sample_time = GetCPU() - start_time;
+
+  for (int n_threads = 1; n_threads <= 4; n_threads += 3) {
+    Matrix A;
+    Vector b;
+    start_time = GetCPU();
+    batch.Calculate(bfs, n_actions, gamma, 1e-6, A, b, n_threads);
+    double batch_time = GetCPU() - start_time;
+    Matrix A_difference = A - A_sample;
+    Vector b_difference = b - b_sample;
+    real A_error = A_difference.L1Norm() / A_sample.L1Norm();
+    real b_error = b_difference.L1Norm() / b_sample.L1Norm();
+    if (A_error > 1e-9 || b_error > 1e-9) {
+      fprintf(stderr, "%d threads: relative error %g in A, %g in b\n",
+              n_threads, A_error, b_error);
+      errors++;
+    }
+    printf("%d samples, %d threads: batch %f s, one sample at a time %f s\n",
+           T, n_threads, batch_time, sample_time);
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -14,10 +14,13 @@
 
 #include "BetaDistribution.h"
 #include "EasyClock.h"
+#include "NodePool.h"
 #include "PolicyEvaluation.h"
 #include "Random.h"
+#include "SingularDistribution.h"
 #include "ValueIteration.h"
 
+#include <algorithm>
 #include <list>
 #include <set>
 #include <vector>
@@ -133,11 +136,23 @@ class BeliefTree {
 
  public:
   class Edge;
+  /// The outgoing edges of a node, which are contiguous in the tree
+  class EdgeSet {
+   public:
+    Edge* first;  ///< the first edge
+    int n;        ///< the number of edges
+    EdgeSet() : first(NULL), n(0) {}
+    Edge* operator[](int j) const {
+      assert(j >= 0 && j < n);
+      return first + j;
+    }
+    int size() const { return n; }
+  };
   class Node {
    public:
     EasyMDPBelief belief;
     int state;
-    std::vector<Edge*> outs;
+    EdgeSet outs;
     Edge* in_edge;
     int index;
     int depth;
@@ -151,20 +166,27 @@ class BeliefTree {
     int a;      ///< action taken
     real r;     ///< reward received
     real p;     ///< probability of path
-    Edge(Node* src_, Node* dst_, int a_, real r_, real p_)
-        : src(src_), dst(dst_), a(a_), r(r_), p(p_) {}
+    Edge() : src(NULL), dst(NULL), a(-1), r(0.0), p(0.0) {}
   };
 
   Node* root;
 
   std::vector<Node*> nodes;
-  std::vector<Edge*> edges;
 
   int n_states;
   int n_actions;
+  int n_rewards;  ///< number of possible rewards
+  /// The number of edges a node can have
+  int MaxEdges() const { return n_actions * n_rewards * std::max(n_states, 1); }
+
+ protected:
+  NodePool<Node> node_pool;  ///< where nodes are stored
+  NodePool<Edge> edge_pool;  ///< where edges are stored
+
+ public:
   BeliefTree(EasyMDPBelief prior, int state, int n_states_, int n_actions_)
-      : n_states(n_states_), n_actions(n_actions_) {
-    root = new Node;
+      : n_states(n_states_), n_actions(n_actions_), n_rewards(2) {
+    root = node_pool.Get(node_pool.New());
     root->belief = prior;
     root->state = state;
     root->index = 0;
@@ -178,18 +200,20 @@ class BeliefTree {
     for (int i = densities.size() - 1; i >= 0; --i) {
       delete densities[i];
     }
-
-    for (int i = nodes.size() - 1; i >= 0; --i) {
-      delete nodes[i];
-    }
-
-    for (int i = edges.size() - 1; i >= 0; --i) {
-      delete edges[i];
-    }
   }
   /// Return
+  ///
+  /// The edges of a node are allocated together, for all the actions,
+  /// rewards and states, when the first one is added.
   Node* ExpandAction(int i, int a, real r, int s, int verbose = 0) {
-    Node* next = new Node;
+    int n_edges = MaxEdges();
+    EdgeSet& outs = nodes[i]->outs;
+    if (outs.first == NULL) {
+      outs.first = edge_pool.Get(edge_pool.NewArray(n_edges));
+    }
+    assert(outs.n < n_edges);
+
+    Node* next = node_pool.Get(node_pool.New());
     next->belief = nodes[i]->belief;
     next->state = s;
     next->index = nodes.size();
@@ -198,19 +222,19 @@ class BeliefTree {
     real p = nodes[i]->belief.getProbability(nodes[i]->state, a, r, s);
     next->belief.update(nodes[i]->state, a, r, s);
 
-    edges.push_back(new Edge(nodes[i],
-                             next,  // nodes[nodes.size()-1],
-                             a, r, p));
+    Edge* edge = outs.first + outs.n++;
+    edge->src = nodes[i];
+    edge->dst = next;
+    edge->a = a;
+    edge->r = r;
+    edge->p = p;
 
-    int k = edges.size() - 1;
     if (verbose >= 100) {
-      printf("Added edge %d : %d --(%d %f %f)-> %d\n", k, edges[k]->src->index,
-             edges[k]->a, edges[k]->r, edges[k]->p, edges[k]->dst->index);
+      printf("Added edge %d : %d --(%d %f %f)-> %d\n", outs.n - 1,
+             edge->src->index, edge->a, edge->r, edge->p, edge->dst->index);
     }
 
-    nodes[i]->outs.push_back(edges[k]);
-
-    next->in_edge = edges[k];
+    next->in_edge = edge;
 
     nodes.push_back(next);
     return nodes.back();
@@ -244,7 +268,7 @@ class BeliefTree {
     int n_nodes = nodes.size();
     int terminal = n_nodes;
 
-    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL, NULL);
+    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL);
     for (int i = 0; i < n_nodes + 1; i++) {
       for (int a = 0; a < n_actions; a++) {
         for (int j = 0; j < n_nodes + 1; j++) {
@@ -309,7 +333,7 @@ class BeliefTree {
     int n_nodes = nodes.size();
     int terminal = n_nodes;
 
-    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL, NULL);
+    DiscreteMDP mdp(n_nodes + 1, n_actions, NULL);
     for (int i = 0; i < n_nodes + 1; i++) {
       for (int a = 0; a < n_actions; a++) {
         for (int j = 0; j < n_nodes + 1; j++) {
@@ -0,0 +1,135 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Check that environment clones simulate like the original, and run
+    a short control loop with sequential, tree-parallel and
+    root-parallel MonteCarloTreeSearch, and with leaves evaluated by a
+    batch of rollouts.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <cstdlib>
+#include "Acrobot.h"
+#include "CartPole.h"
+#include "CounterBasedRNG.h"
+#include "EasyClock.h"
+#include "MersenneTwister.h"
+#include "MonteCarloTreeSearch.h"
+#include "RandomPolicy.h"
+
+typedef MonteCarloTreeSearch<Vector, int> MCTS;
+
+/// Compare a trajectory of the environment with one of its clone
+int TestClone(ContinuousStateEnvironment* environment) {
+  int errors = 0;
+  environment->Reset();
+  ContinuousStateEnvironment* clone = environment->Clone();
+  for (int run = 0; run < 2; ++run) {
+    ContinuousStateEnvironment* model = run ? clone : environment;
+    CounterBasedRNG stream(12345);
+    ScopedRandomNumberGenerator scope(&stream);
+    model->setState(clone->getState());
+    for (int t = 0; t < 100; ++t) {
+      model->Act(t % environment->getNActions());
+    }
+  }
+  Vector difference = environment->getState() - clone->getState();
+  if (difference.L1Norm() != 0.0) {
+    fprintf(stderr, "%s: the clone went elsewhere\n", environment->Name());
+    errors++;
+  }
+  delete clone;
+  return errors;
+}
+
+/// Run a few steps with the given search, returning the total reward
+real ControlLoop(ContinuousStateEnvironment* environment, MCTS& mcts,
+                 int n_steps, int& errors, double& decision_time) {
+  real total_reward = 0;
+  decision_time = 0;
+  environment->Reset();
+  for (int t = 0; t < n_steps; ++t) {
+    Vector state = environment->getState();
+    double start_time = GetMonotonicTime();
+    int action = mcts.SelectAction(state);
+    decision_time += GetMonotonicTime() - start_time;
+    if (action < 0 || action >= (int)environment->getNActions()) {
+      fprintf(stderr, "invalid action %d\n", action);
+      errors++;
+      break;
+    }
+    Vector difference = environment->getState() - state;
+    if (difference.L1Norm() != 0.0) {
+      fprintf(stderr, "the search changed the environment state\n");
+      errors++;
+    }
+    bool running = environment->Act(action);
+    total_reward += environment->getReward();
+    if (!running) {
+      break;
+    }
+  }
+  return total_reward;
+}
+
+int main(int argc, char** argv) {
+  int n_threads = (argc > 1) ? atoi(argv[1]) : 4;
+  int n_rollouts = 200;
+  int n_steps = 20;
+  real gamma = 0.95;
+  int errors = 0;
+
+  MersenneTwisterRNG rng;
+  rng.manualSeed(1234);
+  std::vector<ContinuousStateEnvironment*> environments;
+  environments.push_back(new CartPole());
+  environments.push_back(new Acrobot());
+
+  for (uint i = 0; i < environments.size(); ++i) {
+    ContinuousStateEnvironment* environment = environments[i];
+    errors += TestClone(environment);
+
+    // the search simulates with a copy, so that the loop can act on
+    // the environment itself
+    ContinuousStateEnvironment* model = environment->Clone();
+    RandomPolicy policy(environment->getNActions(), &rng);
+    const char* mode_names[] = {"sequential", "tree parallel",
+                                "root parallel", "tree parallel, batched"};
+    for (int mode = 0; mode < 4; ++mode) {
+      MCTS mcts(gamma, model, &rng, policy, 100, n_rollouts);
+      if (mode == 1) {
+        mcts.setNumberOfThreads(n_threads, MCTS::TREE_PARALLEL);
+      } else if (mode == 2) {
+        mcts.setNumberOfThreads(n_threads, MCTS::ROOT_PARALLEL);
+      } else if (mode == 3) {
+        mcts.setNumberOfThreads(n_threads, MCTS::TREE_PARALLEL);
+        mcts.setLeafRollouts(4);
+      }
+      double decision_time;
+      real total_reward =
+          ControlLoop(environment, mcts, n_steps, errors, decision_time);
+      printf("%s, %s: reward %f, %f s per decision\n", environment->Name(),
+             mode_names[mode], total_reward, decision_time / n_steps);
+    }
+    delete model;
+    delete environment;
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -0,0 +1,109 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include "DiscreteMDP.h"
+#include "EasyClock.h"
+#include "PolicyEvaluation.h"
+#include "Random.h"
+#include "ValueIteration.h"
+
+/// Make an MDP with a few random transitions per state-action pair
+DiscreteMDP* MakeRandomMDP(int n_states, int n_actions, int n_next) {
+  DiscreteMDP* mdp = new DiscreteMDP(n_states, n_actions);
+  for (int s = 0; s < n_states; ++s) {
+    for (int a = 0; a < n_actions; ++a) {
+      Vector p(n_states);
+      for (int k = 0; k < n_next; ++k) {
+        p(rand() % n_states) += urandom();
+      }
+      p /= p.Sum();
+      for (int s2 = 0; s2 < n_states; ++s2) {
+        if (p(s2) > 0) {
+          mdp->setTransitionProbability(s, a, s2, p(s2));
+        }
+      }
+      mdp->setFixedReward(s, a, urandom());
+    }
+  }
+  return mdp;
+}
+
+int main(int argc, char** argv) {
+  int n_states = 2000;
+  int n_actions = 4;
+  int n_next = 10;
+  real gamma = 0.95;
+  int max_threads = 8;
+  if (argc > 1) {
+    n_states = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    max_threads = atoi(argv[2]);
+  }
+  DiscreteMDP* mdp = MakeRandomMDP(n_states, n_actions, n_next);
+  int errors = 0;
+
+  ValueIteration serial(mdp, gamma);
+  double start = GetMonotonicTime();
+  serial.ComputeStateValuesStandard(1e-6);
+  printf("# 1 thread: %f s\n", GetMonotonicTime() - start);
+
+  ValueIteration serial_elimination(mdp, gamma);
+  serial_elimination.ComputeStateValuesElimination(1e-6);
+
+  for (int n_threads = 2; n_threads <= max_threads; n_threads *= 2) {
+    ValueIteration parallel(mdp, gamma);
+    parallel.setNumberOfThreads(n_threads);
+    start = GetMonotonicTime();
+    parallel.ComputeStateValuesStandard(1e-6);
+    printf("# %d threads: %f s\n", n_threads, GetMonotonicTime() - start);
+    ValueIteration parallel_elimination(mdp, gamma);
+    parallel_elimination.setNumberOfThreads(n_threads);
+    parallel_elimination.ComputeStateValuesElimination(1e-6);
+    for (int s = 0; s < n_states; ++s) {
+      if (parallel.getValue(s) != serial.getValue(s)) {
+        errors++;
+      }
+      if (parallel_elimination.getValue(s) !=
+          serial_elimination.getValue(s)) {
+        errors++;
+      }
+    }
+    if (parallel.Delta != serial.Delta) {
+      errors++;
+    }
+  }
+
+  FixedDiscretePolicy* policy = serial.getPolicy();
+  PolicyEvaluation evaluation(policy, mdp, gamma);
+  evaluation.ComputeStateValues(1e-6);
+  PolicyEvaluation parallel_evaluation(policy, mdp, gamma);
+  parallel_evaluation.setNumberOfThreads(max_threads);
+  parallel_evaluation.ComputeStateValues(1e-6);
+  for (int s = 0; s < n_states; ++s) {
+    if (fabs(evaluation.getValue(s) - parallel_evaluation.getValue(s)) >
+        1e-3) {
+      errors++;
+    }
+  }
+  delete policy;
+  delete mdp;
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
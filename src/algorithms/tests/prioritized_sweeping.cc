@@ -0,0 +1,97 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include "DiscreteMDP.h"
+#include "PrioritizedSweeping.h"
+#include "Random.h"
+#include "ValueIteration.h"
+
+/// Set random transitions to a few local states, as in a grid
+void SetRandomRow(DiscreteMDP* mdp, int s, int a) {
+  int n_states = mdp->getNStates();
+  Vector p(n_states);
+  for (int k = 0; k < 3; ++k) {
+    int s2 = (s + rand() % 5 - 2 + n_states) % n_states;
+    p(s2) += urandom();
+  }
+  p /= p.Sum();
+  for (int s2 = 0; s2 < n_states; ++s2) {
+    mdp->setTransitionProbability(s, a, s2, p(s2));
+  }
+}
+
+/// Count the states where the two planners disagree
+int Compare(PrioritizedSweeping& sweeping, ValueIteration& value_iteration,
+            real tolerance) {
+  int errors = 0;
+  for (int s = 0; s < value_iteration.n_states; ++s) {
+    if (fabs(sweeping.getValue(s) - value_iteration.getValue(s)) > tolerance) {
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main(void) {
+  int n_states = 1000;
+  int n_actions = 2;
+  real gamma = 0.9;
+  DiscreteMDP mdp(n_states, n_actions);
+  for (int s = 0; s < n_states; ++s) {
+    for (int a = 0; a < n_actions; ++a) {
+      SetRandomRow(&mdp, s, a);
+      mdp.setFixedReward(s, a, (s == 0) ? 1.0 : 0.0);
+    }
+  }
+
+  int errors = 0;
+  ValueIteration value_iteration(&mdp, gamma);
+  value_iteration.ComputeStateValuesStandard(1e-9);
+  PrioritizedSweeping sweeping(&mdp, gamma);
+  sweeping.ComputeStateValues(1e-9);
+  printf("# Initial sweep: %d backups\n", sweeping.n_backups);
+  errors += Compare(sweeping, value_iteration, 1e-6);
+
+  // change a single row, as after an observed transition
+  for (int t = 0; t < 10; ++t) {
+    int s = rand() % n_states;
+    int a = rand() % n_actions;
+    SetRandomRow(&mdp, s, a);
+    mdp.setFixedReward(s, a, urandom());
+    sweeping.Update(s, a);
+    sweeping.Sweep(1e-9);
+    printf("# Update of (%d, %d): %d backups\n", s, a, sweeping.n_backups);
+  }
+  value_iteration.ComputeStateValuesStandard(1e-9);
+  errors += Compare(sweeping, value_iteration, 1e-6);
+
+  // a limited budget leaves work in the queue
+  mdp.setFixedReward(0, 0, 10.0);
+  sweeping.Update(0, 0);
+  sweeping.Sweep(1e-9, 10);
+  if (sweeping.n_backups != 10 || sweeping.getQueueSize() == 0) {
+    fprintf(stderr, "Backup budget not respected\n");
+    errors++;
+  }
+  sweeping.Sweep(1e-9);
+  value_iteration.ComputeStateValuesStandard(1e-9);
+  errors += Compare(sweeping, value_iteration, 1e-6);
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -0,0 +1,86 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Check the weights of RecursiveLSTDQ against solving the LSTDQ
+    system directly, with and without forgetting, and compare the cost
+    of updating the inverse with that of inverting A after each sample.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include "EasyClock.h"
+#include "Random.h"
+#include "RecursiveLSTDQ.h"
+
+int RecursiveTest(int n_basis, int T, real forgetting) {
+  int errors = 0;
+  real gamma = 0.9;
+  real regularisation = 1.0;
+  RecursiveLSTDQ recursive(n_basis, regularisation, forgetting);
+  Matrix A = Matrix::Unity(n_basis, n_basis) * regularisation;
+  Vector b(n_basis);
+  Vector w;
+  Vector phi(n_basis);
+  Vector phi_next(n_basis);
+  for (int j = 0; j < n_basis; ++j) {
+    phi_next(j) = urandom();
+  }
+  double recursive_time = 0.0;
+  double direct_time = 0.0;
+  for (int t = 0; t < T; ++t) {
+    phi = phi_next;
+    for (int j = 0; j < n_basis; ++j) {
+      phi_next(j) = urandom();
+    }
+    Vector difference = phi - phi_next * gamma;
+    real reward = urandom();
+
+    double start_time = GetCPU();
+    recursive.AddSample(phi, difference, reward);
+    const Vector& w_recursive = recursive.getWeights();
+    recursive_time += GetCPU() - start_time;
+
+    // the initial regularisation is forgotten as well
+    start_time = GetCPU();
+    A = A * forgetting + OuterProduct(phi, difference);
+    b = b * forgetting + phi * reward;
+    w = A.Inverse_LU() * b;
+    direct_time += GetCPU() - start_time;
+
+    for (int j = 0; j < n_basis; ++j) {
+      if (fabs(w(j) - w_recursive(j)) > 1e-6 * (1.0 + fabs(w(j)))) {
+        fprintf(stderr, "t = %d, w(%d): %f != %f\n", t, j, w_recursive(j),
+                w(j));
+        errors++;
+        break;
+      }
+    }
+  }
+  printf("%d features, forgetting %f: recursive %f s, direct %f s\n", n_basis,
+         forgetting, recursive_time, direct_time);
+  return errors;
+}
+
+int main(int argc, char** argv) {
+  int n_basis = 40;
+  int T = 200;
+  int errors = 0;
+  errors += RecursiveTest(n_basis, T, 1.0);
+  errors += RecursiveTest(n_basis, T, 0.95);
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -0,0 +1,119 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Compare SparseLSTDQ with LSTDQ on RBF features, and run policy
+    iteration with tile coding features, on a noisy one-dimensional
+    walk where moving right is always better.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include "EasyClock.h"
+#include "LSTDQ.h"
+#include "Random.h"
+#include "SparseLSTDQ.h"
+
+/// A one-dimensional point
+Vector Point(real x) {
+  Vector v(1);
+  v(0) = x;
+  return v;
+}
+
+/// Random walk in [0, 1] with reward equal to the position
+void CollectSamples(Demonstrations<Vector, int>& samples, int n_episodes,
+                    int T) {
+  Vector s(1);
+  for (int i = 0; i < n_episodes; ++i) {
+    samples.NewEpisode();
+    s(0) = urandom();
+    for (int t = 0; t < T; ++t) {
+      int a = urandom(0, 2);
+      samples.Observe(s, a, s(0));
+      s(0) += ((a == 0) ? -0.1 : 0.1) + urandom(-0.02, 0.02);
+      s(0) = std::max((real)0.0, std::min((real)1.0, s(0)));
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  int errors = 0;
+  real gamma = 0.9;
+  int n_actions = 2;
+  Demonstrations<Vector, int> samples(false);
+  CollectSamples(samples, 100, 20);
+
+  // with all RBF features, both solve the same system
+  RBFBasisSet rbf;
+  for (int i = 0; i < 10; ++i) {
+    rbf.AddCenter(Point((real)i / 9.0), 0.1);
+  }
+  LSTDQ lstdq(gamma, 1, n_actions, rbf, samples);
+  double start_time = GetCPU();
+  lstdq.Calculate();
+  double dense_time = GetCPU() - start_time;
+  SparseLSTDQ sparse_lstdq(gamma, n_actions, rbf, samples);
+  start_time = GetCPU();
+  sparse_lstdq.Calculate();
+  double sparse_time = GetCPU() - start_time;
+  for (int k = 0; k <= 10; ++k) {
+    Vector x = Point((real)k / 10.0);
+    for (int a = 0; a < n_actions; ++a) {
+      real Q = lstdq.getValue(x, a);
+      real Q_sparse = sparse_lstdq.getValue(x, a);
+      if (fabs(Q - Q_sparse) > 1e-3 * (1.0 + fabs(Q))) {
+        fprintf(stderr, "Q(%f, %d): sparse %f, dense %f\n", x(0), a,
+                Q_sparse, Q);
+        errors++;
+      }
+    }
+  }
+  printf("RBF: dense %f s, sparse %f s, %d LSQR iterations\n", dense_time,
+         sparse_time, sparse_lstdq.getSolverIterations());
+
+  // tile coding, with far more features than the dense solver could take
+  int n_tilings = 8;
+  int memory_size = 4096;
+  TileCodingBasisSet tiles(Point(0.0), Point(1.0), 10, n_tilings,
+                           memory_size);
+  SparseLSTDQ lspi(gamma, n_actions, tiles, samples);
+  lspi.setSolverTolerance(1e-6);
+  start_time = GetCPU();
+  int n_iterations = lspi.PolicyIteration(1e-3, 10);
+  double tile_time = GetCPU() - start_time;
+  int n_basis = n_actions * (memory_size + 1);
+  int n_right = 0;
+  for (int k = 0; k < 10; ++k) {
+    Vector x = Point(0.05 + 0.1 * (real)k);
+    if (lspi.GreedyAction(x) == 1) {
+      n_right++;
+    }
+  }
+  if (n_right < 8) {
+    fprintf(stderr, "greedy action is right in %d/10 states\n", n_right);
+    errors++;
+  }
+  if (lspi.getNonZeros() > 100 * n_basis) {
+    fprintf(stderr, "%d non-zeros\n", lspi.getNonZeros());
+    errors++;
+  }
+  printf("Tile coding: %d features, %d non-zeros, %d iterations, %f s\n",
+         n_basis, lspi.getNonZeros(), n_iterations, tile_time);
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
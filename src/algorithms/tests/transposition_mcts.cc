@@ -0,0 +1,105 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Compare MonteCarloTreeSearch with and without a transposition
+    table on discretised MountainCar and PuddleWorld states, with the
+    same number of rollouts.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <cstdlib>
+#include "MersenneTwister.h"
+#include "MonteCarloTreeSearch.h"
+#include "MountainCar.h"
+#include "PuddleWorld.h"
+#include "RandomPolicy.h"
+
+typedef MonteCarloTreeSearch<Vector, int> MCTS;
+
+/// Run a few steps with the given search, returning the total reward
+real ControlLoop(ContinuousStateEnvironment* environment, MCTS& mcts,
+                 int n_steps, int& errors, int& tree_size) {
+  real total_reward = 0;
+  tree_size = 0;
+  environment->Reset();
+  for (int t = 0; t < n_steps; ++t) {
+    Vector state = environment->getState();
+    int action = mcts.SelectAction(state);
+    if (action < 0 || action >= (int)environment->getNActions()) {
+      fprintf(stderr, "invalid action %d\n", action);
+      errors++;
+      break;
+    }
+    tree_size += mcts.getStatistics().tree_size;
+    bool running = environment->Act(action);
+    total_reward += environment->getReward();
+    if (!running) {
+      break;
+    }
+  }
+  return total_reward;
+}
+
+int main(int argc, char** argv) {
+  int n_rollouts = 500;
+  int n_steps = 10;
+  int grid_size = 10;
+  int capacity = 1 << 12;
+  real gamma = 0.95;
+  int errors = 0;
+
+  MersenneTwisterRNG rng;
+  rng.manualSeed(1234);
+  std::vector<ContinuousStateEnvironment*> environments;
+  environments.push_back(new MountainCar());
+  environments.push_back(new PuddleWorld());
+
+  for (uint i = 0; i < environments.size(); ++i) {
+    ContinuousStateEnvironment* environment = environments[i];
+    ContinuousStateEnvironment* model = environment->Clone();
+    RandomPolicy policy(environment->getNActions(), &rng);
+    EvenGrid grid(environment->StateLowerBound(),
+                  environment->StateUpperBound(), grid_size);
+    int tree_size[3];
+    const char* mode_names[] = {"tree", "graph", "graph, tree parallel"};
+    for (int mode = 0; mode < 3; ++mode) {
+      MCTS mcts(gamma, model, &rng, policy, 100, n_rollouts);
+      if (mode > 0) {
+        mcts.setTranspositionTable(grid, capacity);
+      }
+      if (mode == 2) {
+        mcts.setNumberOfThreads(2, MCTS::TREE_PARALLEL);
+      }
+      real total_reward =
+          ControlLoop(environment, mcts, n_steps, errors, tree_size[mode]);
+      printf("%s, %s: reward %f, %f nodes per decision\n", environment->Name(),
+             mode_names[mode], total_reward, (real)tree_size[mode] / n_steps);
+    }
+    // every rollout adds a node to the tree, but not to the graph
+    if (tree_size[1] >= tree_size[0]) {
+      fprintf(stderr, "%s: the table did not merge any nodes\n",
+              environment->Name());
+      errors++;
+    }
+    delete model;
+    delete environment;
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
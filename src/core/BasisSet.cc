@@ -10,49 +10,102 @@
  ***************************************************************************/
 
 #include "BasisSet.h"
+#include <algorithm>
+#include "ParallelFor.h"
+#include "TilingSet.h"
 
-RBFBasisSet::RBFBasisSet(const EvenGrid& grid, real scale) {
-  n_bases = 0;
+RBFBasisSet::RBFBasisSet(const EvenGrid& grid, real scale)
+    : n_dimensions(0),
+      capacity(0),
+      valid_features(false),
+      valid_log_features(false),
+      n_bases(0),
+      sparse_threshold(0.0) {
   for (int i = 0; i < grid.getNIntervals(); ++i) {
     AddCenter(grid.getCenter(i), grid.delta * scale);
   }
   // logmsg("Added %d RBFs\n", centers.size());
 }
 
-RBFBasisSet::~RBFBasisSet() {
-  for (uint i = 0; i < centers.size(); ++i) {
-    delete centers[i];
-  }
-}
+RBFBasisSet::~RBFBasisSet() {}
 
 void RBFBasisSet::AddCenter(const Vector& v, const Vector& b) {
-  RBF* rbf = new RBF(v, b);
-  centers.push_back(rbf);
-  n_bases++;
-  features.Resize(centers.size());
-  features[n_bases - 1] = 0.0;
-  log_features.Resize(centers.size());
-  log_features[n_bases - 1] = 0.0;
-  valid_features = false;
-  valid_log_features = false;
+  assert(v.Size() == b.Size());
+  std::vector<real> inverse_b(v.Size());
+  for (int j = 0; j < v.Size(); ++j) {
+    assert(b(j) > 0);
+    inverse_b[j] = 1.0 / b(j);
+  }
+  AddCenter(v, &inverse_b[0]);
 }
 
 void RBFBasisSet::AddCenter(const Vector& v, real b) {
-  RBF* rbf = new RBF(v, b);
-  centers.push_back(rbf);
+  assert(b > 0);
+  std::vector<real> inverse_b(v.Size(), 1.0 / b);
+  AddCenter(v, &inverse_b[0]);
+}
+
+/** Add a center with the given inverse widths.
+
+    The arrays are laid out again with twice the capacity when they
+    are full, so that adding a center takes amortised constant time.
+ */
+void RBFBasisSet::AddCenter(const Vector& v, const real* inverse_b) {
+  if (n_bases == 0) {
+    n_dimensions = v.Size();
+  }
+  assert(v.Size() == n_dimensions);
+  if (n_bases == capacity) {
+    int new_capacity = std::max(2 * capacity, 16);
+    std::vector<real> new_centers(n_dimensions * new_capacity);
+    std::vector<real> new_inverse_beta(n_dimensions * new_capacity);
+    for (int j = 0; j < n_dimensions; ++j) {
+      for (int i = 0; i < n_bases; ++i) {
+        new_centers[j * new_capacity + i] = centers[j * capacity + i];
+        new_inverse_beta[j * new_capacity + i] = inverse_beta[j * capacity + i];
+      }
+    }
+    centers.swap(new_centers);
+    inverse_beta.swap(new_inverse_beta);
+    capacity = new_capacity;
+  }
+  for (int j = 0; j < n_dimensions; ++j) {
+    centers[j * capacity + n_bases] = v(j);
+    inverse_beta[j * capacity + n_bases] = inverse_b[j];
+  }
   n_bases++;
-  features.Resize(centers.size());
+  features.Resize(n_bases);
   features[n_bases - 1] = 0.0;
-  log_features.Resize(centers.size());
+  log_features.Resize(n_bases);
   log_features[n_bases - 1] = 0.0;
   valid_features = false;
   valid_log_features = false;
 }
 
+/** Compute the squared scaled distances from x to all centers.
+
+    \f$r_i = \sum_j [(x_j - c_{ij}) / \beta_{ij}]^2\f$ is stored in r[i].
+ */
+void RBFBasisSet::SquaredDistances(const real* x, real* r) const {
+  for (int i = 0; i < n_bases; ++i) {
+    r[i] = 0.0;
+  }
+  for (int j = 0; j < n_dimensions; ++j) {
+    const real x_j = x[j];
+    const real* c_j = &centers[j * capacity];
+    const real* ib_j = &inverse_beta[j * capacity];
+    for (int i = 0; i < n_bases; ++i) {
+      real d = (x_j - c_j[i]) * ib_j[i];
+      r[i] += d * d;
+    }
+  }
+}
+
 void RBFBasisSet::logEvaluate(const Vector& x) {
+  assert(x.Size() == n_dimensions || n_bases == 0);
+  SquaredDistances(x.x, log_features.x);
   real log_sum = LOG_ZERO;
   for (int i = 0; i < n_bases; ++i) {
-    log_features[i] = centers[i]->logEvaluate(x);
     log_sum = logAdd(log_features[i], log_sum);
   }
   for (int i = 0; i < n_bases; ++i) {
@@ -72,9 +125,92 @@ void RBFBasisSet::logEvaluate(const Vector& x) {
 //}
 
 void RBFBasisSet::Evaluate(const Vector& x) {
+  assert(x.Size() == n_dimensions || n_bases == 0);
+  real* f = features.x;
+  SquaredDistances(x.x, f);
   for (int i = 0; i < n_bases; ++i) {
-    features[i] = centers[i]->Evaluate(x);
+    f[i] = exp(-0.5 * f[i]);
   }
   valid_log_features = true;
   valid_features = true;
 }
+
+/** Evaluate the features at x, keeping those larger than the sparse
+    threshold in phi.
+
+    This also updates the dense features.
+ */
+void RBFBasisSet::Evaluate(const Vector& x, SparseVector& phi) {
+  Evaluate(x);
+  phi.Clear();
+  for (int i = 0; i < n_bases; ++i) {
+    if (features[i] > sparse_threshold) {
+      phi.Add(i, features[i]);
+    }
+  }
+}
+
+/** Evaluate the features of each row of X.
+
+    The features of the t-th row are stored in the t-th row of Phi.
+    The rows are split among n_threads threads. The features stored
+    in the basis set are not changed.
+ */
+void RBFBasisSet::Evaluate(const Matrix& X, Matrix& Phi, int n_threads) const {
+  assert(X.Columns() == n_dimensions || n_bases == 0);
+  int T = X.Rows();
+  Phi.Resize(T, n_bases);
+  ParallelFor(T, ResolveNumberOfThreads(n_threads),
+              [&](int block, int first, int last) {
+    std::vector<real> x(n_dimensions + 1);
+    std::vector<real> r(n_bases + 1);
+    for (int t = first; t < last; ++t) {
+      for (int j = 0; j < n_dimensions; ++j) {
+        x[j] = X(t, j);
+      }
+      SquaredDistances(&x[0], &r[0]);
+      for (int i = 0; i < n_bases; ++i) {
+        Phi(t, i) = exp(-0.5 * r[i]);
+      }
+    }
+  });
+}
+
+/** Create a tile coding.
+
+    \param lower_ the lower bound of the inputs
+    \param upper the upper bound of the inputs
+    \param n_intervals the number of cells of each tiling per dimension
+    \param n_tilings_ the number of tilings
+    \param memory_size_ the number of features the cells are hashed to
+ */
+TileCodingBasisSet::TileCodingBasisSet(const Vector& lower_,
+                                       const Vector& upper, int n_intervals,
+                                       int n_tilings_, int memory_size_)
+    : lower(lower_),
+      scale(lower_.Size()),
+      n_tilings(n_tilings_),
+      memory_size(memory_size_),
+      floats(lower_.Size()),
+      tiles(n_tilings_) {
+  assert(lower.Size() == upper.Size());
+  assert(lower.Size() <= MAX_NUM_VARS);
+  assert(n_intervals > 0 && n_tilings > 0 && memory_size > 0);
+  for (int j = 0; j < lower.Size(); ++j) {
+    assert(upper(j) > lower(j));
+    scale(j) = (real)n_intervals / (upper(j) - lower(j));
+  }
+}
+
+/// Put the n_tilings active features at x in phi, with value 1
+void TileCodingBasisSet::Evaluate(const Vector& x, SparseVector& phi) {
+  assert(x.Size() == lower.Size());
+  for (int j = 0; j < x.Size(); ++j) {
+    floats[j] = (float)((x(j) - lower(j)) * scale(j));
+  }
+  GetTiles(&tiles[0], n_tilings, memory_size, &floats[0], (int)floats.size());
+  phi.Clear();
+  for (int k = 0; k < n_tilings; ++k) {
+    phi.Add(tiles[k], 1.0);
+  }
+}
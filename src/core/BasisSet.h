@@ -15,8 +15,25 @@
 #include <cassert>
 #include <vector>
 #include "Grid.h"
+#include "Matrix.h"
+#include "SparseMatrix.h"
 #include "Vector.h"
 
+/** A set of basis functions.
+
+    This is the interface used by linear value function approximators
+    that only need the non-zero features of each point, such as
+    SparseLSTDQ.
+ */
+class BasisSet {
+ public:
+  virtual ~BasisSet() {}
+  /// The number of features
+  virtual int size() const = 0;
+  /// Put the non-zero features at x in phi
+  virtual void Evaluate(const Vector& x, SparseVector& phi) = 0;
+};
+
 /** A simple radial basis function */
 class RBF {
  public:
@@ -25,8 +42,7 @@ class RBF {
   /// Constructor
   RBF(const Vector& c, real b) : center(c) {
     assert(b > 0);
-    Vector var(c.Size(), &b);
-    beta = var;
+    beta = Vector::Unity(c.Size()) * b;
   }
 
   RBF(const Vector& c, const Vector& b) : center(c), beta(b) { assert(b > 0); }
@@ -47,26 +63,49 @@ class RBF {
   }
 };
 
-class RBFBasisSet {
+/** A set of radial basis functions.
+
+    The centers and inverse widths are stored in contiguous arrays,
+    one dimension after the other, so that the squared distances from
+    a point to all centers are computed by loops over consecutive
+    centers, which the compiler can vectorise. The exponentials are
+    taken in a second pass over the distances.
+ */
+class RBFBasisSet : public BasisSet {
  protected:
-  std::vector<RBF*> centers;
+  int n_dimensions;                ///< dimension of the centers
+  int capacity;                    ///< number of centers with space reserved
+  std::vector<real> centers;       ///< centers[j * capacity + i] = c_i(j)
+  std::vector<real> inverse_beta;  ///< inverse widths, in the same layout
 
   Vector log_features;
   Vector features;
   bool valid_features;
   bool valid_log_features;
   int n_bases;
+  real sparse_threshold;  ///< features below this are left out of sparse sets
+  void AddCenter(const Vector& v, const real* inverse_b);
+  void SquaredDistances(const real* x, real* r) const;
 
  public:
   RBFBasisSet()
-      : valid_features(false), valid_log_features(false), n_bases(0) {}
+      : n_dimensions(0),
+        capacity(0),
+        valid_features(false),
+        valid_log_features(false),
+        n_bases(0),
+        sparse_threshold(0.0) {}
   RBFBasisSet(const EvenGrid& grid, real scale = 1);
-  ~RBFBasisSet();
+  virtual ~RBFBasisSet();
   void AddCenter(const Vector& v, const Vector& b);
   void AddCenter(const Vector& v, real b);
   void Evaluate(const Vector& x);
+  void Evaluate(const Matrix& X, Matrix& Phi, int n_threads = 1) const;
+  virtual void Evaluate(const Vector& x, SparseVector& phi);
   void logEvaluate(const Vector& x);
-  int size() { return n_bases; }
+  virtual int size() const { return n_bases; }
+  /// Leave features smaller than threshold out of sparse feature sets
+  void setSparseThreshold(real threshold) { sparse_threshold = threshold; }
   real log_F(int j) {
     assert(j >= 0 && j < n_bases);
     assert(valid_log_features);
@@ -80,4 +119,27 @@ class RBFBasisSet {
   }
   Vector F() { return features; }
 };
+
+/** Tile coding features.
+
+    The input space between lower and upper is covered by n_tilings
+    offset grids with n_intervals cells in each dimension. The cells
+    are hashed into memory_size features, and each point activates
+    exactly one feature per tiling.
+ */
+class TileCodingBasisSet : public BasisSet {
+ protected:
+  Vector lower;               ///< lower bound of the inputs
+  Vector scale;               ///< number of cells per unit in each dimension
+  int n_tilings;              ///< number of tilings
+  int memory_size;            ///< number of features
+  std::vector<float> floats;  ///< scaled input
+  std::vector<int> tiles;     ///< active features
+ public:
+  TileCodingBasisSet(const Vector& lower_, const Vector& upper,
+                     int n_intervals, int n_tilings_, int memory_size_);
+  virtual ~TileCodingBasisSet() {}
+  virtual int size() const { return memory_size; }
+  virtual void Evaluate(const Vector& x, SparseVector& phi);
+};
 #endif
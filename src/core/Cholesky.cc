@@ -0,0 +1,114 @@
+/* -*- Mode: c++ -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "Cholesky.h"
+
+Vector CholeskyForwardSolve(const Matrix& U, const Vector& b) {
+  int n = U.Rows();
+  assert(n == U.Columns() && n == b.Size());
+  Vector z(n);
+  for (int i = 0; i < n; ++i) {
+    real sum = b(i);
+    for (int k = 0; k < i; ++k) {
+      sum -= U(k, i) * z(k);
+    }
+    z(i) = sum / U(i, i);
+  }
+  return z;
+}
+
+Vector CholeskyBackSolve(const Matrix& U, const Vector& b) {
+  int n = U.Rows();
+  assert(n == U.Columns() && n == b.Size());
+  Vector z(n);
+  for (int i = n - 1; i >= 0; --i) {
+    real sum = b(i);
+    for (int k = i + 1; k < n; ++k) {
+      sum -= U(i, k) * z(k);
+    }
+    z(i) = sum / U(i, i);
+  }
+  return z;
+}
+
+/** Extend a factor by one row and column.
+
+    If \f$u\f$ solves \f$U^\top u = k\f$, the new factor is
+    \f$[U, u; 0, \sqrt{d - u^\top u}]\f$.
+ */
+void CholeskyAppend(Matrix& U, const Vector& k, real d) {
+  int n = U.Rows();
+  Vector u = CholeskyForwardSolve(U, k);
+  real diagonal = d - Product(u, u);
+  if (diagonal <= 0) {
+    throw std::runtime_error(
+        "Could not do Cholesky, matrix not positive definite");
+  }
+  Matrix V(n + 1, n + 1);
+  for (int i = 0; i < n; ++i) {
+    for (int j = i; j < n; ++j) {
+      V(i, j) = U(i, j);
+    }
+    V(i, n) = u(i);
+  }
+  V(n, n) = sqrt(diagonal);
+  U = std::move(V);
+}
+
+/// Rank one update of the block of U below and right of (start, start)
+static void RankOneUpdate(Matrix& U, Vector& v, int start) {
+  int n = U.Rows();
+  for (int k = start; k < n; ++k) {
+    real u_kk = U(k, k);
+    real r = sqrt(u_kk * u_kk + v(k) * v(k));
+    real c = r / u_kk;
+    real s = v(k) / u_kk;
+    U(k, k) = r;
+    for (int j = k + 1; j < n; ++j) {
+      U(k, j) = (U(k, j) + s * v(j)) / c;
+      v(j) = c * v(j) - s * U(k, j);
+    }
+  }
+}
+
+void CholeskyRankOneUpdate(Matrix& U, Vector v) { RankOneUpdate(U, v, 0); }
+
+/** Remove row and column i.
+
+    The rows above i are unchanged. The block below and to the right
+    of i is the factor of \f$U_{33}^\top U_{33} + u_{23} u_{23}^\top\f$,
+    where \f$u_{23}\f$ is the part of row i to the right of the
+    diagonal, so it is obtained by a rank one update.
+ */
+void CholeskyRemove(Matrix& U, int i) {
+  int n = U.Rows();
+  assert(i >= 0 && i < n);
+  Matrix V(n - 1, n - 1);
+  for (int r = 0; r < n; ++r) {
+    if (r == i) {
+      continue;
+    }
+    int r2 = (r < i) ? r : r - 1;
+    for (int c = r; c < n; ++c) {
+      if (c == i) {
+        continue;
+      }
+      int c2 = (c < i) ? c : c - 1;
+      V(r2, c2) = U(r, c);
+    }
+  }
+  Vector v(n - 1);
+  for (int c = i + 1; c < n; ++c) {
+    v(c - 1) = U(i, c);
+  }
+  RankOneUpdate(V, v, i);
+  U = std::move(V);
+}
@@ -0,0 +1,56 @@
+/* -*- Mode: c++ -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SRC_CORE_CHOLESKY_H_
+#define SRC_CORE_CHOLESKY_H_
+
+#include "Matrix.h"
+#include "Vector.h"
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/** \file Cholesky.h
+
+    \brief Solves and updates with a Cholesky factor.
+
+    The factor is upper triangular, \f$K = U^\top U\f$, as returned by
+    Matrix::Cholesky(). All operations take \f$O(n^2)\f$ time, so that
+    a factor can be maintained while rows and columns are added to and
+    removed from \f$K\f$, without inverting any matrix.
+ */
+
+/// Solve \f$U^\top z = b\f$ by forward substitution.
+Vector CholeskyForwardSolve(const Matrix& U, const Vector& b);
+
+/// Solve \f$U z = b\f$ by back substitution.
+Vector CholeskyBackSolve(const Matrix& U, const Vector& b);
+
+/// Solve \f$U^\top U z = b\f$.
+inline Vector CholeskySolve(const Matrix& U, const Vector& b) {
+  return CholeskyBackSolve(U, CholeskyForwardSolve(U, b));
+}
+
+/// Extend the factor of \f$K\f$ to that of \f$[K, k; k^\top, d]\f$.
+void CholeskyAppend(Matrix& U, const Vector& k, real d);
+
+/// Replace the factor of \f$K\f$ with that of \f$K\f$ without row and
+/// column i.
+void CholeskyRemove(Matrix& U, int i);
+
+/// Replace the factor of \f$K\f$ with that of \f$K + v v^\top\f$.
+void CholeskyRankOneUpdate(Matrix& U, Vector v);
+
+/*@}*/
+
+#endif  // SRC_CORE_CHOLESKY_H_
@@ -10,11 +10,14 @@
  ***************************************************************************/
 
 #include "CoverTree.h"
+#include <algorithm>
+#include <vector>
 
 /// Constructor needs a point and a level
-CoverTree::Node::Node(const CoverTree& tree_, const Vector& point_,
-                      const int level_, CoverTree::Node* const father_,
-                      void* object_)
+template <class Metric>
+MetricCoverTree<Metric>::Node::Node(const MetricCoverTree& tree_,
+                                    const Vector& point_, const int level_,
+                                    Node* const father_, void* object_)
     : tree(tree_),
       point(point_),
       level(level_),
@@ -62,7 +65,8 @@ CoverTree::Node::Node(const CoverTree& tree_, const Vector& point_,
 }
 
 /// Destructor
-CoverTree::Node::~Node() {
+template <class Metric>
+MetricCoverTree<Metric>::Node::~Node() {
   for (uint i = 0; i < children.size(); ++i) {
     delete children[i];
   }
@@ -72,8 +76,9 @@ CoverTree::Node::~Node() {
 }
 
 /// Insert a new point at the given level, as a child of this node
-void CoverTree::Node::Insert(const Vector& new_point, const int level,
-                             void* obj) {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::Insert(const Vector& new_point,
+                                           const int level, void* obj) {
 #ifdef DEBUG_COVER_TREE
   printf(" | [%d] ", this->level);
   point.print(stdout);
@@ -90,9 +95,13 @@ void CoverTree::Node::Insert(const Vector& new_point, const int level,
 }
 
 /// Insert a new point at the given level, as a child of this node
-void CoverTree::Node::Insert(const Vector& new_point, const Vector& phi,
-                             const Vector& next_state, const real& reward,
-                             const bool& absorb, const int level, void* obj) {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::Insert(const Vector& new_point,
+                                           const Vector& phi,
+                                           const Vector& next_state,
+                                           const real& reward,
+                                           const bool& absorb, const int level,
+                                           void* obj) {
 #ifdef DEBUG_COVER_TREE
   printf(" | [%d] ", this->level);
   point.print(stdout);
@@ -109,7 +118,8 @@ void CoverTree::Node::Insert(const Vector& new_point, const Vector& phi,
     children_level = level;
   }
 }
-void CoverTree::Node::SamplingModel(bool Thompson) {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::SamplingModel(bool Thompson) {
   StatePrediction->Sampling(Thompson);
   if (tree.RewardPred) {
     RewardPrediction->Sampling(Thompson);
@@ -121,7 +131,8 @@ void CoverTree::Node::SamplingModel(bool Thompson) {
   }
 }
 
-void CoverTree::Node::Show() const {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::Show() const {
   printf("level: %d ", level);
   printf("descendants: %d ", descendants);
   printf("depth: %d ", depth);
@@ -143,7 +154,8 @@ void CoverTree::Node::Show() const {
     printf("# --\n");
   }
 }
-void CoverTree::Node::ShowSampling() const {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::ShowSampling() const {
   if (active_flag == true) {
     //		printf ("level: %d ", level);
     point.print(stdout);
@@ -164,7 +176,8 @@ void CoverTree::Node::ShowSampling() const {
     }
   }
 }
-void CoverTree::Node::ShowBasis() const {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::ShowBasis() const {
   if (GetActiveBasis() == true) {
     point.print(stdout);
     if (Size()) {
@@ -178,7 +191,8 @@ void CoverTree::Node::ShowBasis() const {
     //		}
   }
 }
-void CoverTree::Node::Show(FILE* fout) const {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::Show(FILE* fout) const {
   printf("%d ", level);
   point.print(stdout);
   if (Size()) {
@@ -191,7 +205,8 @@ void CoverTree::Node::Show(FILE* fout) const {
     printf("# --\n");
   }
 }
-void CoverTree::Node::ShowSampling(FILE* fout) const {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::ShowSampling(FILE* fout) const {
   printf("level: %d ", level);
   point.print(stdout);
   if (active_flag) {
@@ -206,7 +221,8 @@ void CoverTree::Node::ShowSampling(FILE* fout) const {
     }
   }
 }
-void CoverTree::Node::ShowBasis(FILE* fout) const {
+template <class Metric>
+void MetricCoverTree<Metric>::Node::ShowBasis(FILE* fout) const {
   printf("level: %d ", level);
   point.print(stdout);
   if (basis_flag) {
@@ -221,7 +237,9 @@ void CoverTree::Node::ShowBasis(FILE* fout) const {
     }
   }
 }
-const real CoverTree::metric(const CoverSet& Q, const Vector& p) const {
+template <class Metric>
+const real MetricCoverTree<Metric>::metric(const CoverSet& Q,
+                                           const Vector& p) const {
   real D = INF;
   for (int i = 0; i < Q.Size(); ++i) {
     real d_i = metric(Q.nodes[i]->point, p);
@@ -232,7 +250,9 @@ const real CoverTree::metric(const CoverSet& Q, const Vector& p) const {
   return D;
 }
 
-void CoverTree::UpdateStatistics(const Vector& input, const Vector& output) {
+template <class Metric>
+void MetricCoverTree<Metric>::UpdateStatistics(const Vector& input,
+                                               const Vector& output) {
   real total_probability = 0;
   Node* examine = root;
   while (examine != NULL) {
@@ -240,7 +260,8 @@ void CoverTree::UpdateStatistics(const Vector& input, const Vector& output) {
     examine = examine->child;
   }
 }
-const void CoverTree::SamplingNode(Node* n) {
+template <class Metric>
+const void MetricCoverTree<Metric>::SamplingNode(Node* n) {
   /// In this point, we sample the regressor's nodes.
   if (n == root) {
     num_sampling_nodes++;
@@ -285,7 +306,8 @@ const void CoverTree::SamplingNode(Node* n) {
     }
   }
 }
-const void CoverTree::SamplingNode(Node* n, const Vector& R) {
+template <class Metric>
+const void MetricCoverTree<Metric>::SamplingNode(Node* n, const Vector& R) {
   if (R[n->index] <= n->weight && n->samples > thres) {
     num_sampling_nodes++;
     n->active_flag = true;
@@ -311,15 +333,18 @@ const void CoverTree::SamplingNode(Node* n, const Vector& R) {
     }
   }
 }
-const void CoverTree::SamplingTree() {
+template <class Metric>
+const void MetricCoverTree<Metric>::SamplingTree() {
   num_sampling_nodes = 0;
   SamplingNode(root);
 }
-const void CoverTree::SamplingTree(const Vector& R) {
+template <class Metric>
+const void MetricCoverTree<Metric>::SamplingTree(const Vector& R) {
   assert(R.Size() == num_nodes);
   SamplingNode(root, R);
 }
-Vector CoverTree::BasisCreation(const Vector& state) const {
+template <class Metric>
+Vector MetricCoverTree<Metric>::BasisCreation(const Vector& state) const {
   Vector phi = state;
   if (RBFs != NULL) {
     RBFs->Evaluate(state);
@@ -330,8 +355,9 @@ Vector CoverTree::BasisCreation(const Vector& state) const {
   phi[dim - 1] = 1.0;
   return phi;
 }
-const std::vector<std::pair<int, real> > CoverTree::ExternalBasisCreation(
-    const Vector& state) const {
+template <class Metric>
+const std::vector<std::pair<int, real> >
+MetricCoverTree<Metric>::ExternalBasisCreation(const Vector& state) const {
   std::vector<std::pair<int, real> > phi;
   std::pair<int, real> path_data;
   const Node* path_node = NearestNeighbour(state);
@@ -403,8 +429,9 @@ const std::vector<std::pair<int, real> > CoverTree::ExternalBasisCreation(
         }
     }
 */
-CoverTree::Node* CoverTree::Insert(const Vector& new_point, const CoverSet& Q_i,
-                                   const int level, void* obj) {
+template <class Metric>
+typename MetricCoverTree<Metric>::Node* MetricCoverTree<Metric>::Insert(
+    const Vector& new_point, const CoverSet& Q_i, const int level, void* obj) {
   Node* closest_node = NULL;
 
   // Check if d(p, Q) > 2^level
@@ -492,10 +519,11 @@ CoverTree::Node* CoverTree::Insert(const Vector& new_point, const CoverSet& Q_i,
   return found;
 }
 
-CoverTree::Node* CoverTree::Insert(const Vector& new_point, const Vector& phi,
-                                   const Vector& next_state, const real& reward,
-                                   const bool& absorb, const CoverSet& Q_i,
-                                   const int level, void* obj) {
+template <class Metric>
+typename MetricCoverTree<Metric>::Node* MetricCoverTree<Metric>::Insert(
+    const Vector& new_point, const Vector& phi, const Vector& next_state,
+    const real& reward, const bool& absorb, const CoverSet& Q_i,
+    const int level, void* obj) {
   Node* closest_node = NULL;
 
   // Check if d(p, Q) > 2^level
@@ -598,7 +626,9 @@ CoverTree::Node* CoverTree::Insert(const Vector& new_point, const Vector& phi,
   }
   return found;
 }  /// Insert a new point in the tree
-CoverTree::Node* CoverTree::Insert(const Vector& new_point, void* obj) {
+template <class Metric>
+typename MetricCoverTree<Metric>::Node* MetricCoverTree<Metric>::Insert(
+    const Vector& new_point, void* obj) {
   total_samples++;
   if (!root) {
 #ifdef DEBUG_COVER_TREE
@@ -619,9 +649,10 @@ CoverTree::Node* CoverTree::Insert(const Vector& new_point, void* obj) {
 }
 
 /// Insert a new point in the tree along with its statistics
-CoverTree::Node* CoverTree::Insert(const Vector& new_point,
-                                   const Vector& next_state, const real& reward,
-                                   const bool& absorb, void* obj) {
+template <class Metric>
+typename MetricCoverTree<Metric>::Node* MetricCoverTree<Metric>::Insert(
+    const Vector& new_point, const Vector& next_state, const real& reward,
+    const bool& absorb, void* obj) {
   Vector phi = BasisCreation(new_point);
   total_samples++;
   if (!root) {
@@ -645,7 +676,7 @@ CoverTree::Node* CoverTree::Insert(const Vector& new_point,
   Q.Insert(root, distance);
 
   /// A new point is inserted in our tree
-  CoverTree::Node* inserted =
+  Node* inserted =
       Insert(new_point, phi, next_state, reward, absorb, Q, level, obj);
 
   /// Update path statistics.
@@ -657,40 +688,48 @@ CoverTree::Node* CoverTree::Insert(const Vector& new_point,
 
     If the current node is closest, return that.
 
-    Look through all children which are close enough to this point.
+    Look through all children which are close enough to this point,
+    closest first. For an approximate search, the distance of each
+    child is scaled by \f$1 + \epsilon\f$ before the comparison. Every
+    computed distance uses up one of n_nodes, and no more children are
+    examined once it reaches zero.
 */
-std::pair<const CoverTree::Node*, real> CoverTree::Node::NearestNeighbour(
-    const Vector& query, const real distance) const {
-  std::pair<const CoverTree::Node*, real> retval(this, distance);
+template <class Metric>
+std::pair<const typename MetricCoverTree<Metric>::Node*, real>
+MetricCoverTree<Metric>::Node::NearestNeighbour(const Vector& query,
+                                                const real distance,
+                                                int& n_nodes) const {
+  std::pair<const Node*, real> retval(this, distance);
 
   real log_separation = level * tree.log_c;
   real separation = exp(log_separation);
 
   real& dist = retval.second;
-  real& dist_max = retval.second;
-  for (int j = 0; j < Size(); ++j) {
-    real dist_j = children[j]->distanceTo(query);
-    if (dist_j - separation <= dist) {
-      // if (dist_j <= dist + exp(children[j]->level * tree.log_c)) {
-      std::pair<const CoverTree::Node*, real> sub =
-          children[j]->NearestNeighbour(query, dist_j);
-      if (sub.second < dist_max) {
-        dist_max = sub.second;
+  std::vector<std::pair<real, int> > order;
+  order.reserve(Size());
+  for (int j = 0; j < Size() && n_nodes > 0; ++j) {
+    order.push_back(std::make_pair(children[j]->distanceTo(query), j));
+    n_nodes--;
+  }
+  std::sort(order.begin(), order.end());
+  for (uint k = 0; k < order.size(); ++k) {
+    real dist_j = order[k].first;
+    if ((1.0 + tree.epsilon) * (dist_j - separation) <= dist) {
+      std::pair<const Node*, real> sub =
+          children[order[k].second]->NearestNeighbour(query, dist_j, n_nodes);
+      if (sub.second < dist) {
         retval = sub;
       }
-      //} else {
-      //            printf("Sep: %f, Dist: %f, Parent: %f, ignoring node [%d ->
-      //            %d]: ",
-      // separation, dist_j, dist, level, children[j]->level);
-      // children[j]->point.print(stdout);
     }
   }
 
   return retval;
 }
-std::pair<CoverTree::Node*, real> CoverTree::Node::FindNearestNeighbour(
-    const Vector& query, const real distance) {
-  std::pair<CoverTree::Node*, real> retval(this, distance);
+template <class Metric>
+std::pair<typename MetricCoverTree<Metric>::Node*, real>
+MetricCoverTree<Metric>::Node::FindNearestNeighbour(const Vector& query,
+                                                    const real distance) {
+  std::pair<Node*, real> retval(this, distance);
   // real log_separation = level * tree.log_c;
   // real separation = exp(log_separation);
 
@@ -699,7 +738,7 @@ std::pair<CoverTree::Node*, real> CoverTree::Node::FindNearestNeighbour(
   for (int j = 0; j < Size(); ++j) {
     real dist_j = children[j]->distanceTo(query);
     if (dist_j <= dist + exp(children[j]->level * tree.log_c)) {
-      std::pair<CoverTree::Node*, real> sub =
+      std::pair<Node*, real> sub =
           children[j]->FindNearestNeighbour(query, dist_j);
       if (sub.second < dist) {
         retval = sub;
@@ -709,8 +748,9 @@ std::pair<CoverTree::Node*, real> CoverTree::Node::FindNearestNeighbour(
   return retval;
 }
 /// Find the nearest neighbour in the tree
-const CoverTree::Node* CoverTree::NearestNeighbour(
-    const Vector& query_point) const {
+template <class Metric>
+const typename MetricCoverTree<Metric>::Node*
+MetricCoverTree<Metric>::NearestNeighbour(const Vector& query_point) const {
 #ifdef DEBUG_COVER_TREE_NN
   printf("Query: ");
   query_point.print(stdout);
@@ -720,13 +760,15 @@ const CoverTree::Node* CoverTree::NearestNeighbour(
     return NULL;
   }
 
-  std::pair<const CoverTree::Node*, real> val =
-      root->NearestNeighbour(query_point, root->distanceTo(query_point));
+  int n_nodes = (max_nodes > 0) ? max_nodes : std::numeric_limits<int>::max();
+  std::pair<const Node*, real> val = root->NearestNeighbour(
+      query_point, root->distanceTo(query_point), n_nodes);
   //	printf("Min dist: %f\n", val.second);
   return val.first;
 }
-CoverTree::Node* CoverTree::FindNearestNeighbour(
-    const Vector& query_point) const {
+template <class Metric>
+typename MetricCoverTree<Metric>::Node*
+MetricCoverTree<Metric>::FindNearestNeighbour(const Vector& query_point) const {
 #ifdef DEBUG_COVER_TREE_NN
   printf("Query: ");
   query_point.print(stdout);
@@ -736,11 +778,13 @@ CoverTree::Node* CoverTree::FindNearestNeighbour(
     return NULL;
   }
 
-  std::pair<CoverTree::Node*, real> val =
+  std::pair<Node*, real> val =
       root->FindNearestNeighbour(query_point, root->distanceTo(query_point));
   return val.first;
 }
-const CoverTree::Node* CoverTree::SelectedNearestNeighbour(
+template <class Metric>
+const typename MetricCoverTree<Metric>::Node*
+MetricCoverTree<Metric>::SelectedNearestNeighbour(
     const Vector& query_point) const {
   const Node* found = NearestNeighbour(query_point);
   //	query_point.print(stdout);
@@ -753,38 +797,60 @@ const CoverTree::Node* CoverTree::SelectedNearestNeighbour(
   }
   return found;
 }
-const Vector CoverTree::GenerateState(const Vector& query_point) const {
+template <class Metric>
+const Vector MetricCoverTree<Metric>::GenerateState(
+    const Vector& query_point) const {
   const Node* found = SelectedNearestNeighbour(query_point);
   Vector phi = BasisCreation(query_point);
   return found->GenerateS(phi);
 }
-const real CoverTree::GenerateReward(const Vector& query_point) const {
+template <class Metric>
+const real MetricCoverTree<Metric>::GenerateReward(
+    const Vector& query_point) const {
   const Node* found = SelectedNearestNeighbour(query_point);
   Vector phi = BasisCreation(query_point);
   return found->GenerateR(phi);
 }
-const real CoverTree::GetValueFunction(const Vector& query_point) const {
+template <class Metric>
+const real MetricCoverTree<Metric>::GetValueFunction(
+    const Vector& query_point) const {
   const Node* found = SelectedNearestNeighbour(query_point);
   return found->GetValueFunction();
 }
-const void CoverTree::SetValueFunction(const Vector& query_point,
-                                       const real& q_) {
+template <class Metric>
+const void MetricCoverTree<Metric>::SetValueFunction(const Vector& query_point,
+                                                     const real& q_) {
   Node* found = FindNearestNeighbour(query_point);
   found->SetValueFunction(q_);
 }
-const int CoverTree::GetNumNodes() const { return num_nodes; }
+template <class Metric>
+const int MetricCoverTree<Metric>::GetNumNodes() const { return num_nodes; }
 
-const void CoverTree::SetNumNodes(int num) { num_nodes = num; }
+template <class Metric>
+const void MetricCoverTree<Metric>::SetNumNodes(int num) { num_nodes = num; }
 
-const int CoverTree::GetNumSamplingNodes() const { return num_sampling_nodes; }
+template <class Metric>
+const int MetricCoverTree<Metric>::GetNumSamplingNodes() const {
+  return num_sampling_nodes;
+}
 
-const void CoverTree::SetNumSamplingNodes(int num) { num_sampling_nodes = num; }
+template <class Metric>
+const void MetricCoverTree<Metric>::SetNumSamplingNodes(int num) {
+  num_sampling_nodes = num;
+}
 
-const int CoverTree::GetNumBasisNodes() const { return num_basis_nodes; }
+template <class Metric>
+const int MetricCoverTree<Metric>::GetNumBasisNodes() const {
+  return num_basis_nodes;
+}
 
-const void CoverTree::SetNumBasisNodes(int num) { num_basis_nodes = num; }
+template <class Metric>
+const void MetricCoverTree<Metric>::SetNumBasisNodes(int num) {
+  num_basis_nodes = num;
+}
 
-const void CoverTree::Reset() {
+template <class Metric>
+const void MetricCoverTree<Metric>::Reset() {
   delete root;
   root = NULL;
   num_nodes = 0;
@@ -796,7 +862,8 @@ const void CoverTree::Reset() {
   tree_level = std::numeric_limits<int>::max();
 }
 
-const real CoverTree::GetEntranceThreshold(int depth) const {
+template <class Metric>
+const real MetricCoverTree<Metric>::GetEntranceThreshold(int depth) const {
   // Make sure we have enough observations to justify adding a new node.
   // This means at least as many as total outcomes.
   // real threshold = (real) n_outcomes;
@@ -810,13 +877,15 @@ const real CoverTree::GetEntranceThreshold(int depth) const {
   return threshold;
 }
 
-const real CoverTree::GetBasisThreshold() const {
+template <class Metric>
+const real MetricCoverTree<Metric>::GetBasisThreshold() const {
   real n = 1.0 / 10.0;
   return pow((real)total_samples, n);
 }
 
 /** Check that the tree implements the constraints properly */
-bool CoverTree::Check() const {
+template <class Metric>
+bool MetricCoverTree<Metric>::Check() const {
   if (!root) {
     return true;
   }
@@ -829,14 +898,17 @@ bool CoverTree::Check() const {
     If parents are at a particular level, then it is necessary
     for all of them to have a separation s > 2^d.
 */
-bool CoverTree::Check(const CoverSet& parents, const int level) const {
+template <class Metric>
+bool MetricCoverTree<Metric>::Check(const CoverSet& parents,
+                                    const int level) const {
   real separation = Separation(parents);
   if (log(separation - 2) <= static_cast<real>(level)) {
     return false;
   }
   return true;
 }
-real CoverTree::Separation(const CoverSet& Q) const {
+template <class Metric>
+real MetricCoverTree<Metric>::Separation(const CoverSet& Q) const {
   real separation = INF;
   for (int i = 0; i < Q.Size(); ++i) {
     for (int j = i + 1; j < Q.Size(); ++j) {
@@ -849,7 +921,8 @@ real CoverTree::Separation(const CoverSet& Q) const {
   return separation;
 }
 
-void CoverTree::SamplingModel(bool Thompson) {
+template <class Metric>
+void MetricCoverTree<Metric>::SamplingModel(bool Thompson) {
   if (root) {
     root->SamplingModel(Thompson);
   } else {
@@ -858,7 +931,8 @@ void CoverTree::SamplingModel(bool Thompson) {
 }
 /** Show the tree
  */
-void CoverTree::Show() const {
+template <class Metric>
+void MetricCoverTree<Metric>::Show() const {
   if (root) {
     FILE* fout = fopen("tree.dot", "w");
     if (!fout) {
@@ -877,7 +951,8 @@ void CoverTree::Show() const {
 
 /** Show the tree
  */
-void CoverTree::ShowSampling() const {
+template <class Metric>
+void MetricCoverTree<Metric>::ShowSampling() const {
   if (root) {
     FILE* fout = fopen("tree.dot", "w");
     if (!fout) {
@@ -894,7 +969,8 @@ void CoverTree::ShowSampling() const {
   }
 }
 
-void CoverTree::ShowBasis() const {
+template <class Metric>
+void MetricCoverTree<Metric>::ShowBasis() const {
   if (root) {
     FILE* fout = fopen("tree.dot", "w");
     if (!fout) {
@@ -911,8 +987,11 @@ void CoverTree::ShowBasis() const {
   }
 }
 /** Default constructor */
-CoverTree::CoverTree(real c, real a_, real N0_, RBFBasisSet* RBFs_,
-                     bool Sampling, bool f) {
+template <class Metric>
+MetricCoverTree<Metric>::MetricCoverTree(real c, real a_, real N0_,
+                                         RBFBasisSet* RBFs_, bool Sampling,
+                                         bool f, const Metric& rho_)
+    : rho(rho_), epsilon(0.0), max_nodes(0) {
   assert(c > 1);
   log_c = log(c);
   RewardPred = f;
@@ -931,4 +1010,12 @@ CoverTree::CoverTree(real c, real a_, real N0_, RBFBasisSet* RBFs_,
 }
 
 /** Destructor */
-CoverTree::~CoverTree() { delete root; }
+template <class Metric>
+MetricCoverTree<Metric>::~MetricCoverTree() {
+  delete root;
+}
+
+template class MetricCoverTree<L1Metric>;
+template class MetricCoverTree<EuclideanMetric>;
+template class MetricCoverTree<LinfMetric>;
+template class MetricCoverTree<MahalanobisMetric>;
@@ -15,6 +15,7 @@
 #include "BasisSet.h"
 #include "BayesianMultivariateRegression.h"
 #include "Matrix.h"
+#include "Metric.h"
 #include "Random.h"
 #include "Vector.h"
 #include "real.h"
@@ -43,16 +44,25 @@
 
  4. If \f$i \in S_n\f$ and \f$j \in C(i)\f$,
 
+ The metric \f$\rho\f$ is a template parameter (see Metric.h), and
+ CoverTree uses the L1 metric.
+
+ Nearest neighbour searches are exact by default. After
+ setApproximation(epsilon, max_nodes), a child is only searched if
+ its subtree may contain a point closer than \f$1 / (1 + \epsilon)\f$
+ times the current distance, and at most max_nodes distances are
+ computed if max_nodes > 0.
  */
-class CoverTree {
+template <class Metric>
+class MetricCoverTree {
  public:
   /// The raw metric used between points.
-  static const real metric(const Vector& x, const Vector& y) {
-    return L1Norm(x, y);
+  const real metric(const Vector& x, const Vector& y) const {
+    return rho(x, y);
   }
   /// This simply is a node
   struct Node {
-    const CoverTree& tree;
+    const MetricCoverTree& tree;
 
     Vector point;                 ///< The location of the point.
     std::vector<Node*> children;  ///< Pointer to children
@@ -84,8 +94,8 @@ class CoverTree {
     BayesianMultivariateRegression* RewardPrediction;
 
     /// Constructor needs a point and a level
-    Node(const CoverTree& tree_, const Vector& point_, const int level_,
-         CoverTree::Node* const father_, void* object_);
+    Node(const MetricCoverTree& tree_, const Vector& point_, const int level_,
+         Node* const father_, void* object_);
 
     /// Destructor
     ~Node();
@@ -97,7 +107,7 @@ class CoverTree {
 
     void UpdateStatistics(const Vector& state, const Vector& next_state,
                           const real& reward, const bool& absorb,
-                          CoverTree::Node* const child_) {
+                          Node* const child_) {
       Insert(state, next_state, reward, absorb);
       child = child_;
       samples++;
@@ -162,10 +172,11 @@ class CoverTree {
                 const bool& absorb, const int level, void* obj = NULL);
 
     /// Find nearest neighbour of the node
-    std::pair<const CoverTree::Node*, real> NearestNeighbour(
-        const Vector& query, const real distance) const;
-    std::pair<CoverTree::Node*, real> FindNearestNeighbour(const Vector& query,
-                                                           const real distance);
+    std::pair<const Node*, real> NearestNeighbour(const Vector& query,
+                                                  const real distance,
+                                                  int& n_nodes) const;
+    std::pair<Node*, real> FindNearestNeighbour(const Vector& query,
+                                                const real distance);
 
     /// The number of children
     const int Size() const { return children.size(); }
@@ -280,9 +291,16 @@ class CoverTree {
   void Show() const;
   void ShowSampling() const;
   void ShowBasis() const;
-  CoverTree(real c, real a_ = 0.1, real N0_ = 0.1, RBFBasisSet* RBFs_ = NULL,
-            bool Sampling = true, bool f = false);
-  ~CoverTree();
+  MetricCoverTree(real c, real a_ = 0.1, real N0_ = 0.1,
+                  RBFBasisSet* RBFs_ = NULL, bool Sampling = true,
+                  bool f = false, const Metric& rho_ = Metric());
+  ~MetricCoverTree();
+  /// Search approximately, see the class description
+  void setApproximation(real epsilon_, int max_nodes_ = 0) {
+    assert(epsilon_ >= 0.0);
+    epsilon = epsilon_;
+    max_nodes = max_nodes_;
+  }
 
  protected:
   bool Check(const CoverSet& parents, const int level) const;
@@ -304,6 +322,11 @@ class CoverTree {
   bool RewardPred;  // Reward prediction
   bool ThompsonSampling;  // Thompson sampling
   Node* root;
+  Metric rho;     ///< the metric
+  real epsilon;   ///< approximation factor for nearest neighbours
+  int max_nodes;  ///< maximum number of distances to compute, or 0
 };
 
+typedef MetricCoverTree<L1Metric> CoverTree;
+
 #endif
@@ -26,4 +26,11 @@ inline double GetCPU() {
          ((double)usage.ru_utime.tv_usec) / 1000000.0;
 }
 
+/// Seconds elapsed on a monotonic clock, for measuring latency
+inline double GetMonotonicTime() {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + ((double)now.tv_nsec) / 1000000000.0;
+}
+
 #endif
@@ -0,0 +1,189 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "FlatKDTree.h"
+
+/// Create an empty tree
+void_FlatKDTree::void_FlatKDTree(int n_dimensions_, int leaf_size_)
+    : n_dimensions(n_dimensions_),
+      leaf_size(leaf_size_),
+      n_points(0),
+      n_indexed(0),
+      n_stale(0) {
+  assert(n_dimensions > 0 && leaf_size > 0);
+}
+
+void_FlatKDTree::~void_FlatKDTree() {}
+
+/// Reserve space for n points
+void void_FlatKDTree::Reserve(int n) {
+  points.reserve(n * n_dimensions);
+  objects.reserve(n);
+  state.reserve(n);
+}
+
+/** Add a point and associated object. It is indexed at the next rebuild.
+
+    The point is stored in the slot of a removed point if there is one.
+
+    \return the index of the point.
+ */
+int void_FlatKDTree::AddVector(const Vector& x, const void* object) {
+  assert(x.Size() == n_dimensions);
+  int i;
+  if (free_slots.empty()) {
+    i = (int)state.size();
+    points.insert(points.end(), x.x, x.x + n_dimensions);
+    objects.push_back(object);
+    state.push_back(TAIL_SLOT);
+  } else {
+    i = free_slots.back();
+    free_slots.pop_back();
+    std::copy(x.x, x.x + n_dimensions, &points[i * n_dimensions]);
+    objects[i] = object;
+    state[i] = TAIL_SLOT;
+  }
+  tail.push_back(i);
+  n_points++;
+  return i;
+}
+
+/** Remove the i-th point.
+
+    The point is no longer found by searches, and its slot is reused
+    by the next point added.
+ */
+void void_FlatKDTree::Remove(int i) {
+  assert(i >= 0 && i < getNumberOfSlots() && isPoint(i));
+  if (state[i] == INDEXED_SLOT) {
+    n_stale++;
+  } else {
+    std::vector<int>::iterator it = std::find(tail.begin(), tail.end(), i);
+    *it = tail.back();
+    tail.pop_back();
+  }
+  state[i] = FREE_SLOT;
+  objects[i] = NULL;
+  free_slots.push_back(i);
+  n_points--;
+}
+
+/// Replace all points with the rows of X, and build the tree
+void void_FlatKDTree::Build(const Matrix& X,
+                            const std::vector<const void*>& objects_) {
+  assert(X.Columns() == n_dimensions);
+  assert(X.Rows() == (int)objects_.size());
+  n_points = X.Rows();
+  points.resize(n_points * n_dimensions);
+  for (int i = 0; i < n_points; ++i) {
+    for (int j = 0; j < n_dimensions; ++j) {
+      points[i * n_dimensions + j] = X(i, j);
+    }
+  }
+  objects = objects_;
+  state.assign(n_points, TAIL_SLOT);
+  free_slots.clear();
+  Rebuild();
+}
+
+/// Build the tree over all points
+void void_FlatKDTree::Rebuild() {
+  split_dimension.clear();
+  split_value.clear();
+  child.clear();
+  begin.clear();
+  end.clear();
+  index.clear();
+  for (int i = 0; i < getNumberOfSlots(); ++i) {
+    if (isPoint(i)) {
+      index.push_back(i);
+      state[i] = INDEXED_SLOT;
+    }
+  }
+  tail.clear();
+  if (n_points > 0) {
+    BuildNode(NewNode(), 0, n_points);
+  }
+  sorted.resize(n_points * n_dimensions);
+  for (int i = 0; i < n_points; ++i) {
+    std::copy(&points[index[i] * n_dimensions],
+              &points[index[i] * n_dimensions] + n_dimensions,
+              &sorted[i * n_dimensions]);
+  }
+  n_indexed = n_points;
+  n_stale = 0;
+}
+
+/// Append a node to the arrays
+int void_FlatKDTree::NewNode() {
+  split_dimension.push_back(-1);
+  split_value.push_back(0.0);
+  child.push_back(-1);
+  begin.push_back(0);
+  end.push_back(0);
+  return (int)split_dimension.size() - 1;
+}
+
+/** Build the subtree for the points index[first] to index[last - 1].
+
+    The points are split at the median of the dimension with the
+    largest range, so that the lower child has the points at or below
+    the split value and the upper child those at or above it.
+ */
+void void_FlatKDTree::BuildNode(int node, int first, int last) {
+  begin[node] = first;
+  end[node] = last;
+  if (last - first <= leaf_size) {
+    return;
+  }
+  int a = 0;
+  real widest = 0.0;
+  for (int j = 0; j < n_dimensions; ++j) {
+    real lower = points[index[first] * n_dimensions + j];
+    real upper = lower;
+    for (int i = first + 1; i < last; ++i) {
+      real x_j = points[index[i] * n_dimensions + j];
+      lower = std::min(lower, x_j);
+      upper = std::max(upper, x_j);
+    }
+    if (upper - lower > widest) {
+      widest = upper - lower;
+      a = j;
+    }
+  }
+  if (widest <= 0.0) {
+    // all points are the same
+    return;
+  }
+  int mid = (first + last) / 2;
+  const real* X = &points[0];
+  int d = n_dimensions;
+  std::nth_element(index.begin() + first, index.begin() + mid,
+                   index.begin() + last, [X, d, a](int i, int j) {
+    return X[i * d + a] < X[j * d + a];
+  });
+  split_dimension[node] = a;
+  split_value[node] = points[index[mid] * n_dimensions + a];
+  int lower = NewNode();
+  NewNode();
+  child[node] = lower;
+  BuildNode(lower, first, mid);
+  BuildNode(lower + 1, mid, last);
+}
+
+Vector void_FlatKDTree::getPoint(int i) const {
+  assert(i >= 0 && i < getNumberOfSlots() && isPoint(i));
+  Vector x(n_dimensions);
+  for (int j = 0; j < n_dimensions; ++j) {
+    x(j) = points[i * n_dimensions + j];
+  }
+  return x;
+}
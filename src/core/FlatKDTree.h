@@ -0,0 +1,354 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FLAT_KD_TREE_H
+#define FLAT_KD_TREE_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "Matrix.h"
+#include "Metric.h"
+#include "ParallelFor.h"
+#include "Vector.h"
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/** A KD tree stored in flat arrays.
+
+    Points are kept in one contiguous array of slots, with a permuted
+    copy in tree order, so that each leaf holds a contiguous bucket of
+    at most leaf_size points. The nodes are stored as parallel arrays,
+    with the two children of a node next to each other.
+
+    The tree is built by splitting each set of points at the median
+    of its widest dimension. Points added with AddVector() are first
+    kept in an unindexed tail, which is searched linearly; the tree
+    is rebuilt before a search once the tail grows larger than about
+    the square root of the indexed points, so that incremental use
+    stays cheap.
+
+    A point is identified by its slot, which does not change until the
+    point is removed. Without removals, the slots are 0, 1, ... in
+    insertion order. Removed points are skipped by searches, and their
+    slots are reused by later points, so that a tree whose size stays
+    bounded also uses bounded memory.
+
+    This class only holds the points. Searches are done by FlatKDTree,
+    for a given metric.
+ */
+class void_FlatKDTree {
+ public:
+  typedef std::pair<real, int> Neighbour;  ///< (distance, point index)
+
+ protected:
+  /// What a slot holds
+  enum SlotState { FREE_SLOT, INDEXED_SLOT, TAIL_SLOT };
+  int n_dimensions;                  ///< dimensionality of space
+  int leaf_size;                     ///< maximum number of points in a leaf
+  int n_points;                      ///< number of points
+  int n_indexed;                     ///< number of entries in the tree
+  int n_stale;                       ///< tree entries of removed points
+  std::vector<real> points;          ///< points, by slot
+  std::vector<const void*> objects;  ///< objects, by slot
+  std::vector<char> state;           ///< SlotState of each slot
+  std::vector<int> tail;             ///< slots of the unindexed points
+  std::vector<int> free_slots;       ///< slots of removed points
+  std::vector<real> sorted;          ///< indexed points in tree order
+  std::vector<int> index;            ///< slots of the sorted points
+  std::vector<int> split_dimension;  ///< split dimension, or -1 for a leaf
+  std::vector<real> split_value;     ///< split value
+  std::vector<int> child;            ///< first child; the second follows it
+  std::vector<int> begin;            ///< first sorted point under the node
+  std::vector<int> end;              ///< one past the last sorted point
+  int NewNode();
+  void BuildNode(int node, int first, int last);
+  /// Offer a neighbour to a max-heap of at most K neighbours
+  static void AddToHeap(std::vector<Neighbour>& heap, int K, real dist,
+                        int i) {
+    if ((int)heap.size() < K) {
+      heap.push_back(Neighbour(dist, i));
+      std::push_heap(heap.begin(), heap.end());
+    } else if (dist < heap.front().first) {
+      std::pop_heap(heap.begin(), heap.end());
+      heap.back() = Neighbour(dist, i);
+      std::push_heap(heap.begin(), heap.end());
+    }
+  }
+
+ public:
+  void_FlatKDTree(int n_dimensions_, int leaf_size_ = 8);
+  virtual ~void_FlatKDTree();
+  int AddVector(const Vector& x, const void* object);
+  void Remove(int i);
+  void Build(const Matrix& X, const std::vector<const void*>& objects_);
+  void Rebuild();
+  void Reserve(int n);
+  /// Rebuild the tree if too many points are not indexed, or removed
+  void Update() {
+    int n_tail = tail.size();
+    if ((n_tail > leaf_size && (real)n_tail * n_tail > (real)n_indexed) ||
+        (n_stale > leaf_size && 2 * n_stale > n_indexed)) {
+      Rebuild();
+    }
+  }
+  /// Get number of points
+  int getNumberOfPoints() const { return n_points; }
+  /// Get number of slots, that is, one more than the largest point index
+  int getNumberOfSlots() const { return (int)state.size(); }
+  /// Whether the slot holds a point
+  bool isPoint(int i) const { return state[i] != FREE_SLOT; }
+  /// Get number of nodes
+  int getNumberOfNodes() const { return (int)split_dimension.size(); }
+  /// Get the i-th point
+  Vector getPoint(int i) const;
+  /// Get the coordinates of the i-th point, without copying them
+  const real* getPointArray(int i) const { return &points[i * n_dimensions]; }
+  /// Get the object of the i-th point
+  const void* getObject(int i) const { return objects[i]; }
+};
+
+/** Nearest neighbour search in a void_FlatKDTree.
+
+    The metric is a template parameter (see Metric.h), so that
+    distances are computed inline. The K nearest neighbours are
+    collected in a bounded max-heap and returned in increasing order
+    of distance.
+
+    By default the search is exact. With setApproximation(epsilon,
+    max_leaves), a subtree is skipped unless it may hold a point
+    closer than \f$1 / (1 + \epsilon)\f$ times the K-th distance found
+    so far, so that each returned distance is within a factor
+    \f$1 + \epsilon\f$ of the true one. The search also stops once
+    max_leaves leaves have been visited, if max_leaves > 0.
+ */
+template <typename T, class Metric = L1Metric>
+class FlatKDTree : public void_FlatKDTree {
+ public:
+  typedef std::pair<real, T*> ObjectNeighbour;  ///< (distance, object)
+
+ protected:
+  Metric metric;   ///< the metric
+  real epsilon;    ///< approximation factor
+  int max_leaves;  ///< maximum number of leaves to visit, or 0
+  /// Search the subtree of a node
+  void Search(int node, const real* x, int K, std::vector<Neighbour>& heap,
+              int& n_leaves) const {
+    int a = split_dimension[node];
+    if (a < 0) {
+      n_leaves++;
+      for (int i = begin[node]; i < end[node]; ++i) {
+        if (state[index[i]] == INDEXED_SLOT) {
+          AddToHeap(heap, K,
+                    metric(x, &sorted[i * n_dimensions], n_dimensions),
+                    index[i]);
+        }
+      }
+      return;
+    }
+    real delta = x[a] - split_value[node];
+    int first = child[node];
+    int second = first + 1;
+    if (delta > 0) {
+      std::swap(first, second);
+    }
+    Search(first, x, K, heap, n_leaves);
+    if ((int)heap.size() < K) {
+      Search(second, x, K, heap, n_leaves);
+    } else if (max_leaves > 0 && n_leaves >= max_leaves) {
+      return;
+    } else if ((1.0 + epsilon) * metric.AxisBound(a, delta) <
+               heap.front().first) {
+      Search(second, x, K, heap, n_leaves);
+    }
+  }
+  /// Collect the points of the subtree of a node within a radius
+  void SearchRadius(int node, const real* x, real radius,
+                    std::vector<Neighbour>& neighbours) const {
+    int a = split_dimension[node];
+    if (a < 0) {
+      for (int i = begin[node]; i < end[node]; ++i) {
+        if (state[index[i]] != INDEXED_SLOT) {
+          continue;
+        }
+        real dist = metric(x, &sorted[i * n_dimensions], n_dimensions);
+        if (dist <= radius) {
+          neighbours.push_back(Neighbour(dist, index[i]));
+        }
+      }
+      return;
+    }
+    real delta = x[a] - split_value[node];
+    int first = child[node];
+    int second = first + 1;
+    if (delta > 0) {
+      std::swap(first, second);
+    }
+    SearchRadius(first, x, radius, neighbours);
+    if (metric.AxisBound(a, delta) <= radius) {
+      SearchRadius(second, x, radius, neighbours);
+    }
+  }
+  /// Search the tree and the unindexed points
+  void Query(const real* x, int K, std::vector<Neighbour>& knn) const {
+    knn.clear();
+    if (K <= 0) {
+      return;
+    }
+    knn.reserve(K);
+    int n_leaves = 0;
+    if (n_indexed > 0) {
+      Search(0, x, K, knn, n_leaves);
+    }
+    for (uint k = 0; k < tail.size(); ++k) {
+      int i = tail[k];
+      AddToHeap(knn, K, metric(x, &points[i * n_dimensions], n_dimensions),
+                i);
+    }
+    std::sort_heap(knn.begin(), knn.end());
+  }
+
+ public:
+  /// Make a KD-Tree
+  FlatKDTree(int n, int leaf_size = 8, const Metric& metric_ = Metric())
+      : void_FlatKDTree(n, leaf_size),
+        metric(metric_),
+        epsilon(0.0),
+        max_leaves(0) {}
+  /// Search approximately, see the class description
+  void setApproximation(real epsilon_, int max_leaves_ = 0) {
+    assert(epsilon_ >= 0.0);
+    epsilon = epsilon_;
+    max_leaves = max_leaves_;
+  }
+  /// Add a point and its object, returning the point's index
+  int AddVectorObject(const Vector& x, T* object) {
+    return AddVector(x, (const void*)object);
+  }
+  /// Build the tree from the rows of X and their objects
+  void BuildObjects(const Matrix& X, const std::vector<T*>& objects_) {
+    std::vector<const void*> void_objects(objects_.begin(), objects_.end());
+    Build(X, void_objects);
+  }
+  /// Get the object of the i-th point
+  T* getObject(int i) const { return (T*)objects[i]; }
+  /// Get the distance from x to the i-th point
+  real getDistance(const Vector& x, int i) const {
+    assert(x.Size() == n_dimensions);
+    return metric(x.x, &points[i * n_dimensions], n_dimensions);
+  }
+  /// Find the index of the nearest point to x, or -1 if there are none
+  int FindNearestNeighbour(const Vector& x) {
+    std::vector<Neighbour> knn;
+    FindKNearestNeighbours(x, 1, knn);
+    return knn.size() ? knn[0].second : -1;
+  }
+  /// Find the K nearest points to x, in increasing order of distance
+  void FindKNearestNeighbours(const Vector& x, int K,
+                              std::vector<Neighbour>& knn) {
+    assert(x.Size() == n_dimensions);
+    Update();
+    Query(x.x, K, knn);
+  }
+  /// Find the K nearest points to each row of Z, with n_threads threads
+  void FindKNearestNeighbours(const Matrix& Z, int K,
+                              std::vector<std::vector<Neighbour> >& knn,
+                              int n_threads = 1) {
+    assert(Z.Columns() == n_dimensions);
+    Update();
+    int M = Z.Rows();
+    knn.resize(M);
+    ParallelFor(M, ResolveNumberOfThreads(n_threads),
+                [&](int block, int first, int last) {
+      std::vector<real> z(n_dimensions);
+      for (int i = first; i < last; ++i) {
+        for (int j = 0; j < n_dimensions; ++j) {
+          z[j] = Z(i, j);
+        }
+        Query(&z[0], K, knn[i]);
+      }
+    });
+  }
+  /** Find all points within a radius of x.
+
+      The neighbours are not sorted. The search is always exact.
+   */
+  void FindNeighboursWithin(const Vector& x, real radius,
+                            std::vector<Neighbour>& neighbours) {
+    assert(x.Size() == n_dimensions);
+    Update();
+    neighbours.clear();
+    if (n_indexed > 0) {
+      SearchRadius(0, x.x, radius, neighbours);
+    }
+    for (uint k = 0; k < tail.size(); ++k) {
+      int i = tail[k];
+      real dist = metric(x.x, &points[i * n_dimensions], n_dimensions);
+      if (dist <= radius) {
+        neighbours.push_back(Neighbour(dist, i));
+      }
+    }
+  }
+  /// Find the K nearest points to x by linear search
+  void FindKNearestNeighboursLinear(const Vector& x, int K,
+                                    std::vector<Neighbour>& knn) const {
+    assert(x.Size() == n_dimensions);
+    knn.clear();
+    if (K <= 0) {
+      return;
+    }
+    for (int i = 0; i < getNumberOfSlots(); ++i) {
+      if (isPoint(i)) {
+        AddToHeap(knn, K,
+                  metric(x.x, &points[i * n_dimensions], n_dimensions), i);
+      }
+    }
+    std::sort_heap(knn.begin(), knn.end());
+  }
+  /// Find the nearest object, or NULL if the tree is empty
+  T* FindNearestObject(const Vector& x) {
+    int i = FindNearestNeighbour(x);
+    return (i < 0) ? NULL : getObject(i);
+  }
+  /// Find the K nearest objects, in increasing order of distance
+  void FindKNearestObjects(const Vector& x, int K,
+                           std::vector<ObjectNeighbour>& knn) {
+    std::vector<Neighbour> neighbours;
+    FindKNearestNeighbours(x, K, neighbours);
+    knn.resize(neighbours.size());
+    for (uint k = 0; k < neighbours.size(); ++k) {
+      knn[k] = ObjectNeighbour(neighbours[k].first,
+                               getObject(neighbours[k].second));
+    }
+  }
+  /// Find the K nearest objects to each row of Z
+  void FindKNearestObjects(const Matrix& Z, int K,
+                           std::vector<std::vector<ObjectNeighbour> >& knn,
+                           int n_threads = 1) {
+    std::vector<std::vector<Neighbour> > neighbours;
+    FindKNearestNeighbours(Z, K, neighbours, n_threads);
+    knn.resize(neighbours.size());
+    for (uint i = 0; i < neighbours.size(); ++i) {
+      knn[i].resize(neighbours[i].size());
+      for (uint k = 0; k < neighbours[i].size(); ++k) {
+        knn[i][k] = ObjectNeighbour(neighbours[i][k].first,
+                                    getObject(neighbours[i][k].second));
+      }
+    }
+  }
+};
+
+/*@}*/
+
+#endif
@@ -5,7 +5,12 @@
 
 /// Create a tree
 void_KDTree::void_KDTree(int n)
-    : n_dimensions(n), box_sup(n), box_inf(n), root(NULL) {
+    : n_dimensions(n),
+      box_sup(n),
+      box_inf(n),
+      root(NULL),
+      epsilon(0.0),
+      max_nodes(0) {
   for (int i = 0; i < n; ++i) {
     box_sup[i] = RAND_MAX;
     box_inf[i] = -RAND_MAX;
@@ -21,6 +26,7 @@ void_KDTree::~void_KDTree() {
 
 /// Add a vector and associated object, creating a node on the fly.
 void void_KDTree::AddVector(const Vector& x, const void* object) {
+  VectorArena::Scope scope(arena);
   if (!root) {
     root = new KDNode(x, 0, box_inf, box_sup, object);
     node_list.push_back(root);
@@ -79,7 +85,8 @@ KDNode* void_KDTree::FindNearestNeighbour(const Vector& x) {
   }
   real dist = RAND_MAX;
   KDNode* node = NULL;
-  root->NearestNeighbour(x, node, dist);
+  int n_nodes = (max_nodes > 0) ? max_nodes : getNumberOfNodes();
+  root->NearestNeighbour(x, node, dist, epsilon, n_nodes);
 
   return node;
 }
@@ -104,7 +111,8 @@ OrderedFixedList<KDNode> void_KDTree::FindKNearestNeighbours(const Vector& x,
     return knn_list;
   }
   real dist = RAND_MAX;
-  root->KNearestNeighbours(x, knn_list, dist);
+  int n_nodes = (max_nodes > 0) ? max_nodes : getNumberOfNodes();
+  root->KNearestNeighbours(x, knn_list, dist, epsilon, n_nodes);
 
   return knn_list;
 }
@@ -150,8 +158,13 @@ KDNode* KDNode::AddVector(const Vector& x, Vector& inf, Vector& sup,
     bound \f$c_a - x_a\f$, since in the best case, the closest point
     \f$y\f$ in that subset will have \f$y_k = x_k\f$ for all
     \f$k \neq a\f$ and \f$y_a = c_a\f$.
+
+    For an approximate search, the bound is multiplied by \f$1 +
+    \epsilon\f$. The search stops once n_nodes nodes have been visited.
  */
-void KDNode::NearestNeighbour(const Vector& x, KDNode*& nearest, real& dist) {
+void KDNode::NearestNeighbour(const Vector& x, KDNode*& nearest, real& dist,
+                              real epsilon, int& n_nodes) {
+  n_nodes--;
   real c_dist = MY_NORM(&x, &c);
   if (c_dist < dist) {
     nearest = this;
@@ -172,12 +185,12 @@ void KDNode::NearestNeighbour(const Vector& x, KDNode*& nearest, real& dist) {
   }
 
   // the first always has potential to reduce dist
-  if (first) {
-    first->NearestNeighbour(x, nearest, dist);
+  if (first && n_nodes > 0) {
+    first->NearestNeighbour(x, nearest, dist, epsilon, n_nodes);
   }
   // only check second if dist has a chance to be reduced
-  if ((fabs(delta) < dist) && second) {
-    second->NearestNeighbour(x, nearest, dist);
+  if (((1.0 + epsilon) * fabs(delta) < dist) && second && n_nodes > 0) {
+    second->NearestNeighbour(x, nearest, dist, epsilon, n_nodes);
   }
 }
 
@@ -188,8 +201,9 @@ void KDNode::NearestNeighbour(const Vector& x, KDNode*& nearest, real& dist) {
     have a dynamic bound based on the K-th neighbour found so far.
  */
 void KDNode::KNearestNeighbours(const Vector& x,
-                                OrderedFixedList<KDNode>& knn_list,
-                                real& dist) {
+                                OrderedFixedList<KDNode>& knn_list, real& dist,
+                                real epsilon, int& n_nodes) {
+  n_nodes--;
   real c_dist = MY_NORM(&x, &c);
   if (knn_list.AddPerhaps(c_dist, this) &&
       knn_list.size() == knn_list.max_size()) {
@@ -210,11 +224,11 @@ void KDNode::KNearestNeighbours(const Vector& x,
   }
 
   // the first always has potential to reduce dist
-  if (first) {
-    first->KNearestNeighbours(x, knn_list, dist);
+  if (first && n_nodes > 0) {
+    first->KNearestNeighbours(x, knn_list, dist, epsilon, n_nodes);
   }
   // only check second if dist has a chance to be reduced
-  if ((fabs(delta) < dist) && second) {
-    second->KNearestNeighbours(x, knn_list, dist);
+  if (((1.0 + epsilon) * fabs(delta) < dist) && second && n_nodes > 0) {
+    second->KNearestNeighbours(x, knn_list, dist, epsilon, n_nodes);
   }
 }
@@ -14,6 +14,7 @@
 
 #include "OrderedFixedList.h"
 #include "Vector.h"
+#include "VectorArena.h"
 
 #include <list>
 
@@ -40,9 +41,10 @@ class KDNode {
 
   KDNode* AddVector(const Vector& x, Vector& inf, Vector& sup,
                     const void* object);
-  void NearestNeighbour(const Vector& x, KDNode*& nearest, real& dist);
+  void NearestNeighbour(const Vector& x, KDNode*& nearest, real& dist,
+                        real epsilon, int& n_nodes);
   void KNearestNeighbours(const Vector& x, OrderedFixedList<KDNode>& knn_list,
-                          real& dist);
+                          real& dist, real epsilon, int& n_nodes);
 };
 
 /** void_KD Tree
@@ -61,6 +63,10 @@ class KDNode {
         dimension at \f$x\f$, we split along the longest dimension at the
         centroid \f$c\f$ of the box.
 
+    Searches are exact by default. After setApproximation(epsilon,
+    max_nodes), a subtree is only searched if it may contain a point
+    closer than \f$1 / (1 + \epsilon)\f$ times the current distance,
+    and at most max_nodes nodes are visited if max_nodes > 0.
  */
 class void_KDTree {
  protected:
@@ -69,8 +75,17 @@ class void_KDTree {
   Vector box_inf;                  ///< global lower bound
   KDNode* root;                    ///< root node
   std::vector<KDNode*> node_list;  ///< contains a list of all nodes
+  VectorArena arena;               ///< storage for the vectors of the nodes
+  real epsilon;                    ///< approximation factor
+  int max_nodes;                   ///< maximum number of nodes to visit, or 0
  public:
   void_KDTree(int n);
+  /// Search approximately, see the class description
+  void setApproximation(real epsilon_, int max_nodes_ = 0) {
+    assert(epsilon_ >= 0.0);
+    epsilon = epsilon_;
+    max_nodes = max_nodes_;
+  }
   virtual ~void_KDTree();
   void AddVector(const Vector& x, const void* object);
   void Show();
@@ -79,7 +94,7 @@ class void_KDTree {
   OrderedFixedList<KDNode> FindKNearestNeighboursLinear(const Vector& x,
                                                         const int K);
   OrderedFixedList<KDNode> FindKNearestNeighbours(const Vector& x, const int K);
-  typedef std::list<std::pair<real, KDNode*> >::iterator iterator;
+  typedef OrderedFixedList<KDNode>::iterator iterator;
   /// Get number of nodes
   int getNumberOfNodes() { return node_list.size(); }
   /// Get number of leaves
@@ -19,6 +19,7 @@
 #include <cstring>
 #include <exception>
 #include <stdexcept>
+#include "ParallelFor.h"
 
 #include <gsl/gsl_blas.h>
 #include <gsl/gsl_linalg.h>
@@ -139,6 +140,43 @@ Matrix::Matrix(const Matrix& rhs, bool clone)
   }
 }
 
+/** Move constructor.
+
+    The data of rhs is taken over if rhs owns it, and cloned otherwise,
+    as in the copy constructor.
+ */
+Matrix::Matrix(Matrix&& rhs) noexcept
+    : rows(rhs.rows),
+      columns(rhs.columns),
+      checking_bounds(rhs.checking_bounds),
+      transposed(rhs.transposed) {
+  if (rhs.clear_data) {
+    x = rhs.x;
+#ifdef REFERENCE_ACCESS
+    x_list = rhs.x_list;
+    rhs.x_list = NULL;
+#endif
+    clear_data = true;
+    rhs.x = NULL;
+    rhs.rows = 0;
+    rhs.columns = 0;
+  } else {
+    rows = rhs.Rows();
+    columns = rhs.Columns();
+    transposed = false;
+    x = (real*)malloc(sizeof(real) * rows * columns);
+#ifdef REFERENCE_ACCESS
+    MakeReferences();
+#endif
+    for (int m = 0; m < rows; ++m) {
+      for (int n = 0; n < columns; ++n) {
+        (*this)(m, n) = rhs(m, n);
+      }
+    }
+    clear_data = true;
+  }
+}
+
 Matrix::~Matrix() {
   if (clear_data) {
     free(x);
@@ -177,6 +215,32 @@ Matrix& Matrix::operator=(const Matrix& rhs) {
   return *this;
 }
 
+/** Move assignment.
+
+    The data of rhs is taken over when rhs owns it and is not
+    transposed. Otherwise this is a copy.
+ */
+Matrix& Matrix::operator=(Matrix&& rhs) noexcept {
+  if (this == &rhs) return *this;
+  if (!rhs.clear_data || rhs.transposed || !clear_data) {
+    return (*this) = (const Matrix&)rhs;
+  }
+  free(x);
+#ifdef REFERENCE_ACCESS
+  free(x_list);
+  x_list = rhs.x_list;
+  rhs.x_list = NULL;
+#endif
+  x = rhs.x;
+  rows = rhs.rows;
+  columns = rhs.columns;
+  transposed = false;
+  rhs.x = NULL;
+  rhs.rows = 0;
+  rhs.columns = 0;
+  return *this;
+}
+
 void Matrix::Clear() {
   for (int i = 0; i < rows; ++i) {
     for (int j = 0; j < columns; ++j) {
@@ -268,54 +332,6 @@ bool Matrix::operator==(const Matrix& rhs) const {
 /// Boolean inequality operator
 bool Matrix::operator!=(const Matrix& rhs) const { return !(*this == rhs); }
 
-/** Create a matrix through the addition of two other matrices.
-
-        We distinguish four cases.
-
-        1. \f$C = A + B\f$. Then \f$C = A; C += B\f$
-        2. \f$C = A^\top + B\f$. Then \f$C = A^\top; C += B\f$.
-        3. \f$C = A + B^\top\f$. Then \f$C = B^\top; C += A\f$.
-        4. \f$C = A^\top + B^\top\f$. Then \f$C^\top = A; C^\top = B\f$.
-
- */
-Matrix Matrix::operator+(const Matrix& rhs) {
-  if (Columns() != rhs.Columns() || Rows() != rhs.Rows()) {
-    throw std::domain_error("Matrix addition error\n");
-  }
-  int M = Rows();
-  int N = Columns();
-
-  Matrix lhs(M, N);
-#if 1
-  gsl_matrix_const_view A_view = gsl_matrix_const_view_array(x, rows, columns);
-  gsl_matrix_const_view B_view =
-      gsl_matrix_const_view_array(rhs.x, rhs.rows, rhs.columns);
-  gsl_matrix_view C_view = gsl_matrix_view_array(lhs.x, lhs.rows, lhs.columns);
-
-  if (!transposed && !lhs.transposed) {
-    gsl_matrix_memcpy(&C_view.matrix, &A_view.matrix);
-    gsl_matrix_add(&C_view.matrix, &B_view.matrix);
-  } else if (transposed && !lhs.transposed) {
-    gsl_matrix_transpose_memcpy(&C_view.matrix, &A_view.matrix);
-    gsl_matrix_add(&C_view.matrix, &B_view.matrix);
-  } else if (!transposed && lhs.transposed) {
-    gsl_matrix_transpose_memcpy(&C_view.matrix, &B_view.matrix);
-    gsl_matrix_add(&C_view.matrix, &A_view.matrix);
-  } else {
-    gsl_matrix_memcpy(&C_view.matrix, &A_view.matrix);
-    gsl_matrix_add(&C_view.matrix, &B_view.matrix);
-    lhs.transposed = true;
-  }
-#else
-  for (int m = 0; m < M; ++m) {
-    for (int n = 0; n < N; ++n) {
-      lhs(m, n) = (*this)(m, n) + rhs(m, n);
-    }
-  }
-#endif
-  return lhs;
-}
-
 /// Add another matrix to this
 Matrix& Matrix::operator+=(const Matrix& rhs) {
   if (Columns() != rhs.Columns() || Rows() != rhs.Rows()) {
@@ -332,24 +348,6 @@ Matrix& Matrix::operator+=(const Matrix& rhs) {
   return *this;
 }
 
-/// Create a matrix through the subtraction of two other matrices.
-Matrix Matrix::operator-(const Matrix& rhs) {
-  if (Columns() != rhs.Columns() || Rows() != rhs.Rows()) {
-    throw std::domain_error("Matrix addition error\n");
-  }
-  int M = Rows();
-  int N = Columns();
-
-  Matrix lhs(M, N);
-
-  for (int m = 0; m < M; ++m) {
-    for (int n = 0; n < N; ++n) {
-      lhs(m, n) = (*this)(m, n) - rhs(m, n);
-    }
-  }
-  return lhs;
-}
-
 /// Subtract another matrix from this
 Matrix& Matrix::operator-=(const Matrix& rhs) {
   if (Columns() != rhs.Columns() || Rows() != rhs.Rows()) {
@@ -366,20 +364,66 @@ Matrix& Matrix::operator-=(const Matrix& rhs) {
   return *this;
 }
 
+/** Return \f$X^\top Y\f$, split among threads.
+
+    This is a sum of outer products of the rows of X and Y. The rows
+    are split into n_threads blocks, the partial sum of each block is
+    computed with a single dgemm, and the partial sums are then added
+    in pairs, in a fixed order, so that the result does not depend on
+    scheduling.
+ */
+Matrix TransposeProduct(const Matrix& lhs, const Matrix& rhs, int n_threads) {
+  if (lhs.Rows() != rhs.Rows()) {
+    throw std::domain_error("Matrix multiplication error\n");
+  }
+  assert(!lhs.transposed && !rhs.transposed);
+  int T = lhs.rows;
+  int M = lhs.columns;
+  int N = rhs.columns;
+  n_threads = ResolveNumberOfThreads(n_threads);
+  if (n_threads > T) {
+    n_threads = T;
+  }
+  if (n_threads <= 1) {
+    return Transpose(lhs) * rhs;
+  }
+  std::vector<Matrix> partial(n_threads);
+  ParallelFor(T, n_threads, [&](int block, int first, int last) {
+    partial[block] = Matrix(M, N);
+    gsl_matrix_const_view A_view =
+        gsl_matrix_const_view_array(lhs.x + first * M, last - first, M);
+    gsl_matrix_const_view B_view =
+        gsl_matrix_const_view_array(rhs.x + first * N, last - first, N);
+    gsl_matrix_view C_view = gsl_matrix_view_array(partial[block].x, M, N);
+    gsl_blas_dgemm(CblasTrans, CblasNoTrans, 1.0, &A_view.matrix,
+                   &B_view.matrix, 0.0, &C_view.matrix);
+  });
+  for (int stride = 1; stride < n_threads; stride *= 2) {
+    int n_pairs = (n_threads - stride + 2 * stride - 1) / (2 * stride);
+    ParallelFor(n_pairs, n_pairs, [&](int block, int first, int last) {
+      for (int k = first; k < last; ++k) {
+        partial[2 * stride * k] += partial[2 * stride * k + stride];
+      }
+    });
+  }
+  return partial[0];
+}
+
 /// Create a matrix through the multiplication of two other matrices.
-Matrix Matrix::operator*(const Matrix& rhs) {
-  if (Columns() != rhs.Rows()) {
+Matrix operator*(const Matrix& lhs, const Matrix& rhs) {
+  if (lhs.Columns() != rhs.Rows()) {
     throw std::domain_error("Matrix multiplication error\n");
   }
-  int M = Rows();
+  int M = lhs.Rows();
   int N = rhs.Columns();
 
   Matrix C(M, N);
 
-  CBLAS_TRANSPOSE Trans_A = transposed ? CblasTrans : CblasNoTrans;
+  CBLAS_TRANSPOSE Trans_A = lhs.transposed ? CblasTrans : CblasNoTrans;
   CBLAS_TRANSPOSE Trans_B = rhs.transposed ? CblasTrans : CblasNoTrans;
 
-  gsl_matrix_const_view A_view = gsl_matrix_const_view_array(x, rows, columns);
+  gsl_matrix_const_view A_view =
+      gsl_matrix_const_view_array(lhs.x, lhs.rows, lhs.columns);
   gsl_matrix_const_view B_view =
       gsl_matrix_const_view_array(rhs.x, rhs.rows, rhs.columns);
   gsl_matrix_view C_view = gsl_matrix_view_array(C.x, M, N);
@@ -413,55 +457,24 @@ Matrix& Matrix::operator*=(const real& rhs) {
   return *this;
 }
 
-/// Multiply a matrix with a scalar, creating a new matrix
-Matrix Matrix::operator*(const real& rhs) {
-  Matrix lhs(rows, columns);
-  if (transposed) {
-    lhs.Transpose();
-  }
-  real* y = x;
-  real* z = lhs.x;
-  int N = rows * columns;
-  for (int n = 0; n < N; ++n) {
-    (*z++) = (*y++) * rhs;
+/// Add \f$\alpha x y^\top\f$, with a rank-1 BLAS update.
+void Matrix::AddOuterProduct(const Vector& lhs, const Vector& rhs,
+                             real alpha) {
+  if (lhs.Size() != Rows() || rhs.Size() != Columns()) {
+    throw std::domain_error("outer product dimension error\n");
   }
-  return lhs;
-}
-
-/// Divide a matrix by a scalar, creating a new matrix
-Matrix Matrix::operator/(const real& rhs) {
-  real inv = 1.0 / rhs;
-  return (*this) * inv;
-}
-
-/// Add a matrix to a scalar, creating a new matrix
-Matrix Matrix::operator+(const real& rhs) {
-  Matrix lhs(rows, columns);
-  if (transposed) {
-    lhs.Transpose();
-  }
-  real* y = x;
-  real* z = lhs.x;
-  int N = rows * columns;
-  for (int n = 0; n < N; ++n) {
-    (*z++) = (*y++) + rhs;
-  }
-  return lhs;
-}
-
-/// Subtract a scalar from a matrix, creating a new matrix
-Matrix Matrix::operator-(const real& rhs) {
-  Matrix lhs(rows, columns);
   if (transposed) {
-    lhs.Transpose();
-  }
-  real* y = x;
-  real* z = lhs.x;
-  int N = rows * columns;
-  for (int n = 0; n < N; ++n) {
-    (*z++) = (*y++) - rhs;
+    for (int i = 0; i < Rows(); ++i) {
+      for (int j = 0; j < Columns(); ++j) {
+        (*this)(i, j) += alpha * lhs(i) * rhs(j);
+      }
+    }
+    return;
   }
-  return lhs;
+  gsl_vector_const_view x_view = gsl_vector_const_view_array(lhs.x, rows);
+  gsl_vector_const_view y_view = gsl_vector_const_view_array(rhs.x, columns);
+  gsl_matrix_view A_view = gsl_matrix_view_array(x, rows, columns);
+  gsl_blas_dger(alpha, &x_view.vector, &y_view.vector, &A_view.matrix);
 }
 
 void Matrix::print(FILE* f) const {
@@ -473,21 +486,6 @@ void Matrix::print(FILE* f) const {
   }
 }
 
-/// Multiply a matrix with a scalar, creating a new matrix
-Matrix operator*(const real& lhs, const Matrix& rhs) {
-  Matrix v(rhs.Rows(), rhs.Columns());
-  if (rhs.transposed) {
-    v.Transpose();
-  }
-  real* y = rhs.x;
-  real* z = v.x;
-  int N = rhs.Rows() * rhs.Columns();
-  for (int n = 0; n < N; ++n) {
-    (*z++) = (*y++) * lhs;
-  }
-  return v;
-}
-
 /// Multiply a vector with a matrix, creating a new matrix
 ///
 /// The vector is Kx1, and the rhs is 1xN, by necessity,
@@ -887,6 +885,21 @@ void Matrix::Cholesky(Matrix& chol, real epsilon) const {
     }
   }
 }
+/** Solve \f$W U = B\f$ for upper triangular U, where B is this matrix.
+
+    The solution W replaces B. With the Cholesky factor U of \f$K\f$,
+    the rows of W are \f$U^{-\top} b\f$ for each row b of B.
+ */
+void Matrix::RightSolveUpper(const Matrix& U) {
+  assert(!transposed && !U.transposed);
+  assert(U.Rows() == U.Columns() && U.Rows() == Columns());
+  gsl_matrix_const_view U_view =
+      gsl_matrix_const_view_array(U.x, U.rows, U.columns);
+  gsl_matrix_view B_view = gsl_matrix_view_array(x, rows, columns);
+  gsl_blas_dtrsm(CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, 1.0,
+                 &U_view.matrix, &B_view.matrix);
+}
+
 Vector Matrix::SVD_Solve(const Vector& b) const {
   int N = Rows();
   int M = Columns();
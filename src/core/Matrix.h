@@ -20,6 +20,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <vector>
+#include "MatrixExpression.h"
 #include "Vector.h"
 #include "real.h"
 //#include <atlas/cblas.h>
@@ -62,23 +63,30 @@ class Matrix {
                   enum BoundsCheckingStatus check_ = CHECK_BOUNDS);
 #endif
   Matrix(const Matrix& rhs, bool clone = true);
+  Matrix(Matrix&& rhs) noexcept;
+  /// Evaluate an expression
+  template <typename E>
+  Matrix(const MatrixExpression<E>& rhs);
   ~Matrix();
   void Resize(int rows_, int columns_);
   Matrix AddRow(const Vector& rhs);
   Matrix AddColumn(const Vector& rhs);
   Matrix& operator=(const Matrix& rhs);
+  Matrix& operator=(Matrix&& rhs) noexcept;
+  template <typename E>
+  Matrix& operator=(const MatrixExpression<E>& rhs);
   bool operator==(const Matrix& rhs) const;
   bool operator!=(const Matrix& rhs) const;
-  Matrix operator+(const Matrix& rhs);
   Matrix& operator+=(const Matrix& rhs);
-  Matrix operator-(const Matrix& rhs);
   Matrix& operator-=(const Matrix& rhs);
+  template <typename E>
+  Matrix& operator+=(const MatrixExpression<E>& rhs);
+  template <typename E>
+  Matrix& operator-=(const MatrixExpression<E>& rhs);
   Matrix& operator*=(const real& rhs);
-  Matrix operator*(const Matrix& rhs);
-  Matrix operator*(const real& rhs);
-  Matrix operator+(const real& rhs);
-  Matrix operator-(const real& rhs);
-  Matrix operator/(const real& rhs);
+  void AddOuterProduct(const Vector& lhs, const Vector& rhs, real alpha = 1.0);
+  /// The data of this matrix, for use in expressions
+  MatrixLeaf Leaf() const { return MatrixLeaf(x, rows, columns, transposed); }
   /// Matrix inversion (defaults to GSL with LU)
   Matrix Inverse(real epsilon = ACCURACY_LIMIT) const {
     return GSL_Inverse();
@@ -139,6 +147,7 @@ class Matrix {
                                       real epsilon = ACCURACY_LIMIT);
   Matrix Cholesky(real epsilon = ACCURACY_LIMIT) const;
   void Cholesky(Matrix& chol, real epsilon = ACCURACY_LIMIT) const;
+  void RightSolveUpper(const Matrix& U);
   void Clear();
   void Transpose();
   Vector getColumn(int c) const;
@@ -158,8 +167,10 @@ class Matrix {
   real& operator()(int i, int j);
   const real& operator()(int i, int j) const;
   void print(FILE* f) const;
-  friend Matrix operator*(const real& lhs, const Matrix& rhs);
+  friend Matrix operator*(const Matrix& lhs, const Matrix& rhs);
   friend Matrix operator*(const Vector& lhs, const Matrix& rhs);
+  friend Matrix TransposeProduct(const Matrix& lhs, const Matrix& rhs,
+                                 int n_threads);
   friend Vector operator*(const Matrix& lhs, const Vector& rhs);
 
  protected:
@@ -177,7 +188,7 @@ class Matrix {
   void qSet(int i, int j, real v);
 };
 
-Matrix operator*(const real& lhs, const Matrix& rhs);
+Matrix operator*(const Matrix& lhs, const Matrix& rhs);
 Matrix operator*(const Vector& lhs, const Matrix& rhs);
 Vector operator*(const Matrix& lhs, const Vector& rhs);
 real Mahalanobis2(const Vector& x, const Matrix& A, const Vector& y);
@@ -194,6 +205,8 @@ inline Matrix OuterProduct(const Vector& lhs, const Vector& rhs) {
 }
 
 Matrix Transpose(const Matrix& rhs);
+Matrix TransposeProduct(const Matrix& lhs, const Matrix& rhs,
+                        int n_threads = 1);
 
 /// In-place transpose matrix
 inline void Matrix::Transpose() { transposed = !transposed; }
@@ -256,6 +269,226 @@ inline const real& Matrix::operator()(int i, int j) const {
 #endif
 }
 
+template <typename E>
+Matrix::Matrix(const MatrixExpression<E>& rhs)
+    : rows(rhs.Rows()),
+      columns(rhs.Columns()),
+#ifdef NDEBUG
+      checking_bounds(NO_CHECK_BOUNDS),
+#else
+      checking_bounds(CHECK_BOUNDS),
+#endif
+      transposed(false),
+      clear_data(true) {
+  x = (real*)malloc(sizeof(real) * rows * columns);
+#ifdef REFERENCE_ACCESS
+  MakeReferences();
+#endif
+  const E& e = rhs.derived();
+  real* y = x;
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < columns; ++j) {
+      *y++ = e.eval(i, j);
+    }
+  }
+}
+
+/** Assign the value of an expression.
+
+    If the expression reads from this matrix, for example through a
+    transposed view, it is evaluated into a new buffer first.
+ */
+template <typename E>
+Matrix& Matrix::operator=(const MatrixExpression<E>& rhs) {
+  const E& e = rhs.derived();
+  if (e.References(x)) {
+    return (*this) = Matrix(rhs);
+  }
+  int M = e.Rows();
+  int N = e.Columns();
+  if (M * N != rows * columns) {
+    x = (real*)realloc(x, sizeof(real) * M * N);
+  }
+  rows = M;
+  columns = N;
+  transposed = false;
+#ifdef REFERENCE_ACCESS
+  x_list = (real**)realloc(x_list, rows * sizeof(real*));
+  for (int i = 0; i < rows; ++i) {
+    x_list[i] = &x[i * columns];
+  }
+#endif
+  real* y = x;
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < N; ++j) {
+      *y++ = e.eval(i, j);
+    }
+  }
+  return *this;
+}
+
+template <typename E>
+Matrix& Matrix::operator+=(const MatrixExpression<E>& rhs) {
+  if (Columns() != rhs.Columns() || Rows() != rhs.Rows()) {
+    throw std::domain_error("Matrix addition error\n");
+  }
+  const E& e = rhs.derived();
+  if (e.References(x)) {
+    return (*this) += Matrix(rhs);
+  }
+  for (int i = 0; i < Rows(); ++i) {
+    for (int j = 0; j < Columns(); ++j) {
+      (*this)(i, j) += e.eval(i, j);
+    }
+  }
+  return *this;
+}
+
+template <typename E>
+Matrix& Matrix::operator-=(const MatrixExpression<E>& rhs) {
+  if (Columns() != rhs.Columns() || Rows() != rhs.Rows()) {
+    throw std::domain_error("Matrix addition error\n");
+  }
+  const E& e = rhs.derived();
+  if (e.References(x)) {
+    return (*this) -= Matrix(rhs);
+  }
+  for (int i = 0; i < Rows(); ++i) {
+    for (int j = 0; j < Columns(); ++j) {
+      (*this)(i, j) -= e.eval(i, j);
+    }
+  }
+  return *this;
+}
+
+template <typename E>
+bool MatrixExpression<E>::operator==(const Matrix& rhs) const {
+  return Matrix(*this) == rhs;
+}
+
+template <typename E>
+bool MatrixExpression<E>::operator!=(const Matrix& rhs) const {
+  return Matrix(*this) != rhs;
+}
+
+template <typename E>
+Matrix MatrixExpression<E>::Inverse() const {
+  return Matrix(*this).Inverse();
+}
+
+template <typename E>
+Matrix MatrixExpression<E>::Inverse_LU() const {
+  return Matrix(*this).Inverse_LU();
+}
+
+template <typename E>
+void MatrixExpression<E>::print(FILE* f) const {
+  Matrix(*this).print(f);
+}
+
+/** Operands of matrix expressions.
+
+    See VectorOperand.
+ */
+template <typename T, typename Enable = void>
+struct MatrixOperand {};
+
+template <typename T>
+struct MatrixOperand<
+    T, typename std::enable_if<std::is_base_of<Matrix, T>::value>::type> {
+  typedef MatrixLeaf type;
+  static MatrixLeaf get(const Matrix& A) { return A.Leaf(); }
+};
+
+template <typename T>
+struct MatrixOperand<T, typename std::enable_if<std::is_base_of<
+                            MatrixExpression<T>, T>::value>::type> {
+  typedef T type;
+  static const T& get(const T& e) { return e; }
+};
+
+/// Check that two matrices can be added
+template <typename L, typename R>
+inline void CheckMatrixSizes(const L& lhs, const R& rhs) {
+  if (lhs.Columns() != rhs.Columns() || lhs.Rows() != rhs.Rows()) {
+    throw std::domain_error("Matrix addition error\n");
+  }
+}
+
+/// Add two matrices
+template <typename L, typename R>
+inline MatrixBinaryExpression<typename MatrixOperand<L>::type,
+                              typename MatrixOperand<R>::type, ExpressionAdd>
+operator+(const L& lhs, const R& rhs) {
+  CheckMatrixSizes(lhs, rhs);
+  return MatrixBinaryExpression<typename MatrixOperand<L>::type,
+                                typename MatrixOperand<R>::type, ExpressionAdd>(
+      MatrixOperand<L>::get(lhs), MatrixOperand<R>::get(rhs));
+}
+
+/// Subtract two matrices
+template <typename L, typename R>
+inline MatrixBinaryExpression<typename MatrixOperand<L>::type,
+                              typename MatrixOperand<R>::type,
+                              ExpressionSubtract>
+operator-(const L& lhs, const R& rhs) {
+  CheckMatrixSizes(lhs, rhs);
+  return MatrixBinaryExpression<typename MatrixOperand<L>::type,
+                                typename MatrixOperand<R>::type,
+                                ExpressionSubtract>(MatrixOperand<L>::get(lhs),
+                                                    MatrixOperand<R>::get(rhs));
+}
+
+/// Multiply a matrix with a scalar
+template <typename L>
+inline MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                             ExpressionMultiplyScalar>
+operator*(const L& lhs, const real& rhs) {
+  return MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                               ExpressionMultiplyScalar>(
+      MatrixOperand<L>::get(lhs), ExpressionMultiplyScalar(rhs));
+}
+
+/// Multiply a scalar with a matrix
+template <typename R>
+inline MatrixUnaryExpression<typename MatrixOperand<R>::type,
+                             ExpressionMultiplyScalar>
+operator*(const real& lhs, const R& rhs) {
+  return MatrixUnaryExpression<typename MatrixOperand<R>::type,
+                               ExpressionMultiplyScalar>(
+      MatrixOperand<R>::get(rhs), ExpressionMultiplyScalar(lhs));
+}
+
+/// Divide a matrix by a scalar
+template <typename L>
+inline MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                             ExpressionMultiplyScalar>
+operator/(const L& lhs, const real& rhs) {
+  return MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                               ExpressionMultiplyScalar>(
+      MatrixOperand<L>::get(lhs), ExpressionMultiplyScalar(1.0 / rhs));
+}
+
+/// Add a scalar to a matrix
+template <typename L>
+inline MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                             ExpressionAddScalar>
+operator+(const L& lhs, const real& rhs) {
+  return MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                               ExpressionAddScalar>(MatrixOperand<L>::get(lhs),
+                                                    ExpressionAddScalar(rhs));
+}
+
+/// Subtract a scalar from a matrix
+template <typename L>
+inline MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                             ExpressionSubtractScalar>
+operator-(const L& lhs, const real& rhs) {
+  return MatrixUnaryExpression<typename MatrixOperand<L>::type,
+                               ExpressionSubtractScalar>(
+      MatrixOperand<L>::get(lhs), ExpressionSubtractScalar(rhs));
+}
+
 #if 0
 inline const real& Matrix::qGet(int i, int j) {
 #ifdef REFERENCE_ACCESS
@@ -0,0 +1,105 @@
+/* -*- Mode: c++ -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SRC_CORE_MATRIXEXPRESSION_H_
+#define SRC_CORE_MATRIXEXPRESSION_H_
+
+#include <cstdio>
+#include "VectorExpression.h"
+#include "real.h"
+
+class Matrix;
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/** Base class of element-wise matrix expressions.
+
+    An expression E has Rows(), Columns(), an element accessor
+    eval(i, j), and References(p), which tells whether the expression
+    reads from the buffer p. See VectorExpression.h.
+
+    The remaining members are defined in Matrix.h. They evaluate the
+    expression into a Matrix and then call the Matrix method.
+ */
+template <typename E>
+class MatrixExpression {
+ public:
+  const E& derived() const { return static_cast<const E&>(*this); }
+  int Rows() const { return derived().Rows(); }
+  int Columns() const { return derived().Columns(); }
+  real operator()(int i, int j) const { return derived().eval(i, j); }
+  bool operator==(const Matrix& rhs) const;
+  bool operator!=(const Matrix& rhs) const;
+  Matrix Inverse() const;
+  Matrix Inverse_LU() const;
+  void print(FILE* f) const;
+};
+
+/// The data of a Matrix, as used in expressions
+class MatrixLeaf : public MatrixExpression<MatrixLeaf> {
+ protected:
+  const real* x;
+  int rows;
+  int columns;
+  bool transposed;
+
+ public:
+  MatrixLeaf(const real* x_, int rows_, int columns_, bool transposed_)
+      : x(x_), rows(rows_), columns(columns_), transposed(transposed_) {}
+  int Rows() const { return transposed ? columns : rows; }
+  int Columns() const { return transposed ? rows : columns; }
+  real eval(int i, int j) const {
+    return transposed ? x[j * columns + i] : x[i * columns + j];
+  }
+  bool References(const real* p) const { return x == p; }
+};
+
+/// A function applied to each element of an expression
+template <typename A, typename F>
+class MatrixUnaryExpression
+    : public MatrixExpression<MatrixUnaryExpression<A, F> > {
+ protected:
+  A a;
+  F f;
+
+ public:
+  MatrixUnaryExpression(const A& a_, const F& f_) : a(a_), f(f_) {}
+  int Rows() const { return a.Rows(); }
+  int Columns() const { return a.Columns(); }
+  real eval(int i, int j) const { return f(a.eval(i, j)); }
+  bool References(const real* p) const { return a.References(p); }
+};
+
+/// A function applied to each pair of elements of two expressions
+template <typename A, typename B, typename F>
+class MatrixBinaryExpression
+    : public MatrixExpression<MatrixBinaryExpression<A, B, F> > {
+ protected:
+  A a;
+  B b;
+  F f;
+
+ public:
+  MatrixBinaryExpression(const A& a_, const B& b_) : a(a_), b(b_) {}
+  int Rows() const { return a.Rows(); }
+  int Columns() const { return a.Columns(); }
+  real eval(int i, int j) const { return f(a.eval(i, j), b.eval(i, j)); }
+  bool References(const real* p) const {
+    return a.References(p) || b.References(p);
+  }
+};
+
+/*@}*/
+
+#endif  // SRC_CORE_MATRIXEXPRESSION_H_
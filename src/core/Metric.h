@@ -0,0 +1,133 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef METRIC_H
+#define METRIC_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "Matrix.h"
+#include "Vector.h"
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/** \file Metric.h
+
+    \brief Metrics for nearest neighbour search.
+
+    The search structures take the metric as a template parameter, so
+    that distances are computed by inlined loops. Each metric provides
+
+    - operator()(x, y, n): the distance between two arrays of n reals.
+    - operator()(x, y): the distance between two vectors.
+    - AxisBound(a, delta): a lower bound on the distance between two
+      points whose a-th coordinates differ by delta.
+ */
+
+/// The L1 metric \f$\sum_i |x_i - y_i|\f$
+struct L1Metric {
+  real operator()(const real* x, const real* y, int n) const {
+    real d = 0.0;
+    for (int i = 0; i < n; ++i) {
+      d += fabs(x[i] - y[i]);
+    }
+    return d;
+  }
+  real operator()(const Vector& x, const Vector& y) const {
+    assert(x.Size() == y.Size());
+    return (*this)(x.x, y.x, x.Size());
+  }
+  real AxisBound(int a, real delta) const { return fabs(delta); }
+};
+
+/// The Euclidean metric \f$\sqrt{\sum_i (x_i - y_i)^2}\f$
+struct EuclideanMetric {
+  real operator()(const real* x, const real* y, int n) const {
+    real d = 0.0;
+    for (int i = 0; i < n; ++i) {
+      real delta = x[i] - y[i];
+      d += delta * delta;
+    }
+    return sqrt(d);
+  }
+  real operator()(const Vector& x, const Vector& y) const {
+    assert(x.Size() == y.Size());
+    return (*this)(x.x, y.x, x.Size());
+  }
+  real AxisBound(int a, real delta) const { return fabs(delta); }
+};
+
+/// The maximum metric \f$\max_i |x_i - y_i|\f$
+struct LinfMetric {
+  real operator()(const real* x, const real* y, int n) const {
+    real d = 0.0;
+    for (int i = 0; i < n; ++i) {
+      real delta = fabs(x[i] - y[i]);
+      if (delta > d) {
+        d = delta;
+      }
+    }
+    return d;
+  }
+  real operator()(const Vector& x, const Vector& y) const {
+    assert(x.Size() == y.Size());
+    return (*this)(x.x, y.x, x.Size());
+  }
+  real AxisBound(int a, real delta) const { return fabs(delta); }
+};
+
+/** The Mahalanobis metric \f$\sqrt{(x - y)^\top \Sigma^{-1} (x - y)}\f$.
+
+    The closest that two points can be when their a-th coordinates
+    differ by \f$\delta\f$ is \f$|\delta| / \sqrt{\Sigma_{aa}}\f$.
+ */
+struct MahalanobisMetric {
+  int n;                    ///< dimension
+  std::vector<real> P;      ///< the inverse of the covariance, row-major
+  std::vector<real> scale;  ///< \f$1 / \sqrt{\Sigma_{aa}}\f$
+  MahalanobisMetric(const Matrix& Sigma)
+      : n(Sigma.Rows()), P(n * n), scale(n) {
+    assert(Sigma.Rows() == Sigma.Columns());
+    Matrix Sigma_inverse = Sigma.Inverse();
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        P[i * n + j] = Sigma_inverse(i, j);
+      }
+      scale[i] = 1.0 / sqrt(Sigma(i, i));
+    }
+  }
+  real operator()(const real* x, const real* y, int n_) const {
+    assert(n_ == n);
+    real d = 0.0;
+    for (int i = 0; i < n; ++i) {
+      real delta_i = x[i] - y[i];
+      real row = 0.0;
+      for (int j = 0; j < n; ++j) {
+        row += P[i * n + j] * (x[j] - y[j]);
+      }
+      d += delta_i * row;
+    }
+    return sqrt(std::max(d, (real)0.0));
+  }
+  real operator()(const Vector& x, const Vector& y) const {
+    assert(x.Size() == y.Size());
+    return (*this)(x.x, y.x, x.Size());
+  }
+  real AxisBound(int a, real delta) const { return fabs(delta) * scale[a]; }
+};
+
+/*@}*/
+
+#endif
@@ -0,0 +1,22 @@
+// -*- Mode: c++ -*-
+// Globally unique modification stamps
+#ifndef MODIFICATION_STAMP_H
+#define MODIFICATION_STAMP_H
+
+#include <atomic>
+
+#include "real.h"
+
+/** Return a new, globally unique modification stamp.
+
+    Objects record a fresh stamp whenever their contents change, so that
+    cached views of them can detect staleness by comparing stamps alone,
+    even when the original object has been replaced by another one at the
+    same address. The stamp 0 is never returned.
+ */
+inline ulong NewModificationStamp() {
+  static std::atomic<ulong> counter(0);
+  return ++counter;
+}
+
+#endif
@@ -0,0 +1,118 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NODE_POOL_H
+#define NODE_POOL_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/** A pool of tree nodes.
+
+    Nodes are constructed in place in large blocks, and are referred
+    to by their index in the pool, so that a tree can link its nodes
+    with integers instead of pointers. Nodes never move, so pointers
+    to them also stay valid until the pool is cleared.
+
+    There is no way to free a single node: Clear() destroys all nodes
+    at once, and keeps the blocks for the next tree. For trivially
+    destructible nodes, clearing takes constant time.
+
+    NewArray() constructs consecutive nodes that lie in the same block,
+    so that they can also be used as a plain array, e.g. for the
+    children or the edges of a tree node.
+ */
+template <typename T>
+class NodePool {
+ public:
+  static const int BLOCK_BITS = 10;
+  static const int BLOCK_SIZE = 1 << BLOCK_BITS;  ///< nodes per block
+ protected:
+  std::vector<T*> blocks;  ///< raw storage
+  int n_nodes;             ///< number of constructed nodes
+ public:
+  NodePool() : n_nodes(0) {}
+  ~NodePool() {
+    Clear();
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      ::operator delete(blocks[i]);
+    }
+  }
+  /// Construct a node with the given arguments, and return its index
+  template <typename... Args>
+  int New(Args&&... args) {
+    int block = n_nodes >> BLOCK_BITS;
+    if (block == (int)blocks.size()) {
+      blocks.push_back((T*)::operator new(BLOCK_SIZE * sizeof(T)));
+    }
+    new (blocks[block] + (n_nodes & (BLOCK_SIZE - 1)))
+        T(std::forward<Args>(args)...);
+    return n_nodes++;
+  }
+  /** Construct n consecutive nodes in the same block, and return the
+      index of the first.
+
+      The rest of the current block is skipped if it is too small, so
+      this is only available for trivially destructible nodes, which
+      Clear() does not need to visit.
+   */
+  int NewArray(int n) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "NodePool::NewArray needs trivially destructible nodes");
+    assert(n > 0 && n <= BLOCK_SIZE);
+    int offset = n_nodes & (BLOCK_SIZE - 1);
+    if (offset + n > BLOCK_SIZE) {
+      n_nodes += BLOCK_SIZE - offset;
+    }
+    int first = n_nodes;
+    for (int i = 0; i < n; ++i) {
+      New();
+    }
+    return first;
+  }
+  /// The i-th node
+  T* Get(int i) {
+    assert(i >= 0 && i < n_nodes);
+    return blocks[i >> BLOCK_BITS] + (i & (BLOCK_SIZE - 1));
+  }
+  const T* Get(int i) const {
+    assert(i >= 0 && i < n_nodes);
+    return blocks[i >> BLOCK_BITS] + (i & (BLOCK_SIZE - 1));
+  }
+  T& operator[](int i) { return *Get(i); }
+  const T& operator[](int i) const { return *Get(i); }
+  /// Destroy all nodes, in reverse order of construction
+  void Clear() {
+    if (!std::is_trivially_destructible<T>::value) {
+      for (int i = n_nodes - 1; i >= 0; --i) {
+        Get(i)->~T();
+      }
+    }
+    n_nodes = 0;
+  }
+  /// Exchange the nodes of two pools
+  void Swap(NodePool& other) {
+    blocks.swap(other.blocks);
+    std::swap(n_nodes, other.n_nodes);
+  }
+  /// The number of nodes
+  int size() const { return n_nodes; }
+
+ private:
+  NodePool(const NodePool&);
+  NodePool& operator=(const NodePool&);
+};
+
+#endif
@@ -12,23 +12,39 @@
 #ifndef ORDERED_FIXED_LIST_H
 #define ORDERED_FIXED_LIST_H
 
-#include <iostream>
-#include <list>
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include "real.h"
 
+/** The N (value, object) pairs with the smallest values.
+
+    The pairs are kept in a binary max-heap of fixed capacity, so that
+    adding a pair takes \f$O(\log N)\f$ time and no memory is
+    allocated after construction. The pairs are sorted in increasing
+    order of value the first time they are accessed through begin(),
+    end() or front().
+ */
 template <typename T>
 class OrderedFixedList {
+ public:
+  typedef std::pair<real, T*> Pair;
+  typedef typename std::vector<Pair>::iterator iterator;
+
  protected:
   const uint N;
   real lower_bound;
   real upper_bound;
+  std::vector<Pair> S;  ///< a max-heap, or sorted in increasing order
+  bool sorted;          ///< whether S is sorted rather than a heap
+  /// Order pairs by value only
+  static bool Less(const Pair& a, const Pair& b) { return a.first < b.first; }
 
  public:
-  std::list<std::pair<real, T*> > S;
-
-  OrderedFixedList(const uint N_) : N(N_) {
-    lower_bound = -REAL_RANGE;
+  OrderedFixedList(const uint N_) : N(N_), sorted(true) {
+    lower_bound = REAL_RANGE;
     upper_bound = REAL_RANGE;
+    S.reserve(N);
   }
   /** Add a (value, object) pair to the list if possible.
 
@@ -38,27 +54,55 @@ class OrderedFixedList {
       b) The value is smaller than the currently largest value.
   */
   const bool AddPerhaps(real x, T* object) {
-    std::list<real>::iterator it;
-    if (S.size() < N) {
-      S.push_back(std::make_pair(x, object));
-      S.sort();
-      lower_bound = S.front().first;
-      upper_bound = S.back().first;
-      return true;
+    if ((!(x < upper_bound) && S.size() >= N) || N == 0) {
+      return false;
+    }
+    if (sorted) {
+      std::make_heap(S.begin(), S.end(), Less);
+      sorted = false;
     }
-    if (x < upper_bound) {
-      S.pop_back();
-      S.push_back(std::make_pair(x, object));
-      S.sort();
-      upper_bound = S.back().first;
-      return true;
+    if (S.size() < N) {
+      S.push_back(Pair(x, object));
+    } else {
+      std::pop_heap(S.begin(), S.end(), Less);
+      S.back() = Pair(x, object);
     }
-    return false;
+    std::push_heap(S.begin(), S.end(), Less);
+    lower_bound = std::min(lower_bound, x);
+    upper_bound = S.front().first;
+    return true;
   }
+  /// The largest value in the list
   const real UpperBound() const { return upper_bound; }
-  const real LowerBound() const { return lower_bound; }
-  const int max_size() const { return S.size(); }
-  const int size() const { return N; }
+  /// The smallest value in the list
+  const real LowerBound() const {
+    return S.empty() ? -REAL_RANGE : lower_bound;
+  }
+  /// Sort the pairs in increasing order of value
+  void Sort() {
+    if (!sorted) {
+      std::sort_heap(S.begin(), S.end(), Less);
+      sorted = true;
+    }
+  }
+  iterator begin() {
+    Sort();
+    return S.begin();
+  }
+  iterator end() {
+    Sort();
+    return S.end();
+  }
+  /// The pair with the smallest value
+  Pair& front() {
+    Sort();
+    return S.front();
+  }
+  const bool empty() const { return S.empty(); }
+  /// The number of pairs in the list
+  const int size() const { return S.size(); }
+  /// The capacity of the list
+  const int max_size() const { return N; }
 };
 
 #endif
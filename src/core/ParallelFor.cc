@@ -0,0 +1,100 @@
+// -*- Mode: c++ -*-
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ParallelFor.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool() : stop(false) {}
+
+/// Let the workers finish the queued jobs, then join them
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  work_available.notify_all();
+  for (uint i = 0; i < workers.size(); ++i) {
+    workers[i].join();
+  }
+}
+
+ThreadPool& ThreadPool::Shared() {
+  static ThreadPool pool;
+  return pool;
+}
+
+/// Claim the next task of a job, with the mutex held. Return false if
+/// all its tasks have been claimed.
+bool ThreadPool::Claim(Job& job, int& k) {
+  if (job.next >= job.n_tasks) {
+    return false;
+  }
+  k = job.next++;
+  if (job.next == job.n_tasks) {
+    jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+  }
+  return true;
+}
+
+/// The loop of a worker: run tasks of the oldest job until stopped
+void ThreadPool::Work() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    work_available.wait(lock, [this] { return stop || !jobs.empty(); });
+    if (jobs.empty()) {
+      return;
+    }
+    Job* job = jobs.front();
+    int k;
+    Claim(*job, k);
+    lock.unlock();
+    (*job->task)(k);
+    lock.lock();
+    if (++job->n_done == job->n_tasks) {
+      job_done.notify_all();
+    }
+  }
+}
+
+/** Run a job.
+
+    The calling thread claims tasks along with the workers, so that the
+    job finishes even if all workers are busy, e.g. when a task itself
+    calls Run(). Workers are started the first time they are needed.
+ */
+void ThreadPool::Run(int n_tasks, int n_workers,
+                     const std::function<void(int)>& task) {
+  if (n_tasks <= 0) {
+    return;
+  }
+  Job job;
+  job.task = &task;
+  job.n_tasks = n_tasks;
+  job.next = 0;
+  job.n_done = 0;
+  std::unique_lock<std::mutex> lock(mutex);
+  while ((int)workers.size() < n_workers) {
+    workers.push_back(std::thread(&ThreadPool::Work, this));
+  }
+  jobs.push_back(&job);
+  for (int i = 1; i < n_tasks; ++i) {
+    work_available.notify_one();
+  }
+  int k;
+  while (Claim(job, k)) {
+    lock.unlock();
+    task(k);
+    lock.lock();
+    job.n_done++;
+  }
+  job_done.wait(lock, [&job] { return job.n_done == job.n_tasks; });
+}
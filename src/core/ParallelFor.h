@@ -0,0 +1,96 @@
+// -*- Mode: c++ -*-
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Return the number of threads to use: n, or all hardware threads if n <= 0.
+inline int ResolveNumberOfThreads(int n) {
+  if (n > 0) {
+    return n;
+  }
+  int n_hardware = (int)std::thread::hardware_concurrency();
+  return (n_hardware > 0) ? n_hardware : 1;
+}
+
+/** A set of worker threads that stay alive between parallel loops.
+
+    Starting threads costs far more than a sweep over a few thousand
+    states, so ParallelFor() hands its blocks to the workers of the
+    shared pool instead. Workers sleep while there is no work.
+ */
+class ThreadPool {
+ protected:
+  /// The tasks of one call to Run()
+  struct Job {
+    const std::function<void(int)>* task;
+    int n_tasks;  ///< number of tasks
+    int next;     ///< the next task to be claimed
+    int n_done;   ///< number of finished tasks
+  };
+  std::mutex mutex;
+  std::condition_variable work_available;
+  std::condition_variable job_done;
+  std::deque<Job*> jobs;  ///< jobs with unclaimed tasks
+  std::vector<std::thread> workers;
+  bool stop;
+  void Work();
+  bool Claim(Job& job, int& k);
+
+ public:
+  ThreadPool();
+  ~ThreadPool();
+  /// The pool shared by all parallel loops
+  static ThreadPool& Shared();
+  /// Run task(k) for k in [0, n_tasks) on the calling thread and at
+  /// most n_workers workers, and return once all tasks are done
+  void Run(int n_tasks, int n_workers, const std::function<void(int)>& task);
+};
+
+/** Run body(block, begin, end) over contiguous blocks of [0, n).
+
+    The range is split into at most n_threads blocks of nearly equal
+    size; block \f$k\f$ covers the k-th part of the range, so that the
+    partitioning only depends on n and n_threads. The blocks are run by
+    the calling thread and the workers of ThreadPool::Shared(), and the
+    call returns once all blocks are done.
+
+    Each block must only write to its own part of any shared output, so
+    that results are independent of scheduling. Blocks may themselves
+    call ParallelFor().
+ */
+template <typename F>
+void ParallelFor(int n, int n_threads, F body) {
+  if (n_threads > n) {
+    n_threads = n;
+  }
+  if (n_threads <= 1) {
+    if (n > 0) {
+      body(0, 0, n);
+    }
+    return;
+  }
+  std::function<void(int)> block = [&](int k) {
+    int begin = (int)(((long)n * k) / n_threads);
+    int end = (int)(((long)n * (k + 1)) / n_threads);
+    body(k, begin, end);
+  };
+  ThreadPool::Shared().Run(n_threads, n_threads - 1, block);
+}
+
+#endif
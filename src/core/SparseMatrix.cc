@@ -0,0 +1,205 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "SparseMatrix.h"
+#include <algorithm>
+#include <cmath>
+
+SparseMatrix::SparseMatrix(int rows_, int columns_) {
+  Resize(rows_, columns_);
+}
+
+/// Resize the matrix, removing all entries
+void SparseMatrix::Resize(int rows_, int columns_) {
+  assert(rows_ >= 0 && columns_ >= 0);
+  rows = rows_;
+  columns = columns_;
+  entries.clear();
+  entries.resize(rows);
+  row_begin.assign(rows + 1, 0);
+  column.clear();
+  value.clear();
+  compressed = true;
+}
+
+/// Remove all entries
+void SparseMatrix::Clear() { Resize(rows, columns); }
+
+/** Add \f$s x y^\top\f$ to the matrix.
+
+    This only touches the entries in the rows of x and the columns of y.
+ */
+void SparseMatrix::AddOuterProduct(const SparseVector& x,
+                                   const SparseVector& y, real scale) {
+  for (int k = 0; k < x.Size(); ++k) {
+    real x_k = scale * x.value[k];
+    std::unordered_map<int, real>& row = entries[x.index[k]];
+    assert(x.index[k] >= 0 && x.index[k] < rows);
+    for (int l = 0; l < y.Size(); ++l) {
+      assert(y.index[l] >= 0 && y.index[l] < columns);
+      row[y.index[l]] += x_k * y.value[l];
+    }
+  }
+  compressed = false;
+}
+
+/// Store the entries in compressed sparse row form, sorted by column
+void SparseMatrix::Compress() {
+  if (compressed) {
+    return;
+  }
+  column.clear();
+  value.clear();
+  std::vector<std::pair<int, real> > row;
+  for (int i = 0; i < rows; ++i) {
+    row_begin[i] = (int)column.size();
+    row.assign(entries[i].begin(), entries[i].end());
+    std::sort(row.begin(), row.end());
+    for (uint k = 0; k < row.size(); ++k) {
+      column.push_back(row[k].first);
+      value.push_back(row[k].second);
+    }
+  }
+  row_begin[rows] = (int)column.size();
+  compressed = true;
+}
+
+/// The (i, j)-th entry
+real SparseMatrix::operator()(int i, int j) const {
+  assert(i >= 0 && i < rows && j >= 0 && j < columns);
+  std::unordered_map<int, real>::const_iterator it = entries[i].find(j);
+  return (it == entries[i].end()) ? 0.0 : it->second;
+}
+
+/// \f$y = A x\f$
+void SparseMatrix::Multiply(const Vector& x, Vector& y) {
+  assert(x.Size() == columns);
+  Compress();
+  y.Resize(rows);
+  for (int i = 0; i < rows; ++i) {
+    real sum = 0.0;
+    for (int k = row_begin[i]; k < row_begin[i + 1]; ++k) {
+      sum += value[k] * x(column[k]);
+    }
+    y(i) = sum;
+  }
+}
+
+/// \f$y = A^\top x\f$
+void SparseMatrix::MultiplyTransposed(const Vector& x, Vector& y) {
+  assert(x.Size() == rows);
+  Compress();
+  y.Resize(columns);
+  y.Clear();
+  for (int i = 0; i < rows; ++i) {
+    real x_i = x(i);
+    if (x_i == 0.0) {
+      continue;
+    }
+    for (int k = row_begin[i]; k < row_begin[i + 1]; ++k) {
+      y(column[k]) += value[k] * x_i;
+    }
+  }
+}
+
+/** Solve \f$A x = b\f$ in the least-squares sense with LSQR.
+
+    This is the method of Paige and Saunders, which is equivalent to
+    conjugate gradients on the normal equations \f$A^\top A x = A^\top
+    b\f$, but numerically more stable. It only needs products with
+    \f$A\f$ and \f$A^\top\f$.
+
+    \param A the matrix
+    \param b the right hand side
+    \param x the initial guess, replaced by the solution
+    \param tolerance stop once \f$\|A x - b\| \leq\f$ tolerance
+    \f$\|b\|\f$, or once \f$\|A^\top (A x - b)\|\f$ is smaller than
+    tolerance times its initial value.
+    \param max_iterations the maximum number of iterations, or -1 for
+    ten times the number of columns.
+
+    \return the number of iterations.
+ */
+int LSQR(SparseMatrix& A, const Vector& b, Vector& x, real tolerance,
+         int max_iterations) {
+  int n = A.Columns();
+  assert(b.Size() == A.Rows());
+  if (x.Size() != n) {
+    x.Resize(n);
+    x.Clear();
+  }
+  if (max_iterations < 0) {
+    max_iterations = 10 * n;
+  }
+  Vector u(A.Rows());
+  Vector v(n);
+  Vector Av;
+  Vector Atu;
+
+  // u = b - A x, v = A' u
+  A.Multiply(x, Av);
+  u = b - Av;
+  real beta = u.L2Norm();
+  real b_norm = b.L2Norm();
+  if (beta <= tolerance * b_norm || beta == 0.0) {
+    return 0;
+  }
+  u /= beta;
+  A.MultiplyTransposed(u, v);
+  real alpha = v.L2Norm();
+  if (alpha == 0.0) {
+    return 0;
+  }
+  v /= alpha;
+  Vector w = v;
+  real phi_bar = beta;
+  real rho_bar = alpha;
+  real initial_gradient = alpha * beta;
+
+  int iteration = 0;
+  while (iteration < max_iterations) {
+    ++iteration;
+    // bidiagonalisation
+    A.Multiply(v, Av);
+    u = Av - u * alpha;
+    beta = u.L2Norm();
+    if (beta > 0.0) {
+      u /= beta;
+    }
+    A.MultiplyTransposed(u, Atu);
+    v = Atu - v * beta;
+    alpha = v.L2Norm();
+    if (alpha > 0.0) {
+      v /= alpha;
+    }
+
+    // plane rotation
+    real rho = sqrt(rho_bar * rho_bar + beta * beta);
+    real c = rho_bar / rho;
+    real s = beta / rho;
+    real theta = s * alpha;
+    rho_bar = -c * alpha;
+    real phi = c * phi_bar;
+    phi_bar = s * phi_bar;
+
+    x += w * (phi / rho);
+    w = v - w * (theta / rho);
+
+    // phi_bar is the norm of the residual, and phi_bar alpha |c| the
+    // norm of the gradient of the least-squares objective
+    if (phi_bar <= tolerance * b_norm ||
+        phi_bar * alpha * fabs(c) <= tolerance * initial_gradient ||
+        alpha == 0.0) {
+      break;
+    }
+  }
+  return iteration;
+}
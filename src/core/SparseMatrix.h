@@ -0,0 +1,97 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SPARSE_MATRIX_H
+#define SPARSE_MATRIX_H
+
+#include <unordered_map>
+#include <vector>
+#include "Vector.h"
+#include "real.h"
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/// The non-zero entries of a vector, as (index, value) pairs
+class SparseVector {
+ public:
+  std::vector<int> index;   ///< indices of the non-zero entries
+  std::vector<real> value;  ///< values of the non-zero entries
+  void Clear() {
+    index.clear();
+    value.clear();
+  }
+  /// Append an entry. Indices may repeat, in which case they are summed.
+  void Add(int i, real v) {
+    index.push_back(i);
+    value.push_back(v);
+  }
+  /// Number of entries
+  int Size() const { return (int)index.size(); }
+  /// Inner product with a dense vector
+  real Product(const Vector& x) const {
+    real sum = 0.0;
+    for (uint k = 0; k < index.size(); ++k) {
+      sum += value[k] * x(index[k]);
+    }
+    return sum;
+  }
+};
+
+/** A sparse matrix.
+
+    Entries are accumulated in a hash table per row. Compress() copies
+    them in compressed sparse row form, which is what the products
+    use. Adding entries afterwards is allowed; the rows are then
+    compressed again before the next product.
+ */
+class SparseMatrix {
+ protected:
+  int rows;     ///< number of rows
+  int columns;  ///< number of columns
+  std::vector<std::unordered_map<int, real> > entries;  ///< entries by row
+  bool compressed;              ///< whether the row arrays are up to date
+  std::vector<int> row_begin;   ///< first entry of each row, and the end
+  std::vector<int> column;      ///< column of each entry
+  std::vector<real> value;      ///< value of each entry
+ public:
+  SparseMatrix(int rows_ = 0, int columns_ = 0);
+  void Resize(int rows_, int columns_);
+  void Clear();
+  /// Add v to the (i, j)-th entry
+  void Add(int i, int j, real v) {
+    assert(i >= 0 && i < rows && j >= 0 && j < columns);
+    entries[i][j] += v;
+    compressed = false;
+  }
+  void AddOuterProduct(const SparseVector& x, const SparseVector& y,
+                       real scale = 1.0);
+  void Compress();
+  int Rows() const { return rows; }
+  int Columns() const { return columns; }
+  /// Number of stored entries
+  int NonZeros() {
+    Compress();
+    return (int)column.size();
+  }
+  real operator()(int i, int j) const;
+  void Multiply(const Vector& x, Vector& y);
+  void MultiplyTransposed(const Vector& x, Vector& y);
+};
+
+int LSQR(SparseMatrix& A, const Vector& b, Vector& x, real tolerance = 1e-9,
+         int max_iterations = -1);
+
+/*@}*/
+
+#endif
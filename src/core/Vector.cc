@@ -3,6 +3,7 @@
 
 #include "Vector.h"
 #include "Matrix.h"
+#include "VectorArena.h"
 
 #include <cassert>
 #include <cstdlib>
@@ -43,96 +44,116 @@ void CopyVector(Vector* const lhs, const Vector* const rhs) {
 }
 
 #if 1
+/** Set up storage for N_ elements.
+
+    Small vectors use the inline storage, and larger ones the current
+    arena or the heap. The contents are not initialised.
+ */
+void Vector::Allocate(int N_) {
+  n = N_;
+  arena = NULL;
+  if (n == 0) {
+    x = NULL;
+    maxN = 0;
+  } else if (n <= VECTOR_INLINE_SIZE) {
+    x = inline_x;
+    maxN = VECTOR_INLINE_SIZE;
+  } else {
+    arena = VectorArena::Current();
+    x = arena ? arena->Allocate(n) : (real*)malloc(sizeof(real) * n);
+    maxN = n;
+  }
+}
+
+/// Give back the storage, if it was taken from the heap.
+void Vector::Release() {
+  if (x && x != inline_x && !arena) {
+    free(x);
+  }
+}
+
 Vector::Vector() {
-  n = 0;
-  maxN = 0;
-  x = NULL;
+  Allocate(0);
   checking_bounds = NO_CHECK_BOUNDS;
 }
 
 /// Always create a zero vector
 Vector::Vector(int N_, enum BoundsCheckingStatus check) {
-  n = N_;
-  maxN = n;
-  if (n == 0) {
-    x = NULL;
-  } else {
-    x = (real*)calloc(n, sizeof(real));
+  Allocate(N_);
+  if (n) {
+    memset(x, 0, sizeof(real) * n);
   }
   checking_bounds = check;
 }
 
 Vector::Vector(uint N_, enum BoundsCheckingStatus check) {
-  n = N_;
-  maxN = n;
-  if (n == 0) {
-    x = NULL;
-  } else {
-    x = (real*)calloc(n, sizeof(real));
+  Allocate(N_);
+  if (n) {
+    memset(x, 0, sizeof(real) * n);
   }
   checking_bounds = check;
 }
 
 Vector::Vector(real z, enum BoundsCheckingStatus check) {
-  n = 1;
-  maxN = n;
-  x = (real*)calloc(n, sizeof(real));
+  Allocate(1);
   x[0] = z;
   checking_bounds = check;
 }
 
-/** Copy from an array.
-    TODO replace assignment with memcopy
-*/
+/// Copy from an array.
 Vector::Vector(int N_, real* y, enum BoundsCheckingStatus check) {
-  n = N_;
-  maxN = n;
-  if (n == 0) {
-    x = NULL;
-  } else {
-    x = (real*)malloc(sizeof(real) * n);
+  Allocate(N_);
+  if (n) {
     memcpy(x, y, sizeof(real) * n);
   }
   checking_bounds = check;
 }
 
-/** Copy constructor
-    TODO replace assignment with memcopy
-*/
+/// Copy constructor
 Vector::Vector(const Vector& rhs) {
-  n = rhs.n;
-  maxN = n;
-  if (n == 0) {
-    x = NULL;
+  Allocate(rhs.n);
+  if (n) {
+    memcpy(x, rhs.x, sizeof(real) * n);
+  }
+  checking_bounds = rhs.checking_bounds;
+}
+
+/** Take over the storage of rhs, leaving it empty.
+
+    Inline data cannot be taken over, so it is copied.
+ */
+void Vector::Take(Vector& rhs) {
+  if (rhs.x == rhs.inline_x) {
+    Allocate(rhs.n);
+    memcpy(x, rhs.x, sizeof(real) * n);
   } else {
-    x = (real*)malloc(sizeof(real) * n);
-    for (int i = 0; i < n; i++) {
-      x[i] = rhs[i];
-    }
+    x = rhs.x;
+    n = rhs.n;
+    maxN = rhs.maxN;
+    arena = rhs.arena;
+    rhs.x = NULL;
+    rhs.n = 0;
+    rhs.maxN = 0;
+    rhs.arena = NULL;
   }
+}
+
+/// Move constructor
+Vector::Vector(Vector&& rhs) noexcept {
+  Take(rhs);
   checking_bounds = rhs.checking_bounds;
 }
 
 Vector::Vector(const std::vector<real>& rhs) {
-  n = rhs.size();
-  maxN = n;
-  if (n == 0) {
-    x = NULL;
-  } else {
-    x = (real*)malloc(sizeof(real) * n);
-    for (int i = 0; i < n; i++) {
-      x[i] = rhs[i];
-    }
+  Allocate(rhs.size());
+  for (int i = 0; i < n; i++) {
+    x[i] = rhs[i];
   }
   checking_bounds = NO_CHECK_BOUNDS;
 }
 
 /// Destructor
-Vector::~Vector() {
-  if (x) {
-    free(x);
-  }
-}
+Vector::~Vector() { Release(); }
 
 /// Print vector out at file f, make a new line
 void Vector::print(FILE* f) const {
@@ -223,6 +244,17 @@ Vector& Vector::operator=(const Vector& rhs) {
   return *this;
 }
 
+/// Move assignment
+Vector& Vector::operator=(Vector&& rhs) noexcept {
+  if (this == &rhs) return *this;
+  if (rhs.x == rhs.inline_x) {
+    return (*this) = (const Vector&)rhs;
+  }
+  Release();
+  Take(rhs);
+  return *this;
+}
+
 /// Assignment operator
 Vector& Vector::operator=(const real& rhs) {
   Resize(1);
@@ -293,16 +325,6 @@ real Vector::Sum(const int start, const int end) const {
   return sum;
 }
 
-/// Addition
-const Vector Vector::operator+(const Vector& rhs) const {
-  assert(rhs.n == n);
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] + rhs[i];
-  }
-  return lhs;
-}
-
 /// self-addition
 Vector& Vector::operator+=(const Vector& rhs) {
   assert(rhs.n == n);
@@ -312,16 +334,6 @@ Vector& Vector::operator+=(const Vector& rhs) {
   return *this;
 }
 
-/// Subtraction
-const Vector Vector::operator-(const Vector& rhs) const {
-  assert(rhs.n == n);
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] - rhs[i];
-  }
-  return lhs;
-}
-
 /// Self-substraction
 Vector& Vector::operator-=(const Vector& rhs) {
   assert(rhs.n == n);
@@ -331,16 +343,6 @@ Vector& Vector::operator-=(const Vector& rhs) {
   return *this;
 }
 
-/// Per-element multiplication
-const Vector Vector::operator*(const Vector& rhs) const {
-  assert(rhs.n == n);
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] * rhs[i];
-  }
-  return lhs;
-}
-
 /// Per-element self-multiplication
 Vector& Vector::operator*=(const Vector& rhs) {
   assert(rhs.n == n);
@@ -350,16 +352,6 @@ Vector& Vector::operator*=(const Vector& rhs) {
   return *this;
 }
 
-/// Per-element division
-const Vector Vector::operator/(const Vector& rhs) const {
-  assert(rhs.n == n);
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] / rhs[i];
-  }
-  return lhs;
-}
-
 /// Per-element self-division
 Vector& Vector::operator/=(const Vector& rhs) {
   assert(rhs.n == n);
@@ -369,51 +361,6 @@ Vector& Vector::operator/=(const Vector& rhs) {
   return *this;
 }
 
-/* ----------- SCALAR OPERATORS -------------------------*/
-/// Scalar addition
-const Vector Vector::operator+(const real& rhs) const {
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] + rhs;
-  }
-  return lhs;
-}
-/// Scalar subtraction
-const Vector Vector::operator-(const real& rhs) const {
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] - rhs;
-  }
-  return lhs;
-}
-
-/// Scalar multiplication by -1
-const Vector Vector::operator-() const {
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = -x[i];
-  }
-  return lhs;
-}
-
-/// Scalar multiplication
-const Vector Vector::operator*(const real& rhs) const {
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] * rhs;
-  }
-  return lhs;
-}
-/// Scalar division
-const Vector Vector::operator/(const real& rhs) const {
-  Vector lhs(n);
-  real inv = 1.0 / rhs;
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = x[i] * inv;
-  }
-  return lhs;
-}
-
 /* ----------- SELF SCALAR OPERATORS -------------------------*/
 
 /// Self scalar addition
@@ -475,27 +422,30 @@ const real& Vector::operator[](int index) const {
 /// Change size
 void Vector::Clear() { memset(x, 0, sizeof(real) * n); }
 
-/// Change size
+/** Change size.
+
+    The first elements are kept. Memory is only reallocated when the
+    vector grows beyond its capacity.
+ */
 void Vector::Resize(int N_) {
-  n = N_;
-  if (n > maxN) {
-    if (maxN == 0) {
-      x = (real*)malloc(sizeof(real) * n);
+  if (N_ > maxN) {
+    if (x && x != inline_x && !arena) {
+      x = (real*)realloc(x, sizeof(real) * N_);
+      maxN = N_;
     } else {
-      x = (real*)realloc(x, sizeof(real) * n);
+      real* y = x;
+      int n_old = n;
+      Allocate(N_);
+      if (n_old) {
+        memcpy(x, y, sizeof(real) * n_old);
+      }
     }
-    maxN = n;
   }
+  n = N_;
 }
 
 void Vector::AddElement(const real& rhs) {
-  n = n + 1;
-  if (maxN == 0) {
-    x = (real*)malloc(sizeof(real) * (n));
-  } else {
-    x = (real*)realloc(x, sizeof(real) * (n));
-  }
-  maxN = n;
+  Resize(n + 1);
   x[n - 1] = rhs;
 }
 #endif
@@ -10,8 +10,10 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <type_traits>
 
 #include "MathFunctions.h"
+#include "VectorExpression.h"
 #include "debug.h"
 #include "real.h"
 
@@ -32,7 +34,17 @@
 #define DEFAULT_CHECK_BOUNDS CHECK_BOUNDS
 #endif
 
-/// An n-dimensional vector.
+/// Number of elements a Vector stores without allocating memory
+#define VECTOR_INLINE_SIZE 4
+
+class VectorArena;
+
+/** An n-dimensional vector.
+
+    Vectors of up to VECTOR_INLINE_SIZE elements keep their data
+    inside the object. Larger vectors allocate it from the current
+    VectorArena, if there is one, or from the heap.
+ */
 class Vector : public Object {
  public:
   enum BoundsCheckingStatus { NO_CHECK_BOUNDS = 0, CHECK_BOUNDS = 1 };
@@ -61,14 +73,25 @@ class Vector : public Object {
 
   Vector(const Vector& rhs);
 
+  Vector(Vector&& rhs) noexcept;
+
   Vector(const std::vector<real>& rhs);
 
+  /// Evaluate an expression
+  template <typename E>
+  Vector(const VectorExpression<E>& rhs);
+
   ~Vector();
 
   Vector& operator=(const real& rhs);
 
   Vector& operator=(const Vector& rhs);
 
+  Vector& operator=(Vector&& rhs) noexcept;
+
+  template <typename E>
+  Vector& operator=(const VectorExpression<E>& rhs);
+
   void Clear();
 
   void Resize(int N_);
@@ -117,14 +140,6 @@ class Vector : public Object {
 
   const bool operator==(const Vector& rhs) const;
 
-  const Vector operator+(const Vector& rhs) const;
-
-  const Vector operator-(const Vector& rhs) const;
-
-  const Vector operator*(const Vector& rhs) const;
-
-  const Vector operator/(const Vector& rhs) const;
-
   Vector& operator+=(const Vector& rhs);
 
   Vector& operator-=(const Vector& rhs);
@@ -133,15 +148,17 @@ class Vector : public Object {
 
   Vector& operator/=(const Vector& rhs);
 
-  const Vector operator+(const real& rhs) const;
-
-  const Vector operator-(const real& rhs) const;
+  template <typename E>
+  Vector& operator+=(const VectorExpression<E>& rhs);
 
-  const Vector operator-() const;
+  template <typename E>
+  Vector& operator-=(const VectorExpression<E>& rhs);
 
-  const Vector operator*(const real& rhs) const;
+  template <typename E>
+  Vector& operator*=(const VectorExpression<E>& rhs);
 
-  const Vector operator/(const real& rhs) const;
+  template <typename E>
+  Vector& operator/=(const VectorExpression<E>& rhs);
 
   Vector& operator+=(const real& rhs);
 
@@ -158,8 +175,201 @@ class Vector : public Object {
  private:
   int maxN;
   enum BoundsCheckingStatus checking_bounds;
+  VectorArena* arena;                 ///< arena owning x, if any
+  real inline_x[VECTOR_INLINE_SIZE];  ///< storage for small vectors
+  void Allocate(int N_);
+  void Release();
+  void Take(Vector& rhs);
 };
 
+template <typename E>
+Vector::Vector(const VectorExpression<E>& rhs) {
+  Allocate(rhs.Size());
+  const E& e = rhs.derived();
+  for (int i = 0; i < n; i++) {
+    x[i] = e.eval(i);
+  }
+  checking_bounds = DEFAULT_CHECK_BOUNDS;
+}
+
+/// Assign the value of an expression, which may refer to this vector.
+template <typename E>
+Vector& Vector::operator=(const VectorExpression<E>& rhs) {
+  Resize(rhs.Size());
+  const E& e = rhs.derived();
+  for (int i = 0; i < n; i++) {
+    x[i] = e.eval(i);
+  }
+  return *this;
+}
+
+template <typename E>
+Vector& Vector::operator+=(const VectorExpression<E>& rhs) {
+  assert(rhs.Size() == n);
+  const E& e = rhs.derived();
+  for (int i = 0; i < n; i++) {
+    x[i] += e.eval(i);
+  }
+  return *this;
+}
+
+template <typename E>
+Vector& Vector::operator-=(const VectorExpression<E>& rhs) {
+  assert(rhs.Size() == n);
+  const E& e = rhs.derived();
+  for (int i = 0; i < n; i++) {
+    x[i] -= e.eval(i);
+  }
+  return *this;
+}
+
+template <typename E>
+Vector& Vector::operator*=(const VectorExpression<E>& rhs) {
+  assert(rhs.Size() == n);
+  const E& e = rhs.derived();
+  for (int i = 0; i < n; i++) {
+    x[i] *= e.eval(i);
+  }
+  return *this;
+}
+
+template <typename E>
+Vector& Vector::operator/=(const VectorExpression<E>& rhs) {
+  assert(rhs.Size() == n);
+  const E& e = rhs.derived();
+  for (int i = 0; i < n; i++) {
+    x[i] /= e.eval(i);
+  }
+  return *this;
+}
+
+/** Operands of vector expressions.
+
+    A Vector enters an expression as a VectorLeaf, while expressions
+    are used as they are. For other types there is no member \c type,
+    so that the operators below do not apply to them.
+ */
+template <typename T, typename Enable = void>
+struct VectorOperand {};
+
+template <typename T>
+struct VectorOperand<
+    T, typename std::enable_if<std::is_base_of<Vector, T>::value>::type> {
+  typedef VectorLeaf type;
+  static VectorLeaf get(const Vector& v) { return VectorLeaf(v.x, v.n); }
+};
+
+template <typename T>
+struct VectorOperand<T, typename std::enable_if<std::is_base_of<
+                            VectorExpression<T>, T>::value>::type> {
+  typedef T type;
+  static const T& get(const T& e) { return e; }
+};
+
+/// Addition
+template <typename L, typename R>
+inline VectorBinaryExpression<typename VectorOperand<L>::type,
+                              typename VectorOperand<R>::type, ExpressionAdd>
+operator+(const L& lhs, const R& rhs) {
+  return VectorBinaryExpression<typename VectorOperand<L>::type,
+                                typename VectorOperand<R>::type, ExpressionAdd>(
+      VectorOperand<L>::get(lhs), VectorOperand<R>::get(rhs));
+}
+
+/// Subtraction
+template <typename L, typename R>
+inline VectorBinaryExpression<typename VectorOperand<L>::type,
+                              typename VectorOperand<R>::type,
+                              ExpressionSubtract>
+operator-(const L& lhs, const R& rhs) {
+  return VectorBinaryExpression<typename VectorOperand<L>::type,
+                                typename VectorOperand<R>::type,
+                                ExpressionSubtract>(VectorOperand<L>::get(lhs),
+                                                    VectorOperand<R>::get(rhs));
+}
+
+/// Per-element multiplication
+template <typename L, typename R>
+inline VectorBinaryExpression<typename VectorOperand<L>::type,
+                              typename VectorOperand<R>::type,
+                              ExpressionMultiply>
+operator*(const L& lhs, const R& rhs) {
+  return VectorBinaryExpression<typename VectorOperand<L>::type,
+                                typename VectorOperand<R>::type,
+                                ExpressionMultiply>(VectorOperand<L>::get(lhs),
+                                                    VectorOperand<R>::get(rhs));
+}
+
+/// Per-element division
+template <typename L, typename R>
+inline VectorBinaryExpression<typename VectorOperand<L>::type,
+                              typename VectorOperand<R>::type, ExpressionDivide>
+operator/(const L& lhs, const R& rhs) {
+  return VectorBinaryExpression<typename VectorOperand<L>::type,
+                                typename VectorOperand<R>::type,
+                                ExpressionDivide>(VectorOperand<L>::get(lhs),
+                                                  VectorOperand<R>::get(rhs));
+}
+
+/// Scalar addition
+template <typename L>
+inline VectorUnaryExpression<typename VectorOperand<L>::type,
+                             ExpressionAddScalar>
+operator+(const L& lhs, const real& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<L>::type,
+                               ExpressionAddScalar>(VectorOperand<L>::get(lhs),
+                                                    ExpressionAddScalar(rhs));
+}
+
+/// Scalar subtraction
+template <typename L>
+inline VectorUnaryExpression<typename VectorOperand<L>::type,
+                             ExpressionSubtractScalar>
+operator-(const L& lhs, const real& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<L>::type,
+                               ExpressionSubtractScalar>(
+      VectorOperand<L>::get(lhs), ExpressionSubtractScalar(rhs));
+}
+
+/// Scalar multiplication
+template <typename L>
+inline VectorUnaryExpression<typename VectorOperand<L>::type,
+                             ExpressionMultiplyScalar>
+operator*(const L& lhs, const real& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<L>::type,
+                               ExpressionMultiplyScalar>(
+      VectorOperand<L>::get(lhs), ExpressionMultiplyScalar(rhs));
+}
+
+/// Scalar multiplication from the left
+template <typename R>
+inline VectorUnaryExpression<typename VectorOperand<R>::type,
+                             ExpressionMultiplyScalar>
+operator*(const real& lhs, const R& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<R>::type,
+                               ExpressionMultiplyScalar>(
+      VectorOperand<R>::get(rhs), ExpressionMultiplyScalar(lhs));
+}
+
+/// Scalar division, as multiplication with the inverse
+template <typename L>
+inline VectorUnaryExpression<typename VectorOperand<L>::type,
+                             ExpressionMultiplyScalar>
+operator/(const L& lhs, const real& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<L>::type,
+                               ExpressionMultiplyScalar>(
+      VectorOperand<L>::get(lhs), ExpressionMultiplyScalar(1.0 / rhs));
+}
+
+/// Scalar multiplication by -1
+template <typename L>
+inline VectorUnaryExpression<typename VectorOperand<L>::type, ExpressionNegate>
+operator-(const L& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<L>::type,
+                               ExpressionNegate>(VectorOperand<L>::get(rhs),
+                                                 ExpressionNegate());
+}
+
 /// Use this to define an n_1 x n_2 x ... x n_N lattice
 typedef struct Lattice_ {
   int dim;  ///< number of dimensions
@@ -296,53 +506,43 @@ inline real Volume(const Vector& x) {
   return V;
 }
 /// Exponentiation
-inline const Vector exp(const Vector& rhs) {
-  int n = rhs.Size();
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = exp(rhs[i]);
-  }
-  return lhs;
+template <typename T>
+inline VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionExp>
+exp(const T& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionExp>(
+      VectorOperand<T>::get(rhs), ExpressionExp());
 }
 
 /// Power, by element
-inline const Vector pow(const Vector& rhs, const real p) {
-  int n = rhs.Size();
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = pow((double)rhs[i], (double)p);
-  }
-  return lhs;
+template <typename T>
+inline VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionPow>
+pow(const T& rhs, const real p) {
+  return VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionPow>(
+      VectorOperand<T>::get(rhs), ExpressionPow(p));
 }
 
 /// Hypertangentification
-inline const Vector tanh(const Vector& rhs) {
-  int n = rhs.Size();
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = tanh(rhs[i]);
-  }
-  return lhs;
+template <typename T>
+inline VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionTanh>
+tanh(const T& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionTanh>(
+      VectorOperand<T>::get(rhs), ExpressionTanh());
 }
 
 /// Logarithmication
-inline const Vector log(const Vector& rhs) {
-  int n = rhs.Size();
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = log(rhs[i]);
-  }
-  return lhs;
+template <typename T>
+inline VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionLog>
+log(const T& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionLog>(
+      VectorOperand<T>::get(rhs), ExpressionLog());
 }
 
 /// Absolute value
-inline const Vector abs(const Vector& rhs) {
-  int n = rhs.Size();
-  Vector lhs(n);
-  for (int i = 0; i < n; i++) {
-    lhs.x[i] = fabs(rhs[i]);
-  }
-  return lhs;
+template <typename T>
+inline VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionAbs>
+abs(const T& rhs) {
+  return VectorUnaryExpression<typename VectorOperand<T>::type, ExpressionAbs>(
+      VectorOperand<T>::get(rhs), ExpressionAbs());
 }
 
 /// logAdd
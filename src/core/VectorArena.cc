@@ -0,0 +1,68 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "VectorArena.h"
+
+#include <cstdlib>
+
+static thread_local VectorArena* current_arena = NULL;
+
+VectorArena::VectorArena(int block_size_)
+    : block_size(block_size_), current(0), used(0) {}
+
+VectorArena::~VectorArena() {
+  for (unsigned int i = 0; i < blocks.size(); ++i) {
+    free(blocks[i]);
+  }
+  for (unsigned int i = 0; i < large_blocks.size(); ++i) {
+    free(large_blocks[i]);
+  }
+}
+
+/// Allocate n reals. Requests larger than a block are allocated singly.
+real* VectorArena::Allocate(int n) {
+  if (n > block_size) {
+    real* y = (real*)malloc(sizeof(real) * n);
+    large_blocks.push_back(y);
+    return y;
+  }
+  if (blocks.size() == 0 || used + n > block_size) {
+    if (blocks.size() > 0 && current + 1 < (int)blocks.size()) {
+      ++current;
+    } else {
+      blocks.push_back((real*)malloc(sizeof(real) * block_size));
+      current = blocks.size() - 1;
+    }
+    used = 0;
+  }
+  real* y = blocks[current] + used;
+  used += n;
+  return y;
+}
+
+/// Make all memory available again, keeping the blocks for reuse.
+void VectorArena::Reset() {
+  for (unsigned int i = 0; i < large_blocks.size(); ++i) {
+    free(large_blocks[i]);
+  }
+  large_blocks.clear();
+  current = 0;
+  used = 0;
+}
+
+/// The arena of the innermost scope of this thread, or NULL.
+VectorArena* VectorArena::Current() { return current_arena; }
+
+VectorArena::Scope::Scope(VectorArena& arena) : previous(current_arena) {
+  current_arena = &arena;
+}
+
+VectorArena::Scope::~Scope() { current_arena = previous; }
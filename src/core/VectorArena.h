@@ -0,0 +1,71 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SRC_CORE_VECTORARENA_H_
+#define SRC_CORE_VECTORARENA_H_
+
+#include <vector>
+#include "real.h"
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/** A region allocator for vector data.
+
+    Memory is handed out from large blocks and is only returned when
+    the arena is destroyed or Reset(), so allocation costs a pointer
+    increment and deallocation nothing.
+
+    While a Scope is alive, every Vector that needs more than its
+    inline storage takes its data from the arena of the scope:
+    \code
+    VectorArena arena;
+    {
+        VectorArena::Scope scope(arena);
+        // vectors created here use the arena
+    }
+    \endcode
+    Such vectors must be destroyed before the arena is reset or
+    destroyed. The current scope is per thread.
+ */
+class VectorArena {
+ protected:
+  std::vector<real*> blocks;        ///< blocks of block_size reals
+  std::vector<real*> large_blocks;  ///< single allocations above block_size
+  int block_size;                   ///< number of reals per block
+  int current;                      ///< index of the block in use
+  int used;                         ///< reals used in the current block
+
+ public:
+  explicit VectorArena(int block_size_ = 4096);
+  ~VectorArena();
+  real* Allocate(int n);
+  void Reset();
+  /// Number of reals that can be allocated without a new block
+  int Available() const { return blocks.size() ? block_size - used : 0; }
+  static VectorArena* Current();
+
+  /// Make an arena the current one until the end of the scope
+  class Scope {
+   protected:
+    VectorArena* previous;
+
+   public:
+    explicit Scope(VectorArena& arena);
+    ~Scope();
+  };
+};
+
+/*@}*/
+
+#endif  // SRC_CORE_VECTORARENA_H_
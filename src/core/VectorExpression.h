@@ -0,0 +1,199 @@
+/* -*- Mode: c++ -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SRC_CORE_VECTOREXPRESSION_H_
+#define SRC_CORE_VECTOREXPRESSION_H_
+
+#include <cassert>
+#include <cmath>
+
+#include "real.h"
+
+/**
+   \ingroup MathGroup
+*/
+/*@{*/
+
+/** \file VectorExpression.h
+
+    \brief Lazily evaluated element-wise arithmetic.
+
+    The arithmetic operators of Vector and Matrix do not compute their
+    result immediately. Instead, they return a small expression object
+    that refers to its operands. The expression is evaluated element by
+    element, in a single pass, when it is assigned to or used to
+    construct a Vector or a Matrix. Thus
+    \code
+    Vector y = pow((x - center) / beta, 2.0);
+    \endcode
+    allocates only y, rather than three temporaries.
+
+    Expressions refer to their operands, so they must be used within
+    the statement that creates them: do not store them.
+ */
+
+/// Element-wise addition
+struct ExpressionAdd {
+  real operator()(real a, real b) const { return a + b; }
+};
+
+/// Element-wise subtraction
+struct ExpressionSubtract {
+  real operator()(real a, real b) const { return a - b; }
+};
+
+/// Element-wise multiplication
+struct ExpressionMultiply {
+  real operator()(real a, real b) const { return a * b; }
+};
+
+/// Element-wise division
+struct ExpressionDivide {
+  real operator()(real a, real b) const { return a / b; }
+};
+
+/// Add a scalar
+struct ExpressionAddScalar {
+  real c;
+  explicit ExpressionAddScalar(real c_) : c(c_) {}
+  real operator()(real a) const { return a + c; }
+};
+
+/// Subtract a scalar
+struct ExpressionSubtractScalar {
+  real c;
+  explicit ExpressionSubtractScalar(real c_) : c(c_) {}
+  real operator()(real a) const { return a - c; }
+};
+
+/// Multiply by a scalar
+struct ExpressionMultiplyScalar {
+  real c;
+  explicit ExpressionMultiplyScalar(real c_) : c(c_) {}
+  real operator()(real a) const { return a * c; }
+};
+
+/// Negation
+struct ExpressionNegate {
+  real operator()(real a) const { return -a; }
+};
+
+/// Exponentiation
+struct ExpressionExp {
+  real operator()(real a) const { return exp(a); }
+};
+
+/// Logarithm
+struct ExpressionLog {
+  real operator()(real a) const { return log(a); }
+};
+
+/// Hyperbolic tangent
+struct ExpressionTanh {
+  real operator()(real a) const { return tanh(a); }
+};
+
+/// Absolute value
+struct ExpressionAbs {
+  real operator()(real a) const { return fabs(a); }
+};
+
+/// Power, with squares computed directly as they are the common case
+struct ExpressionPow {
+  real p;
+  explicit ExpressionPow(real p_) : p(p_) {}
+  real operator()(real a) const {
+    return (p == 2.0) ? a * a : pow((double)a, (double)p);
+  }
+};
+
+/** Base class of vector expressions.
+
+    An expression E has a Size() and an element accessor eval(i).
+ */
+template <typename E>
+class VectorExpression {
+ public:
+  const E& derived() const { return static_cast<const E&>(*this); }
+  int Size() const { return derived().Size(); }
+  real operator()(int i) const { return derived().eval(i); }
+  real operator[](int i) const { return derived().eval(i); }
+  real Sum() const {
+    real sum = 0.0;
+    for (int i = 0; i < Size(); ++i) {
+      sum += derived().eval(i);
+    }
+    return sum;
+  }
+  real SquareNorm() const {
+    real sum = 0.0;
+    for (int i = 0; i < Size(); ++i) {
+      real d = derived().eval(i);
+      sum += d * d;
+    }
+    return sum;
+  }
+  real L2Norm() const { return sqrt(SquareNorm()); }
+  real L1Norm() const {
+    real sum = 0.0;
+    for (int i = 0; i < Size(); ++i) {
+      sum += fabs(derived().eval(i));
+    }
+    return sum;
+  }
+};
+
+/// The data of a Vector, as used in expressions
+class VectorLeaf : public VectorExpression<VectorLeaf> {
+ protected:
+  const real* x;
+  int n;
+
+ public:
+  VectorLeaf(const real* x_, int n_) : x(x_), n(n_) {}
+  int Size() const { return n; }
+  real eval(int i) const { return x[i]; }
+};
+
+/// A function applied to each element of an expression
+template <typename A, typename F>
+class VectorUnaryExpression
+    : public VectorExpression<VectorUnaryExpression<A, F> > {
+ protected:
+  A a;
+  F f;
+
+ public:
+  VectorUnaryExpression(const A& a_, const F& f_) : a(a_), f(f_) {}
+  int Size() const { return a.Size(); }
+  real eval(int i) const { return f(a.eval(i)); }
+};
+
+/// A function applied to each pair of elements of two expressions
+template <typename A, typename B, typename F>
+class VectorBinaryExpression
+    : public VectorExpression<VectorBinaryExpression<A, B, F> > {
+ protected:
+  A a;
+  B b;
+  F f;
+
+ public:
+  VectorBinaryExpression(const A& a_, const B& b_) : a(a_), b(b_) {
+    assert(a.Size() == b.Size());
+  }
+  int Size() const { return a.Size(); }
+  real eval(int i) const { return f(a.eval(i), b.eval(i)); }
+};
+
+/*@}*/
+
+#endif  // SRC_CORE_VECTOREXPRESSION_H_
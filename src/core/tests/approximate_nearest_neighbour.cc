@@ -0,0 +1,170 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <vector>
+#include "CoverTree.h"
+#include "EasyClock.h"
+#include "FlatKDTree.h"
+#include "KDTree.h"
+#include "Metric.h"
+#include "Random.h"
+
+/** Compare exact and approximate searches with a linear scan.
+
+    Exact searches must find the true distances. Approximate ones must
+    be within a factor 1 + epsilon, unless a node budget is set.
+ */
+template <class M>
+int TestFlatKDTree(const char* name, const M& metric,
+                   const std::vector<Vector>& X, const std::vector<Vector>& Q,
+                   int K, real epsilon, int max_leaves) {
+  int n_dimensions = X[0].Size();
+  FlatKDTree<const Vector, M> exact(n_dimensions, 8, metric);
+  FlatKDTree<const Vector, M> approximate(n_dimensions, 8, metric);
+  for (uint i = 0; i < X.size(); ++i) {
+    exact.AddVectorObject(X[i], &X[i]);
+    approximate.AddVectorObject(X[i], &X[i]);
+  }
+  approximate.setApproximation(epsilon, max_leaves);
+  int errors = 0;
+  real ratio = 0.0;
+  std::vector<void_FlatKDTree::Neighbour> knn, knn_linear;
+  double start_time = GetCPU();
+  for (uint i = 0; i < Q.size(); ++i) {
+    exact.FindKNearestNeighbours(Q[i], K, knn);
+  }
+  double exact_time = GetCPU() - start_time;
+  start_time = GetCPU();
+  for (uint i = 0; i < Q.size(); ++i) {
+    approximate.FindKNearestNeighbours(Q[i], K, knn);
+  }
+  double approximate_time = GetCPU() - start_time;
+  for (uint i = 0; i < Q.size(); ++i) {
+    exact.FindKNearestNeighboursLinear(Q[i], K, knn_linear);
+    exact.FindKNearestNeighbours(Q[i], K, knn);
+    if (fabs(knn[K - 1].first - knn_linear[K - 1].first) > 1e-9) {
+      fprintf(stderr, "%s: exact search failed\n", name);
+      errors++;
+    }
+    approximate.FindKNearestNeighbours(Q[i], K, knn);
+    real ratio_i = knn[K - 1].first / knn_linear[K - 1].first;
+    if (max_leaves == 0 && ratio_i > 1.0 + epsilon + 1e-9) {
+      fprintf(stderr, "%s: distance ratio %f\n", name, ratio_i);
+      errors++;
+    }
+    ratio += ratio_i;
+  }
+  printf("%s, epsilon %.2f, %d leaves: exact %f s, approximate %f s, ", name,
+         epsilon, max_leaves, exact_time, approximate_time);
+  printf("mean distance ratio %f\n", ratio / (real)Q.size());
+  return errors;
+}
+
+int main() {
+  int errors = 0;
+  int n_dimensions = 16;
+  int n_points = 10000;
+  int n_queries = 500;
+  int K = 5;
+  std::vector<Vector> X(n_points);
+  std::vector<Vector> Q(n_queries);
+  // points near a low-dimensional subspace, as with features of states
+  for (int i = 0; i < n_points + n_queries; ++i) {
+    Vector x(n_dimensions);
+    real u = urandom();
+    real v = urandom();
+    for (int j = 0; j < n_dimensions; ++j) {
+      x(j) = sin((j + 1) * u) + cos((j + 1) * v) + 0.05 * urandom();
+    }
+    if (i < n_points) {
+      X[i] = x;
+    } else {
+      Q[i - n_points] = x;
+    }
+  }
+  Matrix Sigma = Matrix::Unity(n_dimensions, n_dimensions);
+  for (int j = 0; j < n_dimensions; ++j) {
+    Sigma(j, j) = 1.0 + j;
+  }
+
+  errors += TestFlatKDTree("L1", L1Metric(), X, Q, K, 0.0, 0);
+  errors += TestFlatKDTree("L1", L1Metric(), X, Q, K, 0.5, 0);
+  errors += TestFlatKDTree("L1", L1Metric(), X, Q, K, 0.0, 16);
+  errors += TestFlatKDTree("L2", EuclideanMetric(), X, Q, K, 0.0, 0);
+  errors += TestFlatKDTree("L2", EuclideanMetric(), X, Q, K, 0.5, 0);
+  errors += TestFlatKDTree("Linf", LinfMetric(), X, Q, K, 0.0, 0);
+  errors += TestFlatKDTree("Linf", LinfMetric(), X, Q, K, 0.5, 0);
+  errors += TestFlatKDTree("Mahalanobis", MahalanobisMetric(Sigma), X, Q, K,
+                           0.0, 0);
+  errors += TestFlatKDTree("Mahalanobis", MahalanobisMetric(Sigma), X, Q, K,
+                           0.5, 0);
+
+  // the pointer-based KD tree uses the L1 metric
+  KDTree<Vector> kd_tree(n_dimensions);
+  for (int i = 0; i < n_points; ++i) {
+    kd_tree.AddVectorObject(X[i], &X[i]);
+  }
+  real epsilon = 0.5;
+  for (int i = 0; i < n_queries; ++i) {
+    kd_tree.setApproximation(0.0);
+    real exact = L1Norm(Q[i], kd_tree.FindNearestNeighbour(Q[i])->c);
+    real linear = L1Norm(Q[i], kd_tree.FindNearestNeighbourLinear(Q[i])->c);
+    kd_tree.setApproximation(epsilon);
+    real approximate = L1Norm(Q[i], kd_tree.FindNearestNeighbour(Q[i])->c);
+    if (fabs(exact - linear) > 1e-9 || approximate > (1 + epsilon) * linear) {
+      fprintf(stderr, "KDTree: %f %f %f\n", exact, approximate, linear);
+      errors++;
+    }
+  }
+
+  // the cover tree search only reports the distance ratio
+  MetricCoverTree<EuclideanMetric> cover_tree(2.0);
+  for (int i = 0; i < n_points; ++i) {
+    cover_tree.Insert(X[i]);
+  }
+  real ratio = 0.0;
+  double exact_time = 0.0;
+  double approximate_time = 0.0;
+  for (int i = 0; i < n_queries; ++i) {
+    cover_tree.setApproximation(0.0);
+    double start_time = GetCPU();
+    const MetricCoverTree<EuclideanMetric>::Node* exact =
+        cover_tree.NearestNeighbour(Q[i]);
+    exact_time += GetCPU() - start_time;
+    cover_tree.setApproximation(epsilon, 1000);
+    start_time = GetCPU();
+    const MetricCoverTree<EuclideanMetric>::Node* approximate =
+        cover_tree.NearestNeighbour(Q[i]);
+    approximate_time += GetCPU() - start_time;
+    if (!exact || !approximate) {
+      fprintf(stderr, "CoverTree: no neighbour found\n");
+      errors++;
+      continue;
+    }
+    ratio += cover_tree.metric(Q[i], approximate->point) /
+             cover_tree.metric(Q[i], exact->point);
+  }
+  printf("cover tree, epsilon %.2f, 1000 nodes: exact %f s, ", epsilon,
+         exact_time);
+  printf("approximate %f s, mean distance ratio %f\n", approximate_time,
+         ratio / (real)n_queries);
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
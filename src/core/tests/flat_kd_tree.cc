@@ -0,0 +1,185 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <vector>
+#include "EasyClock.h"
+#include "FlatKDTree.h"
+#include "KDTree.h"
+#include "Random.h"
+
+/// Check that two neighbour lists have the same distances
+int CompareDistances(const char* name,
+                     const std::vector<void_FlatKDTree::Neighbour>& a,
+                     const std::vector<void_FlatKDTree::Neighbour>& b) {
+  if (a.size() != b.size()) {
+    fprintf(stderr, "%s: %d != %d neighbours\n", name, (int)a.size(),
+            (int)b.size());
+    return 1;
+  }
+  for (uint k = 0; k < a.size(); ++k) {
+    if (fabs(a[k].first - b[k].first) > 1e-9) {
+      fprintf(stderr, "%s: neighbour %d at %f != %f\n", name, k, a[k].first,
+              b[k].first);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/// Check that searches agree with linear search and skip removed points
+int CheckRemoval(FlatKDTree<Vector>& tree, const Matrix& Z, int K) {
+  int errors = 0;
+  for (int i = 0; i < Z.Rows(); i += 50) {
+    std::vector<void_FlatKDTree::Neighbour> knn, knn_linear;
+    tree.FindKNearestNeighbours(Z.getRow(i), K, knn);
+    tree.FindKNearestNeighboursLinear(Z.getRow(i), K, knn_linear);
+    errors += CompareDistances("removal", knn, knn_linear);
+    for (uint k = 0; k < knn.size(); ++k) {
+      if (!tree.isPoint(knn[k].second)) {
+        fprintf(stderr, "removed point %d was found\n", knn[k].second);
+        errors++;
+      }
+    }
+  }
+  return errors;
+}
+
+int main() {
+  int errors = 0;
+  int n_dimensions = 4;
+  int n_points = 20000;
+  int n_queries = 5000;
+  int K = 10;
+  Matrix X(n_points, n_dimensions);
+  std::vector<Vector> points(n_points);
+  for (int i = 0; i < n_points; ++i) {
+    points[i] = Vector(n_dimensions);
+    for (int j = 0; j < n_dimensions; ++j) {
+      X(i, j) = urandom();
+      points[i](j) = X(i, j);
+    }
+  }
+  Matrix Z(n_queries, n_dimensions);
+  for (int i = 0; i < n_queries; ++i) {
+    for (int j = 0; j < n_dimensions; ++j) {
+      Z(i, j) = urandom();
+    }
+  }
+
+  // incremental insertion, with queries in between
+  FlatKDTree<Vector> incremental(n_dimensions);
+  for (int i = 0; i < n_points; ++i) {
+    incremental.AddVectorObject(points[i], &points[i]);
+    if (i % 97 == 0) {
+      std::vector<void_FlatKDTree::Neighbour> knn, knn_linear;
+      Vector z = Z.getRow(i % n_queries);
+      incremental.FindKNearestNeighbours(z, K, knn);
+      incremental.FindKNearestNeighboursLinear(z, K, knn_linear);
+      errors += CompareDistances("incremental", knn, knn_linear);
+    }
+  }
+  for (int i = 0; i < n_points; i += 101) {
+    if (incremental.FindNearestObject(points[i]) != &points[i]) {
+      fprintf(stderr, "point %d is not its own nearest neighbour\n", i);
+      errors++;
+    }
+  }
+
+  // removal, with the slots of removed points reused
+  for (int i = 0; i < n_points; i += 3) {
+    incremental.Remove(i);
+  }
+  errors += CheckRemoval(incremental, Z, K);
+  for (int i = 0; i < n_points; i += 4) {
+    int slot = incremental.AddVectorObject(points[i], &points[i]);
+    if (slot >= n_points) {
+      fprintf(stderr, "point %d was not put in a free slot\n", i);
+      errors++;
+      break;
+    }
+    if (i % 3 == 0) {
+      incremental.Remove(slot);
+    }
+  }
+  errors += CheckRemoval(incremental, Z, K);
+
+  // bulk construction
+  std::vector<Vector*> objects(n_points);
+  for (int i = 0; i < n_points; ++i) {
+    objects[i] = &points[i];
+  }
+  double start_time = GetCPU();
+  FlatKDTree<Vector> flat(n_dimensions);
+  flat.BuildObjects(X, objects);
+  double flat_build_time = GetCPU() - start_time;
+
+  start_time = GetCPU();
+  KDTree<Vector> tree(n_dimensions);
+  for (int i = 0; i < n_points; ++i) {
+    tree.AddVectorObject(points[i], &points[i]);
+  }
+  double tree_build_time = GetCPU() - start_time;
+
+  // single queries against the pointer-based tree
+  std::vector<std::vector<void_FlatKDTree::Neighbour> > knn(n_queries);
+  start_time = GetCPU();
+  for (int i = 0; i < n_queries; ++i) {
+    flat.FindKNearestNeighbours(Z.getRow(i), K, knn[i]);
+  }
+  double flat_time = GetCPU() - start_time;
+
+  start_time = GetCPU();
+  for (int i = 0; i < n_queries; ++i) {
+    OrderedFixedList<KDNode> knn_list =
+        tree.FindKNearestNeighbours(Z.getRow(i), K);
+    std::vector<void_FlatKDTree::Neighbour> knn_tree;
+    for (KDTree<Vector>::iterator it = knn_list.begin(); it != knn_list.end();
+         ++it) {
+      knn_tree.push_back(void_FlatKDTree::Neighbour(it->first, 0));
+    }
+    errors += CompareDistances("KDTree", knn[i], knn_tree);
+  }
+  double tree_time = GetCPU() - start_time;
+
+  for (int i = 0; i < n_queries; i += 50) {
+    std::vector<void_FlatKDTree::Neighbour> knn_linear;
+    flat.FindKNearestNeighboursLinear(Z.getRow(i), K, knn_linear);
+    errors += CompareDistances("linear", knn[i], knn_linear);
+  }
+
+  // batched queries
+  std::vector<std::vector<void_FlatKDTree::Neighbour> > knn_batch;
+  double start_wall = GetMonotonicTime();
+  flat.FindKNearestNeighbours(Z, K, knn_batch);
+  double batch_time = GetMonotonicTime() - start_wall;
+  start_wall = GetMonotonicTime();
+  flat.FindKNearestNeighbours(Z, K, knn_batch, 4);
+  double parallel_time = GetMonotonicTime() - start_wall;
+  for (int i = 0; i < n_queries; ++i) {
+    errors += CompareDistances("batch", knn[i], knn_batch[i]);
+  }
+
+  printf("%d points, %d dimensions: build %f s (KDTree %f s)\n", n_points,
+         n_dimensions, flat_build_time, tree_build_time);
+  printf("%d queries for %d neighbours: %f s (KDTree %f s), ", n_queries, K,
+         flat_time, tree_time);
+  printf("batch %f s, 4 threads %f s\n", batch_time, parallel_time);
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -45,10 +45,10 @@ int kd_tree_test(int n_points, int n_dimensions) {
     KDNode* node2 = tree.FindNearestNeighbour(Z);
     OrderedFixedList<KDNode> knn_list = tree.FindKNearestNeighboursLinear(Z, 1);
 
-    KDNode* node3 = knn_list.S.front().second;
+    KDNode* node3 = knn_list.front().second;
     OrderedFixedList<KDNode> knn_list2 = tree.FindKNearestNeighbours(Z, 1);
 
-    KDNode* node4 = knn_list2.S.front().second;
+    KDNode* node4 = knn_list2.front().second;
     if (node != node2 || node != node3 || node != node4) {
       printf("MISMATCH ");
       printf("dist: %f %f\n", L1Norm(&Z, &node->c), L1Norm(&Z, &node2->c));
@@ -67,18 +67,18 @@ int kd_tree_test(int n_points, int n_dimensions) {
     OrderedFixedList<KDNode> knn_list = tree.FindKNearestNeighboursLinear(Z, K);
     OrderedFixedList<KDNode> knn_list2 = tree.FindKNearestNeighbours(Z, K);
 
-    KDNode* node3 = knn_list.S.front().second;
-    KDNode* node4 = knn_list2.S.front().second;
+    KDNode* node3 = knn_list.front().second;
+    KDNode* node4 = knn_list2.front().second;
     if (node != node2 || node != node3 || node != node4) {
       printf("MISMATCH ");
       printf("dist: %f %f\n", L1Norm(&Z, &node->c), L1Norm(&Z, &node2->c));
       n_errors++;
     }
 
-    std::list<std::pair<real, KDNode*> >::iterator s1 = knn_list.S.begin();
-    std::list<std::pair<real, KDNode*> >::iterator s2 = knn_list2.S.begin();
+    OrderedFixedList<KDNode>::iterator s1 = knn_list.begin();
+    OrderedFixedList<KDNode>::iterator s2 = knn_list2.begin();
     for (int k = 1; k < K; ++k, ++s1, ++s2) {
-      if (s1 == knn_list.S.end() || s2 == knn_list.S.end()) {
+      if (s1 == knn_list.end() || s2 == knn_list2.end()) {
         printf("# END\n");
         break;
       }
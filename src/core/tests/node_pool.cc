@@ -0,0 +1,120 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Check that NodePool constructs nodes in place, keeps them in
+    place as it grows, and destroys all of them when cleared. Also
+    check that arrays of nodes are contiguous.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <vector>
+#include "NodePool.h"
+
+static int n_alive = 0;
+
+struct TestNode {
+  int index;
+  TestNode* prev;
+  std::vector<int> data;  ///< to check that destructors are called
+  TestNode(int index_, TestNode* prev_)
+      : index(index_), prev(prev_), data(4, index_) {
+    n_alive++;
+  }
+  ~TestNode() { n_alive--; }
+};
+
+int main(int argc, char** argv) {
+  int errors = 0;
+  int n_nodes = 5 * NodePool<TestNode>::BLOCK_SIZE + 17;
+  {
+    NodePool<TestNode> pool;
+    for (int round = 0; round < 2; ++round) {
+      std::vector<TestNode*> pointers;
+      for (int i = 0; i < n_nodes; ++i) {
+        TestNode* prev = (i > 0) ? pool.Get((i - 1) / 2) : NULL;
+        int index = pool.New(i, prev);
+        if (index != i) {
+          fprintf(stderr, "node %d got index %d\n", i, index);
+          errors++;
+        }
+        pointers.push_back(pool.Get(index));
+      }
+      if (pool.size() != n_nodes || n_alive != n_nodes) {
+        fprintf(stderr, "%d nodes, %d alive, expected %d\n", pool.size(),
+                n_alive, n_nodes);
+        errors++;
+      }
+      for (int i = 0; i < n_nodes; ++i) {
+        TestNode& node = pool[i];
+        if (&node != pointers[i] || node.index != i || node.data[3] != i) {
+          fprintf(stderr, "node %d moved or was overwritten\n", i);
+          errors++;
+        }
+        if (i > 0 && node.prev->index != (i - 1) / 2) {
+          fprintf(stderr, "node %d has the wrong parent\n", i);
+          errors++;
+        }
+      }
+      pool.Clear();
+      if (pool.size() != 0 || n_alive != 0) {
+        fprintf(stderr, "%d nodes alive after clearing\n", n_alive);
+        errors++;
+      }
+    }
+    pool.New(0, (TestNode*)NULL);
+  }
+  if (n_alive != 0) {
+    fprintf(stderr, "%d nodes alive after destruction\n", n_alive);
+    errors++;
+  }
+
+  // arrays of 3 do not fit exactly in a block
+  {
+    NodePool<int> pool;
+    NodePool<int> other;
+    std::vector<int> first;
+    int n_arrays = NodePool<int>::BLOCK_SIZE;
+    for (int i = 0; i < n_arrays; ++i) {
+      first.push_back(pool.NewArray(3));
+      int* array = pool.Get(first[i]);
+      for (int j = 0; j < 3; ++j) {
+        if (array[j] != 0) {
+          fprintf(stderr, "array %d was not initialised\n", i);
+          errors++;
+        }
+        array[j] = i;
+      }
+    }
+    pool.Swap(other);
+    if (pool.size() != 0) {
+      fprintf(stderr, "%d nodes after swapping with an empty pool\n",
+              pool.size());
+      errors++;
+    }
+    for (int i = 0; i < n_arrays; ++i) {
+      int* array = other.Get(first[i]);
+      if (array[0] != i || array[1] != i || array[2] != i) {
+        fprintf(stderr, "array %d is not contiguous\n", i);
+        errors++;
+      }
+    }
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
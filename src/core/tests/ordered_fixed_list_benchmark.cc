@@ -0,0 +1,117 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Compare OrderedFixedList with the list it replaced, which was sorted
+    after every insertion.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <list>
+#include <vector>
+#include "EasyClock.h"
+#include "OrderedFixedList.h"
+#include "Random.h"
+
+/// The previous implementation, kept as a reference
+template <typename T>
+class ListOrderedFixedList {
+ protected:
+  const uint N;
+  real upper_bound;
+
+ public:
+  std::list<std::pair<real, T*> > S;
+
+  ListOrderedFixedList(const uint N_) : N(N_) { upper_bound = REAL_RANGE; }
+  const bool AddPerhaps(real x, T* object) {
+    if (S.size() < N) {
+      S.push_back(std::make_pair(x, object));
+      S.sort();
+      upper_bound = S.back().first;
+      return true;
+    }
+    if (x < upper_bound) {
+      S.pop_back();
+      S.push_back(std::make_pair(x, object));
+      S.sort();
+      upper_bound = S.back().first;
+      return true;
+    }
+    return false;
+  }
+};
+
+int main() {
+  int errors = 0;
+  int n_values = 4096;
+  int n_repetitions = 100;
+  std::vector<real> values(n_values);
+  std::vector<int> objects(n_values);
+  for (int i = 0; i < n_values; ++i) {
+    values[i] = urandom();
+    objects[i] = i;
+  }
+  printf("# K heap_time list_time (s for %d lists of %d values)\n",
+         n_repetitions, n_values);
+  for (int K = 1; K <= 64; K *= 2) {
+    real heap_sum = 0.0;
+    double start_time = GetCPU();
+    for (int k = 0; k < n_repetitions; ++k) {
+      OrderedFixedList<int> heap_list(K);
+      for (int i = 0; i < n_values; ++i) {
+        heap_list.AddPerhaps(values[i], &objects[i]);
+      }
+      heap_sum += heap_list.front().first;
+    }
+    double heap_time = GetCPU() - start_time;
+
+    real list_sum = 0.0;
+    start_time = GetCPU();
+    for (int k = 0; k < n_repetitions; ++k) {
+      ListOrderedFixedList<int> list(K);
+      for (int i = 0; i < n_values; ++i) {
+        list.AddPerhaps(values[i], &objects[i]);
+      }
+      list_sum += list.S.front().first;
+    }
+    double list_time = GetCPU() - start_time;
+    printf("%d %f %f\n", K, heap_time, list_time);
+
+    // both keep the same values, in the same order
+    OrderedFixedList<int> heap_list(K);
+    ListOrderedFixedList<int> list(K);
+    for (int i = 0; i < n_values; ++i) {
+      heap_list.AddPerhaps(values[i], &objects[i]);
+      list.AddPerhaps(values[i], &objects[i]);
+    }
+    std::list<std::pair<real, int*> >::iterator it = list.S.begin();
+    for (OrderedFixedList<int>::iterator h = heap_list.begin();
+         h != heap_list.end(); ++h, ++it) {
+      if (h->first != it->first || h->second != it->second) {
+        fprintf(stderr, "K = %d: %f != %f\n", K, h->first, it->first);
+        errors++;
+        break;
+      }
+    }
+    if (heap_sum != list_sum || heap_list.size() != K) {
+      errors++;
+    }
+  }
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -55,13 +55,13 @@ bool TestList(int N, int K) {
   }
   X.sort();
   list<real>::iterator it;
-  list<pair<real, int*> >::iterator oit;
+  OrderedFixedList<int>::iterator oit;
 
   it = X.begin();
-  oit = L.S.begin();
+  oit = L.begin();
   bool flag = true;
   for (int i = 0; i < K; ++i, ++it, ++oit) {
-    if (it == X.end() || oit == L.S.end()) {
+    if (it == X.end() || oit == L.end()) {
       break;
     }
     if (*it != oit->first) {
@@ -72,7 +72,7 @@ bool TestList(int N, int K) {
 
   if (!flag) {
     it = X.begin();
-    oit = L.S.begin();
+    oit = L.begin();
     for (int i = 0; i < K; ++i, ++it, ++oit) {
       real x = *it;
       real y = *it;
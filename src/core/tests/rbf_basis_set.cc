@@ -0,0 +1,120 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Compare RBFBasisSet with evaluating one RBF object per center, for
+    single points and for a matrix of points.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <vector>
+#include "BasisSet.h"
+#include "EasyClock.h"
+#include "Random.h"
+
+int main(int argc, char** argv) {
+  int n_dimensions = 4;
+  int n_centers = 500;
+  int n_points = 2000;
+  int errors = 0;
+
+  RBFBasisSet basis;
+  std::vector<RBF*> rbfs(n_centers);
+  for (int i = 0; i < n_centers; ++i) {
+    Vector c(n_dimensions);
+    Vector b(n_dimensions);
+    for (int j = 0; j < n_dimensions; ++j) {
+      c(j) = urandom();
+      b(j) = 0.1 + urandom();
+    }
+    if (i % 2) {
+      basis.AddCenter(c, b);
+      rbfs[i] = new RBF(c, b);
+    } else {
+      basis.AddCenter(c, b(0));
+      rbfs[i] = new RBF(c, b(0));
+    }
+  }
+  Matrix X(n_points, n_dimensions);
+  for (int t = 0; t < n_points; ++t) {
+    for (int j = 0; j < n_dimensions; ++j) {
+      X(t, j) = urandom();
+    }
+  }
+
+  // one RBF object per center
+  Matrix Phi_rbf(n_points, n_centers);
+  double start_time = GetCPU();
+  for (int t = 0; t < n_points; ++t) {
+    Vector x = X.getRow(t);
+    for (int i = 0; i < n_centers; ++i) {
+      Phi_rbf(t, i) = rbfs[i]->Evaluate(x);
+    }
+  }
+  double rbf_time = GetCPU() - start_time;
+
+  // one point at a time
+  Matrix Phi(n_points, n_centers);
+  start_time = GetCPU();
+  for (int t = 0; t < n_points; ++t) {
+    basis.Evaluate(X.getRow(t));
+    for (int i = 0; i < n_centers; ++i) {
+      Phi(t, i) = basis.F(i);
+    }
+  }
+  double basis_time = GetCPU() - start_time;
+
+  // all points at once
+  Matrix Phi_batch;
+  start_time = GetCPU();
+  basis.Evaluate(X, Phi_batch);
+  double batch_time = GetCPU() - start_time;
+
+  for (int t = 0; t < n_points; ++t) {
+    for (int i = 0; i < n_centers; ++i) {
+      if (fabs(Phi(t, i) - Phi_rbf(t, i)) > 1e-12 ||
+          fabs(Phi_batch(t, i) - Phi_rbf(t, i)) > 1e-12) {
+        fprintf(stderr, "feature %d of point %d: %f %f != %f\n", i, t,
+                Phi(t, i), Phi_batch(t, i), Phi_rbf(t, i));
+        errors++;
+      }
+    }
+  }
+
+  // the normalised log features use the same distances
+  Vector x = X.getRow(0);
+  basis.logEvaluate(x);
+  real log_sum = LOG_ZERO;
+  for (int i = 0; i < n_centers; ++i) {
+    log_sum = logAdd(log_sum, rbfs[i]->logEvaluate(x));
+  }
+  for (int i = 0; i < n_centers; ++i) {
+    if (fabs(basis.log_F(i) - (rbfs[i]->logEvaluate(x) - log_sum)) > 1e-9) {
+      fprintf(stderr, "log feature %d: %f\n", i, basis.log_F(i));
+      errors++;
+    }
+  }
+
+  printf("%d points, %d centers: RBF objects %f s, basis set %f s, ",
+         n_points, n_centers, rbf_time, basis_time);
+  printf("batch %f s\n", batch_time);
+  for (int i = 0; i < n_centers; ++i) {
+    delete rbfs[i];
+  }
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
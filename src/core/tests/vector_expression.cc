@@ -0,0 +1,130 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include "EasyClock.h"
+#include "Matrix.h"
+#include "Vector.h"
+
+static int Check(const char* name, real a, real b) {
+  if (fabs(a - b) > 1e-9 * (1.0 + fabs(b))) {
+    fprintf(stderr, "%s: %f != %f\n", name, a, b);
+    return 1;
+  }
+  return 0;
+}
+
+int main() {
+  int errors = 0;
+  int n = 16;
+  Vector x(n);
+  Vector center(n);
+  Vector beta(n);
+  for (int i = 0; i < n; ++i) {
+    x(i) = 0.1 * i;
+    center(i) = 0.5 - 0.03 * i;
+    beta(i) = 1.0 + 0.2 * i;
+  }
+
+  // element-wise expressions against explicit loops
+  Vector d = pow((x - center) / beta, 2.0);
+  Vector e = exp(-d) * 2.0 + x;
+  Vector f = 3.0 * x - center / 2.0;
+  Vector g = -x + 1.0;
+  for (int i = 0; i < n; ++i) {
+    real di = (x(i) - center(i)) / beta(i);
+    di = di * di;
+    errors += Check("pow", d(i), di);
+    errors += Check("exp", e(i), exp(-di) * 2.0 + x(i));
+    errors += Check("scalar", f(i), 3.0 * x(i) - center(i) / 2.0);
+    errors += Check("negate", g(i), 1.0 - x(i));
+  }
+  errors += Check("norm", (x - center).SquareNorm(),
+                  Vector(x - center).SquareNorm());
+
+  // in-place operations and self-reference
+  Vector y(x);
+  y += x * 2.0;
+  y = y - center;
+  y -= (x - center);
+  for (int i = 0; i < n; ++i) {
+    errors += Check("in place", y(i), 2.0 * x(i));
+  }
+
+  // matrices, including expressions with transposed views of themselves
+  Matrix A(3, 3);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      A(i, j) = i * 3 + j;
+    }
+  }
+  Matrix B = A * 2.0 - A + 1.0;
+  Matrix C(A);
+  C = C + Transpose(C);
+  Matrix D = 0.5 * (A - B) / 2.0;
+  Matrix E = A * B;
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      errors += Check("matrix scalar", B(i, j), A(i, j) + 1.0);
+      errors += Check("matrix alias", C(i, j), A(i, j) + A(j, i));
+      errors += Check("matrix chain", D(i, j), -0.25);
+      real sum = 0.0;
+      for (int k = 0; k < 3; ++k) {
+        sum += A(i, k) * B(k, j);
+      }
+      errors += Check("matrix product", E(i, j), sum);
+    }
+  }
+
+  // time a chained expression against its eager equivalent
+  int m = 64;
+  int T = 100000;
+  Vector u(m);
+  Vector c(m);
+  Vector b(m);
+  for (int i = 0; i < m; ++i) {
+    u(i) = 0.01 * i;
+    c(i) = 0.3;
+    b(i) = 2.0;
+  }
+  real total = 0.0;
+  double start_time = GetCPU();
+  for (int t = 0; t < T; ++t) {
+    Vector z = pow((u - c) / b, 2.0);
+    total += z(t % m);
+  }
+  double lazy_time = GetCPU() - start_time;
+  start_time = GetCPU();
+  for (int t = 0; t < T; ++t) {
+    Vector z1 = u;
+    z1 -= c;
+    Vector z2 = z1;
+    z2 /= b;
+    Vector z(m);
+    for (int i = 0; i < m; ++i) {
+      z(i) = pow(z2(i), 2.0);
+    }
+    total -= z(t % m);
+  }
+  double eager_time = GetCPU() - start_time;
+  errors += Check("timing", total, 0.0);
+  printf("expression: %f s, with temporaries: %f s\n", lazy_time, eager_time);
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -0,0 +1,136 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <vector>
+#include "EasyClock.h"
+#include "KDTree.h"
+#include "Random.h"
+#include "Vector.h"
+#include "VectorArena.h"
+
+/// Check that v is 0, 1, ..., n - 1
+static int CheckCount(const char* name, const Vector& v, int n) {
+  if (v.Size() != n) {
+    fprintf(stderr, "%s: size %d != %d\n", name, v.Size(), n);
+    return 1;
+  }
+  for (int i = 0; i < n; ++i) {
+    if (v(i) != (real)i) {
+      fprintf(stderr, "%s: v(%d) = %f\n", name, i, v(i));
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/// Grow a vector one element at a time, then copy and shrink it
+static int CheckStorage(const char* name) {
+  int errors = 0;
+  Vector v;
+  for (int i = 0; i < 3 * VECTOR_INLINE_SIZE; ++i) {
+    v.AddElement((real)i);
+    errors += CheckCount(name, v, i + 1);
+    Vector w(v);
+    errors += CheckCount(name, w, i + 1);
+    Vector z(2);
+    z = w;
+    errors += CheckCount(name, z, i + 1);
+  }
+  v.Resize(2);
+  errors += CheckCount(name, v, 2);
+  v.Resize(VECTOR_INLINE_SIZE + 2);
+  for (int i = 2; i < v.Size(); ++i) {
+    v(i) = (real)i;
+  }
+  errors += CheckCount(name, v, VECTOR_INLINE_SIZE + 2);
+
+  std::vector<Vector> list;
+  for (int i = 0; i < 100; ++i) {
+    list.push_back(Vector(1 + i % (2 * VECTOR_INLINE_SIZE)));
+    list.back() += 1.0;
+  }
+  for (int i = 0; i < 100; ++i) {
+    if (list[i].Sum() != (real)(1 + i % (2 * VECTOR_INLINE_SIZE))) {
+      fprintf(stderr, "%s: wrong copy in list\n", name);
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main() {
+  int errors = 0;
+  errors += CheckStorage("heap");
+  {
+    VectorArena arena(16);
+    VectorArena::Scope scope(arena);
+    errors += CheckStorage("arena");
+    {
+      VectorArena inner;
+      VectorArena::Scope inner_scope(inner);
+      Vector v(100);
+      if (VectorArena::Current() != &inner) {
+        errors++;
+      }
+    }
+    if (VectorArena::Current() != &arena) {
+      fprintf(stderr, "scopes not restored\n");
+      errors++;
+    }
+  }
+  if (VectorArena::Current() != NULL) {
+    fprintf(stderr, "scopes not restored\n");
+    errors++;
+  }
+
+  // a tree whose nodes are allocated in its arena
+  int n_dimensions = 8;
+  int n_points = 1000;
+  std::vector<Vector> X(n_points);
+  KDTree<Vector> tree(n_dimensions);
+  for (int i = 0; i < n_points; ++i) {
+    X[i] = Vector(n_dimensions);
+    for (int j = 0; j < n_dimensions; ++j) {
+      X[i](j) = urandom();
+    }
+    tree.AddVectorObject(X[i], &X[i]);
+  }
+  for (int i = 0; i < n_points; i += 10) {
+    if (tree.FindNearestObject(X[i]) != &X[i]) {
+      fprintf(stderr, "wrong nearest neighbour\n");
+      errors++;
+    }
+  }
+
+  // copies of small states, as done by environments and rollouts
+  int T = 1000000;
+  Vector state(4);
+  real sum = 0.0;
+  double start_time = GetCPU();
+  for (int t = 0; t < T; ++t) {
+    state(t % 4) += 1.0;
+    Vector copy(state);
+    sum += copy(0);
+  }
+  printf("%d copies of a 4-dimensional vector: %f s\n", T,
+         GetCPU() - start_time);
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
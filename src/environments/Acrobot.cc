@@ -12,6 +12,7 @@
 #include "Acrobot.h"
 #include "MersenneTwister.h"
 #include "Random.h"
+#include "RandomNumberGenerator.h"
 #include "RandomSourceRNG.h"
 
 Acrobot::Parameters Acrobot::default_parameters = {
@@ -101,13 +102,6 @@ bool Acrobot::Act(const int& action) {
 
 void Acrobot::Simulate(const int action) {
   real torque = action - 1.0;
-  real d1;
-  real d2;
-  real phi_2;
-  real phi_1;
-
-  real theta2_ddot;
-  real theta1_ddot;
 
   // torque is in [-1,1]
   // We'll make noise equal to at most +/- 1
@@ -115,81 +109,104 @@ void Acrobot::Simulate(const int action) {
 
   torque += theNoise;
 
-  int count = 0;
-  while (!endsim && count < 4) {
-    count++;
+  if (Step(state[0], state[1], state[2], state[3], torque)) {
+    endsim = true;
+    reward = 0;
+  } else {
+    endsim = false;
+    reward = -1;
+  }
+}
 
+/// Advance the arms, returning true if the feet reach the goal height
+bool Acrobot::Step(real& theta1, real& theta2, real& theta1Dot,
+                   real& theta2Dot, real torque) const {
+  real d1;
+  real d2;
+  real phi_2;
+  real phi_1;
+
+  real theta2_ddot;
+  real theta1_ddot;
+
+  for (int count = 0; count < 4; ++count) {
     d1 =
         parameters.m1 * pow(parameters.lc1, 2.0) +
         parameters.m2 * (pow(parameters.l1, 2.0) + pow(parameters.lc2, 2.0) +
-                         2.0 * parameters.l1 * parameters.lc2 * cos(state[1])) +
+                         2.0 * parameters.l1 * parameters.lc2 * cos(theta2)) +
         parameters.I1 + parameters.I2;
     d2 = parameters.m2 * (pow(parameters.lc2, 2.0) +
-                          parameters.l1 * parameters.lc2 * cos(state[1])) +
+                          parameters.l1 * parameters.lc2 * cos(theta2)) +
          parameters.I2;
 
     phi_2 = parameters.m2 * parameters.lc2 * parameters.g *
-            cos(state[0] + state[1] - M_PI / 2.0);
+            cos(theta1 + theta2 - M_PI / 2.0);
     phi_1 = -(parameters.m2 * parameters.l1 * parameters.lc2 *
-                  pow(state[3], 2.0) * sin(state[1]) -
-              2.0 * parameters.m2 * parameters.l1 * parameters.lc2 * state[2] *
-                  state[3] * sin(state[1])) +
+                  pow(theta2Dot, 2.0) * sin(theta2) -
+              2.0 * parameters.m2 * parameters.l1 * parameters.lc2 * theta1Dot *
+                  theta2Dot * sin(theta2)) +
             (parameters.m1 * parameters.lc1 + parameters.m2 * parameters.l1) *
-                parameters.g * cos(state[0] - M_PI / 2.0) +
+                parameters.g * cos(theta1 - M_PI / 2.0) +
             phi_2;
 
     theta2_ddot = (torque + (d2 / d1) * phi_1 -
                    parameters.m2 * parameters.l1 * parameters.lc2 *
-                       pow(state[2], 2.0) * sin(state[1]) -
+                       pow(theta1Dot, 2.0) * sin(theta2) -
                    phi_2) /
                   (parameters.m2 * pow(parameters.lc2, 2.0) + parameters.I2 -
                    pow(d2, 2.0) / d1);
     theta1_ddot = -(d2 * theta2_ddot + phi_1) / d1;
 
-    state[2] += theta1_ddot * parameters.dt;
-    state[3] += theta2_ddot * parameters.dt;
+    theta1Dot += theta1_ddot * parameters.dt;
+    theta2Dot += theta2_ddot * parameters.dt;
 
-    state[0] += state[2] * parameters.dt;
-    state[1] += state[3] * parameters.dt;
+    theta1 += theta1Dot * parameters.dt;
+    theta2 += theta2Dot * parameters.dt;
   }
-  if (abs(state[2]) > parameters.maxTheta1Dot) {
-    state[2] = signum(state[2]) * parameters.maxTheta1Dot;
+  if (abs(theta1Dot) > parameters.maxTheta1Dot) {
+    theta1Dot = signum(theta1Dot) * parameters.maxTheta1Dot;
   }
 
-  if (abs(state[3]) > parameters.maxTheta2Dot) {
-    state[3] = signum(state[3]) * parameters.maxTheta2Dot;
+  if (abs(theta2Dot) > parameters.maxTheta2Dot) {
+    theta2Dot = signum(theta2Dot) * parameters.maxTheta2Dot;
   }
   /* Put a hard constraint on the Acrobot physics, thetas MUST be in [-PI,+PI]
    * if they reach a top then angular velocity becomes zero
    */
-  if (abs(state[1]) > M_PI) {
-    state[1] = signum(state[1]) * M_PI;
-    state[3] = 0;
+  if (abs(theta2) > M_PI) {
+    theta2 = signum(theta2) * M_PI;
+    theta2Dot = 0;
   }
-  if (abs(state[0]) > M_PI) {
-    state[0] = signum(state[0]) * M_PI;
-    state[2] = 0;
+  if (abs(theta1) > M_PI) {
+    theta1 = signum(theta1) * M_PI;
+    theta1Dot = 0;
   }
 
-  real feet_height =
-      -(parameters.l1 * cos(state[0]) + parameters.l2 * cos(state[1]));
-
-  real firstJointEndHeight = parameters.l1 * cos(state[0]);
+  real firstJointEndHeight = parameters.l1 * cos(theta1);
   // Second Joint height (relative to first joint)
-  real secondJointEndHeight =
-      parameters.l2 * sin(M_PI / 2 - state[0] - state[1]);
-  feet_height = -(firstJointEndHeight + secondJointEndHeight);
+  real secondJointEndHeight = parameters.l2 * sin(M_PI / 2 - theta1 - theta2);
+  real feet_height = -(firstJointEndHeight + secondJointEndHeight);
 
-  if (feet_height > parameters.acrobotGoalPosition) {
-    endsim = true;
-    reward = 0;
-  } else {
-    endsim = false;
-    reward = -1;
+  return (feet_height > parameters.acrobotGoalPosition);
+}
+
+bool Acrobot::SimulateBatch(real* const* x, const int* action, real* reward,
+                            char* endsim, int n,
+                            RandomNumberGenerator& rng) const {
+  for (int i = 0; i < n; ++i) {
+    if (endsim[i]) {
+      reward[i] = 0.0;
+      continue;
+    }
+    real torque = action[i] - 1.0;
+    torque += parameters.transitionNoise * 2.0 * (rng.uniform() - 0.5);
+    endsim[i] = Step(x[0][i], x[1][i], x[2][i], x[3][i], torque);
+    reward[i] = endsim[i] ? 0.0 : -1.0;
   }
+  return true;
 }
 
-real Acrobot::signum(const real& num) {
+real Acrobot::signum(const real& num) const {
   if (num == 0) {
     return 0.0;
   } else if (num > 0.0) {
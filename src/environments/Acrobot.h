@@ -48,7 +48,9 @@ class Acrobot : public Environment<Vector, int> {
   Vector state_action_lower_bound;
   Vector action_upper_bound;
   Vector action_lower_bound;
-  real signum(const real& num);
+  real signum(const real& num) const;
+  bool Step(real& theta1, real& theta2, real& theta1Dot, real& theta2Dot,
+            real torque) const;
 
  public:
   Acrobot(bool random_parameters = false);
@@ -56,6 +58,9 @@ class Acrobot : public Environment<Vector, int> {
   virtual void Reset();
   virtual bool Act(const int& action);
   virtual void Simulate(const int action);
+  virtual bool SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const;
   const Vector& StateUpperBound() const { return state_upper_bound; }
   const Vector& StateLowerBound() const { return state_lower_bound; }
   const Vector& StateActionUpperBound() const {
@@ -78,6 +83,7 @@ class Acrobot : public Environment<Vector, int> {
     parameters.transitionNoise = randomness;
   }
   virtual const char* Name() const { return "Acrobot"; }
+  virtual Acrobot* Clone() const { return new Acrobot(*this); }
   void Show() {
     printf("%f %f %f %f %f %f # params (Bike)\n", parameters.m1, parameters.m2,
            parameters.l1, parameters.l2, parameters.lc1, parameters.lc2);
@@ -94,6 +94,7 @@ class Bike : public Environment<Vector, int> {
     parameters.max_noise = randomness;
   }
   virtual const char* Name() const { return "Bike"; }
+  virtual Bike* Clone() const { return new Bike(*this); }
   void Show() {
     printf("%f %f %f %f %d %f # params (Bike)\n", parameters.R1, parameters.R2,
            parameters.R3, parameters.R_FACTOR, parameters.N0_STATES2,
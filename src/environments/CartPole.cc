@@ -11,6 +11,7 @@
 #include "CartPole.h"
 #include "MersenneTwister.h"
 #include "Random.h"
+#include "RandomNumberGenerator.h"
 #include "RandomSourceRNG.h"
 
 CartPole::Parameters CartPole::default_parameters = {9.8,  1.0,  0.1,  0.5,
@@ -102,13 +103,7 @@ bool CartPole::Act(const int& action) {
 }
 
 void CartPole::Simulate(const int action) {
-  real xacc;
-  real thetaacc;
-  real costheta;
-  real sintheta;
-  real temp;
   real force = 0.0;
-  ;
 
   switch (action) {
     case 0:
@@ -128,37 +123,60 @@ void CartPole::Simulate(const int action) {
   //	real thisNoise = 0.0;
   force += thisNoise;
 
-  costheta = cos(state[2]);
-  sintheta = sin(state[2]);
+  if (Step(state[0], state[1], state[2], state[3], force)) {
+    endsim = true;
+    reward = -1.0;
+  } else {
+    endsim = false;
+    reward = 1.0;
+  }
+}
+
+/// Advance the cart and pole, returning true if they are out of bounds
+bool CartPole::Step(real& x, real& x_dot, real& theta, real& theta_dot,
+                    real force) const {
+  real costheta = cos(theta);
+  real sintheta = sin(theta);
 
-  temp =
-      (force + POLEMASS_LENGTH * state[3] * state[3] * sintheta) / TOTAL_MASS;
-  thetaacc =
+  real temp =
+      (force + POLEMASS_LENGTH * theta_dot * theta_dot * sintheta) / TOTAL_MASS;
+  real thetaacc =
       (parameters.GRAVITY * sintheta - costheta * temp) /
       (parameters.LENGTH *
        (FOURTHIRDS - parameters.MASSPOLE * costheta * costheta / TOTAL_MASS));
 
-  xacc = temp - POLEMASS_LENGTH * thetaacc * costheta / TOTAL_MASS;
+  real xacc = temp - POLEMASS_LENGTH * thetaacc * costheta / TOTAL_MASS;
   /*** Update the four state variables, using Euler's method. ***/
-  state[0] += parameters.TAU * state[1];
-  state[1] += parameters.TAU * xacc;
-  state[2] += parameters.TAU * state[3];
-  state[3] += parameters.TAU * thetaacc;
+  x += parameters.TAU * x_dot;
+  x_dot += parameters.TAU * xacc;
+  theta += parameters.TAU * theta_dot;
+  theta_dot += parameters.TAU * thetaacc;
 
   /**These probably never happen because the pole would crash **/
-  while (state[2] >= M_PI) {
-    state[2] -= 2.0 * M_PI;
+  while (theta >= M_PI) {
+    theta -= 2.0 * M_PI;
   }
-  while (state[2] < -M_PI) {
-    state[2] += 2.0 * M_PI;
+  while (theta < -M_PI) {
+    theta += 2.0 * M_PI;
   }
 
-  if (state[0] < state_lower_bound[0] || state[0] > state_upper_bound[0] ||
-      state[2] < state_lower_bound[2] || state[2] > state_upper_bound[2]) {
-    endsim = true;
-    reward = -1.0;
-  } else {
-    endsim = false;
-    reward = 1.0;
+  return (x < state_lower_bound[0] || x > state_upper_bound[0] ||
+          theta < state_lower_bound[2] || theta > state_upper_bound[2]);
+}
+
+bool CartPole::SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const {
+  for (int i = 0; i < n; ++i) {
+    if (endsim[i]) {
+      reward[i] = 0.0;
+      continue;
+    }
+    real force = (real)(action[i] - 1) * parameters.FORCE_MAG;
+    force +=
+        2.0 * parameters.noise * parameters.FORCE_MAG * (rng.uniform() - 0.5);
+    endsim[i] = Step(x[0][i], x[1][i], x[2][i], x[3][i], force);
+    reward[i] = endsim[i] ? -1.0 : 1.0;
   }
+  return true;
 }
@@ -40,6 +40,8 @@ class CartPole : public Environment<Vector, int> {
   void Simulate();
   void penddot(Vector& xdot, real u, Vector& x);
   void pendulum_simulate(int action);
+  bool Step(real& x, real& x_dot, real& theta, real& theta_dot,
+            real force) const;
 
  public:
   CartPole(bool random_parameters = false);
@@ -47,7 +49,11 @@ class CartPole : public Environment<Vector, int> {
   virtual void Reset();
   virtual bool Act(const int& action);
   virtual void Simulate(const int action);
+  virtual bool SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const;
   virtual const char* Name() const { return "Cart Pole RL"; }
+  virtual CartPole* Clone() const { return new CartPole(*this); }
   const Vector& StateUpperBound() const { return state_upper_bound; }
   const Vector& StateLowerBound() const { return state_lower_bound; }
   const Vector& StateActionUpperBound() const {
@@ -16,6 +16,8 @@
 
 #include "MDP.h"
 #include "Vector.h"
+
+class RandomNumberGenerator;
 /**
    \defgroup EnvironmentGroup Environments
  */
@@ -76,6 +78,33 @@ class Environment {
 
   virtual const char* Name() const { return "Undefined environment name"; }
 
+  /// Return a copy of the environment, including its state, that can
+  /// be simulated independently, e.g. in another thread. The copy is
+  /// required to be freed by the user!
+  virtual Environment<S, A>* Clone() const {
+    Serror("Not implemented\n");
+    exit(-1);
+    return NULL;
+  }
+
+  /** Simulate one step of n copies of the environment at once.
+
+      Copy i is in the state (x[0][i], x[1][i], ...), with one array
+      per state dimension, and takes action[i]. The states are
+      advanced in place, and the reward and whether the copy reached
+      an absorbing state are written to reward[i] and endsim[i].
+      Copies with endsim[i] already set are not simulated, and get a
+      zero reward, as with Act(). Noise is drawn from rng.
+
+      Returns false, without changing anything, if the environment
+      has no batched dynamics. Calling it with n = 0 only checks that.
+   */
+  virtual bool SimulateBatch(real* const* x, const A* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const {
+    return false;
+  }
+
   // --- The following functions are not supposed to be overwritten.. -- //
   /// returns a (reference to) the current state
   const S& getState() const { return state; }
@@ -0,0 +1,147 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "EnvironmentBatch.h"
+#include <algorithm>
+#include "ParallelFor.h"
+#include "RandomNumberGenerator.h"
+#include "SmartAssert.h"
+
+/// Make n_lanes copies of the environment, all in its current state
+EnvironmentBatch::EnvironmentBatch(
+    const ContinuousStateEnvironment& environment_, int n_lanes_, ulong seed)
+    : environment(environment_.Clone()),
+      n_lanes(n_lanes_),
+      n_threads(1) {
+  assert(n_lanes > 0);
+  n_states = environment->getState().Size();
+  n_chunks = (n_lanes + chunk_size - 1) / chunk_size;
+  states.resize(n_states * n_lanes);
+  rewards.resize(n_lanes, 0.0);
+  endsim.resize(n_lanes, 0);
+  CounterBasedRNG master(seed);
+  for (int c = 0; c < n_chunks; ++c) {
+    streams.push_back(master.Split(c));
+  }
+  chunk_states.resize(n_chunks * n_states);
+  for (int c = 0; c < n_chunks; ++c) {
+    for (int d = 0; d < n_states; ++d) {
+      chunk_states[c * n_states + d] = &states[d * n_lanes + c * chunk_size];
+    }
+  }
+  batched = HasBatchDynamics(*environment);
+  if (!batched) {
+    for (int i = 0; i < n_lanes; ++i) {
+      lanes.push_back(environment->Clone());
+    }
+  }
+  setState(environment->getState());
+}
+
+EnvironmentBatch::~EnvironmentBatch() {
+  for (uint i = 0; i < lanes.size(); ++i) {
+    delete lanes[i];
+  }
+  delete environment;
+}
+
+bool EnvironmentBatch::HasBatchDynamics(
+    const ContinuousStateEnvironment& environment) {
+  CounterBasedRNG rng;
+  return environment.SimulateBatch(NULL, NULL, NULL, NULL, 0, rng);
+}
+
+void EnvironmentBatch::setNumberOfThreads(int n_threads_) {
+  n_threads = ResolveNumberOfThreads(n_threads_);
+}
+
+/// Each chunk draws its start states from its own stream.
+void EnvironmentBatch::Reset() {
+  for (int c = 0; c < n_chunks; ++c) {
+    ScopedRandomNumberGenerator scope(&streams[c]);
+    int end = std::min((c + 1) * chunk_size, n_lanes);
+    for (int i = c * chunk_size; i < end; ++i) {
+      ContinuousStateEnvironment* lane = batched ? environment : lanes[i];
+      lane->Reset();
+      setState(i, lane->getState());
+    }
+  }
+}
+
+void EnvironmentBatch::setState(int lane, const Vector& state) {
+  assert(state.Size() == n_states);
+  for (int d = 0; d < n_states; ++d) {
+    states[d * n_lanes + lane] = state[d];
+  }
+  rewards[lane] = 0.0;
+  endsim[lane] = 0;
+}
+
+void EnvironmentBatch::setState(const Vector& state) {
+  for (int i = 0; i < n_lanes; ++i) {
+    setState(i, state);
+  }
+}
+
+Vector EnvironmentBatch::getState(int lane) const {
+  Vector state(n_states);
+  for (int d = 0; d < n_states; ++d) {
+    state[d] = states[d * n_lanes + lane];
+  }
+  return state;
+}
+
+int EnvironmentBatch::NRunning() const {
+  int n_running = 0;
+  for (int i = 0; i < n_lanes; ++i) {
+    if (!endsim[i]) {
+      n_running++;
+    }
+  }
+  return n_running;
+}
+
+/// Step the lanes of one chunk, with the stream of the chunk
+void EnvironmentBatch::ActChunk(int chunk, const int* action) {
+  int begin = chunk * chunk_size;
+  int end = std::min(begin + chunk_size, n_lanes);
+  if (batched) {
+    environment->SimulateBatch(&chunk_states[chunk * n_states], action + begin,
+                               &rewards[begin], &endsim[begin], end - begin,
+                               streams[chunk]);
+    return;
+  }
+  ScopedRandomNumberGenerator scope(&streams[chunk]);
+  for (int i = begin; i < end; ++i) {
+    if (endsim[i]) {
+      rewards[i] = 0.0;
+      continue;
+    }
+    ContinuousStateEnvironment* lane = lanes[i];
+    lane->setState(getState(i));
+    lane->setEndsim(false);
+    endsim[i] = !lane->Act(action[i]);
+    rewards[i] = lane->getReward();
+    const Vector& state = lane->getState();
+    for (int d = 0; d < n_states; ++d) {
+      states[d * n_lanes + i] = state[d];
+    }
+  }
+}
+
+bool EnvironmentBatch::Act(const int* action) {
+  ParallelFor(n_chunks, n_threads, [&](int block, int begin, int end) {
+    for (int c = begin; c < end; ++c) {
+      ActChunk(c, action);
+    }
+  });
+  return NRunning() > 0;
+}
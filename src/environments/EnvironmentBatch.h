@@ -0,0 +1,105 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ENVIRONMENT_BATCH_H
+#define ENVIRONMENT_BATCH_H
+
+#include <vector>
+#include "CounterBasedRNG.h"
+#include "Environment.h"
+#include "Vector.h"
+#include "real.h"
+
+/**
+   \ingroup EnvironmentGroup
+ */
+/*@{*/
+
+/** A batch of copies of a continuous state environment, simulated in
+    lockstep.
+
+    Each copy is a lane of the batch. The states of the lanes are kept
+    with one array per state dimension, and Act() advances all lanes
+    that have not reached an absorbing state by one step. A lane can
+    also be stopped before that, e.g. at the end of a rollout.
+
+    Environments that implement SimulateBatch() are stepped through
+    it, without any virtual calls per lane. Other environments are
+    stepped through Act() on one clone per lane, so they must
+    implement Clone(). Code that only wants a batch when it is cheap
+    should check HasBatchDynamics() first.
+
+    The lanes are split into chunks of chunk_size lanes, and each
+    chunk draws its noise from its own random number stream, split
+    from the seed. The chunks are shared among threads, so that the
+    results only depend on the seed, and not on the number of threads.
+ */
+class EnvironmentBatch {
+ public:
+  static const int chunk_size = 64;  ///< lanes per random number stream
+
+ protected:
+  ContinuousStateEnvironment* environment;  ///< a copy, for Reset()
+  int n_lanes;                              ///< number of lanes
+  int n_states;                             ///< state dimension
+  int n_chunks;                             ///< number of chunks
+  int n_threads;                            ///< threads used by Act()
+  bool batched;  ///< whether the environment has SimulateBatch()
+  std::vector<real> states;   ///< dimension d of lane i at d * n_lanes + i
+  std::vector<real> rewards;  ///< reward of the last step, per lane
+  std::vector<char> endsim;   ///< whether the lane has stopped
+  std::vector<CounterBasedRNG> streams;  ///< one per chunk
+  std::vector<ContinuousStateEnvironment*> lanes;  ///< clones, if !batched
+  std::vector<real*> chunk_states;  ///< the state arrays of each chunk
+  void ActChunk(int chunk, const int* action);
+
+ public:
+  EnvironmentBatch(const ContinuousStateEnvironment& environment_,
+                   int n_lanes_, ulong seed = 0);
+  ~EnvironmentBatch();
+  /// Whether the environment implements SimulateBatch()
+  static bool HasBatchDynamics(const ContinuousStateEnvironment& environment);
+  /// Use n_threads threads in Act(), or all hardware threads if n_threads <= 0
+  void setNumberOfThreads(int n_threads_);
+  /// The number of lanes
+  int getNLanes() const { return n_lanes; }
+  /// The state dimension
+  int getNStates() const { return n_states; }
+  /// Whether lanes are stepped by the batched dynamics of the environment
+  bool isBatched() const { return batched; }
+  /// Put every lane in a state drawn from the start distribution
+  void Reset();
+  /// Put a lane in the given state, and start it again
+  void setState(int lane, const Vector& state);
+  /// Put every lane in the given state, and start them again
+  void setState(const Vector& state);
+  /// The state of a lane
+  Vector getState(int lane) const;
+  /// Dimension d of the states of all lanes
+  const real* getStates(int d) const { return &states[d * n_lanes]; }
+  /// The reward of a lane in the last step
+  real getReward(int lane) const { return rewards[lane]; }
+  /// Whether a lane has reached an absorbing state, or was stopped
+  bool getEndsim(int lane) const { return endsim[lane] != 0; }
+  /// Stop simulating a lane, as if it was in an absorbing state
+  void Stop(int lane) { endsim[lane] = 1; }
+  /// The number of lanes that have not stopped
+  int NRunning() const;
+  /// Take action[i] in lane i, for all lanes, and return whether any
+  /// lane is still running
+  bool Act(const int* action);
+  /// Take action[i] in lane i, for all lanes
+  bool Act(const std::vector<int>& action) { return Act(&action[0]); }
+};
+
+/*@}*/
+
+#endif
@@ -14,6 +14,7 @@
 
 #include "MountainCar.h"
 #include "Random.h"
+#include "RandomNumberGenerator.h"
 #include "RandomSourceRNG.h"
 
 MountainCar::Parameters MountainCar::default_parameters = {
@@ -120,31 +121,53 @@ void MountainCar::Simulate(const int action) {
   real noise = urandom(-parameters.MCNOISE, parameters.MCNOISE);
   input += noise;
 
-  state[1] = state[1] + parameters.INPUT * input -
-             parameters.GRAVITY * cos(3.0 * state[0]);
-  if (state[1] > parameters.U_VEL) {
-    state[1] = parameters.U_VEL;
-  }
-  if (state[1] < parameters.L_VEL) {
-    state[1] = parameters.L_VEL;
+  endsim = Step(state[0], state[1], input);
+  if (endsim) {
+    reward = 0.0;
+  } else {
+    reward = -1;
   }
 
-  state[0] = state[0] + state[1];
-  if (state[0] > parameters.U_POS) {
-    state[0] = parameters.U_POS;
+  return;
+}
+
+/// Advance the car under the given input, returning true at the goal
+bool MountainCar::Step(real& position, real& velocity, real input) const {
+  velocity = velocity + parameters.INPUT * input -
+             parameters.GRAVITY * cos(3.0 * position);
+  if (velocity > parameters.U_VEL) {
+    velocity = parameters.U_VEL;
   }
-  if (state[0] < parameters.L_POS) {
-    state[0] = parameters.L_POS + 0.01;
-    state[1] = 0.01;
+  if (velocity < parameters.L_VEL) {
+    velocity = parameters.L_VEL;
   }
 
-  if (state[0] == parameters.U_POS) {
-    reward = 0.0;
-    endsim = true;
-  } else {
-    reward = -1;
-    endsim = false;
+  position = position + velocity;
+  if (position > parameters.U_POS) {
+    position = parameters.U_POS;
+  }
+  if (position < parameters.L_POS) {
+    position = parameters.L_POS + 0.01;
+    velocity = 0.01;
   }
+  return (position == parameters.U_POS);
+}
 
-  return;
+bool MountainCar::SimulateBatch(real* const* x, const int* action,
+                                real* reward, char* endsim, int n,
+                                RandomNumberGenerator& rng) const {
+  for (int i = 0; i < n; ++i) {
+    if (endsim[i]) {
+      reward[i] = 0.0;
+      continue;
+    }
+    if (action[i] < 0 || action[i] > 2) {
+      Serror("Undefined action %d\n", action[i]);
+    }
+    real input = (real)(action[i] - 1);
+    input += -parameters.MCNOISE + 2.0 * parameters.MCNOISE * rng.uniform();
+    endsim[i] = Step(x[0][i], x[1][i], input);
+    reward[i] = endsim[i] ? 0.0 : -1.0;
+  }
+  return true;
 }
@@ -39,6 +39,7 @@ class MountainCar : public Environment<Vector, int> {
   Vector action_upper_bound;
   Vector action_lower_bound;
   void Simulate();
+  bool Step(real& position, real& velocity, real input) const;
 
  public:
   MountainCar(bool random_parameters = false);
@@ -46,6 +47,9 @@ class MountainCar : public Environment<Vector, int> {
   virtual void Reset();
   virtual bool Act(const int& action);
   virtual void Simulate(const int action);
+  virtual bool SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const;
 
   const Vector& StateActionUpperBound() const {
     return state_action_upper_bound;
@@ -61,6 +65,7 @@ class MountainCar : public Environment<Vector, int> {
   }
 
   virtual const char* Name() const { return "Mountain Car"; }
+  virtual MountainCar* Clone() const { return new MountainCar(*this); }
 
   void Show() {
     printf("%f %f %f %f %f %f %f # params (MountainCar)\n", parameters.U_POS,
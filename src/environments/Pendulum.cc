@@ -15,6 +15,7 @@
 #include "Pendulum.h"
 #include "MersenneTwister.h"
 #include "Random.h"
+#include "RandomNumberGenerator.h"
 #include "RandomSourceRNG.h"
 
 Pendulum::Parameters Pendulum::default_parameters = {
@@ -90,19 +91,19 @@ void Pendulum::Reset() {
   endsim = false;
 }
 
-void Pendulum::penddot(Vector& xdot, real u, Vector& x) {
+/// The angular acceleration of the pendulum
+real Pendulum::penddot(real theta, real theta_dot, real u) const {
   // Nonlinear model
 
-  double cx = cos(x[0]);
-  real dtheta2 = x[1] * x[1];
-  xdot[0] = x[1];
-  xdot[1] =
-      (parameters.gravity * sin(x[0]) -
-       0.5 * CCa * parameters.pendulum_mass * parameters.pendulum_length *
-           dtheta2 * sin(2.0 * x[0]) -
-       CCa * cos(x[0]) * u) /
-      (4.0 / 3.0 * parameters.pendulum_length -
-       CCa * parameters.pendulum_mass * parameters.pendulum_length * cx * cx);
+  double cx = cos(theta);
+  real dtheta2 = theta_dot * theta_dot;
+  return (parameters.gravity * sin(theta) -
+          0.5 * CCa * parameters.pendulum_mass * parameters.pendulum_length *
+              dtheta2 * sin(2.0 * theta) -
+          CCa * cos(theta) * u) /
+         (4.0 / 3.0 * parameters.pendulum_length -
+          CCa * parameters.pendulum_mass * parameters.pendulum_length * cx *
+              cx);
 }
 
 bool Pendulum::Act(const int& action) {
@@ -122,8 +123,7 @@ bool Pendulum::Act(const int& action) {
 }
 
 void Pendulum::Simulate(const int action) {
-  Vector xdot(2);
-  real input = 0.0, noise, t;
+  real input = 0.0, noise;
 
   // printf ("# s: %f %f, a: %d\n", state[0], state[1], action);
   switch (action) {
@@ -141,15 +141,7 @@ void Pendulum::Simulate(const int action) {
   noise = urandom(-parameters.max_noise, parameters.max_noise);
   input += noise;
 
-  // Simulate for 0.1 seconds
-  for (t = 0.0; t <= 0.1; t += parameters.Dt) {
-    penddot(xdot, input, state);
-
-    state[0] += xdot[0] * parameters.Dt;
-    state[1] += xdot[1] * parameters.Dt;
-  }
-
-  if (fabs(state[0]) > M_PI / 2.0) {
+  if (Step(state[0], state[1], input)) {
     reward = -1.0;
     endsim = true;
   } else {
@@ -157,3 +149,37 @@ void Pendulum::Simulate(const int action) {
     endsim = false;
   }
 }
+
+/// Simulate for 0.1 seconds, returning true if the pendulum fell
+bool Pendulum::Step(real& theta, real& theta_dot, real input) const {
+  for (real t = 0.0; t <= 0.1; t += parameters.Dt) {
+    real theta_acc = penddot(theta, theta_dot, input);
+    theta += theta_dot * parameters.Dt;
+    theta_dot += theta_acc * parameters.Dt;
+  }
+  return (fabs(theta) > M_PI / 2.0);
+}
+
+bool Pendulum::SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const {
+  for (int i = 0; i < n; ++i) {
+    if (endsim[i]) {
+      reward[i] = 0.0;
+      continue;
+    }
+    real input = 0.0;
+    switch (action[i]) {
+      case 0:
+        input = -50.0;
+        break;
+      case 2:
+        input = +50.0;
+        break;
+    }
+    input += -parameters.max_noise + 2.0 * parameters.max_noise * rng.uniform();
+    endsim[i] = Step(x[0][i], x[1][i], input);
+    reward[i] = endsim[i] ? -1.0 : 0.0;
+  }
+  return true;
+}
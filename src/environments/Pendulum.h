@@ -39,7 +39,8 @@ class Pendulum : public Environment<Vector, int> {
   Vector action_upper_bound;
   Vector action_lower_bound;
   void Simulate();
-  void penddot(Vector& xdot, real u, Vector& x);
+  real penddot(real theta, real theta_dot, real u) const;
+  bool Step(real& theta, real& theta_dot, real input) const;
   void pendulum_simulate(int action);
 
  public:
@@ -48,6 +49,9 @@ class Pendulum : public Environment<Vector, int> {
   virtual void Reset();
   virtual bool Act(const int& action);
   virtual void Simulate(const int action);
+  virtual bool SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const;
   virtual void setRandomness(real w) { parameters.max_noise = w; }
   const Vector& StateUpperBound() const { return state_upper_bound; }
   const Vector& StateLowerBound() const { return state_lower_bound; }
@@ -73,6 +77,7 @@ class Pendulum : public Environment<Vector, int> {
     }
   }
   virtual const char* Name() const { return "Pendulum"; }
+  virtual Pendulum* Clone() const { return new Pendulum(*this); }
   void Show() {
     printf("%f %f %f %f %f %f # params (Pendulum)\n", parameters.pendulum_mass,
            parameters.cart_mass, parameters.pendulum_length, parameters.gravity,
@@ -13,6 +13,7 @@
 #include "PuddleWorld.h"
 #include "NormalDistribution.h"
 #include "Random.h"
+#include "RandomNumberGenerator.h"
 #include "RandomSourceRNG.h"
 
 // PuddleWorld::Parameters PuddleWorld::default_parameters =
@@ -102,79 +103,122 @@ bool PuddleWorld::Act(const int& action) {
 }
 
 void PuddleWorld::Simulate(const int action) {
-  Vector input(2);
+  // We add noise in the transition.
+  NormalDistribution R;
+  real noise_x = R.generate();
+  real noise_y = R.generate();
+
+  if (Step(state[0], state[1], action, noise_x, noise_y)) {
+    reward = 0.0;
+    endsim = true;
+  } else {
+    reward = PuddleReward(state[0], state[1]);
+    endsim = false;
+  }
+
+  return;
+}
+
+/// Move the agent, returning true if it reached the goal
+bool PuddleWorld::Step(real& x, real& y, int action, real noise_x,
+                       real noise_y) const {
+  real input_x = 0.0;
+  real input_y = 0.0;
 
   switch (action) {
     case 0:
-      input[0] = parameters.AGENTSPEED;
+      input_x = parameters.AGENTSPEED;
       break;
     case 1:
-      input[0] = -parameters.AGENTSPEED;
+      input_x = -parameters.AGENTSPEED;
       break;
     case 2:
-      input[1] = parameters.AGENTSPEED;
+      input_y = parameters.AGENTSPEED;
       break;
     case 3:
-      input[1] = -parameters.AGENTSPEED;
+      input_y = -parameters.AGENTSPEED;
       break;
     default:
       Serror("Undefined action %d\n", action);
   }
 
-  state = state + input;
+  x = x + input_x;
+  y = y + input_y;
 
-  // We add noise in the transition.
-  NormalDistribution R;
-  state[0] =
-      state[0] + (R.generate()) * parameters.MCNOISE * parameters.AGENTSPEED;
-  state[1] =
-      state[1] + (R.generate()) * parameters.MCNOISE * parameters.AGENTSPEED;
+  x = x + noise_x * parameters.MCNOISE * parameters.AGENTSPEED;
+  y = y + noise_y * parameters.MCNOISE * parameters.AGENTSPEED;
 
-  if (state[0] > parameters.U_POS_X) {
-    state[0] = parameters.U_POS_X;
+  if (x > parameters.U_POS_X) {
+    x = parameters.U_POS_X;
   }
-  if (state[0] < parameters.L_POS_X) {
-    state[0] = parameters.L_POS_X;
+  if (x < parameters.L_POS_X) {
+    x = parameters.L_POS_X;
   }
-  if (state[1] > parameters.U_POS_Y) {
-    state[1] = parameters.U_POS_Y;
+  if (y > parameters.U_POS_Y) {
+    y = parameters.U_POS_Y;
   }
-  if (state[1] < parameters.L_POS_Y) {
-    state[1] = parameters.L_POS_Y;
+  if (y < parameters.L_POS_Y) {
+    y = parameters.L_POS_Y;
   }
 
-  if (state[0] + state[1] >= 1.9) {
-    reward = 0.0;
-    endsim = true;
-  } else {
-    reward = -1.0;
-    for (int i = 0; i < parameters.NUMPUDDLES; i++) {
-      real distance = DistPointToPuddle(i);
-      if (distance < parameters.RADIUSPUDDLES[i])
-        reward += -400.0 * (parameters.RADIUSPUDDLES[i] - distance);
-    }
-    endsim = false;
+  return (x + y >= 1.9);
+}
+
+/// The reward away from the goal, with a penalty inside the puddles
+real PuddleWorld::PuddleReward(real x, real y) const {
+  real reward = -1.0;
+  for (int i = 0; i < parameters.NUMPUDDLES; i++) {
+    real distance = DistPointToPuddle(x, y, i);
+    if (distance < parameters.RADIUSPUDDLES[i])
+      reward += -400.0 * (parameters.RADIUSPUDDLES[i] - distance);
   }
+  return reward;
+}
 
-  return;
+bool PuddleWorld::SimulateBatch(real* const* x, const int* action,
+                                real* reward, char* endsim, int n,
+                                RandomNumberGenerator& rng) const {
+  ScopedRandomNumberGenerator scope(&rng);
+  for (int i = 0; i < n; ++i) {
+    if (endsim[i]) {
+      reward[i] = 0.0;
+      continue;
+    }
+    NormalDistribution R;
+    real noise_x = R.generate();
+    real noise_y = R.generate();
+    endsim[i] = Step(x[0][i], x[1][i], action[i], noise_x, noise_y);
+    reward[i] = endsim[i] ? 0.0 : PuddleReward(x[0][i], x[1][i]);
+  }
+  return true;
 }
 
 real PuddleWorld::DistPointToPuddle(const int puddle) const {
-  Vector P0 = parameters.U_POS_P.getRow(puddle);
-  Vector P1 = parameters.L_POS_P.getRow(puddle);
+  return DistPointToPuddle(state[0], state[1], puddle);
+}
 
-  Vector v = P1 - P0;
-  Vector w = state - P0;
+/// The distance of (x, y) to the segment of the puddle
+real PuddleWorld::DistPointToPuddle(real x, real y, const int puddle) const {
+  real P0_x = parameters.U_POS_P(puddle, 0);
+  real P0_y = parameters.U_POS_P(puddle, 1);
+  real v_x = parameters.L_POS_P(puddle, 0) - P0_x;
+  real v_y = parameters.L_POS_P(puddle, 1) - P0_y;
+  real w_x = x - P0_x;
+  real w_y = y - P0_y;
 
-  real c1 = Product(w, v);
+  real c1 = w_x * v_x + w_y * v_y;
   if (c1 <= 0) {
-    return (state - P0).L2Norm();
+    return sqrt(w_x * w_x + w_y * w_y);
   }
-  real c2 = Product(v, v);
+  real c2 = v_x * v_x + v_y * v_y;
   if (c2 <= c1) {
-    return (state - P1).L2Norm();
+    real d_x = x - parameters.L_POS_P(puddle, 0);
+    real d_y = y - parameters.L_POS_P(puddle, 1);
+    return sqrt(d_x * d_x + d_y * d_y);
   }
 
   real c = c1 / c2;
-  return (state - (P0 + v * c)).L2Norm();
+  real d_x = x - (P0_x + v_x * c);
+  real d_y = y - (P0_y + v_y * c);
+  return sqrt(d_x * d_x + d_y * d_y);
 }
@@ -68,6 +68,8 @@ class PuddleWorld : public Environment<Vector, int> {
     return p;
   };
   void Simulate();
+  bool Step(real& x, real& y, int action, real noise_x, real noise_y) const;
+  real PuddleReward(real x, real y) const;
 
  public:
   PuddleWorld(bool random_parameters = false);
@@ -75,7 +77,11 @@ class PuddleWorld : public Environment<Vector, int> {
   virtual void Reset();
   virtual bool Act(const int& action);
   virtual void Simulate(const int action);
+  virtual bool SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const;
   real DistPointToPuddle(const int puddle) const;
+  real DistPointToPuddle(real x, real y, const int puddle) const;
 
   Vector& StateActionUpperBound() { return state_action_upper_bound; }
   Vector& StateActionLowerBound() { return state_action_lower_bound; }
@@ -130,6 +136,7 @@ class PuddleWorld : public Environment<Vector, int> {
     }
   }
   virtual const char* Name() const { return "Puddle World"; }
+  virtual PuddleWorld* Clone() const { return new PuddleWorld(*this); }
 
   void Show() const {
     printf(
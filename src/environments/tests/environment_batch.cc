@@ -0,0 +1,154 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2014 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Check that an EnvironmentBatch follows the same trajectories as
+    separate copies of the environment, stepped one at a time with the
+    random number streams of the chunks of the batch, and that the
+    number of threads does not change the result.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <vector>
+#include "Acrobot.h"
+#include "CartPole.h"
+#include "EnvironmentBatch.h"
+#include "MountainCar.h"
+#include "Pendulum.h"
+#include "PuddleWorld.h"
+#include "RandomNumberGenerator.h"
+
+/// A mountain car without batched dynamics, stepped through its clones
+class UnbatchedMountainCar : public MountainCar {
+ public:
+  virtual bool SimulateBatch(real* const* x, const int* action, real* reward,
+                             char* endsim, int n,
+                             RandomNumberGenerator& rng) const {
+    return false;
+  }
+  virtual const char* Name() const { return "Unbatched Mountain Car"; }
+  virtual UnbatchedMountainCar* Clone() const {
+    return new UnbatchedMountainCar(*this);
+  }
+};
+
+/// The action of a lane at time t
+int LaneAction(int lane, int t, int n_actions) {
+  return ((lane + 1) * (t + 3) / 2) % n_actions;
+}
+
+/// Compare a batch with copies of the environment, returning the errors
+int TestBatch(const ContinuousStateEnvironment& environment, int n_lanes,
+              int n_steps, ulong seed) {
+  int errors = 0;
+  int n_actions = environment.getNActions();
+  EnvironmentBatch batch(environment, n_lanes, seed);
+  EnvironmentBatch threaded(environment, n_lanes, seed);
+  threaded.setNumberOfThreads(3);
+  batch.Reset();
+  threaded.Reset();
+
+  // The copies use the streams of the chunks, in the order of the lanes
+  CounterBasedRNG master(seed);
+  std::vector<CounterBasedRNG> streams;
+  for (int i = 0; i < n_lanes; i += EnvironmentBatch::chunk_size) {
+    streams.push_back(master.Split(i / EnvironmentBatch::chunk_size));
+  }
+  std::vector<ContinuousStateEnvironment*> copies;
+  for (int i = 0; i < n_lanes; ++i) {
+    ScopedRandomNumberGenerator scope(
+        &streams[i / EnvironmentBatch::chunk_size]);
+    copies.push_back(environment.Clone());
+    copies[i]->Reset();
+  }
+  std::vector<bool> running(n_lanes, true);
+
+  std::vector<int> action(n_lanes);
+  bool batch_running = true;
+  for (int t = 0; t < n_steps && batch_running; ++t) {
+    for (int i = 0; i < n_lanes; ++i) {
+      action[i] = LaneAction(i, t, n_actions);
+      // stop a few lanes early, as at the end of a rollout
+      if (t == n_steps / 2 && i % 5 == 0) {
+        batch.Stop(i);
+        threaded.Stop(i);
+        running[i] = false;
+      }
+    }
+    batch_running = batch.Act(action);
+    threaded.Act(action);
+    int n_running = 0;
+    for (int i = 0; i < n_lanes; ++i) {
+      real reward = 0.0;
+      if (running[i]) {
+        ScopedRandomNumberGenerator scope(
+            &streams[i / EnvironmentBatch::chunk_size]);
+        running[i] = copies[i]->Act(action[i]);
+        reward = copies[i]->getReward();
+      }
+      n_running += running[i];
+      Vector state = batch.getState(i);
+      Vector other = threaded.getState(i);
+      const Vector& expected = copies[i]->getState();
+      for (int d = 0; d < batch.getNStates(); ++d) {
+        if (state[d] != expected[d] || other[d] != expected[d]) {
+          errors++;
+        }
+      }
+      if (batch.getReward(i) != reward || threaded.getReward(i) != reward) {
+        errors++;
+      }
+      if (batch.getEndsim(i) == running[i] ||
+          threaded.getEndsim(i) == running[i]) {
+        errors++;
+      }
+    }
+    if (batch.NRunning() != n_running) {
+      errors++;
+    }
+  }
+
+  printf("%s: %s, %d of %d lanes running, %d errors\n", environment.Name(),
+         batch.isBatched() ? "batched" : "cloned", batch.NRunning(), n_lanes,
+         errors);
+  for (int i = 0; i < n_lanes; ++i) {
+    delete copies[i];
+  }
+  return errors;
+}
+
+int main(int argc, char** argv) {
+  int n_lanes = 150;
+  int n_steps = 100;
+  ulong seed = 20140901;
+  int errors = 0;
+
+  std::vector<ContinuousStateEnvironment*> environments;
+  environments.push_back(new MountainCar());
+  environments.push_back(new Pendulum());
+  environments.push_back(new CartPole());
+  environments.push_back(new Acrobot());
+  environments.push_back(new PuddleWorld());
+  environments.push_back(new UnbatchedMountainCar());
+  for (uint i = 0; i < environments.size(); ++i) {
+    errors += TestBatch(*environments[i], n_lanes, n_steps, seed);
+    delete environments[i];
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -0,0 +1,83 @@
+// -*- Mode: c++ -*-
+// copyright (c) 2013 by Christos Dimitrakakis
+// <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "CompiledDiscreteMDP.h"
+
+/// Create an empty snapshot, which is never current.
+CompiledDiscreteMDP::CompiledDiscreteMDP()
+    : n_states(0),
+      n_actions(0),
+      row_begin(1, 0),
+      transition_stamp(0),
+      reward_stamp(0) {}
+
+/// Create a snapshot of the mdp.
+CompiledDiscreteMDP::CompiledDiscreteMDP(const DiscreteMDP& mdp)
+    : transition_stamp(0), reward_stamp(0) {
+  Compile(mdp);
+}
+
+/// Rebuild the snapshot from scratch.
+void CompiledDiscreteMDP::Compile(const DiscreteMDP& mdp) {
+  n_states = mdp.getNStates();
+  n_actions = mdp.getNActions();
+  int N = n_states * n_actions;
+  row_begin.resize(N + 1);
+  expected_reward.resize(N);
+  next_state.clear();
+  probability.clear();
+  for (int s = 0; s < n_states; ++s) {
+    for (int a = 0; a < n_actions; ++a) {
+      int ID = getID(s, a);
+      row_begin[ID] = (int)next_state.size();
+      const DiscreteStateSet& next = mdp.getNextStates(s, a);
+      for (DiscreteStateSet::const_iterator i = next.begin(); i != next.end();
+           ++i) {
+        int s2 = *i;
+        real P = mdp.getTransitionProbability(s, a, s2);
+        if (P > 0) {
+          next_state.push_back(s2);
+          probability.push_back(P);
+        }
+      }
+      expected_reward[ID] = mdp.getExpectedReward(s, a);
+    }
+  }
+  row_begin[N] = (int)next_state.size();
+  transition_stamp = mdp.getTransitionStamp();
+  reward_stamp = mdp.getRewardStamp();
+}
+
+/** Bring the snapshot up to date with the mdp.
+
+    Only the parts of the snapshot that are stale are rebuilt: a change
+    in rewards alone does not cause the transitions to be recompiled.
+
+    \return true if anything had to be recompiled.
+ */
+bool CompiledDiscreteMDP::Synchronise(const DiscreteMDP& mdp) {
+  if (transition_stamp != mdp.getTransitionStamp() ||
+      n_states != mdp.getNStates() || n_actions != mdp.getNActions()) {
+    Compile(mdp);
+    return true;
+  }
+  if (reward_stamp != mdp.getRewardStamp()) {
+    for (int s = 0; s < n_states; ++s) {
+      for (int a = 0; a < n_actions; ++a) {
+        expected_reward[getID(s, a)] = mdp.getExpectedReward(s, a);
+      }
+    }
+    reward_stamp = mdp.getRewardStamp();
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,89 @@
+// -*- Mode: c++ -*-
+// copyright (c) 2013 by Christos Dimitrakakis
+// <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SRC_MODELS_COMPILEDDISCRETEMDP_H_
+#define SRC_MODELS_COMPILEDDISCRETEMDP_H_
+
+#include <vector>
+#include "DiscreteMDP.h"
+#include "real.h"
+
+/** A compiled, compressed sparse row snapshot of a DiscreteMDP.
+
+    For every state-action pair \f$(s,a)\f$, the next states with
+    non-zero probability and their probabilities are stored
+    contiguously in the range [RowBegin(s,a), RowEnd(s,a)), in the same
+    order as DiscreteMDP::getNextStates() enumerates them. The expected
+    rewards are stored in a dense array. Planners can thus sweep the
+    model without virtual calls or hash lookups.
+
+    The snapshot remembers the modification stamps of the model's
+    transition and reward distributions, so Synchronise() only
+    recompiles it when the model has actually changed. Reward
+    distributions that are mutated behind the model's back (rather than
+    through its setters) are not detected; call Compile() in that case.
+ */
+class CompiledDiscreteMDP {
+ protected:
+  int n_states;                       ///< number of states
+  int n_actions;                      ///< number of actions
+  std::vector<int> row_begin;         ///< row offsets, size N + 1
+  std::vector<int> next_state;        ///< next state of each transition
+  std::vector<real> probability;      ///< probability of each transition
+  std::vector<real> expected_reward;  ///< expected reward of each (s,a)
+  ulong transition_stamp;             ///< stamp of compiled transitions
+  ulong reward_stamp;                 ///< stamp of compiled rewards
+ public:
+  CompiledDiscreteMDP();
+  explicit CompiledDiscreteMDP(const DiscreteMDP& mdp);
+  void Compile(const DiscreteMDP& mdp);
+  bool Synchronise(const DiscreteMDP& mdp);
+  /// Check whether the snapshot reflects the current state of the model
+  bool isCurrent(const DiscreteMDP& mdp) const {
+    return transition_stamp == mdp.getTransitionStamp() &&
+           reward_stamp == mdp.getRewardStamp();
+  }
+  int getNStates() const { return n_states; }
+  int getNActions() const { return n_actions; }
+  /// Total number of stored transitions
+  int getNTransitions() const { return (int)next_state.size(); }
+  inline int getID(int s, int a) const {
+    assert(s >= 0 && s < n_states);
+    assert(a >= 0 && a < n_actions);
+    return s * n_actions + a;
+  }
+  /// Index of the first transition of \f$(s,a)\f$
+  inline int RowBegin(int s, int a) const { return row_begin[getID(s, a)]; }
+  /// Index one past the last transition of \f$(s,a)\f$
+  inline int RowEnd(int s, int a) const { return row_begin[getID(s, a) + 1]; }
+  inline int getNextState(int i) const { return next_state[i]; }
+  inline real getProbability(int i) const { return probability[i]; }
+  inline real getExpectedReward(int s, int a) const {
+    return expected_reward[getID(s, a)];
+  }
+  /// Return \f$\sum_{s'} P(s'|s,a) V(s')\f$
+  inline real ExpectedNextValue(int s, int a, const real* V) const {
+    int ID = getID(s, a);
+    real sum = 0.0;
+    for (int i = row_begin[ID]; i < row_begin[ID + 1]; ++i) {
+      sum += probability[i] * V[next_state[i]];
+    }
+    return sum;
+  }
+  /// Return \f$\sum_{s'} P(s'|s,a) V(s')\f$
+  inline real ExpectedNextValue(int s, int a, const Vector& V) const {
+    assert(V.Size() == n_states);
+    return ExpectedNextValue(s, a, V.x);
+  }
+};
+
+#endif  // SRC_MODELS_COMPILEDDISCRETEMDP_H_
@@ -15,35 +15,28 @@
 
 #define INITIAL_Q_VALUE 0.0
 
-ContextTreeRL::Node::Node(int n_branches_, int n_outcomes_)
-    : n_branches(n_branches_),
-      n_outcomes(n_outcomes_),
+ContextTreeRL::Node::Node(ContextTreeRL& tree_, int index_)
+    : tree(tree_),
+      index(index_),
+      n_branches(tree_.n_branches),
+      n_outcomes(tree_.n_symbols),
       depth(0),
       prev(NULL),
-      next(n_branches),
-      P(n_outcomes),
-      alpha(n_outcomes),
       prior_alpha(0.5),
       w(1),
       log_w(0),
       log_w_prior(0),
       reward_prior(0, 0.1),
-      Q(INITIAL_Q_VALUE) {
-  for (int i = 0; i < n_outcomes; ++i) {
-    P(i) = 1.0 / (real)n_outcomes;
-    alpha(i) = 0;
-  }
-}
+      Q(INITIAL_Q_VALUE) {}
 
 /// Make a node for K symbols at nominal depth d
-ContextTreeRL::Node::Node(ContextTreeRL::Node* prev_)
-    : n_branches(prev_->n_branches),
+ContextTreeRL::Node::Node(ContextTreeRL::Node* prev_, int index_)
+    : tree(prev_->tree),
+      index(index_),
+      n_branches(prev_->n_branches),
       n_outcomes(prev_->n_outcomes),
       depth(prev_->depth + 1),
       prev(prev_),
-      next(n_branches),
-      P(n_outcomes),
-      alpha(n_outcomes),
       prior_alpha(0.5),
       log_w(0),
       log_w_prior(prev_->log_w_prior - log(2)),
@@ -52,20 +45,6 @@ ContextTreeRL::Node::Node(ContextTreeRL::Node* prev_)
 // log_w_prior( - log(10))
 {
   w = exp(log_w_prior);
-  for (int i = 0; i < n_branches; ++i) {
-    next[i] = NULL;
-  }
-  for (int i = 0; i < n_outcomes; ++i) {
-    P(i) = 1.0 / (real)n_outcomes;
-    alpha(i) = 0;
-  }
-}
-
-/// make sure to kill all
-ContextTreeRL::Node::~Node() {
-  for (int i = 0; i < n_branches; ++i) {
-    delete next[i];
-  }
 }
 
 /** Obtain a new observation.
@@ -98,37 +77,23 @@ real ContextTreeRL::Node::Observe(Ring<int>& history, Ring<int>::iterator x,
   // calculate probabilities
   assert(z >= 0 && z < n_outcomes);
 
-// Standard
-#if 0
-    real S = alpha.Sum();
-    real Z = 1.0 / (prior_alpha * (real) n_outcomes + S);
-    P = (alpha + prior_alpha) * Z;
-    P /= P.Sum();
-    //P[y] = (alpha[y] + prior_alpha) * Z;
-#endif
-
-#if 1
   // aka: I-BVMM -- best for many outcomes
-  real S = alpha.Sum();
+  real* alpha = this->alpha();
+  real S = 0;
   real N = 0;
   for (int i = 0; i < n_outcomes; ++i) {
-    if (alpha(i)) {
+    S += alpha[i];
+    if (alpha[i]) {
       N += 1;
     }
   }
   real Z = (1 + N) * prior_alpha + S;
-  P = (alpha + prior_alpha) / Z;
-  real n_zero_outcomes = n_outcomes - N;
-  if (n_zero_outcomes > 0) {
-    real SA = 1.0 / n_zero_outcomes;
-    for (int i = 0; i < n_outcomes; ++i) {
-      if (alpha(i) == 0) {
-        P(i) *= SA;
-      }
-    }
+  real P_z = (alpha[z] + prior_alpha) / Z;
+  if (alpha[z] == 0) {
+    // spread the prior mass over the unseen outcomes
+    P_z /= (real)n_outcomes - N;
   }
-#endif
-  alpha[z]++;  ///< \BUG Valgrind!
+  alpha[z]++;
 
   // Do it for probability too
   real p_reward = 0.001 + reward_prior.Observe(r);
@@ -138,7 +103,7 @@ real ContextTreeRL::Node::Observe(Ring<int>& history, Ring<int>::iterator x,
   w = exp(log_w_prior + log_w);
   assert(w >= 0 && w <= 1);
 
-  real p_observations = P[z] * p_reward;
+  real p_observations = P_z * p_reward;
   total_probability = p_observations * w + (1 - w) * probability;
 
   // real log_w_prev = log_w;
@@ -155,9 +120,8 @@ real ContextTreeRL::Node::Observe(Ring<int>& history, Ring<int>::iterator x,
     fprintf(stderr,
             "Warning: log_w at depth %d is nan! log_w=%f, w = %f, p = %f, p(x) "
             "= %f, p(z) = %f, p(r)=%f, prior = %f, z = %d, r = %f \n",
-            depth, log_w, w, p_observations, P[z], p_reward, total_probability,
+            depth, log_w, w, p_observations, P_z, p_reward, total_probability,
             log_w_prior, z, r);
-    P.print(stderr);
     log_w = -2;
   }
   w_prod = 1;  ///< auxilliary calculation
@@ -168,12 +132,13 @@ real ContextTreeRL::Node::Observe(Ring<int>& history, Ring<int>::iterator x,
   if (x != history.end() && S > threshold) {
     int k = *x;
     ++x;
-    if (!next[k]) {
-      next[k] = new Node(this);
+    Node* next_node = next(k);
+    if (!next_node) {
+      next_node = tree.NewNode(this, k);
     }
     total_probability =
-        next[k]->Observe(history, x, z, r, total_probability, active_contexts);
-    w_prod = next[k]->w_prod;  ///< for post facto context probabilities
+        next_node->Observe(history, x, z, r, total_probability, active_contexts);
+    w_prod = next_node->w_prod;  ///< for post facto context probabilities
     assert(!std::isnan(total_probability));
     assert(!std::isnan(w_prod));
   }
@@ -213,10 +178,10 @@ real ContextTreeRL::Node::QValue(Ring<int>& history, Ring<int>::iterator x,
   int k = *x;
   // printf ("# [%d] (%f %f %f) -> %f (%d) ->\n", depth, Q_prev, w, Q, Q_next,
   // k);
-  assert(k >= 0 && k < (int)next.size());
-  if (x != history.end() && next[k]) {
+  assert(k >= 0 && k < n_branches);
+  if (x != history.end() && next(k)) {
     ++x;
-    Q_next = next[k]->QValue(history, x, Q_next);
+    Q_next = next(k)->QValue(history, x, Q_next);
   }
 
   return Q_next;
@@ -224,13 +189,14 @@ real ContextTreeRL::Node::QValue(Ring<int>& history, Ring<int>::iterator x,
 
 void ContextTreeRL::Node::Show() {
   std::cout << w << " " << depth << "# weight depth\n";
+  real* alpha = this->alpha();
   for (int i = 0; i < n_outcomes; ++i) {
     std::cout << alpha[i] << " ";
   }
   for (int k = 0; k < n_branches; ++k) {
-    if (next[k]) {
+    if (next(k)) {
       std::cout << "b: " << k << std::endl;
-      next[k]->Show();
+      next(k)->Show();
     }
   }
   std::cout << "<<<<\n";
@@ -239,9 +205,9 @@ void ContextTreeRL::Node::Show() {
 int ContextTreeRL::Node::NChildren() {
   int my_children = 0;
   for (int k = 0; k < n_branches; ++k) {
-    if (next[k]) {
+    if (next(k)) {
       my_children++;
-      my_children += next[k]->NChildren();
+      my_children += next(k)->NChildren();
     }
   }
   return my_children;
@@ -255,14 +221,38 @@ ContextTreeRL::ContextTreeRL(int n_branches_, int n_observations_,
       n_symbols(n_symbols_),
       max_depth(max_depth_),
       history(max_depth) {
-  root = new Node(n_branches, n_symbols);
+  root = NewNode(NULL, 0);
   std::cout << "# Making new CTRL with depth: " << max_depth
             << " branches:" << n_branches << " actions:" << n_actions
             << " observations:" << n_observations << " symbols:" << n_symbols
             << std::endl;
 }
 
-ContextTreeRL::~ContextTreeRL() { delete root; }
+ContextTreeRL::~ContextTreeRL() {}
+
+/// Remove all contexts and observations, freeing all nodes at once
+void ContextTreeRL::Reset() {
+  active_contexts.clear();
+  nodes.Clear();
+  children.clear();
+  counts.clear();
+  history.clear();
+  root = NewNode(NULL, 0);
+}
+
+/// Make a new node following branch k of prev, or a root if prev is NULL
+ContextTreeRL::Node* ContextTreeRL::NewNode(Node* prev, int branch) {
+  int index = nodes.size();
+  children.resize(children.size() + n_branches, -1);
+  counts.resize(counts.size() + n_symbols, 0.0);
+  if (prev) {
+    children[prev->index * n_branches + branch] = index;
+    nodes.New(prev, index);
+  } else {
+    nodes.New(*this, index);
+  }
+  return nodes.Get(index);
+}
 
 /** Observe complete observation (branch) x, next observation z and reward r.
 
@@ -15,6 +15,7 @@
 #include <list>
 #include <vector>
 #include "BetaDistribution.h"
+#include "NodePool.h"
 #include "NormalDistribution.h"
 #include "Ring.h"
 #include "Vector.h"
@@ -33,13 +34,12 @@ class ContextTreeRL {
  public:
   // public classes
   struct Node {
+    ContextTreeRL& tree;      ///< the tree holding the node
+    int index;                ///< index of the node in the tree
     int n_branches;           ///< \f$|X|\f$
     int n_outcomes;           ///< \f$|Y|\f$
     int depth;                ///< depth
     Node* prev;               ///< previous node
-    std::vector<Node*> next;  ///< pointers to next nodes
-    Vector P;                 ///< probability of next symbols
-    Vector alpha;             ///< parameters of next symbols
     const real prior_alpha;   ///< implicit prior value of alpha
     real w;                   ///< backoff weight
     real log_w;               ///< log of w
@@ -51,9 +51,15 @@ class ContextTreeRL {
     real w_prod;               ///< \f$\prod_k (1 - w_k)\f$
     real context_probability;  ///< last probability of the context
 
-    Node(int n_branches_, int n_outcomes_);
-    Node(Node* prev_);
-    ~Node();
+    Node(ContextTreeRL& tree_, int index_);
+    Node(Node* prev_, int index_);
+    /// parameters of next symbols
+    real* alpha() { return &tree.counts[index * n_outcomes]; }
+    /// the k-th next node, or NULL
+    Node* next(int k) {
+      int child = tree.children[index * n_branches + k];
+      return (child < 0) ? NULL : tree.nodes.Get(child);
+    }
 
     real Observe(Ring<int>& history, Ring<int>::iterator x, int z, real r,
                  real probability, std::list<Node*>& active_contexts);
@@ -65,6 +71,7 @@ class ContextTreeRL {
   ContextTreeRL(int n_branches_, int n_observations, int n_actions,
                 int n_symbols_, int max_depth_ = 0);
   ~ContextTreeRL();
+  void Reset();
   real Observe(int x, int z, real r);
   void Show();
   int NChildren();
@@ -81,6 +88,10 @@ class ContextTreeRL {
   Node* root;
   Ring<int> history;
   std::list<Node*> active_contexts;
+  NodePool<Node> nodes;       ///< all nodes
+  std::vector<int> children;  ///< n_branches child indices per node, or -1
+  std::vector<real> counts;   ///< n_symbols counts per node
+  Node* NewNode(Node* prev, int branch);
 };
 
 #endif
@@ -23,15 +23,15 @@
 
 /** Construction of the root node */
 ContinuousStateContextTreeRL::Node::Node(ContinuousStateContextTreeRL& tree_,
-                                         const Vector& lower_bound_x_,
-                                         const Vector& upper_bound_x_)
+                                         int index_,
+                                         const Vector& lower_bound_x,
+                                         const Vector& upper_bound_x)
     : tree(tree_),
-      lower_bound_x(lower_bound_x_),
-      upper_bound_x(upper_bound_x_),
+      index(index_),
+      branch(-1),
       depth(0),
       mean_reward(0),
       prev(NULL),
-      next(tree.n_branches),
       log_w(0),
       w(1),
       Q(INITIAL_Q_VALUE),
@@ -79,15 +79,14 @@ ContinuousStateContextTreeRL::Node::Node(ContinuousStateContextTreeRL& tree_,
     \]
  */
 ContinuousStateContextTreeRL::Node::Node(
-    ContinuousStateContextTreeRL::Node* prev_, const Vector& lower_bound_x_,
-    const Vector& upper_bound_x_)
+    ContinuousStateContextTreeRL::Node* prev_, int index_, int branch_,
+    const Vector& lower_bound_x, const Vector& upper_bound_x)
     : tree(prev_->tree),
-      lower_bound_x(lower_bound_x_),
-      upper_bound_x(upper_bound_x_),
+      index(index_),
+      branch(branch_),
       depth(prev_->depth + 1),
       mean_reward(0),
       prev(prev_),
-      next(tree.n_branches),
       log_w((1 + (depth - 1) * tree.depth_factor) * log(tree.weight_factor)),
       w(exp(log_w)),
       Q(INITIAL_Q_VALUE),
@@ -107,9 +106,6 @@ ContinuousStateContextTreeRL::Node::Node(
 #endif
 
   w = exp(log_w);
-  for (int i = 0; i < tree.n_branches; ++i) {
-    next[i] = NULL;
-  }
 
   local_density = new ContextTreeKDTree(tree.n_branches, tree.max_depth_cond,
                                         tree.lower_bound_x, tree.upper_bound_x);
@@ -121,12 +117,25 @@ ContinuousStateContextTreeRL::Node::Node(
   prior_normal = NORMAL_PRIOR;
 }
 
-/// make sure to kill all
+/// The next nodes are destroyed by the tree
 ContinuousStateContextTreeRL::Node::~Node() {
   delete local_density;
   delete normal_density;
-  for (int i = 0; i < tree.n_branches; ++i) {
-    delete next[i];
+}
+
+/// Get the bounds of the node from the root bounds and the splits above it
+void ContinuousStateContextTreeRL::Node::Bounds(Vector& lower_bound_x,
+                                                Vector& upper_bound_x) {
+  if (!prev) {
+    lower_bound_x = tree.lower_bound_x;
+    upper_bound_x = tree.upper_bound_x;
+    return;
+  }
+  prev->Bounds(lower_bound_x, upper_bound_x);
+  if (branch == 0) {
+    upper_bound_x(prev->splitting_dimension) = prev->mid_point;
+  } else {
+    lower_bound_x(prev->splitting_dimension) = prev->mid_point;
   }
 }
 
@@ -213,22 +222,23 @@ real ContinuousStateContextTreeRL::Node::Observe(const Vector& x_t,
 #endif
   // Do a forward mixture if there is another node available.
   if ((tree.max_depth == -1 || depth < tree.max_depth) && S > threshold) {
-    if (!next[k]) {
+    Node* next_node = next(k);
+    if (!next_node) {
       // printf ("Making new node from depth %d, max: %d\n", depth,
       // tree.max_depth);
+      Vector lower_bound_x;
+      Vector upper_bound_x;
+      Bounds(lower_bound_x, upper_bound_x);
       if (k == 0) {
-        Vector new_bound_x = upper_bound_x;
-        new_bound_x(splitting_dimension) = mid_point;
-        next[k] = new Node(this, lower_bound_x, new_bound_x);
+        upper_bound_x(splitting_dimension) = mid_point;
       } else {
-        Vector new_bound_x = lower_bound_x;
-        new_bound_x(splitting_dimension) = mid_point;
-        next[k] = new Node(this, new_bound_x, upper_bound_x);
+        lower_bound_x(splitting_dimension) = mid_point;
       }
+      next_node = tree.NewNode(this, k, lower_bound_x, upper_bound_x);
     }
-    total_probability =
-        next[k]->Observe(x_t, y_t, reward, total_probability, active_contexts);
-    w_prod = next[k]->w_prod;
+    total_probability = next_node->Observe(x_t, y_t, reward, total_probability,
+                                           active_contexts);
+    w_prod = next_node->w_prod;
     assert(!std::isnan(total_probability));
     assert(!std::isnan(w_prod));
   }
@@ -265,8 +275,8 @@ real ContinuousStateContextTreeRL::Node::QValue(const Vector& x_t,
     k = 1;
   }
 
-  if (next[k]) {
-    Q_next = next[k]->QValue(x_t, Q_next);
+  if (next(k)) {
+    Q_next = next(k)->QValue(x_t, Q_next);
   }
 
   return Q_next;
@@ -382,8 +392,8 @@ void ContinuousStateContextTreeRL::Node::Show() {
 #if 0
 	printf("%d %f #w\n", depth, w);
 	for (int k=0; k<tree.n_branches; ++k) {
-		if (next[k]) {
-			next[k]->Show();
+		if (next(k)) {
+			next(k)->Show();
 		}
 	}
 #endif
@@ -393,9 +403,9 @@ void ContinuousStateContextTreeRL::Node::Show() {
 int ContinuousStateContextTreeRL::Node::NChildren() {
   int my_children = 0;
   for (int k = 0; k < tree.n_branches; ++k) {
-    if (next[k]) {
+    if (next(k)) {
       my_children++;
-      my_children += next[k]->NChildren();
+      my_children += next(k)->NChildren();
     }
   }
   return my_children;
@@ -416,7 +426,7 @@ ContinuousStateContextTreeRL::ContinuousStateContextTreeRL(
       weight_factor(weight_factor_),
       root(n_actions) {
   for (int i = 0; i < n_actions; ++i) {
-    root[i] = new Node(*this, lower_bound_x, upper_bound_x);
+    root[i] = NewNode(NULL, 0, lower_bound_x, upper_bound_x);
   }
   assert(n_states == upper_bound_x.Size());
   assert(n_actions > 0);
@@ -426,10 +436,31 @@ ContinuousStateContextTreeRL::ContinuousStateContextTreeRL(
   current_action = -1;
 }
 
-ContinuousStateContextTreeRL::~ContinuousStateContextTreeRL() {
+ContinuousStateContextTreeRL::~ContinuousStateContextTreeRL() {}
+
+/// Forget all data, freeing all nodes at once
+void ContinuousStateContextTreeRL::Clear() {
+  Reset();
+  nodes.Clear();
+  children.clear();
   for (int i = 0; i < n_actions; ++i) {
-    delete root[i];
+    root[i] = NewNode(NULL, 0, lower_bound_x, upper_bound_x);
+  }
+}
+
+/// Make a new node following branch k of prev, or a root if prev is NULL
+ContinuousStateContextTreeRL::Node* ContinuousStateContextTreeRL::NewNode(
+    Node* prev, int branch, const Vector& lower_bound_x_,
+    const Vector& upper_bound_x_) {
+  int index = nodes.size();
+  children.resize(children.size() + n_branches, -1);
+  if (prev) {
+    children[prev->index * n_branches + branch] = index;
+    nodes.New(prev, index, branch, lower_bound_x_, upper_bound_x_);
+  } else {
+    nodes.New(*this, index, lower_bound_x_, upper_bound_x_);
   }
+  return nodes.Get(index);
 }
 
 /** Observe a transition and update the model and active contexts.
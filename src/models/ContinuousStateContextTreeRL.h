@@ -18,6 +18,7 @@
 #include "ContextTreeKDTree.h"
 #include "MultivariateNormal.h"
 #include "MultivariateNormalUnknownMeanPrecision.h"
+#include "NodePool.h"
 #include "Vector.h"
 #include "real.h"
 
@@ -41,8 +42,8 @@ class ContinuousStateContextTreeRL {
   // public classes
   struct Node {
     ContinuousStateContextTreeRL& tree;  ///< the tree
-    Vector lower_bound_x;                ///< looks at x > lower_bound
-    Vector upper_bound_x;                ///< looks at x < upper_bound
+    int index;                           ///< index of the node in the tree
+    int branch;                          ///< which branch of prev this node is
     real mid_point;                      ///< how to split
     int splitting_dimension;  ///< dimension on which to do the split.
     const int depth;          ///< depth of the node
@@ -54,17 +55,23 @@ class ContinuousStateContextTreeRL {
     NormalUnknownMeanPrecision reward_prior;  ///< local density estimator
     real mean_reward;                         ///< mean reward
     Node* prev;                               ///< previous node
-    std::vector<Node*> next;                  ///< pointers to next nodes
     real log_w;                               ///< log of w
     real w;                                   ///< backoff weight
     real Q;                                   ///< Q-value
     real w_prod;                              ///< \f$\prod_k (1 - w_k)\f$
     real context_probability;  ///< last probability of the context
 
-    Node(ContinuousStateContextTreeRL& tree_, const Vector& lower_bound_x_,
-         const Vector& upper_bound_x_);
-    Node(Node* prev_, const Vector& lower_bound_x, const Vector& upper_bound_x);
+    Node(ContinuousStateContextTreeRL& tree_, int index_,
+         const Vector& lower_bound_x_, const Vector& upper_bound_x_);
+    Node(Node* prev_, int index_, int branch_, const Vector& lower_bound_x,
+         const Vector& upper_bound_x);
     virtual ~Node();
+    /// the k-th next node, or NULL
+    Node* next(int k) {
+      int child = tree.children[index * tree.n_branches + k];
+      return (child < 0) ? NULL : tree.nodes.Get(child);
+    }
+    void Bounds(Vector& lower_bound_x, Vector& upper_bound_x);
     real Observe(const Vector& x, const Vector& y, real reward,
                  real probability, ContextList& active_contexts);
     real QValue(const Vector& state, real Q_prev);
@@ -91,6 +98,7 @@ class ContinuousStateContextTreeRL {
     current_action = -1;
     active_contexts.clear();
   }
+  void Clear();
   virtual void Show();
   int NChildren();
 
@@ -105,6 +113,10 @@ class ContinuousStateContextTreeRL {
   real depth_factor;
   real weight_factor;
   std::vector<Node*> root;
+  NodePool<Node> nodes;       ///< all nodes, for all actions
+  std::vector<int> children;  ///< n_branches child indices per node, or -1
+  Node* NewNode(Node* prev, int branch, const Vector& lower_bound_x_,
+                const Vector& upper_bound_x_);
   Vector current_state;  ///< current state
   int current_action;    ///< current action
   std::list<Node*> active_contexts;
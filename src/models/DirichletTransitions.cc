@@ -75,6 +75,43 @@ Vector DirichletTransitions::generate(int state, int action) const {
   return got->second.generate();
 }
 
+void DirichletTransitions::generate(int state, int action, Vector& p,
+                                    RandomNumberGenerator& rng) const {
+  auto got = P.find(DiscreteStateAction(state, action));
+  if (got == P.end()) {
+    p.Clear();
+    if (uniform_unknown) {
+      real z = 1.0 / (real)n_states;
+      for (int j = 0; j < n_states; j++) {
+        p(j) = z;
+      }
+    } else {
+      p(state) = 1;
+    }
+    return;
+  }
+  got->second.generate(p, rng);
+}
+
+/** Generate the transitions of an action.
+
+    The next state distribution of each state is sampled into one
+    vector and written into the transitions of mdp, so that no
+    S x S matrix is needed.
+ */
+void DirichletTransitions::generate(int action, DiscreteMDP& mdp,
+                                    RandomNumberGenerator& rng) const {
+  Vector p(n_states);
+  for (int s = 0; s < n_states; s++) {
+    generate(s, action, p, rng);
+    for (int s2 = 0; s2 < n_states; s2++) {
+      if (p(s2)) {
+        mdp.setTransitionProbability(s, action, s2, p(s2));
+      }
+    }
+  }
+}
+
 Vector DirichletTransitions::getMarginal(int state, int action) const {
   auto got = P.find(DiscreteStateAction(state, action));
   if (got == P.end()) {
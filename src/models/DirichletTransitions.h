@@ -13,6 +13,7 @@
 
 #include "Dirichlet.h"
 #include "DirichletFiniteOutcomes.h"
+#include "DiscreteMDP.h"
 #include "TransitionDistribution.h"
 
 /** Discrete transition distribution that is Dirichlet
@@ -53,6 +54,14 @@ class DirichletTransitions {
   /// Generate a multinomial distribution parameter vector
   virtual Vector generate(int state, int action) const;
 
+  /// Generate a parameter vector in-place, from a stream
+  virtual void generate(int state, int action, Vector& p,
+                        RandomNumberGenerator& rng) const;
+
+  /// Generate the transitions of an action into an MDP, from a stream
+  void generate(int action, DiscreteMDP& mdp,
+                RandomNumberGenerator& rng) const;
+
   /// Get the marginal probability of the next state
   virtual real marginal_pdf(int state, int action, int next_state) const;
 
@@ -138,6 +138,16 @@ class MDP<int, int> {
     return transition_distribution.getNextStates(s, a);
   }
 
+  /// Get the stamp of the last change to the transition distribution
+  ulong getTransitionStamp() const {
+    return transition_distribution.getModificationStamp();
+  }
+
+  /// Get the stamp of the last change to the reward distribution
+  ulong getRewardStamp() const {
+    return reward_distribution.getModificationStamp();
+  }
+
   void AperiodicityTransform(real tau);
 
   bool Check() const;
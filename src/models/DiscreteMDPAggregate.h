@@ -52,6 +52,11 @@ class DiscreteMDPAggregate : public DiscreteMDPCounts {
   virtual Vector getTransitionProbabilities(int s, int a) const;
   virtual real getExpectedReward(int s, int a) const;
   virtual void Reset();
+  /// The batched sampler of DiscreteMDPCounts does not know about
+  /// aggregation, so use the generic one.
+  virtual DiscreteMDP* generate(RandomNumberGenerator& rng) const {
+    return MDPModel::generate(rng);
+  }
   // void SetNextReward(int s, int a, real r);
 };
 
@@ -182,6 +182,23 @@ DiscreteMDP* DiscreteMDPCounts::generate() const {
   return mdp;
 }
 
+/** Generate an MDP from a stream.
+
+    The transitions of each action are sampled in one pass, and
+    rewards are then drawn from the same stream.
+ */
+DiscreteMDP* DiscreteMDPCounts::generate(RandomNumberGenerator& rng) const {
+  DiscreteMDP* mdp = new DiscreteMDP(n_states, n_actions, NULL);
+  for (int a = 0; a < n_actions; a++) {
+    transitions.generate(a, *mdp, rng);
+    for (int s = 0; s < n_states; s++) {
+      real expected_reward = ER[getID(s, a)]->generate(rng);
+      mdp->reward_distribution.addFixedReward(s, a, expected_reward);
+    }
+  }
+  return mdp;
+}
+
 /// Get a pointer to the mean MDP
 const DiscreteMDP* const DiscreteMDPCounts::getMeanMDP() const {
   // DiscreteMDP* mdp = new DiscreteMDP(n_states, n_actions);
@@ -71,6 +71,8 @@ class DiscreteMDPCounts : public MDPModel {
 
   virtual DiscreteMDP* generate() const;
 
+  virtual DiscreteMDP* generate(RandomNumberGenerator& rng) const;
+
   virtual const DiscreteMDP* const getMeanMDP() const;
 
   // virtual DiscreteMDP* CreateMDP() const;
@@ -37,14 +37,14 @@ KNNClassifier::~KNNClassifier() {}
 
     \param sample sample to add
 
-    Add a sample if not too many samples have been added.  The sample
-    is added to the list of samples.  It is also added to the tree,
-    using x as a context.
+    The input is added to the tree, and the class probabilities to
+    the end of Py.
 
  */
-void KNNClassifier::AddSample(const DataSample sample) {
-  samples.push_back(sample);
-  kd_tree.AddVectorObject(sample.x, &samples.back());
+void KNNClassifier::AddSample(const DataSample& sample) {
+  assert(sample.Py.Size() == n_classes);
+  kd_tree.AddVectorObject(sample.x, NULL);
+  Py.insert(Py.end(), sample.Py.x, sample.Py.x + n_classes);
 }
 
 /** Predict the next label.
@@ -68,23 +68,22 @@ Vector& KNNClassifier::Output(const Vector& x) {
   // basis.Evaluate(x);
   assert(n_inputs == x.Size());
   assert(n_classes == output.Size());
-  real init_value = 1.0 / (1 + samples.size());
+  real init_value = 1.0 / (1 + kd_tree.getNumberOfPoints());
   for (int i = 0; i < n_classes; ++i) {
     output(i) = init_value;
   }
 
   real w = 1.0 / (real)K;
 
-  OrderedFixedList<KDNode> node_list = kd_tree.FindKNearestNeighbours(x, K);
-  std::list<std::pair<real, KDNode*> >::iterator it;
-  int i = 0;
-  for (it = node_list.S.begin(); it != node_list.S.end(); ++it, ++i) {
-    KDNode* node = it->second;
-    DataSample* sample = kd_tree.getObject(node);
-    // output[sample->label] += w;
-    output += sample->Py * w;
+  std::vector<void_FlatKDTree::Neighbour> knn;
+  kd_tree.FindKNearestNeighbours(x, K, knn);
+  for (uint k = 0; k < knn.size(); ++k) {
+    const real* P = &Py[knn[k].second * n_classes];
+    for (int i = 0; i < n_classes; ++i) {
+      output(i) += P[i] * w;
+    }
   }
-  if (i == 0) {
+  if (knn.empty()) {
     output += w;
   }
   output /= output.Sum();
@@ -12,13 +12,16 @@
 #ifndef KNN_CLASSIFIER_H
 #define KNN_CLASSIFIER_H
 
-#include <list>
 #include <vector>
 #include "Classifier.h"
-#include "KDTree.h"
+#include "FlatKDTree.h"
 #include "Vector.h"
 
 /** K Nearest neighbour classifier.
+
+    The inputs of the samples are stored in a FlatKDTree, and their
+    class probabilities in a contiguous array, in the same order as
+    the tree's points.
  */
 class KNNClassifier : public Classifier<Vector, int, Vector> {
  public:
@@ -32,12 +35,12 @@ class KNNClassifier : public Classifier<Vector, int, Vector> {
   };
 
  protected:
-  int n_classes;                  ///< number of classes
-  int n_inputs;                   ///< number of input dimensions
-  int K;                          ///< number of neighbours to use
-  KDTree<DataSample> kd_tree;     ///< storage backend
-  std::list<DataSample> samples;  ///< list of samples
-  void AddSample(const DataSample sample);
+  int n_classes;             ///< number of classes
+  int n_inputs;              ///< number of input dimensions
+  int K;                     ///< number of neighbours to use
+  FlatKDTree<void> kd_tree;  ///< storage backend
+  std::vector<real> Py;      ///< class probabilities, sample by sample
+  void AddSample(const DataSample& sample);
 
  public:
   Vector output;  ///< temporary storage for the last output of the classifier
@@ -57,7 +60,9 @@ class KNNClassifier : public Classifier<Vector, int, Vector> {
     AddSample(DataSample(x, p));
     return Product(&p_y_x, &p);
   }
-  void Show() { kd_tree.Show(); }
+  void Show() {
+    printf("# KNN classifier with %d samples\n", kd_tree.getNumberOfPoints());
+  }
 };
 
 #endif
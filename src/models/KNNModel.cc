@@ -35,9 +35,12 @@ KNNModel::KNNModel(int n_actions_, int n_dim_, real gamma_, bool optimistic,
       optimism(optimism_),
       r_max(r_max_),
       max_samples(-1),
+      eviction(NO_EVICTION),
+      n_accepted(0),
+      oldest(0),
       threshold(n_actions * 10) {
   for (int i = 0; i < n_actions; ++i) {
-    kd_tree[i] = new KDTree<TrajectorySample>(n_dim);
+    kd_tree[i] = new FlatKDTree<TrajectorySample>(n_dim);
   }
 }
 
@@ -52,33 +55,82 @@ KNNModel::~KNNModel() {
 
     \param sample sample to add
 
-    Add a sample if not too many samples have been added.
+    Add a sample if not too many samples have been added, or if the
+    eviction policy selects a sample for it to replace.
     The sample is added to the list of samples.
     It is also added to the tree and the value is initialised.
 
  */
 void KNNModel::AddSample(TrajectorySample sample, int K, real beta) {
-  if (max_samples < 0 || samples.size() < (uint)max_samples) {
-    OrderedFixedList<KDNode> node_list =
-        kd_tree[sample.a]->FindKNearestNeighbours(sample.s, K);
-    RBF rbf(sample.s, beta);
-    // std::list<std::pair<real, KDNode*> >::iterator it;
-    KDTree<TrajectorySample>::iterator it;
-
-    real w = 0;
-    for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-      KDNode* node = it->second;
-      TrajectorySample* near_sample = kd_tree[sample.a]->getObject(node);
-      w += rbf.Evaluate(near_sample->s);
-    }
-    if (w < urandom() * threshold) {
-      threshold = 0.01 * w + 0.99 * threshold;
-      printf("%f -> %f #thr\n", w, threshold);
+  bool full = max_samples >= 0 && samples.size() >= (uint)max_samples;
+  if (full && (eviction == NO_EVICTION || max_samples == 0)) {
+    return;
+  }
+  std::vector<FlatKDTree<TrajectorySample>::ObjectNeighbour> knn;
+  kd_tree[sample.a]->FindKNearestObjects(sample.s, K, knn);
+  RBF rbf(sample.s, beta);
+
+  real w = 0;
+  for (uint k = 0; k < knn.size(); ++k) {
+    TrajectorySample* near_sample = knn[k].second;
+    w += rbf.Evaluate(near_sample->s);
+  }
+  if (w < urandom() * threshold) {
+    threshold = 0.01 * w + 0.99 * threshold;
+    printf("%f -> %f #thr\n", w, threshold);
+    n_accepted++;
+    if (!full) {
       samples.push_back(sample);
-      kd_tree[sample.a]->AddVectorObject(sample.s, &samples.back());
-      sample.dV = 1.0;
-      sample.V = sample.r;
+      tree_index.push_back(
+          kd_tree[sample.a]->AddVectorObject(sample.s, &samples.back()));
+    } else {
+      int i = SelectEvictedSample();
+      if (i >= 0) {
+        kd_tree[samples[i].a]->Remove(tree_index[i]);
+        samples[i] = sample;
+        tree_index[i] =
+            kd_tree[sample.a]->AddVectorObject(sample.s, &samples[i]);
+      }
     }
+    sample.dV = 1.0;
+    sample.V = sample.r;
+  }
+}
+
+/** Select a sample to replace, when the model is full.
+
+    \return the index of the sample, or -1 if no sample is to be replaced.
+ */
+int KNNModel::SelectEvictedSample() {
+  int n = samples.size();
+  switch (eviction) {
+    case FIFO_EVICTION: {
+      int i = oldest;
+      oldest = (oldest + 1) % n;
+      return i;
+    }
+    case RESERVOIR_EVICTION: {
+      int i = urandom(0, n_accepted);
+      return (i < n) ? i : -1;
+    }
+    case THINNING_EVICTION: {
+      // the candidate closest to another sample with the same action
+      int n_candidates = 8;
+      int selected = urandom(0, n);
+      real closest = INF;
+      for (int k = 0; k < n_candidates; ++k) {
+        int i = urandom(0, n);
+        std::vector<void_FlatKDTree::Neighbour> knn;
+        kd_tree[samples[i].a]->FindKNearestNeighbours(samples[i].s, 2, knn);
+        if (knn.size() == 2 && knn[1].first < closest) {
+          closest = knn[1].first;
+          selected = i;
+        }
+      }
+      return selected;
+    }
+    default:
+      return -1;
   }
 }
 
@@ -107,25 +159,20 @@ void KNNModel::GetExpectedTransition(real alpha, Vector& x, int action,
     y[i] = 0;
   }
 
-  OrderedFixedList<KDNode> node_list =
-      kd_tree[action]->FindKNearestNeighbours(x, K);
-
-  std::list<std::pair<real, KDNode*> >::iterator it;
+  std::vector<FlatKDTree<TrajectorySample>::ObjectNeighbour> knn;
+  kd_tree[action]->FindKNearestObjects(x, K, knn);
 
   real sum = 0;
   Vector w(K);
-  int i = 0;
-  for (it = node_list.S.begin(); it != node_list.S.end(); ++it, ++i) {
-    KDNode* node = it->second;
-    TrajectorySample* sample = kd_tree[action]->getObject(node);
+  int n_neighbours = knn.size();
+  for (int i = 0; i < n_neighbours; ++i) {
+    TrajectorySample* sample = knn[i].second;
     w[i] = rbf.Evaluate(sample->s);
     sum += w[i];
   }
   w /= sum;
-  i = 0;
-  for (it = node_list.S.begin(); it != node_list.S.end(); ++it, ++i) {
-    KDNode* node = it->second;
-    TrajectorySample* sample = kd_tree[action]->getObject(node);
+  for (int i = 0; i < n_neighbours; ++i) {
+    TrajectorySample* sample = knn[i].second;
     y += (sample->s2 + (x - sample->s) * alpha) * w[i];
     reward += sample->r * w[i];
   }
@@ -139,16 +186,13 @@ void KNNModel::GetExpectedTransition(real alpha, Vector& x, int action,
 real KNNModel::GetExpectedActionValue(Vector& x, int action, int K, real b) {
   RBF rbf(x, b);
 
-  OrderedFixedList<KDNode> node_list =
-      kd_tree[action]->FindKNearestNeighbours(x, K);
-
-  std::list<std::pair<real, KDNode*> >::iterator it;
+  std::vector<FlatKDTree<TrajectorySample>::ObjectNeighbour> knn;
+  kd_tree[action]->FindKNearestObjects(x, K, knn);
 
   real sum = 0;
   real Q = 0.0;
-  for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-    KDNode* node = it->second;
-    TrajectorySample* sample = kd_tree[action]->getObject(node);
+  for (uint k = 0; k < knn.size(); ++k) {
+    TrajectorySample* sample = knn[k].second;
     real w = rbf.Evaluate(sample->s);
     Q += sample->V * w;
     sum += w;
@@ -206,17 +250,14 @@ void KNNModel::UpdateValue(TrajectorySample& start_sample, real alpha, int K,
   Vector Q(n_actions);
 
   for (int a = 0; a < n_actions; ++a) {
-    OrderedFixedList<KDNode> node_list =
-        kd_tree[a]->FindKNearestNeighbours(start_sample.s, K);
-
-    KDTree<TrajectorySample>::iterator it;
+    std::vector<FlatKDTree<TrajectorySample>::ObjectNeighbour> knn;
+    kd_tree[a]->FindKNearestObjects(start_sample.s, K, knn);
 
     real sum = 0;
     Q[a] = 0.0;
     // printf("Action %d: ", a);
-    for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-      KDNode* node = it->second;
-      TrajectorySample* sample = kd_tree[a]->getObject(node);
+    for (uint k = 0; k < knn.size(); ++k) {
+      TrajectorySample* sample = knn[k].second;
       Vector y = sample->s2 + (start_sample.s - sample->s) * alpha;
       real w = rbf.Evaluate(sample->s);
       real Qa_i = (sample->r + gamma * GetExpectedValue(y, K, b));
@@ -228,7 +269,7 @@ void KNNModel::UpdateValue(TrajectorySample& start_sample, real alpha, int K,
       sum += w;
     }
     Q[a] /= sum;
-    if (node_list.S.size() == 0) {
+    if (knn.size() == 0) {
       Q[a] = 0.0;
     }
     // printf ("-> %f\n", Q[a]);
@@ -248,7 +289,7 @@ void KNNModel::UpdateValue(TrajectorySample& start_sample, real alpha, int K,
 
 */
 void KNNModel::ValueIteration(real alpha, int K, real b) {
-  for (std::list<TrajectorySample>::iterator it = samples.begin();
+  for (std::deque<TrajectorySample>::iterator it = samples.begin();
        it != samples.end(); ++it) {
     if (it->dV > 0) {  // 10e-6) {
       UpdateValue(*it, alpha, K, b);
@@ -257,7 +298,7 @@ void KNNModel::ValueIteration(real alpha, int K, real b) {
 }
 
 void KNNModel::Show() {
-  for (std::list<TrajectorySample>::iterator it = samples.begin();
+  for (std::deque<TrajectorySample>::iterator it = samples.begin();
        it != samples.end(); ++it) {
     for (int i = 0; i < n_dim; ++i) {
       printf("%f ", it->s[i]);
@@ -12,9 +12,9 @@
 #ifndef KNN_MODEL_H
 #define KNN_MODEL_H
 
-#include <list>
+#include <deque>
 #include <vector>
-#include "KDTree.h"
+#include "FlatKDTree.h"
 #include "Vector.h"
 
 class TrajectorySample {
@@ -31,20 +31,49 @@ class TrajectorySample {
       : s(s_), a(a_), r(r_), s2(s2_), V(0.0), dV(1.0), terminal(terminal_) {}
 };
 
-/** A K-Nearest-neighbour model of a controlled process. */
+/** A K-Nearest-neighbour model of a controlled process.
+
+    By default, all accepted samples are kept. With SetMaxSamples(),
+    at most max_samples are kept, so that the model can run for ever in
+    fixed memory and ValueIteration() has a fixed cost. Once the model
+    is full, a new sample is handled according to the eviction policy:
+
+    - NO_EVICTION: the sample is discarded.
+    - FIFO_EVICTION: the sample replaces the oldest one.
+    - RESERVOIR_EVICTION: the n-th accepted sample replaces a random
+      sample with probability max_samples / n, so that the model holds
+      a uniform sample of all accepted samples.
+    - THINNING_EVICTION: the sample replaces the most redundant of a few
+      random samples, that is, the one closest to another sample with
+      the same action.
+ */
 class KNNModel {
+ public:
+  /// What to do with new samples when the model is full
+  enum EvictionPolicy {
+    NO_EVICTION,
+    FIFO_EVICTION,
+    RESERVOIR_EVICTION,
+    THINNING_EVICTION
+  };
+
  protected:
   int n_actions;  ///< The number of actions
   int n_dim;      ///< The number of state dimensions
-  std::vector<KDTree<TrajectorySample>*> kd_tree;  ///< One tree per action
+  std::vector<FlatKDTree<TrajectorySample>*> kd_tree;  ///< One tree per action
   // RBFBasisSet basis;
-  std::list<TrajectorySample> samples;
+  std::deque<TrajectorySample> samples;  ///< The samples
+  std::vector<int> tree_index;  ///< The index of each sample in its tree
   real gamma;
   bool optimistic_values;
   real optimism;
   real r_max;
   int max_samples;
+  EvictionPolicy eviction;  ///< What to do when the model is full
+  int n_accepted;           ///< The number of accepted samples
+  int oldest;               ///< The oldest sample, for FIFO eviction
   real threshold;
+  int SelectEvictedSample();
 
  public:
   KNNModel(int n_actions, int n_dim, real gamma_ = 0.9, bool optimistic = true,
@@ -59,8 +88,14 @@ class KNNModel {
   void UpdateValue(TrajectorySample& start_sample, real alpha, int K, real b);
   void ValueIteration(real alpha, int K, real b);
   void Show();
-  /// The maximum number of samples to store
-  void SetMaxSamples(int max_samples_) { max_samples = max_samples_; }
+  /// The maximum number of samples to store, and what to do beyond it
+  void SetMaxSamples(int max_samples_,
+                     EvictionPolicy eviction_ = NO_EVICTION) {
+    max_samples = max_samples_;
+    eviction = eviction_;
+  }
+  /// The number of samples stored
+  int getNumberOfSamples() const { return (int)samples.size(); }
 };
 
 #endif
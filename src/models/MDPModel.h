@@ -93,6 +93,12 @@ class MDPModel {
 
   virtual DiscreteMDP* generate() const = 0;
 
+  /// Generate an MDP, drawing from the given stream
+  virtual DiscreteMDP* generate(RandomNumberGenerator& rng) const {
+    ScopedRandomNumberGenerator scope(&rng);
+    return generate();
+  }
+
   virtual const DiscreteMDP* const getMeanMDP() const = 0;
 
   virtual void ShowModel() const;
@@ -60,7 +60,8 @@ DiscreteSpaceRewardDistribution::DiscreteSpaceRewardDistribution(int n_states_,
     : n_states(n_states_),
       n_actions(n_actions_),
       R(n_states * n_actions),
-      ER(n_states * n_actions) {
+      ER(n_states * n_actions),
+      stamp(NewModificationStamp()) {
   // empty
   for (uint i = 0; i < R.size(); ++i) {
     R[i] = NULL;
@@ -70,21 +71,62 @@ DiscreteSpaceRewardDistribution::DiscreteSpaceRewardDistribution(int n_states_,
   // R.size(), ER.Size());
 }
 
-/// Copy constructor. Do not actually copy anything!
+/** Copy constructor. Do not actually copy anything!
+
+    The distributions belong to rhs, so the copy only keeps the expected
+    rewards, and generates them deterministically.
+ */
+DiscreteSpaceRewardDistribution::DiscreteSpaceRewardDistribution(
+    const DiscreteSpaceRewardDistribution& rhs)
+    : n_states(rhs.n_states),
+      n_actions(rhs.n_actions),
+      R(rhs.R.size(), (Distribution*)NULL),
+      ER(rhs.ER),
+      stamp(rhs.stamp) {}
+
+/// Move constructor. This takes over the distributions of rhs.
 DiscreteSpaceRewardDistribution::DiscreteSpaceRewardDistribution(
+    DiscreteSpaceRewardDistribution&& rhs)
+    : n_states(rhs.n_states),
+      n_actions(rhs.n_actions),
+      R(std::move(rhs.R)),
+      distribution_vector(std::move(rhs.distribution_vector)),
+      ER(std::move(rhs.ER)),
+      stamp(rhs.stamp) {
+  rhs.R.clear();
+  rhs.distribution_vector.clear();
+}
+
+/// Assignment operator. Do not copy anything!
+DiscreteSpaceRewardDistribution& DiscreteSpaceRewardDistribution::operator=(
     const DiscreteSpaceRewardDistribution& rhs) {
+  if (this == &rhs) return *this;
   n_states = rhs.n_states;
   n_actions = rhs.n_actions;
+  R.resize(rhs.R.size());
+  for (uint i = 0; i < R.size(); ++i) {
+    R[i] = NULL;
+  }
   ER = rhs.ER;
+  stamp = rhs.stamp;
+  return *this;
 }
 
-/// Assignment operator. Do not copy anything!
+/// Move assignment. This takes over the distributions of rhs.
 DiscreteSpaceRewardDistribution& DiscreteSpaceRewardDistribution::operator=(
-    const DiscreteSpaceRewardDistribution& rhs) {
+    DiscreteSpaceRewardDistribution&& rhs) {
   if (this == &rhs) return *this;
+  for (uint i = 0; i < distribution_vector.size(); ++i) {
+    delete distribution_vector[i];
+  }
   n_states = rhs.n_states;
   n_actions = rhs.n_actions;
-  ER = rhs.ER;
+  R = std::move(rhs.R);
+  distribution_vector = std::move(rhs.distribution_vector);
+  ER = std::move(rhs.ER);
+  stamp = rhs.stamp;
+  rhs.R.clear();
+  rhs.distribution_vector.clear();
   return *this;
 }
 
@@ -139,6 +181,7 @@ void DiscreteSpaceRewardDistribution::setRewardDistribution(
   int ID = getID(s, a);
   R[ID] = reward;
   ER(ID) = reward->getMean();
+  stamp = NewModificationStamp();
 }
 
 // only use this function once per state-action pair
@@ -149,6 +192,7 @@ void DiscreteSpaceRewardDistribution::addRewardDistribution(
   distribution_vector.push_back(reward);
   R[ID] = reward;
   ER(ID) = reward->getMean();
+  stamp = NewModificationStamp();
 }
 // only use this function once per state-action pair
 void DiscreteSpaceRewardDistribution::addFixedReward(int s, int a,
@@ -165,6 +209,7 @@ void DiscreteSpaceRewardDistribution::setFixedReward(int s, int a,
   if (R[ID]) {
     R[ID]->setMean(reward);
     ER[ID] = reward;
+    stamp = NewModificationStamp();
   } else {
     SingularDistribution* distribution = new SingularDistribution(reward);
     addRewardDistribution(s, a, distribution);
@@ -14,6 +14,7 @@
 #define REWARD_DISTRIBUTION_H
 
 #include <vector>
+#include "ModificationStamp.h"
 #include "Vector.h"
 #include "real.h"
 
@@ -58,6 +59,7 @@ class DiscreteSpaceRewardDistribution : public RewardDistribution<int, int> {
   std::vector<Distribution*> R;                    ///< reward distribution
   std::vector<Distribution*> distribution_vector;  ///< for malloc
   Vector ER;                                       ///< expected reward
+  ulong stamp;  ///< stamp of the last modification
   inline int getID(int s, int a) const {
     assert(s >= 0 && s < n_states);
     assert(a >= 0 && a < n_actions);
@@ -67,8 +69,11 @@ class DiscreteSpaceRewardDistribution : public RewardDistribution<int, int> {
  public:
   DiscreteSpaceRewardDistribution(int n_states_, int n_actions_);
   DiscreteSpaceRewardDistribution(const DiscreteSpaceRewardDistribution& rhs);
+  DiscreteSpaceRewardDistribution(DiscreteSpaceRewardDistribution&& rhs);
   DiscreteSpaceRewardDistribution& operator=(
       const DiscreteSpaceRewardDistribution& rhs);
+  DiscreteSpaceRewardDistribution& operator=(
+      DiscreteSpaceRewardDistribution&& rhs);
   virtual ~DiscreteSpaceRewardDistribution();
   virtual real generate(int state, int action) const;
   virtual real expected(int state, int action) const;
@@ -79,6 +84,8 @@ class DiscreteSpaceRewardDistribution : public RewardDistribution<int, int> {
   void setFixedReward(int s, int a, real reward);
   void Show();
   Vector getExpectedRewardVector() const { return ER; }
+  /// Get the stamp of the last modification
+  ulong getModificationStamp() const { return stamp; }
 };
 
 #endif
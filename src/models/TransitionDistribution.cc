@@ -34,6 +34,7 @@ void DiscreteTransitionDistribution::SetTransition(int state, int action,
                                                    int next_state,
                                                    real probability) {
   assert(probability >= 0 && probability <= 1);
+  stamp = NewModificationStamp();
   DiscreteTransition transition = DiscreteTransition(state, action, next_state);
   if (probability > 0) {
     P[transition] = probability;
@@ -19,6 +19,7 @@
 
 #include "DiscreteStateSet.h"
 #include "HashCombine.h"
+#include "ModificationStamp.h"
 #include "StateAction.h"
 #include "debug.h"
 #include "real.h"
@@ -84,8 +85,13 @@ class TransitionDistribution<int, int> {
   ///< next states for quick access
   std::unordered_map<DiscreteStateAction, DiscreteStateSet> next_states;
 
+  ///< stamp of the last modification
+  ulong stamp;
+
   TransitionDistribution(int n_states_, int n_actions_)
-      : n_states(n_states_), n_actions(n_actions_) {}
+      : n_states(n_states_),
+        n_actions(n_actions_),
+        stamp(NewModificationStamp()) {}
 
   virtual ~TransitionDistribution();
 
@@ -93,6 +99,9 @@ class TransitionDistribution<int, int> {
 
   int GetNActions() const { return n_actions; }
 
+  /// Get the stamp of the last modification
+  ulong getModificationStamp() const { return stamp; }
+
   /// Set a state transition
   virtual void SetTransition(int state, int action, int next_state,
                              real probability);
@@ -0,0 +1,113 @@
+// -*- Mode: c++ -*-
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+
+#include "CompiledDiscreteMDP.h"
+#include "DiscreteMDP.h"
+#include "Random.h"
+#include "real.h"
+
+/// Make an MDP with a few random transitions per state-action pair
+DiscreteMDP* MakeRandomMDP(int n_states, int n_actions) {
+  DiscreteMDP* mdp = new DiscreteMDP(n_states, n_actions);
+  for (int s = 0; s < n_states; ++s) {
+    for (int a = 0; a < n_actions; ++a) {
+      Vector p(n_states);
+      for (int k = 0; k < 3; ++k) {
+        p(rand() % n_states) += urandom();
+      }
+      p /= p.Sum();
+      mdp->setTransitionProbabilities(s, a, p);
+      mdp->setFixedReward(s, a, urandom());
+    }
+  }
+  return mdp;
+}
+
+/// Check that the snapshot agrees with the model
+int CheckSnapshot(const DiscreteMDP& mdp, const CompiledDiscreteMDP& kernel) {
+  int errors = 0;
+  for (int s = 0; s < mdp.getNStates(); ++s) {
+    for (int a = 0; a < mdp.getNActions(); ++a) {
+      Vector P(mdp.getNStates());
+      for (int i = kernel.RowBegin(s, a); i < kernel.RowEnd(s, a); ++i) {
+        P(kernel.getNextState(i)) = kernel.getProbability(i);
+      }
+      for (int s2 = 0; s2 < mdp.getNStates(); ++s2) {
+        if (P(s2) != mdp.getTransitionProbability(s, a, s2)) {
+          errors++;
+        }
+      }
+      if (kernel.getExpectedReward(s, a) != mdp.getExpectedReward(s, a)) {
+        errors++;
+      }
+    }
+  }
+  return errors;
+}
+
+int main() {
+  int n_states = 20;
+  int n_actions = 3;
+  int errors = 0;
+
+  DiscreteMDP* mdp = MakeRandomMDP(n_states, n_actions);
+  CompiledDiscreteMDP kernel(*mdp);
+  errors += CheckSnapshot(*mdp, kernel);
+
+  if (kernel.Synchronise(*mdp)) {
+    fprintf(stderr, "Unchanged model recompiled\n");
+    errors++;
+  }
+
+  mdp->setFixedReward(0, 0, 10.0);
+  if (!kernel.Synchronise(*mdp) || kernel.getExpectedReward(0, 0) != 10.0) {
+    fprintf(stderr, "Reward change not detected\n");
+    errors++;
+  }
+
+  Vector p(n_states);
+  p(n_states - 1) = 1.0;
+  mdp->setTransitionProbabilities(1, 1, p);
+  if (!kernel.Synchronise(*mdp)) {
+    fprintf(stderr, "Transition change not detected\n");
+    errors++;
+  }
+  errors += CheckSnapshot(*mdp, kernel);
+
+  // A copy has the same contents, so the snapshot stays valid.
+  DiscreteMDP copy(*mdp);
+  if (!kernel.isCurrent(copy)) {
+    fprintf(stderr, "Copy of model considered stale\n");
+    errors++;
+  }
+
+  // A new model has new stamps, even if it is at the same address.
+  delete mdp;
+  mdp = MakeRandomMDP(n_states, n_actions);
+  if (kernel.isCurrent(*mdp)) {
+    fprintf(stderr, "New model considered current\n");
+    errors++;
+  }
+  kernel.Synchronise(*mdp);
+  errors += CheckSnapshot(*mdp, kernel);
+  delete mdp;
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
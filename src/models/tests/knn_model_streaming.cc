@@ -0,0 +1,151 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Run KNNModel on a long stream of samples from a noisy oscillator,
+    with each eviction policy, and check that the number of samples
+    and the cost of value iteration stay bounded, that the KD-trees
+    hold exactly the stored samples, and that FIFO eviction replaces
+    the oldest sample.
+*/
+
+#ifdef MAKE_MAIN
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include "EasyClock.h"
+#include "KNNModel.h"
+#include "Random.h"
+
+/// Expose the samples and trees of KNNModel
+class StreamingKNNModel : public KNNModel {
+ public:
+  StreamingKNNModel(int n_actions, int n_dim)
+      : KNNModel(n_actions, n_dim, 0.9, false, 0.0, 1.0) {}
+  /// The number of samples accepted so far
+  int getNumberOfAccepted() const { return n_accepted; }
+  const TrajectorySample& getSample(int i) const { return samples[i]; }
+  /// The number of points in the trees of all actions
+  int getNumberOfTreePoints() const {
+    int n_points = 0;
+    for (int a = 0; a < n_actions; ++a) {
+      n_points += kd_tree[a]->getNumberOfPoints();
+    }
+    return n_points;
+  }
+};
+
+/// Whether a stored sample is the given one
+bool SameSample(const TrajectorySample& x, const TrajectorySample& y) {
+  return x.a == y.a && x.r == y.r && x.s[0] == y.s[0] && x.s[1] == y.s[1];
+}
+
+int StreamingTest(const char* name, KNNModel::EvictionPolicy eviction,
+                  int max_samples, int T) {
+  int errors = 0;
+  int n_actions = 2;
+  int n_dim = 2;
+  int K = 4;
+  real beta = 1.0;
+  real alpha = 0.5;
+  StreamingKNNModel model(n_actions, n_dim);
+  model.SetMaxSamples(max_samples, eviction);
+  // the time at which each stored sample was added
+  std::vector<int> added;
+
+  Vector s(n_dim);
+  Vector s2(n_dim);
+  Vector y(n_dim);
+  real reward = 0.0;
+  s[0] = 1.0;
+  real dt = 0.05;
+  double first_time = 0.0;
+  double last_time = 0.0;
+  for (int t = 0; t < T; ++t) {
+    int a = urandom(0, n_actions);
+    real force = (a == 0) ? -1.0 : 1.0;
+    s2[0] = s[0] + s[1] * dt;
+    s2[1] = s[1] + (force - s[0]) * dt + urandom(-0.01, 0.01);
+    TrajectorySample sample(s, a, -fabs(s2[0]), s2);
+    int n_samples = model.getNumberOfSamples();
+    int n_accepted = model.getNumberOfAccepted();
+    model.AddSample(sample, K, beta);
+    if (model.getNumberOfAccepted() > n_accepted) {
+      if (n_samples < model.getNumberOfSamples()) {
+        added.push_back(t);
+      } else if (eviction == KNNModel::FIFO_EVICTION) {
+        int oldest = std::min_element(added.begin(), added.end()) -
+                     added.begin();
+        if (!SameSample(model.getSample(oldest), sample)) {
+          fprintf(stderr, "%s: sample %d is not the oldest\n", name, oldest);
+          errors++;
+        }
+        added[oldest] = t;
+      }
+    }
+    if (model.getNumberOfTreePoints() != model.getNumberOfSamples()) {
+      fprintf(stderr, "%s: %d points in the trees for %d samples\n", name,
+              model.getNumberOfTreePoints(), model.getNumberOfSamples());
+      errors++;
+      break;
+    }
+    double start_time = GetCPU();
+    model.ValueIteration(alpha, K, beta);
+    double iteration_time = GetCPU() - start_time;
+    if (t < T / 4) {
+      first_time += iteration_time;
+    } else if (t >= 3 * T / 4) {
+      last_time += iteration_time;
+    }
+    if (max_samples >= 0 && model.getNumberOfSamples() > max_samples) {
+      fprintf(stderr, "%s: %d samples\n", name, model.getNumberOfSamples());
+      errors++;
+      break;
+    }
+    s = s2;
+    if (fabs(s[0]) > 10.0) {
+      s[0] = 1.0;
+      s[1] = 0.0;
+    }
+  }
+  model.GetExpectedTransition(alpha, s, 0, reward, y, K, beta);
+  if (std::isnan(y[0]) || std::isnan(reward)) {
+    fprintf(stderr, "%s: invalid prediction\n", name);
+    errors++;
+  }
+  printf("%s: %d samples, value iteration %f s in the first quarter, ", name,
+         model.getNumberOfSamples(), first_time);
+  printf("%f s in the last\n", last_time);
+  return errors;
+}
+
+int main(int argc, char** argv) {
+  int T = 2000;
+  if (argc > 1) {
+    T = atoi(argv[1]);
+  }
+  int max_samples = 100;
+  int errors = 0;
+  errors += StreamingTest("unbounded", KNNModel::NO_EVICTION, -1, T);
+  errors += StreamingTest("no eviction", KNNModel::NO_EVICTION, max_samples, T);
+  errors += StreamingTest("FIFO", KNNModel::FIFO_EVICTION, max_samples, T);
+  errors +=
+      StreamingTest("reservoir", KNNModel::RESERVOIR_EVICTION, max_samples, T);
+  errors +=
+      StreamingTest("thinning", KNNModel::THINNING_EVICTION, max_samples, T);
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -13,6 +13,7 @@
 #include "ranlib.h"
 #include "BetaDistribution.h"
 #include "ExponentialDistribution.h"
+#include "Sampling.h"
 #include "SpecialFunctions.h"
 
 /// Calculate
@@ -85,6 +86,19 @@ real BetaDistribution::generate() const {
   return genbet(alpha, beta);
 }
 
+/// Generate from a stream
+real BetaDistribution::generate(RandomNumberGenerator& rng) const {
+  assert(alpha > 0 && beta > 0);
+  return BetaSample(alpha, beta, rng);
+}
+
+/// Fill x with n samples from a stream
+void BetaDistribution::generate_n(real* x, int n,
+                                  RandomNumberGenerator& rng) const {
+  assert(alpha > 0 && beta > 0);
+  BetaSample(alpha, beta, x, n, rng);
+}
+
 /// Generate using ranlib
 real BetaDistribution::generateMarginal() {
   if (urandom() < getMean()) {
@@ -55,6 +55,9 @@ class BetaDistribution : public ConjugatePrior {
   virtual real getVariance();
   virtual real generate();
   real generate() const;
+  virtual real generate(RandomNumberGenerator& rng) const;
+  using Distribution::generate_n;
+  virtual void generate_n(real* x, int n, RandomNumberGenerator& rng) const;
   virtual real generateMarginal();
   real Observe(real x);
   real setMaximumLikelihoodParameters(const std::vector<real>& x,
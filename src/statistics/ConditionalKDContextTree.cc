@@ -18,14 +18,13 @@
 #define DEFAULT_PRIOR_NORMAL 0.5
 
 ConditionalKDContextTree::Node::Node(ConditionalKDContextTree& tree_,
-                                     Vector& lower_bound_x_,
-                                     Vector& upper_bound_x_)
+                                     int index_, Vector& lower_bound_x,
+                                     Vector& upper_bound_x)
     : tree(tree_),
-      lower_bound_x(lower_bound_x_),
-      upper_bound_x(upper_bound_x_),
+      index(index_),
+      branch(-1),
       depth(0),
       prev(NULL),
-      next(tree.n_branches),
       w(1),
       log_w(0),
       S(0) {
@@ -58,14 +57,14 @@ ConditionalKDContextTree::Node::Node(ConditionalKDContextTree& tree_,
 
  */
 ConditionalKDContextTree::Node::Node(ConditionalKDContextTree::Node* prev_,
-                                     Vector& lower_bound_x_,
-                                     Vector& upper_bound_x_)
+                                     int index_, int branch_,
+                                     Vector& lower_bound_x,
+                                     Vector& upper_bound_x)
     : tree(prev_->tree),
-      lower_bound_x(lower_bound_x_),
-      upper_bound_x(upper_bound_x_),
+      index(index_),
+      branch(branch_),
       depth(prev_->depth + 1),
       prev(prev_),
-      next(tree.n_branches),
       log_w(-depth * log(2)),
       S(0) {
   assert(lower_bound_x < upper_bound_x);
@@ -81,9 +80,6 @@ ConditionalKDContextTree::Node::Node(ConditionalKDContextTree::Node* prev_,
 #endif
 
   w = exp(log_w);
-  for (int i = 0; i < tree.n_branches; ++i) {
-    next[i] = NULL;
-  }
 
   local_density = new ContextTreeKDTree(tree.n_branches, tree.max_depth_cond,
                                         tree.lower_bound_y, tree.upper_bound_y);
@@ -95,12 +91,25 @@ ConditionalKDContextTree::Node::Node(ConditionalKDContextTree::Node* prev_,
   log_prior_normal = log(prior_normal);
 }
 
-/// make sure to kill all
+/// The next nodes are destroyed by the tree
 ConditionalKDContextTree::Node::~Node() {
   delete local_density;
   delete normal_density;
-  for (int i = 0; i < tree.n_branches; ++i) {
-    delete next[i];
+}
+
+/// Get the bounds of the node from the root bounds and the splits above it
+void ConditionalKDContextTree::Node::Bounds(Vector& lower_bound_x,
+                                            Vector& upper_bound_x) {
+  if (!prev) {
+    lower_bound_x = tree.lower_bound_x;
+    upper_bound_x = tree.upper_bound_x;
+    return;
+  }
+  prev->Bounds(lower_bound_x, upper_bound_x);
+  if (branch == 0) {
+    upper_bound_x(prev->splitting_dimension) = prev->mid_point;
+  } else {
+    lower_bound_x(prev->splitting_dimension) = prev->mid_point;
   }
 }
 
@@ -152,18 +161,19 @@ real ConditionalKDContextTree::Node::Observe(Vector& x, Vector& y,
 #endif
   // Do a forward mixture if there is another node available.
   if ((tree.max_depth == 0 || depth < tree.max_depth) && S > threshold) {
-    if (!next[k]) {
+    Node* next_node = next(k);
+    if (!next_node) {
+      Vector lower_bound_x;
+      Vector upper_bound_x;
+      Bounds(lower_bound_x, upper_bound_x);
       if (k == 0) {
-        Vector new_bound_x = upper_bound_x;
-        new_bound_x(splitting_dimension) = mid_point;
-        next[k] = new Node(this, lower_bound_x, new_bound_x);
+        upper_bound_x(splitting_dimension) = mid_point;
       } else {
-        Vector new_bound_x = lower_bound_x;
-        new_bound_x(splitting_dimension) = mid_point;
-        next[k] = new Node(this, new_bound_x, upper_bound_x);
+        lower_bound_x(splitting_dimension) = mid_point;
       }
+      next_node = tree.NewNode(this, k, lower_bound_x, upper_bound_x);
     }
-    total_probability = next[k]->Observe(x, y, total_probability);
+    total_probability = next_node->Observe(x, y, total_probability);
   }
 
   return total_probability;
@@ -202,8 +212,8 @@ real ConditionalKDContextTree::Node::pdf(Vector& x, Vector& y,
     k = 1;
   }
   // Do one more mixing step if required
-  if (next[k]) {
-    total_probability = next[k]->pdf(x, y, total_probability);
+  if (next(k)) {
+    total_probability = next(k)->pdf(x, y, total_probability);
   }
   return total_probability;
 }
@@ -212,8 +222,8 @@ void ConditionalKDContextTree::Node::Show() {
 #if 0
 	printf("%d %f #w\n", depth, w);
 	for (int k=0; k<tree.n_branches; ++k) {
-		if (next[k]) {
-			next[k]->Show();
+		if (next(k)) {
+			next(k)->Show();
 		}
 	}
 #endif
@@ -223,26 +233,50 @@ void ConditionalKDContextTree::Node::Show() {
 int ConditionalKDContextTree::Node::NChildren() {
   int my_children = 0;
   for (int k = 0; k < tree.n_branches; ++k) {
-    if (next[k]) {
+    if (next(k)) {
       my_children++;
-      my_children += next[k]->NChildren();
+      my_children += next(k)->NChildren();
     }
   }
   return my_children;
 }
 
 ConditionalKDContextTree::ConditionalKDContextTree(
-    int n_branches_, int max_depth_, int max_depth_cond_, Vector& lower_bound_x,
-    Vector& upper_bound_x, Vector& lower_bound_y_, Vector& upper_bound_y_)
+    int n_branches_, int max_depth_, int max_depth_cond_,
+    Vector& lower_bound_x_, Vector& upper_bound_x_, Vector& lower_bound_y_,
+    Vector& upper_bound_y_)
     : n_branches(n_branches_),
       max_depth(max_depth_),
       max_depth_cond(max_depth_cond_),
+      lower_bound_x(lower_bound_x_),
+      upper_bound_x(upper_bound_x_),
       lower_bound_y(lower_bound_y_),
       upper_bound_y(upper_bound_y_) {
-  root = new Node(*this, lower_bound_x, upper_bound_x);
+  root = NewNode(NULL, 0, lower_bound_x, upper_bound_x);
+}
+
+ConditionalKDContextTree::~ConditionalKDContextTree() {}
+
+/// Forget all data, freeing all nodes at once
+void ConditionalKDContextTree::Reset() {
+  nodes.Clear();
+  children.clear();
+  root = NewNode(NULL, 0, lower_bound_x, upper_bound_x);
 }
 
-ConditionalKDContextTree::~ConditionalKDContextTree() { delete root; }
+/// Make a new node following branch k of prev, or a root if prev is NULL
+ConditionalKDContextTree::Node* ConditionalKDContextTree::NewNode(
+    Node* prev, int branch, Vector& lower_bound_x_, Vector& upper_bound_x_) {
+  int index = nodes.size();
+  children.resize(children.size() + n_branches, -1);
+  if (prev) {
+    children[prev->index * n_branches + branch] = index;
+    nodes.New(prev, index, branch, lower_bound_x_, upper_bound_x_);
+  } else {
+    nodes.New(*this, index, lower_bound_x_, upper_bound_x_);
+  }
+  return nodes.Get(index);
+}
 
 /** Obtain \f$\xi_t(y \mid x)\f$ and calculate \f$\xi_{t+1}(w) = \xi_t(w \mid x,
  * y)\f$.
@@ -16,6 +16,7 @@
 #include "ContextTreeKDTree.h"
 #include "MultivariateNormal.h"
 #include "MultivariateNormalUnknownMeanPrecision.h"
+#include "NodePool.h"
 #include "Ring.h"
 #include "Vector.h"
 #include "real.h"
@@ -50,8 +51,8 @@ class ConditionalKDContextTree {
   // public classes
   struct Node {
     ConditionalKDContextTree& tree;  ///< the tree
-    Vector lower_bound_x;            ///< looks at x > lower_bound
-    Vector upper_bound_x;            ///< looks at x < upper_bound
+    int index;                       ///< index of the node in the tree
+    int branch;                      ///< which branch of prev this node is
     real mid_point;                  ///< how to split
     int splitting_dimension;         ///< dimension on which to do the split.
     const int depth;                 ///< depth of the node
@@ -61,14 +62,20 @@ class ConditionalKDContextTree {
     MultivariateNormalUnknownMeanPrecision*
         normal_density;       ///< local density estimator
     Node* prev;               ///< previous node
-    std::vector<Node*> next;  ///< pointers to next nodes
     real w;                   ///< backoff weight
     real log_w;               ///< log of w
 
-    Node(ConditionalKDContextTree& tree_, Vector& lower_bound_x_,
+    Node(ConditionalKDContextTree& tree_, int index_, Vector& lower_bound_x_,
          Vector& upper_bound_x_);
-    Node(Node* prev_, Vector& lower_bound_x, Vector& upper_bound_x);
+    Node(Node* prev_, int index_, int branch_, Vector& lower_bound_x,
+         Vector& upper_bound_x);
     ~Node();
+    /// the k-th next node, or NULL
+    Node* next(int k) {
+      int child = tree.children[index * tree.n_branches + k];
+      return (child < 0) ? NULL : tree.nodes.Get(child);
+    }
+    void Bounds(Vector& lower_bound_x, Vector& upper_bound_x);
     real Observe(Vector& x, Vector& y, real probability);
     real pdf(Vector& x, Vector& y, real probability);
     void Show();
@@ -81,6 +88,7 @@ class ConditionalKDContextTree {
                            Vector& lower_bound_x, Vector& upper_bound_x,
                            Vector& lower_bound_y, Vector& upper_bound_y);
   ~ConditionalKDContextTree();
+  void Reset();
   real Observe(Vector& x, Vector& y);
   real pdf(Vector& x, Vector& y);
   void Show();
@@ -90,9 +98,15 @@ class ConditionalKDContextTree {
   int n_branches;
   int max_depth;
   int max_depth_cond;
+  Vector lower_bound_x;  ///< lower bound of the root
+  Vector upper_bound_x;  ///< upper bound of the root
   Vector lower_bound_y;
   Vector upper_bound_y;
   Node* root;
+  NodePool<Node> nodes;       ///< all nodes
+  std::vector<int> children;  ///< n_branches child indices per node, or -1
+  Node* NewNode(Node* prev, int branch, Vector& lower_bound_x_,
+                Vector& upper_bound_x_);
 };
 
 #endif
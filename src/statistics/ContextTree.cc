@@ -14,153 +14,77 @@
 //#define DEFAULT_PRIOR (1.0 / sqrt((real) n_outcomes))
 #define DEFAULT_PRIOR (1.0 / (real)n_outcomes)
 
-ContextTree::Node::Node(int n_branches_, int n_outcomes_)
-    : N_obs(0),
-      n_branches(n_branches_),
-      n_outcomes(n_outcomes_),
+ContextTree::Node::Node(ContextTree& tree_, int index_)
+    : tree(tree_),
+      index(index_),
+      N_obs(0),
+      n_branches(tree_.n_branches),
+      n_outcomes(tree_.n_symbols),
       depth(0),
       prev(NULL),
-      next(n_branches),
-      P(n_outcomes),
-      alpha(n_outcomes),
       prior_alpha(DEFAULT_PRIOR),
       w(1),
       log_w(0),
-      log_w_prior(0) {
-  for (int i = 0; i < n_outcomes; ++i) {
-    P(i) = 1.0 / (real)n_outcomes;
-    alpha(i) = 0;
-  }
-}
+      log_w_prior(0) {}
 
 /// Make a node for K symbols at nominal depth d
-ContextTree::Node::Node(ContextTree::Node* prev_)
-    : N_obs(0),
+ContextTree::Node::Node(ContextTree::Node* prev_, int index_)
+    : tree(prev_->tree),
+      index(index_),
+      N_obs(0),
       n_branches(prev_->n_branches),
       n_outcomes(prev_->n_outcomes),
       depth(prev_->depth + 1),
       prev(prev_),
-      next(n_branches),
-      P(n_outcomes),
-      alpha(n_outcomes),
       prior_alpha(DEFAULT_PRIOR),
       log_w(0),
       log_w_prior(prev_->log_w_prior - log(2))
 // log_w_prior( - log(10))
 {
   w = exp(log_w_prior);
-  for (int i = 0; i < n_branches; ++i) {
-    next[i] = NULL;
-  }
-  for (int i = 0; i < n_outcomes; ++i) {
-    P(i) = 1.0 / (real)n_outcomes;
-    alpha(i) = 0;
-  }
-}
-
-/// make sure to kill all
-ContextTree::Node::~Node() {
-  for (int i = 0; i < n_branches; ++i) {
-    delete next[i];
-  }
 }
 
 real ContextTree::Node::Observe(Ring<int>& history, Ring<int>::iterator x,
                                 int y, real probability) {
   real total_probability = 0;
-// calculate probabilities
-
-// Standard
-#if 0
-    real S = (real) N_obs; //xalpha.Sum();
-    real Z = 1.0 / (prior_alpha * (real) n_outcomes + S);
-    P = (alpha + prior_alpha) * Z;
-    
-    //printf("%f\n", P.Sum());//P.print(stdout);
-    //P /= P.Sum();
-    //P[y] = (alpha[y] + prior_alpha) * Z;
-#endif
-
-#if 0
-    // P-BVMM
-    // use a modified PPM -- best for many outcomes
-    real S = alpha.Sum(); // total number of observations
-    real Z = 0; // total prior mass for observed values
-    int zeros = 0; // number of unobserved values
-    for (int i=0; i<n_outcomes; ++i) {
-        if (alpha(i) > 0) {
-            Z += prior_alpha; 
-        } else {
-            zeros++;
-        }
-    }
-    if (zeros == n_outcomes) {
-        // case 1: observed nothing yet
-        for (int i=0; i<n_outcomes; ++i) {
-            if (alpha(i) == 0) {
-                P(i) = 1.0 / (real) n_outcomes;
-            }
-        }
-    } else {
-        // case 2: observed some things
-        real iSZ = 1.0 / (S + Z); // S + Z is the total alpha for observed values
-        P = (alpha) * iSZ; // Pr of seeing the i-th symbol if you know you are going to see a previsouly seen symbol
-        
-        real P_rest = 1.0 - P.Sum(); // Remaining mass
-        
-        if (zeros > 0) {
-            for (int i=0; i<n_outcomes; ++i) {
-                if (alpha(i) == 0) {
-                    P(i) = P_rest / (real) zeros;
-                }
-            }
-        }
-         P /= P.Sum();
-    }
-#endif
-
-#if 1
+  // calculate the probability of y
   // aka: I-BVMM -- best for many outcomes
-  real S = alpha.Sum();  // = N_obs
-  real N = 0;            // N is the number of symbols
+  real* alpha = this->alpha();
+  real S = 0;  // = N_obs
+  real N = 0;  // N is the number of symbols
   for (int i = 0; i < n_outcomes; ++i) {
-    if (alpha(i)) {
+    S += alpha[i];
+    if (alpha[i]) {
       N += 1;
     }
   }
   real Z = (1 + N) * prior_alpha + S;  // total dirichlet mass
-  P = (alpha + prior_alpha) / Z;
-  real n_zero_outcomes = n_outcomes - N;
-  if (n_zero_outcomes > 0) {
-    real SA = 1.0 / n_zero_outcomes;
-    for (int i = 0; i < n_outcomes; ++i) {
-      if (alpha(i) == 0) {
-        P(i) *= SA;
-      }
-    }
+  real P_y = (alpha[y] + prior_alpha) / Z;
+  if (alpha[y] == 0) {
+    // spread the prior mass over the unseen outcomes
+    P_y /= (real)n_outcomes - N;
   }
-#endif
   alpha[y]++;
   // P(y | B_k) = P(y | B_k, h_k) P(h_k | B_k) + (1 - P(h_k | B_k)) P(y |
   // B_{k-1})
   w = exp(log_w_prior + log_w);
 
-  total_probability = P[y] * w + (1 - w) * probability;
+  total_probability = P_y * w + (1 - w) * probability;
 #if 0
-    std::cout << depth << ": P(y|h_k)=" << P[y] 
+    std::cout << depth << ": P(y|h_k)=" << P_y 
               << ", P(h_k|B_k)=" << w 
               << ", P(y|B_{k-1})="<< probability
               << ", P(y|B_k)=" << total_probability
               << std::endl;
 #endif
-  // real posterior = w * P[y] / total_probability; // real posterior
+  // real posterior = w * P_y / total_probability; // real posterior
   // real posterior = w; // fake posterior
-  // real log_posterior = log(w) + log(P[y]) - log(total_probability);
+  // real log_posterior = log(w) + log(P_y) - log(total_probability);
   // log_w = log(posterior) - log_w_prior;
-  log_w = log(w * P[y] / total_probability) - log_w_prior;
+  log_w = log(w * P_y / total_probability) - log_w_prior;
 
   // This sometimes doesn't work
-  // log_w = log_w + log(P[y]) - log(total_probability);
+  // log_w = log_w + log(P_y) - log(total_probability);
 
   // Make sure we have enough observations to justify adding a
   // node. This means at least as many as total outcomes.
@@ -180,10 +104,11 @@ real ContextTree::Node::Observe(Ring<int>& history, Ring<int>::iterator x,
   if (x != history.end() && S > threshold) {
     int k = *x;
     ++x;
-    if (!next[k]) {
-      next[k] = new Node(this);
+    Node* next_node = next(k);
+    if (!next_node) {
+      next_node = tree.NewNode(this, k);
     }
-    total_probability = next[k]->Observe(history, x, y, total_probability);
+    total_probability = next_node->Observe(history, x, y, total_probability);
   }
 
   N_obs++;
@@ -193,13 +118,14 @@ real ContextTree::Node::Observe(Ring<int>& history, Ring<int>::iterator x,
 
 void ContextTree::Node::Show() {
   std::cout << w << " " << depth << "# weight depth\n";
+  real* alpha = this->alpha();
   for (int i = 0; i < n_outcomes; ++i) {
     std::cout << alpha[i] << " ";
   }
   for (int k = 0; k < n_branches; ++k) {
-    if (next[k]) {
+    if (next(k)) {
       std::cout << "b: " << k << std::endl;
-      next[k]->Show();
+      next(k)->Show();
     }
   }
   std::cout << "<<<<\n";
@@ -208,9 +134,9 @@ void ContextTree::Node::Show() {
 int ContextTree::Node::NChildren() {
   int my_children = 0;
   for (int k = 0; k < n_branches; ++k) {
-    if (next[k]) {
+    if (next(k)) {
       my_children++;
-      my_children += next[k]->NChildren();
+      my_children += next(k)->NChildren();
     }
   }
   return my_children;
@@ -221,12 +147,32 @@ ContextTree::ContextTree(int n_branches_, int n_symbols_, int max_depth_)
       n_symbols(n_symbols_),
       max_depth(max_depth_),
       history(max_depth) {
-  root = new Node(n_branches, n_symbols);
+  root = NewNode(NULL, 0);
+}
+
+ContextTree::~ContextTree() { Show(); }
+
+/// Remove all contexts and observations, freeing all nodes at once
+void ContextTree::Reset() {
+  nodes.Clear();
+  children.clear();
+  counts.clear();
+  history.clear();
+  root = NewNode(NULL, 0);
 }
 
-ContextTree::~ContextTree() {
-  Show();
-  delete root;
+/// Make a new node following branch k of prev, or a root if prev is NULL
+ContextTree::Node* ContextTree::NewNode(Node* prev, int branch) {
+  int index = nodes.size();
+  children.resize(children.size() + n_branches, -1);
+  counts.resize(counts.size() + n_symbols, 0.0);
+  if (prev) {
+    children[prev->index * n_branches + branch] = index;
+    nodes.New(prev, index);
+  } else {
+    nodes.New(*this, index);
+  }
+  return nodes.Get(index);
 }
 
 real ContextTree::Observe(int x, int y) {
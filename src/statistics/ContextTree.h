@@ -13,6 +13,7 @@
 #define CONTEXT_TREE_H
 
 #include <vector>
+#include "NodePool.h"
 #include "Ring.h"
 #include "Vector.h"
 #include "real.h"
@@ -27,21 +28,26 @@ class ContextTree {
  public:
   // public classes
   struct Node {
+    ContextTree& tree;        ///< the tree holding the node
+    int index;                ///< index of the node in the tree
     int N_obs;                ///< total number of observations
     int n_branches;           ///< The number of symbols we condition on
     int n_outcomes;           ///< The number of symbols to predict
     int depth;                ///< depth
     Node* prev;               ///< previous node
-    std::vector<Node*> next;  ///< pointers to next nodes
-    Vector P;                 ///< probability of next symbols
-    Vector alpha;             ///< parameters of next symbols
     const real prior_alpha;   ///< implicit prior value of alpha
     real w;                   ///< backoff weight
     real log_w;               ///< log of w
     real log_w_prior;         ///< initial value
-    Node(int n_branches_, int n_outcomes_);
-    Node(Node* prev_);
-    ~Node();
+    Node(ContextTree& tree_, int index_);
+    Node(Node* prev_, int index_);
+    /// parameters of next symbols
+    real* alpha() { return &tree.counts[index * n_outcomes]; }
+    /// the k-th next node, or NULL
+    Node* next(int k) {
+      int child = tree.children[index * n_branches + k];
+      return (child < 0) ? NULL : tree.nodes.Get(child);
+    }
     real Observe(Ring<int>& history, Ring<int>::iterator x, int y,
                  real probability);
     void Show();
@@ -51,6 +57,7 @@ class ContextTree {
   // public methods
   ContextTree(int n_branches_, int n_symbols_, int max_depth_ = 0);
   ~ContextTree();
+  void Reset();
   real Observe(int x, int y);
   void Show();
   int NChildren();
@@ -61,6 +68,10 @@ class ContextTree {
   int max_depth;
   Node* root;
   Ring<int> history;
+  NodePool<Node> nodes;       ///< all nodes
+  std::vector<int> children;  ///< n_branches child indices per node, or -1
+  std::vector<real> counts;   ///< n_symbols counts per node
+  Node* NewNode(Node* prev, int branch);
 };
 
 #endif
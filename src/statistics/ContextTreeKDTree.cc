@@ -17,7 +17,7 @@
 #undef LOG_CALCULATIONS
 
 /** Create the root node of the tree */
-ContextTreeKDTree::Node::Node(ContextTreeKDTree& tree_,
+ContextTreeKDTree::Node::Node(ContextTreeKDTree& tree_, int index_,
                               const Vector& lower_bound_,
                               const Vector& upper_bound_)
     : tree(tree_),
@@ -28,26 +28,24 @@ ContextTreeKDTree::Node::Node(ContextTreeKDTree& tree_,
       w_gaussian(0.5),
 #endif
       // beta_product(lower_bound_, upper_bound_),
-      lower_bound(lower_bound_),
-      upper_bound(upper_bound_),
-      volume(Volume(upper_bound - lower_bound)),
+      index(index_),
+      branch(-1),
+      volume(Volume(upper_bound_ - lower_bound_)),
       depth(0),
       prev(NULL),
-      next(tree.n_branches),
-      alpha(tree.n_branches),
       w(0.5),
       log_w(0),
       log_w_prior(-log(2)),
       S(0) {
-  assert(lower_bound < upper_bound);
-  splitting_dimension = ArgMax(upper_bound - lower_bound);
+  assert(lower_bound_ < upper_bound_);
+  splitting_dimension = ArgMax(upper_bound_ - lower_bound_);
 #ifdef RANDOM_SPLITS
   real phi = 0.1 + 0.8 * urandom();
-  mid_point = phi * upper_bound[splitting_dimension] +
-              (1 - phi) * lower_bound[splitting_dimension];
+  mid_point = phi * upper_bound_[splitting_dimension] +
+              (1 - phi) * lower_bound_[splitting_dimension];
 #else
   mid_point =
-      (upper_bound[splitting_dimension] + lower_bound[splitting_dimension]) /
+      (upper_bound_[splitting_dimension] + lower_bound_[splitting_dimension]) /
       2.0;
 #endif
 }
@@ -57,8 +55,8 @@ ContextTreeKDTree::Node::Node(ContextTreeKDTree& tree_,
     In order to avoid overfitting, the weights are fixed.
     That way, the contribution of the leaf nodes is small.
  */
-ContextTreeKDTree::Node::Node(ContextTreeKDTree::Node* prev_,
-                              const Vector& lower_bound_,
+ContextTreeKDTree::Node::Node(ContextTreeKDTree::Node* prev_, int index_,
+                              int branch_, const Vector& lower_bound_,
                               const Vector& upper_bound_)
     : tree(prev_->tree),
 #ifdef USE_GAUSSIAN_MIX
@@ -69,39 +67,46 @@ ContextTreeKDTree::Node::Node(ContextTreeKDTree::Node* prev_,
       w_gaussian(0.5),
 #endif
       // beta_product(lower_bound_, upper_bound_),
-      lower_bound(lower_bound_),
-      upper_bound(upper_bound_),
-      volume(Volume(upper_bound - lower_bound)),
+      index(index_),
+      branch(branch_),
+      volume(Volume(upper_bound_ - lower_bound_)),
       depth(prev_->depth + 1),
       prev(prev_),
-      next(tree.n_branches),
-      alpha(tree.n_branches),
       log_w(0),
       // log_w_prior(-(real) depth * log(2)),
       log_w_prior(-log(2)),
       S(0) {
-  assert(lower_bound < upper_bound);
-  splitting_dimension = ArgMax(upper_bound - lower_bound);
+  assert(lower_bound_ < upper_bound_);
+  splitting_dimension = ArgMax(upper_bound_ - lower_bound_);
 #ifdef RANDOM_SPLITS
   real phi = 0.1 + 0.8 * urandom();
-  mid_point = phi * upper_bound[splitting_dimension] +
-              (1 - phi) * lower_bound[splitting_dimension];
+  mid_point = phi * upper_bound_[splitting_dimension] +
+              (1 - phi) * lower_bound_[splitting_dimension];
 #else
   mid_point =
-      (upper_bound[splitting_dimension] + lower_bound[splitting_dimension]) /
+      (upper_bound_[splitting_dimension] + lower_bound_[splitting_dimension]) /
       2.0;
 #endif
 
   w = exp(log_w_prior);
-  for (int i = 0; i < tree.n_branches; ++i) {
-    next[i] = NULL;
-  }
 }
 
-/// make sure to kill all
-ContextTreeKDTree::Node::~Node() {
-  for (int i = 0; i < tree.n_branches; ++i) {
-    delete next[i];
+/** Get the bounds of the node.
+
+    These are obtained from the bounds of the root and the splits of
+    the previous nodes, so that nodes need not store them.
+ */
+void ContextTreeKDTree::Node::Bounds(Vector& lower_bound, Vector& upper_bound) {
+  if (!prev) {
+    lower_bound = tree.lower_bound;
+    upper_bound = tree.upper_bound;
+    return;
+  }
+  prev->Bounds(lower_bound, upper_bound);
+  if (branch == 0) {
+    upper_bound(prev->splitting_dimension) = prev->mid_point;
+  } else {
+    lower_bound(prev->splitting_dimension) = prev->mid_point;
   }
 }
 
@@ -158,6 +163,7 @@ real ContextTreeKDTree::Node::Observe(const Vector& x, real probability) {
   // printf ("P_u = %f\n", P_uniform);
   // probability of recursion
   // P is the probability in the remainder of the chain.
+  real* alpha = this->alpha();
   P = (1.0 + alpha[k]) / (2.0 + S);
 
   // adapt parameters
@@ -167,18 +173,19 @@ real ContextTreeKDTree::Node::Observe(const Vector& x, real probability) {
   // real threshold = 1; //log(depth);
   real threshold = pow(1.1, (real)depth);
   if ((tree.max_depth == 0 || depth < tree.max_depth) && S > threshold) {
-    if (!next[k]) {
+    Node* next_node = next(k);
+    if (!next_node) {
+      Vector lower_bound;
+      Vector upper_bound;
+      Bounds(lower_bound, upper_bound);
       if (k == 0) {
-        Vector new_bound = upper_bound;
-        new_bound(splitting_dimension) = mid_point;
-        next[k] = new Node(this, lower_bound, new_bound);
+        upper_bound(splitting_dimension) = mid_point;
       } else {
-        Vector new_bound = lower_bound;
-        new_bound(splitting_dimension) = mid_point;
-        next[k] = new Node(this, new_bound, upper_bound);
+        lower_bound(splitting_dimension) = mid_point;
       }
+      next_node = tree.NewNode(this, k, lower_bound, upper_bound);
     }
-    P *= next[k]->Observe(x, P);
+    P *= next_node->Observe(x, P);
   } else {
     // There are four options when there are no further
     // children.
@@ -248,12 +255,12 @@ real ContextTreeKDTree::Node::pdf(const Vector& x, real probability) {
   real P_local = P_uniform;
 #endif
 
-  P = (1.0 + alpha[k]) / (2.0 + S);
+  P = (1.0 + alpha()[k]) / (2.0 + S);
 
   // real threshold = 1;
   real threshold = pow(1.1, (real)depth);
-  if (S > threshold && next[k]) {
-    P *= next[k]->pdf(x, P);
+  if (S > threshold && next(k)) {
+    P *= next(k)->pdf(x, P);
   } else {
     //     P *= 2 * P_local;
     P = P_local;
@@ -269,8 +276,8 @@ real ContextTreeKDTree::Node::pdf(const Vector& x, real probability) {
 void ContextTreeKDTree::Node::Show() {
   printf("%d %f %f\n", depth, w, volume);
   for (int k = 0; k < tree.n_branches; ++k) {
-    if (next[k]) {
-      next[k]->Show();
+    if (next(k)) {
+      next(k)->Show();
     }
   }
   return;
@@ -279,9 +286,9 @@ void ContextTreeKDTree::Node::Show() {
 int ContextTreeKDTree::Node::NChildren() {
   int my_children = 0;
   for (int k = 0; k < tree.n_branches; ++k) {
-    if (next[k]) {
+    if (next(k)) {
       my_children++;
-      my_children += next[k]->NChildren();
+      my_children += next(k)->NChildren();
     }
   }
   return my_children;
@@ -289,13 +296,40 @@ int ContextTreeKDTree::Node::NChildren() {
 
 /// n_branches is a bit of a silly thing, deprecated
 ContextTreeKDTree::ContextTreeKDTree(int n_branches_, int max_depth_,
-                                     const Vector& lower_bound,
-                                     const Vector& upper_bound)
-    : n_branches(n_branches_), max_depth(max_depth_) {
-  root = new Node(*this, lower_bound, upper_bound);
+                                     const Vector& lower_bound_,
+                                     const Vector& upper_bound_)
+    : n_branches(n_branches_),
+      max_depth(max_depth_),
+      lower_bound(lower_bound_),
+      upper_bound(upper_bound_) {
+  root = NewNode(NULL, 0, lower_bound, upper_bound);
+}
+
+ContextTreeKDTree::~ContextTreeKDTree() {}
+
+/// Forget all data, freeing all nodes at once
+void ContextTreeKDTree::Reset() {
+  nodes.Clear();
+  children.clear();
+  counts.clear();
+  root = NewNode(NULL, 0, lower_bound, upper_bound);
 }
 
-ContextTreeKDTree::~ContextTreeKDTree() { delete root; }
+/// Make a new node following branch k of prev, or a root if prev is NULL
+ContextTreeKDTree::Node* ContextTreeKDTree::NewNode(
+    Node* prev, int branch, const Vector& lower_bound_,
+    const Vector& upper_bound_) {
+  int index = nodes.size();
+  children.resize(children.size() + n_branches, -1);
+  counts.resize(counts.size() + n_branches, 0.0);
+  if (prev) {
+    children[prev->index * n_branches + branch] = index;
+    nodes.New(prev, index, branch, lower_bound_, upper_bound_);
+  } else {
+    nodes.New(*this, index, lower_bound_, upper_bound_);
+  }
+  return nodes.Get(index);
+}
 
 real ContextTreeKDTree::Observe(const Vector& x) { return root->Observe(x, 1); }
 
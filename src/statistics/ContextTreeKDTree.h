@@ -15,6 +15,7 @@
 #include <vector>
 #include "DeltaDistribution.h"
 #include "MomentMatchingBetaEstimate.h"
+#include "NodePool.h"
 #include "NormalDistribution.h"
 #include "Ring.h"
 #include "Vector.h"
@@ -52,8 +53,8 @@ class ContextTreeKDTree {
     // DeltaUniformDistribution gaussian; ///< discrete estimator
     real w_gaussian;
 #endif
-    Vector lower_bound;       ///< looks at x > lower_bound
-    Vector upper_bound;       ///< looks at x < upper_bound
+    int index;                ///< index of the node in the tree
+    int branch;               ///< which branch of prev this node is
     real volume;              ///< volume of area in this node
     real mid_point;           ///< how to split
     int splitting_dimension;  ///< dimension on which to do the split.
@@ -63,17 +64,23 @@ class ContextTreeKDTree {
                       const int max_depth; ///< maximum depth
                               */
     Node* prev;               ///< previous node
-    std::vector<Node*> next;  ///< pointers to next nodes
     real P;                   ///< probability of next symbols
-    Vector alpha;             ///< number of times seen in each quadrant
     real w;                   ///< backoff weight
     real log_w;               ///< log of w
     real log_w_prior;         ///< initial value
 
-    Node(ContextTreeKDTree& tree_, const Vector& lower_bound_,
+    Node(ContextTreeKDTree& tree_, int index_, const Vector& lower_bound_,
          const Vector& upper_bound_);
-    Node(Node* prev_, const Vector& lower_bound_, const Vector& upper_bound_);
-    ~Node();
+    Node(Node* prev_, int index_, int branch_, const Vector& lower_bound_,
+         const Vector& upper_bound_);
+    /// number of times seen in each quadrant
+    real* alpha() { return &tree.counts[index * tree.n_branches]; }
+    /// the k-th next node, or NULL
+    Node* next(int k) {
+      int child = tree.children[index * tree.n_branches + k];
+      return (child < 0) ? NULL : tree.nodes.Get(child);
+    }
+    void Bounds(Vector& lower_bound, Vector& upper_bound);
     real Observe(const Vector& x, real probability);
     real pdf(const Vector& x, real probability);
     void Show();
@@ -85,6 +92,7 @@ class ContextTreeKDTree {
   ContextTreeKDTree(int n_branches_, int max_depth_, const Vector& lower_bound,
                     const Vector& upper_bound);
   ~ContextTreeKDTree();
+  void Reset();
   real Observe(const Vector& x);
   real pdf(const Vector& x);
   void Show();
@@ -93,7 +101,14 @@ class ContextTreeKDTree {
  protected:
   int n_branches;
   int max_depth;
+  Vector lower_bound;         ///< lower bound of the root
+  Vector upper_bound;         ///< upper bound of the root
   Node* root;
+  NodePool<Node> nodes;       ///< all nodes
+  std::vector<int> children;  ///< n_branches child indices per node, or -1
+  std::vector<real> counts;   ///< n_branches counts per node
+  Node* NewNode(Node* prev, int branch, const Vector& lower_bound_,
+                const Vector& upper_bound_);
 };
 
 #endif
@@ -0,0 +1,45 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "CounterBasedRNG.h"
+
+static const uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+/// Key of the stream with the given id under a parent key
+static inline uint64_t DeriveKey(uint64_t parent, uint64_t id) {
+  uint64_t z = parent + GOLDEN_GAMMA * (id + 1);
+  z = (z ^ (z >> 32)) * 0xd6e8feb86659fd93ULL;
+  z = (z ^ (z >> 32)) * 0xd6e8feb86659fd93ULL;
+  return z ^ (z >> 32);
+}
+
+CounterBasedRNG::CounterBasedRNG(ulong seed, ulong stream) : stream(stream) {
+  manualSeed(seed);
+}
+
+void CounterBasedRNG::manualSeed(unsigned long seed) {
+  initial_seed = seed;
+  key = DeriveKey(Mix(seed), stream);
+  counter = 0;
+}
+
+/** Create a child stream.
+
+    The child only depends on the key of this stream and on the id, and
+    not on how many numbers have been generated.
+ */
+CounterBasedRNG CounterBasedRNG::Split(ulong id) const {
+  CounterBasedRNG child(*this);
+  child.key = DeriveKey(key, id);
+  child.stream = id;
+  child.counter = 0;
+  return child;
+}
@@ -0,0 +1,102 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#ifndef COUNTER_BASED_RNG_H
+#define COUNTER_BASED_RNG_H
+
+#include <stdint.h>
+#include "RandomNumberGenerator.h"
+
+/** A counter-based random number generator with independent streams.
+
+    The k-th number of a stream is a hash of the stream key and of k,
+    so the generator has no state other than a key and a counter.
+    Streams are identified by a seed and a stream id: the same pair
+    always gives the same sequence, and different ids give unrelated
+    sequences. Split() derives further streams deterministically from
+    an existing one.
+
+    A typical use is to give each thread or each experiment run its
+    own stream:
+    \code
+    CounterBasedRNG master(seed);
+    ParallelFor(n_runs, n_threads, [&](int block, int begin, int end) {
+        for (int run = begin; run < end; ++run) {
+            CounterBasedRNG rng = master.Split(run);
+            ...
+        }
+    });
+    \endcode
+    The results then depend only on the seed and the run number, and
+    not on the number of threads.
+
+    A single object must not be used by several threads at once.
+ */
+class CounterBasedRNG : public RandomNumberGenerator {
+ protected:
+  uint64_t key;       ///< key of the stream
+  uint64_t counter;   ///< number of values generated so far
+  ulong initial_seed; ///< seed of the root stream
+  ulong stream;       ///< id of the stream
+  /// The finaliser of SplitMix64, a bijection on 64-bit integers.
+  static inline uint64_t Mix(uint64_t z) {
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+  uint64_t next() { return Mix(key ^ Mix(++counter)); }
+
+ public:
+  explicit CounterBasedRNG(ulong seed = 0, ulong stream = 0);
+
+  virtual ~CounterBasedRNG() {}
+
+  /// Initializes the stream with the given seed, keeping the stream id.
+  virtual void manualSeed(unsigned long seed);
+
+  /// Returns the starting seed used.
+  virtual unsigned long getInitialSeed() { return initial_seed; }
+
+  /// Generates a uniform 32 bits integer.
+  virtual unsigned long random() { return (unsigned long)(next() >> 32); }
+
+  /// Generates a uniform random number in [0,1[.
+  virtual real uniform() {
+    return (real)(next() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  /// Fills x with n uniform random numbers in [0,1[.
+  ///
+  /// The loop has no dependency between iterations other than the
+  /// counter, so that it can be unrolled and vectorised.
+  virtual void uniform_n(real* x, int n) {
+    uint64_t c = counter;
+    for (int i = 0; i < n; ++i) {
+      x[i] = (real)(Mix(key ^ Mix(c + 1 + (uint64_t)i)) >> 11) *
+             (1.0 / 9007199254740992.0);
+    }
+    counter = c + (uint64_t)n;
+  }
+
+  /// Create the child stream with the given id
+  CounterBasedRNG Split(ulong id) const;
+
+  /// Skip the next n numbers of the stream.
+  void Skip(ulong n) { counter += n; }
+
+  /// Return the id of this stream
+  ulong getStream() const { return stream; }
+
+  /// Return the number of values generated so far
+  ulong getCounter() const { return (ulong)counter; }
+};
+
+#endif
@@ -11,6 +11,7 @@
  ***************************************************************************/
 
 #include "Dirichlet.h"
+#include "Sampling.h"
 
 #include "SpecialFunctions.h"
 #include "ranlib.h"
@@ -72,6 +73,39 @@ void DirichletDistribution::generate(Vector& y) const {
   y *= invsum;
 }
 
+/// Generate a multinomial vector from a stream
+Vector DirichletDistribution::generate(RandomNumberGenerator& rng) const {
+  Vector x(n);
+  generate(x, rng);
+  return x;
+}
+
+/// Generate a multinomial vector in-place, from a stream
+void DirichletDistribution::generate(Vector& y,
+                                     RandomNumberGenerator& rng) const {
+  assert(y.Size() == n);
+  GammaSample(alpha.x, y.x, n, rng);
+  real sum = 0.0;
+  for (int i = 0; i < n; i++) {
+    sum += y(i);
+  }
+  real invsum = 1.0 / sum;
+  y *= invsum;
+}
+
+/// Fill each row of X with a sample, from a stream
+void DirichletDistribution::generate_n(Matrix& X,
+                                       RandomNumberGenerator& rng) const {
+  assert(X.Columns() == n);
+  Vector y(n);
+  for (int k = 0; k < X.Rows(); ++k) {
+    generate(y, rng);
+    for (int i = 0; i < n; i++) {
+      X(k, i) = y(i);
+    }
+  }
+}
+
 /** Dirichlet distribution
     Gets the parameters of a multinomial distribution as input.
 */
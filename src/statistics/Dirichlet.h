@@ -11,6 +11,7 @@
 #define SRC_STATISTICS_DIRICHLET_H_
 
 #include "Distribution.h"
+#include "Matrix.h"
 #include "MultinomialDistribution.h"
 
 /** Dirichlet distribution.
@@ -31,12 +32,26 @@ class DirichletDistribution : public VectorDistribution {
 
   explicit DirichletDistribution(const Vector& x);
 
+  DirichletDistribution(const DirichletDistribution& rhs) = default;
+
+  DirichletDistribution(DirichletDistribution&& rhs) = default;
+
+  DirichletDistribution& operator=(const DirichletDistribution& rhs) = default;
+
+  DirichletDistribution& operator=(DirichletDistribution&& rhs) = default;
+
   virtual ~DirichletDistribution();
 
   virtual void generate(Vector& x) const;
 
   virtual Vector generate() const;
 
+  virtual void generate(Vector& x, RandomNumberGenerator& rng) const;
+
+  Vector generate(RandomNumberGenerator& rng) const;
+
+  void generate_n(Matrix& X, RandomNumberGenerator& rng) const;
+
   virtual real pdf(const Vector& x) const;
 
   virtual real log_pdf(const Vector& x) const;
@@ -19,6 +19,29 @@
 #include "SmartAssert.h"
 #include "ranlib.h"
 
+/** Generate a value using the given stream.
+
+    The default implementation routes urandom() to rng in the calling
+    thread. Distributions that sample through ranlib override this.
+ */
+real Distribution::generate(RandomNumberGenerator& rng) const {
+  ScopedRandomNumberGenerator scope(&rng);
+  return generate();
+}
+
+void Distribution::generate_n(real* x, int n) const {
+  for (int i = 0; i < n; ++i) {
+    x[i] = generate();
+  }
+}
+
+void Distribution::generate_n(real* x, int n,
+                              RandomNumberGenerator& rng) const {
+  for (int i = 0; i < n; ++i) {
+    x[i] = generate(rng);
+  }
+}
+
 real Distribution::log_pdf(const std::vector<real>& x) const {
   int T = x.size();
   real log_prod = 0;
@@ -34,6 +34,14 @@ class AbstractDistribution : public Object {
   virtual ~AbstractDistribution() {}
   virtual void generate(T& x) const = 0;
   virtual T generate() const = 0;
+  /// Generate from a given stream.
+  ///
+  /// By default this routes the global generator of the calling thread
+  /// to rng for the duration of the call.
+  virtual void generate(T& x, RandomNumberGenerator& rng) const {
+    ScopedRandomNumberGenerator scope(&rng);
+    generate(x);
+  }
   virtual real pdf(const T& x) const = 0;
   virtual real log_pdf(const T& x) const { return log(pdf(x)); }
 };
@@ -51,6 +59,15 @@ class Distribution : public Object {
   ///< generate a value from this distribution
   virtual real generate() const = 0;
 
+  /// Generate a value using the given stream.
+  virtual real generate(RandomNumberGenerator& rng) const;
+
+  /// Fill x with n values from this distribution
+  virtual void generate_n(real* x, int n) const;
+
+  /// Fill x with n values, using the given stream.
+  virtual void generate_n(real* x, int n, RandomNumberGenerator& rng) const;
+
   virtual real pdf(real x) const = 0;  ///< return the density at point x
 
   virtual real log_pdf(real x) const { return log(pdf(x)); }
@@ -19,6 +19,19 @@ real ExponentialDistribution::generate() const {
   return -log(1.0 - x) / l;
 }
 
+real ExponentialDistribution::generate(RandomNumberGenerator& rng) const {
+  real x = rng.uniform();
+  return -log(1.0 - x) / l;
+}
+
+void ExponentialDistribution::generate_n(real* x, int n,
+                                         RandomNumberGenerator& rng) const {
+  rng.uniform_n(x, n);
+  for (int i = 0; i < n; ++i) {
+    x[i] = -log(1.0 - x[i]) / l;
+  }
+}
+
 real ExponentialDistribution::pdf(real x) const {
   if (x >= 0.0) {
     return l * exp(-l * x);
@@ -38,6 +38,9 @@ class ExponentialDistribution : public ParametricDistribution {
   }
   virtual ~ExponentialDistribution() {}
   virtual real generate() const;
+  virtual real generate(RandomNumberGenerator& rng) const;
+  using Distribution::generate_n;
+  virtual void generate_n(real* x, int n, RandomNumberGenerator& rng) const;
   virtual real pdf(real x) const;
   virtual real log_pdf(real x) const;
   virtual real log_pdf(const std::vector<real>& x) const;
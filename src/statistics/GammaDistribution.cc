@@ -14,6 +14,7 @@
 #include "Distribution.h"
 #include "ExponentialDistribution.h"
 #include "GammaDistribution.h"
+#include "Sampling.h"
 #include "SpecialFunctions.h"
 
 GammaDistribution::GammaDistribution() : alpha(1.0), beta(1.0) {}
@@ -56,6 +57,21 @@ real GammaDistribution::generate() { return gengam(alpha, beta); }
 /// Generate using ranlib
 real GammaDistribution::generate() const { return gengam(alpha, beta); }
 
+/// Generate from a stream, with the same parametrisation as gengam().
+real GammaDistribution::generate(RandomNumberGenerator& rng) const {
+  return GammaSample(beta, rng) / alpha;
+}
+
+/// Fill x with n samples from a stream.
+void GammaDistribution::generate_n(real* x, int n,
+                                   RandomNumberGenerator& rng) const {
+  GammaSample(beta, x, n, rng);
+  real scale = 1.0 / alpha;
+  for (int i = 0; i < n; ++i) {
+    x[i] *= scale;
+  }
+}
+
 /// Set the maximum likelihood parameters. Return the likelihood at that point.
 ///
 /// Unfortunately this can only be done approximately. We generate
@@ -34,6 +34,9 @@ class GammaDistribution : public Distribution {
   virtual real log_pdf(real x) const;
   virtual real generate();
   virtual real generate() const;
+  virtual real generate(RandomNumberGenerator& rng) const;
+  using Distribution::generate_n;
+  virtual void generate_n(real* x, int n, RandomNumberGenerator& rng) const;
   real setMaximumLikelihoodParameters(const std::vector<real>& x,
                                       int n_iterations);
 };
@@ -10,10 +10,14 @@
  ***************************************************************************/
 
 #include "GaussianProcess.h"
+#include "Cholesky.h"
+#include "ParallelFor.h"
 
 /// Create a new GP with observations in R^d
 GaussianProcess::GaussianProcess(Matrix& Sigma_p_, real noise_variance_)
-    : Sigma_p(Sigma_p_),
+    : N(0),
+      Sigma_p(Sigma_p_),
+      max_samples(0),
       noise_variance(noise_variance_),
       X2(Matrix::Null(Sigma_p.Rows(), Sigma_p.Columns())) {
   Accuracy = Sigma_p.Inverse();
@@ -22,16 +26,17 @@ GaussianProcess::GaussianProcess(Matrix& Sigma_p_, real noise_variance_)
 
 GaussianProcess::GaussianProcess(real noise_variance_, Vector scale_length_,
                                  real sig_var_)
-    : noise_variance(noise_variance_),
+    : N(0),
+      max_samples(0),
+      noise_variance(noise_variance_),
       scale_length(scale_length_),
-      sig_var(sig_var_) {
-  N = 0;
-}
+      sig_var(sig_var_) {}
 
 GaussianProcess::GaussianProcess(Matrix& X_, Vector& Y_, real noise_variance_,
                                  real scale_length_, real sig_var_)
     : X(X_),
       Y(Y_),
+      max_samples(0),
       noise_variance(noise_variance_),
       scale_length(scale_length_),
       sig_var(sig_var_) {
@@ -105,17 +110,76 @@ void GaussianProcess::Observe(std::vector<Vector>& x, std::vector<real>& y) {
   }
 }
 
+/** Add a single observation.
+
+    The kernel matrix grows by one row and column, and its Cholesky
+    factor is extended rather than recomputed.
+ */
 void GaussianProcess::AddObservation(const Vector& x, const real& y) {
-  Serror("Not implemented\n");
-  exit(-1);
+  real d = sig_var * sig_var + noise_variance * noise_variance;
+  if (N == 0) {
+    X = Matrix(1, x.Size());
+    X.setRow(0, x);
+    Y = Vector(1);
+    Y(0) = y;
+    K = Matrix(1, 1);
+    K(0, 0) = d;
+    L = K.Cholesky();
+    N = 1;
+  } else {
+    Vector k = Kernel(x);
+    CholeskyAppend(L, k, d);
+    Matrix K_new(N + 1, N + 1);
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        K_new(i, j) = K(i, j);
+      }
+      K_new(i, N) = k(i);
+      K_new(N, i) = k(i);
+    }
+    K_new(N, N) = d;
+    K = std::move(K_new);
+    X = X.AddRow(x);
+    Y.AddElement(y);
+    N++;
+  }
+  if (max_samples > 0 && N > max_samples) {
+    RemoveFirstObservation();
+  }
+  alpha = CholeskySolve(L, Y);
+}
+
+/** Forget the oldest observation.
+
+    The Cholesky factor is downdated in \f$O(N^2)\f$.
+ */
+void GaussianProcess::RemoveFirstObservation() {
+  assert(N > 0);
+  CholeskyRemove(L, 0);
+  int d = X.Columns();
+  Matrix X_new(N - 1, d);
+  Matrix K_new(N - 1, N - 1);
+  Vector Y_new(N - 1);
+  for (int i = 1; i < N; ++i) {
+    for (int j = 0; j < d; ++j) {
+      X_new(i - 1, j) = X(i, j);
+    }
+    for (int j = 1; j < N; ++j) {
+      K_new(i - 1, j - 1) = K(i, j);
+    }
+    Y_new(i - 1) = Y(i);
+  }
+  X = std::move(X_new);
+  K = std::move(K_new);
+  Y = std::move(Y_new);
+  N--;
+  alpha = CholeskySolve(L, Y);
 }
 
 void GaussianProcess::UpdateGaussianProcess() {
   Covariance();
   L = K.Cholesky();
-  inv_L = L.Inverse();
-  inv_K = inv_L * Transpose(inv_L);
-  alpha = inv_K * Y;
+  alpha = CholeskySolve(L, Y);
 }
 
 real GaussianProcess::GeneratePrediction(const Vector& x) {
@@ -151,13 +215,96 @@ void GaussianProcess::Prediction(Vector& x, real& mean, real& var) {
   var = PredictiveVariance(k);
 }
 
+/// Predict at each row of Z. See GaussianProcessPrediction().
+void GaussianProcess::Prediction(const Matrix& Z, Vector& mean, Vector& var,
+                                 int n_threads) {
+  GaussianProcessPrediction(X, scale_length, sig_var, L, alpha, Z, mean, var,
+                            n_threads);
+}
+
+/// Rows begin to end of X, each divided by the length scale
+static Matrix ScaledRows(const Matrix& X, const Vector& scale_length,
+                         int begin, int end) {
+  int d = X.Columns();
+  assert(scale_length.Size() == 1 || scale_length.Size() == d);
+  Matrix A(end - begin, d);
+  for (int i = begin; i < end; ++i) {
+    for (int j = 0; j < d; ++j) {
+      real s = (scale_length.Size() == 1) ? scale_length(0) : scale_length(j);
+      A(i - begin, j) = X(i, j) / s;
+    }
+  }
+  return A;
+}
+
+/** Predictive means and variances at the rows of Z.
+
+    This is the prediction of a Gaussian process with samples X, a
+    squared exponential kernel, a Cholesky factor L of the kernel
+    matrix and weights \f$\alpha = K^{-1} y\f$.
+
+    The cross-kernel of a block of rows of Z with X is built from a
+    single matrix product, as
+    \f$\|a - b\|^2 = \|a\|^2 + \|b\|^2 - 2 a^\top b\f$, and the
+    variances come from one triangular solve with all of its rows.
+    Blocks are processed in parallel by n_threads threads.
+ */
+void GaussianProcessPrediction(const Matrix& X, const Vector& scale_length,
+                               real sig_var, const Matrix& L,
+                               const Vector& alpha, const Matrix& Z,
+                               Vector& mean, Vector& var, int n_threads) {
+  int M = Z.Rows();
+  int N = X.Rows();
+  real sig_noise = sig_var * sig_var;
+  mean.Resize(M);
+  var.Resize(M);
+  if (N == 0 || alpha.Size() == 0) {
+    for (int i = 0; i < M; ++i) {
+      mean(i) = 0.0;
+      var(i) = sig_noise;
+    }
+    return;
+  }
+  Matrix B = ScaledRows(X, scale_length, 0, N);
+  Vector B2(N);
+  for (int j = 0; j < N; ++j) {
+    B2(j) = B.getRow(j).SquareNorm();
+  }
+  ParallelFor(M, ResolveNumberOfThreads(n_threads),
+              [&](int block, int begin, int end) {
+    Matrix A = ScaledRows(Z, scale_length, begin, end);
+    Matrix K_ZX = A * Transpose(B);
+    for (int i = 0; i < end - begin; ++i) {
+      real A2 = A.getRow(i).SquareNorm();
+      real mean_i = 0.0;
+      for (int j = 0; j < N; ++j) {
+        real delta = A2 + B2(j) - 2.0 * K_ZX(i, j);
+        if (delta < 0.0) {
+          delta = 0.0;
+        }
+        K_ZX(i, j) = sig_noise * exp(-0.5 * delta);
+        mean_i += K_ZX(i, j) * alpha(j);
+      }
+      mean(begin + i) = mean_i;
+    }
+    K_ZX.RightSolveUpper(L);
+    for (int i = 0; i < end - begin; ++i) {
+      real v2 = 0.0;
+      for (int j = 0; j < N; ++j) {
+        v2 += K_ZX(i, j) * K_ZX(i, j);
+      }
+      var(begin + i) = sig_noise - v2;
+    }
+  });
+}
+
 real GaussianProcess::PredictiveMean(const Vector& k) {
   real mean = Product(k, alpha);  ///(mean = k'*alpha)
   return mean;
 }
 
 real GaussianProcess::PredictiveVariance(const Vector& k) {
-  Vector v = Transpose(inv_L) * k;
+  Vector v = CholeskyForwardSolve(L, k);
   real var = sig_var * sig_var - Product(v, v);
   return var;
 }
@@ -24,6 +24,11 @@
 /** Gaussian process.
 
     This is a {\em conditional} distribution.
+
+    Observations added one at a time with AddObservation() update the
+    Cholesky factor of the kernel matrix in \f$O(N^2)\f$, and
+    predictions use triangular solves with it. With setMaxSamples(),
+    the oldest observation is forgotten whenever there are too many.
  */
 class GaussianProcess {
  protected:
@@ -35,9 +40,8 @@ class GaussianProcess {
   Matrix Accuracy;
   Matrix A;
   Matrix L;  ///< Cholesky Decomposition (L is an upper tringular matrix)
-  Matrix inv_L;
   Matrix K;             ///< Kernel(Covariance) Matrix
-  Matrix inv_K;         ///< Inverse Covariance Matrix (Precision)
+  int max_samples;      ///< maximum number of samples kept (0: all)
                         /// Kernel hyperparameters.
   real noise_variance;  ///< noise variance
   Vector scale_length;  ///< lenght scale
@@ -53,6 +57,8 @@ class GaussianProcess {
                   real scale_length_, real hyp_u_);
   virtual ~GaussianProcess();
   virtual int getNSamples() { return N; }
+  /// Keep only the last n samples; 0 keeps all of them.
+  void setMaxSamples(int n) { max_samples = n; }
   virtual Vector generate();
   virtual real pdf(Vector& x, real y);
   virtual void Observe(Vector& x, real y);
@@ -60,9 +66,12 @@ class GaussianProcess {
   virtual void Observe(std::vector<Vector>& x, std::vector<real>& y);
   virtual void AddObservation(const Vector& x, const real& y);
   virtual void UpdateGaussianProcess();
+  virtual void RemoveFirstObservation();
   virtual real GeneratePrediction(const Vector& x);
   virtual real GeneratePredictionKernel(const Vector& k);
   virtual void Prediction(Vector& x, real& mean, real& var);
+  virtual void Prediction(const Matrix& Z, Vector& mean, Vector& var,
+                          int n_threads = 1);
   virtual real PredictiveMean(const Vector& x);
   virtual real PredictiveVariance(const Vector& x);
   virtual void Covariance();
@@ -71,4 +80,9 @@ class GaussianProcess {
   virtual real LogLikelihood();
 };
 
+void GaussianProcessPrediction(const Matrix& X, const Vector& scale_length,
+                               real sig_var, const Matrix& L,
+                               const Vector& alpha, const Matrix& Z,
+                               Vector& mean, Vector& var, int n_threads = 1);
+
 #endif
@@ -16,33 +16,72 @@ KNNRegression::KNNRegression(int m, int n) : M(m), N(n), kd_tree(m) {}
 
 /// Add an element
 void KNNRegression::AddElement(const PointPair& p) {
-  pairs.push_back(p);
-  kd_tree.AddVectorObject(p.x, &pairs.back());
+  assert(p.y.Size() == N);
+  kd_tree.AddVectorObject(p.x, NULL);
+  outputs.insert(outputs.end(), p.y.x, p.y.x + N);
   // basis.AddCenter(p.x, 1.0);
 }
 
-/// Obtain a K-nearest neighbour estimate of E[y | x].
-void KNNRegression::Evaluate(Vector& x, Vector& y, int K) {
-  RBF rbf(x, 1.0);
+/** Average the outputs of the neighbours of x into y.
 
-  // basis.Evaluate(x);
-  assert(N == y.Size());
-  for (int i = 0; i < N; ++i) {
-    y[i] = 0;
+    Each neighbour is weighted by a unit-width RBF centered on it.
+ */
+void KNNRegression::Estimate(const real* x,
+                             const std::vector<void_FlatKDTree::Neighbour>& knn,
+                             real* y) const {
+  for (int j = 0; j < N; ++j) {
+    y[j] = 0;
+  }
+  real sum = 0;
+  for (uint k = 0; k < knn.size(); ++k) {
+    int i = knn[k].second;
+    const real* c = kd_tree.getPointArray(i);
+    real r = 0;
+    for (int j = 0; j < M; ++j) {
+      r += (x[j] - c[j]) * (x[j] - c[j]);
+    }
+    real w = exp(-0.5 * r);
+    const real* y_i = &outputs[i * N];
+    for (int j = 0; j < N; ++j) {
+      y[j] += y_i[j] * w;
+    }
+    sum += w;
+  }
+  for (int j = 0; j < N; ++j) {
+    y[j] /= sum;
   }
+}
 
-  OrderedFixedList<KDNode> node_list = kd_tree.FindKNearestNeighbours(x, K);
+/// Obtain a K-nearest neighbour estimate of E[y | x].
+void KNNRegression::Evaluate(const Vector& x, Vector& y, int K) {
+  // basis.Evaluate(x);
+  assert(M == x.Size());
+  assert(N == y.Size());
+  std::vector<void_FlatKDTree::Neighbour> knn;
+  kd_tree.FindKNearestNeighbours(x, K, knn);
+  Estimate(x.x, knn, y.x);
+}
 
-  std::list<std::pair<real, KDNode*> >::iterator it;
+/** Obtain K-nearest neighbour estimates for each row of X.
 
-  real sum = 0;
-  for (it = node_list.S.begin(); it != node_list.S.end(); ++it) {
-    KDNode* node = it->second;
-    PointPair* point_pair = kd_tree.getObject(node);
-    rbf.center = point_pair->x;
-    real w = rbf.Evaluate(x);
-    y += point_pair->y * w;
-    sum += w;
+    The neighbours of all rows are found by one batched search, with
+    n_threads threads. The estimates are stored in the rows of Y.
+ */
+void KNNRegression::Evaluate(const Matrix& X, Matrix& Y, int K,
+                             int n_threads) {
+  assert(X.Columns() == M);
+  std::vector<std::vector<void_FlatKDTree::Neighbour> > knn;
+  kd_tree.FindKNearestNeighbours(X, K, knn, n_threads);
+  Y.Resize(X.Rows(), N);
+  std::vector<real> x(M);
+  std::vector<real> y(N);
+  for (int t = 0; t < X.Rows(); ++t) {
+    for (int j = 0; j < M; ++j) {
+      x[j] = X(t, j);
+    }
+    Estimate(&x[0], knn[t], &y[0]);
+    for (int j = 0; j < N; ++j) {
+      Y(t, j) = y[j];
+    }
   }
-  y /= sum;
 }
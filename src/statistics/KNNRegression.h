@@ -12,24 +12,33 @@
 #ifndef KNN_REGRESSION_H
 #define KNN_REGRESSION_H
 
-#include "KDTree.h"
+#include <vector>
+#include "FlatKDTree.h"
 //#include "CoverTree.h"
 #include "BasisSet.h"
 #include "PointPair.h"
 
-/** K-Nearest-Neighbour regression */
+/** K-Nearest-Neighbour regression
+
+    The inputs are stored in a FlatKDTree, and the outputs in a
+    contiguous array, in the same order as the tree's points.
+ */
 class KNNRegression {
  protected:
   int M;                      ///< Tree and conditioning variable dimension
   int N;                      ///< Dimension of the conditioned variable
-  KDTree<PointPair> kd_tree;  ///< The tree
-  // CoverTree<PointPair> kd_tree;
+  FlatKDTree<void> kd_tree;   ///< The tree
+  std::vector<real> outputs;  ///< The outputs of the points, row by row
   // RBFBasisSet basis;
-  std::list<PointPair> pairs;  ///< A list of pairs
+  void Estimate(const real* x,
+                const std::vector<void_FlatKDTree::Neighbour>& knn,
+                real* y) const;
+
  public:
   KNNRegression(int m, int n);
   void AddElement(const PointPair& p);
-  void Evaluate(Vector& x, Vector& y, int K);
+  void Evaluate(const Vector& x, Vector& y, int K);
+  void Evaluate(const Matrix& X, Matrix& Y, int K, int n_threads = 1);
 };
 
 #endif
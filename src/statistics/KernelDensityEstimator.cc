@@ -17,6 +17,7 @@ KernelDensityEstimator::KernelDensityEstimator(int n_dimensions,
     : n(n_dimensions),
       b(initial_bandwidth),
       change_b(true),
+      truncation(8.0),
       nearest_neighbour_size(knn),
       kd_tree(n_dimensions) {}
 
@@ -28,17 +29,16 @@ real KernelDensityEstimator::Observe(const Vector& x) {
 
 /// Add a point x with weight w (defaults to w = 1)
 void KernelDensityEstimator::AddPoint(const Vector& x, real w) {
-  points.push_back(WeightedPoint(x, w));
-  if (nearest_neighbour_size > 0) {
-    kd_tree.AddVectorObject(x, &points.back());
-  }
+  kd_tree.AddVectorObject(x, NULL);
+  weights.push_back(w);
 }
 
 real KernelDensityEstimator::log_pdf(const Vector& x) {
   real C = -0.5 * ((real)n) * log(2.0 * M_PI);
+  int n_points = kd_tree.getNumberOfPoints();
 
   // If no points are stored, use a standard normal density
-  if (!points.size()) {
+  if (!n_points) {
     real d = x.Norm(2.0);
     real r = C - 0.5 * d * d;
     printf("! %f %f\n", r, exp(r));
@@ -48,46 +48,42 @@ real KernelDensityEstimator::log_pdf(const Vector& x) {
   // otherwise, do the kernel estimate
   real ib2 = 1.0 / (b * b);
   real log_P = LOG_ZERO;
+  std::vector<void_FlatKDTree::Neighbour> neighbours;
   if (nearest_neighbour_size == 0) {
-    for (std::list<WeightedPoint>::iterator it = points.begin();
-         it != points.end(); ++it) {
-      real d = SquareNorm(&x, &(it->x));
-      real log_p_i = C - 0.5 * d * ib2;
-      log_P = logAdd(log_P, log_p_i);
+    kd_tree.FindNeighboursWithin(x, truncation * b, neighbours);
+    if (neighbours.empty()) {
+      for (int i = 0; i < n_points; ++i) {
+        real d = kd_tree.getDistance(x, i);
+        log_P = logAdd(log_P, C - 0.5 * d * d * ib2);
+      }
     }
   } else {
-    int K = points.size();
+    int K = n_points;
     if (K > nearest_neighbour_size) {
       K = nearest_neighbour_size;
     }
-    OrderedFixedList<KDNode> node_list = kd_tree.FindKNearestNeighbours(x, K);
-
-    for (std::list<std::pair<real, KDNode*> >::iterator it =
-             node_list.S.begin();
-         it != node_list.S.end(); ++it) {
-      KDNode* node = it->second;
-      WeightedPoint* p = kd_tree.getObject(node);
-      real d = SquareNorm(&x, &(p->x));
-      real log_p_i = C - 0.5 * d * ib2;
-      log_P = logAdd(log_P, log_p_i);
-    }
+    kd_tree.FindKNearestNeighbours(x, K, neighbours);
+  }
+  for (uint k = 0; k < neighbours.size(); ++k) {
+    real d = neighbours[k].first;
+    real log_p_i = C - 0.5 * d * d * ib2;
+    log_P = logAdd(log_P, log_p_i);
   }
 
-  real N = (real)points.size();
+  real N = (real)n_points;
   return log_P - log(b) - log(N);
 }
 
 /// Use bootstrapping to estimate the bandwidth
 void KernelDensityEstimator::BootstrapBandwidth() {
   KernelDensityEstimator kde(n, b, nearest_neighbour_size);
-  std::list<WeightedPoint> test_data;
+  std::vector<Vector> test_data;
   fprintf(stderr, "Boostrapping bandiwdth\n");
-  for (std::list<WeightedPoint>::iterator it = points.begin();
-       it != points.end(); ++it) {
+  for (int i = 0; i < kd_tree.getNumberOfPoints(); ++i) {
     if (urandom() < 0.3) {
-      test_data.push_back(*it);
+      test_data.push_back(kd_tree.getPoint(i));
     } else {
-      kde.AddPoint(it->x);
+      kde.AddPoint(kd_tree.getPoint(i));
     }
   }
 
@@ -97,9 +93,8 @@ void KernelDensityEstimator::BootstrapBandwidth() {
     kde.b = current_b;
     // Get log-likelihood of b.
     real current_log_p = 0;
-    for (std::list<WeightedPoint>::iterator p = test_data.begin();
-         p != test_data.end(); ++p) {
-      current_log_p += kde.log_pdf(p->x);
+    for (uint i = 0; i < test_data.size(); ++i) {
+      current_log_p += kde.log_pdf(test_data[i]);
       // current_log_p += kde.pdf(p->x);
     }
 
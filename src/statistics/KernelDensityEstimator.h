@@ -12,8 +12,8 @@
 #ifndef KERNEL_DENSITY_ESTIMATOR_H
 #define KERNEL_DENSITY_ESTIMATOR_H
 
-#include <list>
-#include "KDTree.h"
+#include <vector>
+#include "FlatKDTree.h"
 #include "NormalDistribution.h"
 #include "Vector.h"
 
@@ -25,20 +25,21 @@
     \f[
     P(y | z) = P(y, z) / P(z).
     \f]
+
+    The points are stored in a FlatKDTree with the Euclidean metric.
+    When knn > 0, only the knn nearest points are used. Otherwise, the
+    kernel is truncated to a ball of radius truncation * b around the
+    query, which only drops terms smaller than
+    \f$\exp(-\textrm{truncation}^2 / 2)\f$ times the kernel's peak.
+    If the ball is empty, all points are used.
  */
 class KernelDensityEstimator {
  public:
-  /// Points can be weighted.
-  struct WeightedPoint {
-    Vector x;
-    real w;
-    WeightedPoint(const Vector& x_, const real w_) : x(x_), w(w_) {}
-  };
   KernelDensityEstimator(int n_dimensions, real initial_bandwidth, int knn);
-  int n;                            ///< The number of dimensions
-  real b;                           ///< The bandwidth
-  bool change_b;                    ///< Whether be should be able to change
-  std::list<WeightedPoint> points;  ///< A list of weighted points
+  int n;            ///< The number of dimensions
+  real b;           ///< The bandwidth
+  bool change_b;    ///< Whether be should be able to change
+  real truncation;  ///< The kernel radius, in bandwidths
   real Observe(const Vector& x);
   void AddPoint(const Vector& x, real w = 1);
   /// Return the pdf at x
@@ -46,10 +47,13 @@ class KernelDensityEstimator {
   real log_pdf(const Vector& x);
   void BootstrapBandwidth();
   void Show() {}
+  /// The number of points
+  int getNumberOfPoints() const { return kd_tree.getNumberOfPoints(); }
 
  protected:
   int nearest_neighbour_size;  ///< what size to use for the nearest neighbour
-  KDTree<WeightedPoint> kd_tree;  ///< The tree, for faster access
+  FlatKDTree<void, EuclideanMetric> kd_tree;  ///< The points
+  std::vector<real> weights;                  ///< The weights of the points
 };
 
 #endif
@@ -64,15 +64,13 @@ Vector KernelRegression::expected_value(const Vector& x) {
     OrderedFixedList<KDNode> node_list = kd_tree.FindKNearestNeighbours(x, K);
     real max_log_p_i;
     {
-      std::list<std::pair<real, KDNode*> >::iterator it = node_list.S.begin();
-      KDNode* node = it->second;
+      KDNode* node = node_list.front().second;
       PointPair* p = kd_tree.getObject(node);
       real d = SquareNorm(&x, &(p->x));
       max_log_p_i = -0.5 * d * ib2;
     }
-    for (std::list<std::pair<real, KDNode*> >::iterator it =
-             node_list.S.begin();
-         it != node_list.S.end(); ++it) {
+    for (OrderedFixedList<KDNode>::iterator it = node_list.begin();
+         it != node_list.end(); ++it) {
       KDNode* node = it->second;
       PointPair* p = kd_tree.getObject(node);
       real d = SquareNorm(&x, &(p->x));
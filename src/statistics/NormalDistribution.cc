@@ -12,6 +12,7 @@
 
 #include "ExponentialDistribution.h"
 #include "Random.h"
+#include "Sampling.h"
 #include "SpecialFunctions.h"
 
 // Taken from numerical recipes in C
@@ -49,6 +50,29 @@ real NormalDistribution::generate() {
   }
 }
 
+/// Generate from a stream.
+///
+/// This does not use the cached second variate, which belongs to the
+/// global generator.
+real NormalDistribution::generate(RandomNumberGenerator& rng) const {
+  return NormalSample(rng) * s + m;
+}
+
+/// Fill x with n samples, drawing the uniforms from the global generator.
+void NormalDistribution::generate_n(real* x, int n) const {
+  DefaultRandomNumberGenerator rng;
+  generate_n(x, n, rng);
+}
+
+/// Fill x with n samples from a stream.
+void NormalDistribution::generate_n(real* x, int n,
+                                    RandomNumberGenerator& rng) const {
+  NormalSample(x, n, rng);
+  for (int i = 0; i < n; ++i) {
+    x[i] = x[i] * s + m;
+  }
+}
+
 /// Normal distribution log-pdf
 real NormalDistribution::log_pdf(real x) const {
   real d = (m - x) / s;
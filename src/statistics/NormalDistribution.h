@@ -56,6 +56,12 @@ class NormalDistribution : public ParametricDistribution {
 
   virtual real generate() const;
 
+  virtual real generate(RandomNumberGenerator& rng) const;
+
+  virtual void generate_n(real* x, int n) const;
+
+  virtual void generate_n(real* x, int n, RandomNumberGenerator& rng) const;
+
   virtual real log_pdf(real x) const;
 
   virtual real pdf(real x) const;
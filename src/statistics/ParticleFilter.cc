@@ -14,6 +14,7 @@
 #include "ParticleFilter.h"
 ParticleFilter::ParticleFilter(int N, Distribution* prior, Distribution* T,
                                Distribution* O) {
+  rng = NULL;
   this->transitions = T;
   this->observations = O;
   this->prior = prior;
@@ -29,6 +30,7 @@ void ParticleFilter::Init(int N, Distribution* prior, Distribution* T,
 }
 
 ParticleFilter::ParticleFilter() {
+  rng = NULL;
   transitions = NULL;
   observations = NULL;
   prior = NULL;
@@ -52,7 +54,7 @@ void ParticleFilter::Reset() {
   // printf ("Generating: ");
   for (int i = 0; i < N; i++) {
     w[i] = a;
-    y[i] = prior->generate();
+    y[i] = Generate(prior);
     // printf ("(%f, %f)", w[i], y[i]);
   }
   // printf ("\n");
@@ -61,8 +63,8 @@ void ParticleFilter::Reset() {
 ParticleFilter::~ParticleFilter() {}
 
 real ParticleFilter::Sample() {
-  int Yn = PropSample(w);
-  return y[Yn] + transitions->generate();
+  int Yn = SampleParticle();
+  return y[Yn] + Generate(transitions);
 }
 
 void ParticleFilter::Observe(real x) {
@@ -123,8 +125,8 @@ BernoulliParticleFilter::~BernoulliParticleFilter() {}
 void BernoulliParticleFilter::Observe(real x) {
   // Generate a set of samples from our current belief
   for (int n = 0; n < N; n++) {
-    int Yn = PropSample(w);
-    y2[n] = y[Yn] + transitions->generate();
+    int Yn = SampleParticle();
+    y2[n] = y[Yn] + Generate(transitions);
     w[n] = w[Yn];
     // printf ("y2:%f ", y2[n]);
   }
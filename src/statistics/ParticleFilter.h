@@ -29,11 +29,20 @@ class ParticleFilter {
   Distribution* transitions;   ///< Transitions
   Distribution* observations;  ///< Observations
   Distribution* prior;         //<prior
+  RandomNumberGenerator* rng;  ///< stream to sample from, or NULL
                                /// Constructor
   ParticleFilter(int N, Distribution* prior, Distribution* T, Distribution* O);
   void Init(int N, Distribution* prior, Distribution* T, Distribution* O);
   ParticleFilter();
   virtual void SetNumberOfEstimates(int n_estimates);
+  /// Sample from rng rather than the global generator
+  void setRandomNumberGenerator(RandomNumberGenerator* rng_) { rng = rng_; }
+  /// Generate from d, using the stream if there is one
+  real Generate(const Distribution* d) const {
+    return rng ? d->generate(*rng) : d->generate();
+  }
+  /// Sample a particle proportionally to the weights
+  int SampleParticle() { return rng ? PropSample(w, *rng) : PropSample(w); }
   virtual void Reset();
   virtual ~ParticleFilter();
   virtual real Sample();
@@ -15,22 +15,61 @@
 #include <cstdlib>
 #include "MersenneTwister.h"
 #include "Random.h"
+#include "RandomNumberGenerator.h"
 #include "SmartAssert.h"
 #include "ranlib.h"
 
+/// The generator of the calling thread, if any.
+///
+/// The global MersenneTwister is not thread safe, so threads that
+/// sample in parallel should each set their own generator.
+static thread_local RandomNumberGenerator* thread_rng = NULL;
+
 void setRandomSeed(unsigned int seed) {
   srand(seed);
   MersenneTwister::manualSeed(seed);
 }
 
-unsigned long lrandom() { return MersenneTwister::random(); }
+void setThreadRandomNumberGenerator(RandomNumberGenerator* rng) {
+  thread_rng = rng;
+}
+
+RandomNumberGenerator* getThreadRandomNumberGenerator() { return thread_rng; }
+
+/// Draw from the thread generator.
+///
+/// The generator is unset during the call, so that generators which
+/// call urandom() themselves fall back to the global one.
+static real ThreadUniform() {
+  RandomNumberGenerator* rng = thread_rng;
+  thread_rng = NULL;
+  real x = rng->uniform();
+  thread_rng = rng;
+  return x;
+}
+
+unsigned long lrandom() {
+  if (thread_rng) {
+    RandomNumberGenerator* rng = thread_rng;
+    thread_rng = NULL;
+    unsigned long x = rng->random();
+    thread_rng = rng;
+    return x;
+  }
+  return MersenneTwister::random();
+}
 
-real urandom2() { return MersenneTwister::uniform(); }
+real urandom2() {
+  if (thread_rng) {
+    return ThreadUniform();
+  }
+  return MersenneTwister::uniform();
+}
 
 real urandom() {
   real x;
   do {
-    x = MersenneTwister::uniform();
+    x = thread_rng ? ThreadUniform() : MersenneTwister::uniform();
   } while (x >= 1.0);
   return x;
 }
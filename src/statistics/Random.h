@@ -27,7 +27,13 @@
 */
 /*@{*/
 
+class RandomNumberGenerator;
+
 void setRandomSeed(unsigned int seed);
+/// Make urandom() and lrandom() draw from rng in the calling thread.
+/// Passing NULL restores the global generator.
+void setThreadRandomNumberGenerator(RandomNumberGenerator* rng);
+RandomNumberGenerator* getThreadRandomNumberGenerator();
 unsigned long lrandom();
 real urandom();
 real urandom(real min, real max);
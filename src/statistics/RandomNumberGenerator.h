@@ -36,6 +36,13 @@ class RandomNumberGenerator {
   /// Generates a uniform random number in [0,1[.
   virtual real uniform() = 0;
 
+  /// Fills x with n uniform random numbers in [0,1[.
+  virtual void uniform_n(real* x, int n) {
+    for (int i = 0; i < n; ++i) {
+      x[i] = uniform();
+    }
+  }
+
   /// Generates a uniform random number in [0,n)
   inline int discrete_uniform(int n) {
     return (int)floor(uniform() * ((real)n));
@@ -69,4 +76,22 @@ class DefaultRandomNumberGenerator : public RandomNumberGenerator {
   virtual real uniform() { return urandom(); }
 };
 
+/** Route urandom() and lrandom() to a generator within a scope.
+
+    While the object exists, library code that samples through the
+    global functions draws from rng in the current thread. The previous
+    thread generator is restored on destruction.
+ */
+class ScopedRandomNumberGenerator {
+ protected:
+  RandomNumberGenerator* previous;
+
+ public:
+  explicit ScopedRandomNumberGenerator(RandomNumberGenerator* rng)
+      : previous(getThreadRandomNumberGenerator()) {
+    setThreadRandomNumberGenerator(rng);
+  }
+  ~ScopedRandomNumberGenerator() { setThreadRandomNumberGenerator(previous); }
+};
+
 #endif  // SRC_STATISTICS_RANDOMNUMBERGENERATOR_H_
@@ -11,6 +11,7 @@
  ***************************************************************************/
 #include "Sampling.h"
 #include <cassert>
+#include <cmath>
 
 int PropSample(std::vector<real>& w) {
   int n = w.size();
@@ -25,3 +26,180 @@ int PropSample(std::vector<real>& w) {
   }
   return rand() % n;
 }
+
+/// Sample an index with probability proportional to w, from a stream.
+int PropSample(std::vector<real>& w, RandomNumberGenerator& rng) {
+  int n = w.size();
+  assert(n > 0);
+  real X = UniformSample(rng);
+  real s = 0.0;
+  for (int i = 0; i < n; i++) {
+    s += w[i];
+    if (X < s) {
+      return i;
+    }
+  }
+  return rng.discrete_uniform(n);
+}
+
+/// Standard normal sample, with the Box-Muller transform.
+real NormalSample(RandomNumberGenerator& rng) {
+  real x = rng.uniform();
+  real y = rng.uniform();
+  return sqrt(-2.0 * log(1.0 - y)) * cos(2.0 * M_PI * x);
+}
+
+/** Sample from a Gamma distribution with unit scale.
+
+    This uses the method of Marsaglia and Tsang (2000). For shape
+    \f$a < 1\f$, a sample \f$x\f$ with shape \f$a + 1\f$ is
+    transformed to \f$x u^{1/a}\f$.
+ */
+real GammaSample(real shape, RandomNumberGenerator& rng) {
+  assert(shape > 0);
+  if (shape < 1.0) {
+    real u = rng.uniform();
+    return GammaSample(shape + 1.0, rng) * pow(1.0 - u, 1.0 / shape);
+  }
+  real d = shape - 1.0 / 3.0;
+  real c = 1.0 / sqrt(9.0 * d);
+  while (true) {
+    real x, v;
+    do {
+      x = NormalSample(rng);
+      v = 1.0 + c * x;
+    } while (v <= 0.0);
+    v = v * v * v;
+    real u = 1.0 - rng.uniform();
+    real x2 = x * x;
+    if (u < 1.0 - 0.0331 * x2 * x2) {
+      return d * v;
+    }
+    if (log(u) < 0.5 * x2 + d * (1.0 - v + log(v))) {
+      return d * v;
+    }
+  }
+}
+
+/// Sample from a Beta distribution, as a ratio of Gamma samples.
+real BetaSample(real a, real b, RandomNumberGenerator& rng) {
+  real x = GammaSample(a, rng);
+  real y = GammaSample(b, rng);
+  return x / (x + y);
+}
+
+/** Fill x with n standard normal samples.
+
+    Both variates of each Box-Muller pair are used, and the uniforms
+    are drawn in a single call to the generator.
+ */
+void NormalSample(real* x, int n, RandomNumberGenerator& rng) {
+  int n_pairs = n / 2;
+  rng.uniform_n(x, 2 * n_pairs);
+  for (int i = 0; i < 2 * n_pairs; i += 2) {
+    real rho = sqrt(-2.0 * log(1.0 - x[i + 1]));
+    real phi = 2.0 * M_PI * x[i];
+    x[i] = rho * cos(phi);
+    x[i + 1] = rho * sin(phi);
+  }
+  if (n % 2) {
+    x[n - 1] = NormalSample(rng);
+  }
+}
+
+/// Normal and uniform variates for the Gamma sampler, drawn in blocks.
+class GammaProposals {
+ protected:
+  static const int N = 64;
+  real z[N];
+  real u[N];
+  int k;
+  RandomNumberGenerator& rng;
+
+ public:
+  explicit GammaProposals(RandomNumberGenerator& rng_) : k(N), rng(rng_) {}
+  /// Sample with shape d + 1/3, where c = 1/sqrt(9d) and d >= 2/3.
+  real Sample(real d, real c) {
+    while (true) {
+      if (k == N) {
+        NormalSample(z, N, rng);
+        rng.uniform_n(u, N);
+        k = 0;
+      }
+      real x = z[k];
+      real U = 1.0 - u[k];
+      k++;
+      real v = 1.0 + c * x;
+      if (v <= 0.0) {
+        continue;
+      }
+      v = v * v * v;
+      real x2 = x * x;
+      if (U < 1.0 - 0.0331 * x2 * x2 ||
+          log(U) < 0.5 * x2 + d * (1.0 - v + log(v))) {
+        return d * v;
+      }
+    }
+  }
+};
+
+/** Fill x with n samples from a Gamma distribution with unit scale.
+
+    The constants of the Marsaglia-Tsang method are computed once and
+    the proposals are drawn in blocks.
+ */
+void GammaSample(real shape, real* x, int n, RandomNumberGenerator& rng) {
+  assert(shape > 0);
+  if (n <= 0) {
+    return;
+  }
+  real a = (shape < 1.0) ? shape + 1.0 : shape;
+  real d = a - 1.0 / 3.0;
+  real c = 1.0 / sqrt(9.0 * d);
+  GammaProposals proposals(rng);
+  for (int i = 0; i < n; ++i) {
+    x[i] = proposals.Sample(d, c);
+  }
+  if (shape < 1.0) {
+    real inv_shape = 1.0 / shape;
+    std::vector<real> u(n);
+    rng.uniform_n(&u[0], n);
+    for (int i = 0; i < n; ++i) {
+      x[i] *= pow(1.0 - u[i], inv_shape);
+    }
+  }
+}
+
+/// Fill x with one Gamma sample with unit scale for each shape.
+///
+/// A shape of zero gives zero, which is the limit of the distribution.
+void GammaSample(const real* shape, real* x, int n,
+                 RandomNumberGenerator& rng) {
+  GammaProposals proposals(rng);
+  for (int i = 0; i < n; ++i) {
+    assert(shape[i] >= 0);
+    if (shape[i] <= 0) {
+      x[i] = 0.0;
+      continue;
+    }
+    real a = (shape[i] < 1.0) ? shape[i] + 1.0 : shape[i];
+    real d = a - 1.0 / 3.0;
+    x[i] = proposals.Sample(d, 1.0 / sqrt(9.0 * d));
+    if (shape[i] < 1.0) {
+      x[i] *= pow(1.0 - rng.uniform(), 1.0 / shape[i]);
+    }
+  }
+}
+
+/// Fill x with n samples from a Beta distribution.
+void BetaSample(real a, real b, real* x, int n, RandomNumberGenerator& rng) {
+  if (n <= 0) {
+    return;
+  }
+  std::vector<real> y(n);
+  GammaSample(a, x, n, rng);
+  GammaSample(b, &y[0], n, rng);
+  for (int i = 0; i < n; ++i) {
+    x[i] /= x[i] + y[i];
+  }
+}
@@ -15,10 +15,30 @@
 
 #include <cstdlib>
 #include <vector>
+#include "RandomNumberGenerator.h"
 #include "real.h"
 
 inline real UniformSample() { return drand48(); }
 
+/// Uniform sample in [0,1) from a given stream
+inline real UniformSample(RandomNumberGenerator& rng) { return rng.uniform(); }
+
 int PropSample(std::vector<real>& w);
 
+int PropSample(std::vector<real>& w, RandomNumberGenerator& rng);
+
+real NormalSample(RandomNumberGenerator& rng);
+
+real GammaSample(real shape, RandomNumberGenerator& rng);
+
+real BetaSample(real a, real b, RandomNumberGenerator& rng);
+
+void NormalSample(real* x, int n, RandomNumberGenerator& rng);
+
+void GammaSample(real shape, real* x, int n, RandomNumberGenerator& rng);
+
+void GammaSample(const real* shape, real* x, int n, RandomNumberGenerator& rng);
+
+void BetaSample(real a, real b, real* x, int n, RandomNumberGenerator& rng);
+
 #endif
@@ -10,6 +10,8 @@
  ***************************************************************************/
 
 #include "SparseGaussianProcess.h"
+#include "Cholesky.h"
+#include "GaussianProcess.h"
 
 /// Create a new GP with observations
 SparseGaussianProcess::SparseGaussianProcess(real noise_variance_,
@@ -112,9 +114,7 @@ void SparseGaussianProcess::AddObservation(const std::vector<Vector>& x,
 void SparseGaussianProcess::UpdateSparseGaussianProcess() {
   Covariance();
   L = K.Cholesky();
-  inv_L = L.Inverse();
-  //	alpha = inv_L*(Transpose(inv_L)*Y);
-  alpha = K.Inverse() * Y;
+  alpha = CholeskySolve(L, Y);
 }
 
 real SparseGaussianProcess::GeneratePrediction(const Vector& x) {
@@ -150,13 +150,20 @@ void SparseGaussianProcess::Prediction(Vector& x, real& mean, real& var) {
   var = PredictiveVariance(k);
 }
 
+/// Predict at each row of Z. See GaussianProcessPrediction().
+void SparseGaussianProcess::Prediction(const Matrix& Z, Vector& mean,
+                                       Vector& var, int n_threads) {
+  GaussianProcessPrediction(X, scale_length, sig_var, L, alpha, Z, mean, var,
+                            n_threads);
+}
+
 real SparseGaussianProcess::PredictiveMean(const Vector& k) {
   real mean = Product(k, alpha);  ///(mean = k'*alpha)
   return mean;
 }
 
 real SparseGaussianProcess::PredictiveVariance(const Vector& k) {
-  Vector iLk = Transpose(inv_L) * k;
+  Vector iLk = CholeskyForwardSolve(L, k);
   real var = sig_var * sig_var - Product(iLk, iLk);
   return var;
 }
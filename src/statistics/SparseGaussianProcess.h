@@ -28,7 +28,6 @@ class SparseGaussianProcess {
 
   Matrix Sigma_p;
   Matrix L;  ///< Cholesky Decomposition (L is an upper tringular matrix)
-  Matrix inv_L;
   Matrix K;      ///< Kernel(Covariance) Matrix
   Matrix inv_K;  ///< Inverse Covariance Matrix (Precision)
   /// Kernel hyperparameters.
@@ -60,6 +59,8 @@ class SparseGaussianProcess {
   virtual real GeneratePrediction(const Vector& x);
   virtual real GeneratePredictionKernel(const Vector& k);
   virtual void Prediction(Vector& x, real& mean, real& var);
+  virtual void Prediction(const Matrix& Z, Vector& mean, Vector& var,
+                          int n_threads = 1);
   virtual real PredictiveMean(const Vector& x);
   virtual real PredictiveVariance(const Vector& x);
   virtual void Covariance();
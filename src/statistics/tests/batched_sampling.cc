@@ -0,0 +1,117 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include "BetaDistribution.h"
+#include "CounterBasedRNG.h"
+#include "Dirichlet.h"
+#include "EasyClock.h"
+#include "ExponentialDistribution.h"
+#include "GammaDistribution.h"
+#include "NormalDistribution.h"
+
+/// Check the first two moments of a batch of samples
+int CheckMoments(const char* name, const Distribution& d, real mean,
+                 real variance, RandomNumberGenerator& rng) {
+  int T = 200001;
+  std::vector<real> x(T);
+  double start_time = GetCPU();
+  d.generate_n(&x[0], T, rng);
+  double batch_time = GetCPU() - start_time;
+  start_time = GetCPU();
+  for (int t = 0; t < T; ++t) {
+    d.generate(rng);
+  }
+  double single_time = GetCPU() - start_time;
+
+  real m = 0.0;
+  for (int t = 0; t < T; ++t) {
+    m += x[t];
+  }
+  m /= (real)T;
+  real v = 0.0;
+  for (int t = 0; t < T; ++t) {
+    v += (x[t] - m) * (x[t] - m);
+  }
+  v /= (real)T;
+  printf("%s: mean %f (%f), variance %f (%f), time %f s (single: %f s)\n",
+         name, m, mean, v, variance, batch_time, single_time);
+  if (fabs(m - mean) > 0.02 * (1.0 + fabs(mean)) ||
+      fabs(v - variance) > 0.05 * (1.0 + variance)) {
+    fprintf(stderr, "Wrong moments for %s\n", name);
+    return 1;
+  }
+  return 0;
+}
+
+int main() {
+  int errors = 0;
+  CounterBasedRNG rng(7);
+
+  errors += CheckMoments("normal", NormalDistribution(1.0, 2.0), 1.0, 4.0, rng);
+  // GammaDistribution(a, b) has rate a and shape b, as ranlib's gengam()
+  errors += CheckMoments("gamma", GammaDistribution(2.0, 3.0), 1.5, 0.75, rng);
+  errors += CheckMoments("gamma (shape < 1)", GammaDistribution(1.0, 0.3), 0.3,
+                         0.3, rng);
+  errors += CheckMoments("beta", BetaDistribution(2.0, 6.0), 0.25,
+                         12.0 / (64.0 * 9.0), rng);
+  errors += CheckMoments("exponential", ExponentialDistribution(2.0), 0.5,
+                         0.25, rng);
+
+  // the uniforms of a stream do not depend on how they are requested
+  CounterBasedRNG a(99);
+  CounterBasedRNG b(99);
+  std::vector<real> u(100);
+  a.uniform_n(&u[0], 100);
+  for (int i = 0; i < 100; ++i) {
+    if (u[i] != b.uniform()) {
+      errors++;
+    }
+  }
+
+  // each row of a batch of Dirichlet samples is a distribution
+  Vector alpha(5);
+  alpha(0) = 0.0;
+  for (int i = 1; i < 5; ++i) {
+    alpha(i) = 0.1 * i;
+  }
+  DirichletDistribution dirichlet(alpha);
+  Matrix P(1000, 5);
+  dirichlet.generate_n(P, rng);
+  Vector mean(5);
+  for (int k = 0; k < P.Rows(); ++k) {
+    real sum = 0.0;
+    for (int i = 0; i < 5; ++i) {
+      sum += P(k, i);
+      mean(i) += P(k, i) / (real)P.Rows();
+    }
+    if (fabs(sum - 1.0) > 1e-9 || P(k, 0) != 0.0) {
+      errors++;
+    }
+  }
+  printf("Dirichlet mean: ");
+  mean.print(stdout);
+  for (int i = 1; i < 5; ++i) {
+    if (fabs(mean(i) - alpha(i) / alpha.Sum()) > 0.05) {
+      fprintf(stderr, "Wrong Dirichlet mean\n");
+      errors++;
+    }
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
@@ -0,0 +1,96 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include "EasyClock.h"
+#include "GaussianProcess.h"
+#include "Random.h"
+
+/// Compare batch predictions with those made one point at a time
+int Compare(const char* name, const Matrix& Z, const Vector& mean,
+            const Vector& var, const Vector& mean_0, const Vector& var_0) {
+  int errors = 0;
+  for (int i = 0; i < Z.Rows(); ++i) {
+    if (fabs(mean(i) - mean_0(i)) > 1e-6 || fabs(var(i) - var_0(i)) > 1e-6) {
+      fprintf(stderr, "%s %d: (%f, %f) != (%f, %f)\n", name, i, mean(i),
+              var(i), mean_0(i), var_0(i));
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main() {
+  int errors = 0;
+  int n_dim = 3;
+  int N = 500;
+  int M = 2000;
+  Matrix X(N, n_dim);
+  Vector Y(N);
+  for (int t = 0; t < N; ++t) {
+    for (int j = 0; j < n_dim; ++j) {
+      X(t, j) = urandom() * 2.0 - 1.0;
+    }
+    Y(t) = sin(3.0 * X(t, 0)) + X(t, 1) * X(t, 2) + 0.1 * urandom();
+  }
+  Matrix Z(M, n_dim);
+  for (int i = 0; i < M; ++i) {
+    for (int j = 0; j < n_dim; ++j) {
+      Z(i, j) = urandom() * 2.0 - 1.0;
+    }
+  }
+
+  Vector scale(n_dim);
+  scale += 0.5;
+  scale(0) = 0.3;
+  GaussianProcess gp(0.1, scale, 1.0);
+
+  // without observations, the prior is returned
+  Vector mean, var;
+  gp.Prediction(Z, mean, var);
+  if (mean.Size() != M || mean(0) != 0.0 || var(0) != 1.0) {
+    fprintf(stderr, "wrong prior prediction\n");
+    errors++;
+  }
+
+  gp.Observe(X, Y);
+
+  Vector mean_0(M), var_0(M);
+  double start_time = GetCPU();
+  for (int i = 0; i < M; ++i) {
+    Vector z = Z.getRow(i);
+    gp.Prediction(z, mean_0(i), var_0(i));
+  }
+  double loop_time = GetCPU() - start_time;
+
+  double start_wall = GetMonotonicTime();
+  gp.Prediction(Z, mean, var);
+  double batch_time = GetMonotonicTime() - start_wall;
+  errors += Compare("batch", Z, mean, var, mean_0, var_0);
+
+  start_wall = GetMonotonicTime();
+  gp.Prediction(Z, mean, var, 4);
+  double parallel_time = GetMonotonicTime() - start_wall;
+  errors += Compare("parallel", Z, mean, var, mean_0, var_0);
+
+  printf("%d predictions with %d samples: loop %f s, batch %f s, ", M, N,
+         loop_time, batch_time);
+  printf("4 threads %f s\n", parallel_time);
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
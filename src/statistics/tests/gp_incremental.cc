@@ -0,0 +1,134 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include "Cholesky.h"
+#include "EasyClock.h"
+#include "GaussianProcess.h"
+#include "Random.h"
+
+/// Compare the predictions of two processes on a few points
+int Compare(const char* name, GaussianProcess& a, GaussianProcess& b,
+            int n_dim) {
+  int errors = 0;
+  for (int k = 0; k < 20; ++k) {
+    Vector x(n_dim);
+    for (int j = 0; j < n_dim; ++j) {
+      x(j) = urandom() * 2.0 - 1.0;
+    }
+    real mean_a, var_a, mean_b, var_b;
+    a.Prediction(x, mean_a, var_a);
+    b.Prediction(x, mean_b, var_b);
+    if (fabs(mean_a - mean_b) > 1e-6 || fabs(var_a - var_b) > 1e-6) {
+      fprintf(stderr, "%s: (%f, %f) != (%f, %f)\n", name, mean_a, var_a,
+              mean_b, var_b);
+      errors++;
+    }
+  }
+  return errors;
+}
+
+int main() {
+  int errors = 0;
+  int n_dim = 2;
+  int T = 400;
+  int window = 50;
+  Matrix X(T, n_dim);
+  Vector Y(T);
+  for (int t = 0; t < T; ++t) {
+    for (int j = 0; j < n_dim; ++j) {
+      X(t, j) = urandom() * 2.0 - 1.0;
+    }
+    Y(t) = sin(3.0 * X(t, 0)) + X(t, 1) + 0.1 * urandom();
+  }
+
+  // adding observations one at a time gives the same process
+  Vector scale(n_dim);
+  scale += 0.5;
+  GaussianProcess incremental(0.1, scale, 1.0);
+  GaussianProcess windowed(0.1, scale, 1.0);
+  windowed.setMaxSamples(window);
+  double start_time = GetCPU();
+  for (int t = 0; t < T; ++t) {
+    incremental.AddObservation(X.getRow(t), Y(t));
+  }
+  double incremental_time = GetCPU() - start_time;
+  for (int t = 0; t < T; ++t) {
+    windowed.AddObservation(X.getRow(t), Y(t));
+  }
+
+  GaussianProcess batch(0.1, scale, 1.0);
+  start_time = GetCPU();
+  for (int t = 1; t <= T; t += 10) {
+    Matrix X_t(t, n_dim);
+    Vector Y_t(t);
+    for (int i = 0; i < t; ++i) {
+      X_t.setRow(i, X.getRow(i));
+      Y_t(i) = Y(i);
+    }
+    batch.Observe(X_t, Y_t);
+  }
+  double batch_time = (GetCPU() - start_time) * 10.0;
+  Matrix X_all(X);
+  batch.Observe(X_all, Y);
+  errors += Compare("incremental", incremental, batch, n_dim);
+
+  // the window only keeps the last observations
+  Matrix X_last(window, n_dim);
+  Vector Y_last(window);
+  for (int i = 0; i < window; ++i) {
+    X_last.setRow(i, X.getRow(T - window + i));
+    Y_last(i) = Y(T - window + i);
+  }
+  batch.Observe(X_last, Y_last);
+  if (windowed.getNSamples() != window) {
+    fprintf(stderr, "window has %d samples\n", windowed.getNSamples());
+    errors++;
+  }
+  errors += Compare("window", windowed, batch, n_dim);
+
+  // removing an inner row and column of a factor
+  Matrix A(5, 5);
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      A(i, j) = exp(-0.5 * (i - j) * (i - j)) + ((i == j) ? 0.1 : 0.0);
+    }
+  }
+  Matrix U = A.Cholesky();
+  CholeskyRemove(U, 2);
+  Matrix B(4, 4);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      B(i, j) = A(i < 2 ? i : i + 1, j < 2 ? j : j + 1);
+    }
+  }
+  Matrix V = B.Cholesky();
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      if (fabs(U(i, j) - V(i, j)) > 1e-9) {
+        fprintf(stderr, "wrong downdate at %d %d\n", i, j);
+        errors++;
+      }
+    }
+  }
+
+  printf("%d observations: incremental %f s, recomputing %f s\n", T,
+         incremental_time, batch_time);
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
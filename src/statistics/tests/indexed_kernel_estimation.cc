@@ -0,0 +1,133 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Check the indexed kernel density estimate and KNN regression
+    against direct sums over all points.
+*/
+
+#ifdef MAKE_MAIN
+#include <cstdio>
+#include <vector>
+#include "EasyClock.h"
+#include "KNNRegression.h"
+#include "KernelDensityEstimator.h"
+#include "Random.h"
+
+/// The kernel density estimate at x, summing over all points
+real DirectLogPdf(const std::vector<Vector>& X, const Vector& x, real b) {
+  real C = -0.5 * ((real)x.Size()) * log(2.0 * M_PI);
+  real log_P = LOG_ZERO;
+  for (uint i = 0; i < X.size(); ++i) {
+    real d = EuclideanNorm(&x, &X[i]);
+    log_P = logAdd(log_P, C - 0.5 * d * d / (b * b));
+  }
+  return log_P - log(b) - log((real)X.size());
+}
+
+int main(int argc, char** argv) {
+  int n_points = 100000;
+  if (argc > 1) {
+    n_points = atoi(argv[1]);
+  }
+  int n_dimensions = 3;
+  int n_queries = 1000;
+  real b = 0.05;
+  int errors = 0;
+
+  std::vector<Vector> X(n_points);
+  std::vector<Vector> Y(n_points);
+  for (int i = 0; i < n_points; ++i) {
+    X[i] = Vector(n_dimensions);
+    Y[i] = Vector(1);
+    for (int j = 0; j < n_dimensions; ++j) {
+      X[i](j) = urandom();
+      Y[i](0) += X[i](j);
+    }
+  }
+  Matrix Z(n_queries, n_dimensions);
+  std::vector<Vector> queries(n_queries);
+  for (int t = 0; t < n_queries; ++t) {
+    queries[t] = Vector(n_dimensions);
+    for (int j = 0; j < n_dimensions; ++j) {
+      // some queries lie outside the data, where the kernel ball is empty
+      Z(t, j) = 1.2 * urandom();
+      queries[t](j) = Z(t, j);
+    }
+  }
+
+  // truncated kernel density estimate
+  KernelDensityEstimator kde(n_dimensions, b, 0);
+  for (int i = 0; i < n_points; ++i) {
+    kde.AddPoint(X[i]);
+  }
+  std::vector<real> log_p(n_queries);
+  kde.log_pdf(queries[0]);  // builds the tree
+  double start_time = GetCPU();
+  for (int t = 0; t < n_queries; ++t) {
+    log_p[t] = kde.log_pdf(queries[t]);
+  }
+  double kde_time = GetCPU() - start_time;
+  start_time = GetCPU();
+  for (int t = 0; t < n_queries; ++t) {
+    real direct = DirectLogPdf(X, queries[t], b);
+    if (fabs(direct - log_p[t]) > 1e-5) {
+      fprintf(stderr, "log pdf %f != %f\n", log_p[t], direct);
+      errors++;
+    }
+  }
+  double direct_time = GetCPU() - start_time;
+  printf("KDE, %d points: %f s (direct sum %f s)\n", n_points, kde_time,
+         direct_time);
+
+  // KNN regression, one query at a time and batched
+  int K = 4;
+  KNNRegression knn_regression(n_dimensions, 1);
+  for (int i = 0; i < n_points; ++i) {
+    knn_regression.AddElement(PointPair(X[i], Y[i]));
+  }
+  Vector y(1);
+  knn_regression.Evaluate(queries[0], y, K);  // builds the tree
+  start_time = GetCPU();
+  for (int t = 0; t < n_queries; ++t) {
+    knn_regression.Evaluate(queries[t], y, K);
+  }
+  double single_time = GetCPU() - start_time;
+  Matrix Y_batch;
+  start_time = GetCPU();
+  knn_regression.Evaluate(Z, Y_batch, K);
+  double batch_time = GetCPU() - start_time;
+  for (int t = 0; t < n_queries; ++t) {
+    knn_regression.Evaluate(queries[t], y, K);
+    if (fabs(y(0) - Y_batch(t, 0)) > 1e-9) {
+      fprintf(stderr, "batch estimate %f != %f\n", Y_batch(t, 0), y(0));
+      errors++;
+    }
+  }
+  // the nearest point of each data point is itself
+  for (int i = 0; i < n_points; i += 997) {
+    knn_regression.Evaluate(X[i], y, 1);
+    if (fabs(y(0) - Y[i](0)) > 1e-9) {
+      fprintf(stderr, "point %d: estimate %f != %f\n", i, y(0), Y[i](0));
+      errors++;
+    }
+  }
+  printf("KNN regression, %d queries: %f s, batch %f s\n", n_queries,
+         single_time, batch_time);
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif
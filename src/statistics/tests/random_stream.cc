@@ -0,0 +1,125 @@
+/* -*- Mode: C++; -*- */
+// copyright (c) 2013 by Christos Dimitrakakis <christos.dimitrakakis@gmail.com>
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifdef MAKE_MAIN
+#include "BetaDistribution.h"
+#include "CounterBasedRNG.h"
+#include "Dirichlet.h"
+#include "ExponentialDistribution.h"
+#include "GammaDistribution.h"
+#include "NormalDistribution.h"
+#include "ParallelFor.h"
+#include "Random.h"
+#include "Sampling.h"
+
+/// Check that the sample mean of d is close to its expected value
+int CheckMean(const char* name, const Distribution& d, real mean,
+              RandomNumberGenerator& rng) {
+  int T = 100000;
+  real sum = 0.0;
+  for (int t = 0; t < T; ++t) {
+    sum += d.generate(rng);
+  }
+  sum /= (real)T;
+  printf("%s: %f (expected %f)\n", name, sum, mean);
+  if (fabs(sum - mean) > 0.02 * (1.0 + fabs(mean))) {
+    fprintf(stderr, "Wrong mean for %s\n", name);
+    return 1;
+  }
+  return 0;
+}
+
+/// Sum of samples of a few runs, each using its own stream
+real Run(const CounterBasedRNG& master, int run) {
+  CounterBasedRNG rng = master.Split(run);
+  NormalDistribution normal(1.0, 2.0);
+  DirichletDistribution dirichlet(4, 0.5);
+  real sum = 0.0;
+  for (int t = 0; t < 1000; ++t) {
+    sum += normal.generate(rng);
+    sum += dirichlet.generate(rng)(0);
+    // library code sampling through urandom() uses the stream too
+    ScopedRandomNumberGenerator scope(&rng);
+    sum += urandom();
+  }
+  return sum;
+}
+
+int main() {
+  int errors = 0;
+
+  // the same seed and stream give the same sequence
+  CounterBasedRNG a(1234, 5);
+  CounterBasedRNG b(1234, 5);
+  CounterBasedRNG c(1234, 6);
+  int n_same = 0;
+  for (int t = 0; t < 1000; ++t) {
+    ulong x = a.random();
+    if (x != b.random()) {
+      errors++;
+    }
+    if (x == c.random()) {
+      n_same++;
+    }
+  }
+  if (n_same > 1) {
+    fprintf(stderr, "Streams 5 and 6 are not independent\n");
+    errors++;
+  }
+
+  // reseeding and splitting are deterministic
+  a.manualSeed(1234);
+  CounterBasedRNG d = a.Split(3);
+  a.uniform();
+  CounterBasedRNG e = a.Split(3);
+  if (d.uniform() != e.uniform()) {
+    fprintf(stderr, "Split depends on the position in the stream\n");
+    errors++;
+  }
+
+  CounterBasedRNG rng(42);
+  errors += CheckMean("normal", NormalDistribution(1.0, 2.0), 1.0, rng);
+  errors += CheckMean("gamma", GammaDistribution(2.0, 3.0), 1.5, rng);
+  errors += CheckMean("gamma (shape < 1)", GammaDistribution(1.0, 0.5), 0.5,
+                      rng);
+  errors += CheckMean("beta", BetaDistribution(2.0, 6.0), 0.25, rng);
+  errors += CheckMean("exponential", ExponentialDistribution(2.0), 0.5, rng);
+
+  // parallel runs give the same results as serial runs
+  int n_runs = 16;
+  CounterBasedRNG master(2013);
+  std::vector<real> serial(n_runs);
+  for (int run = 0; run < n_runs; ++run) {
+    serial[run] = Run(master, run);
+  }
+  std::vector<real> parallel(n_runs);
+  ParallelFor(n_runs, 4, [&](int block, int begin, int end) {
+    for (int run = begin; run < end; ++run) {
+      parallel[run] = Run(master, run);
+    }
+  });
+  for (int run = 0; run < n_runs; ++run) {
+    if (serial[run] != parallel[run]) {
+      fprintf(stderr, "Run %d differs: %f %f\n", run, serial[run],
+              parallel[run]);
+      errors++;
+    }
+  }
+
+  if (errors) {
+    fprintf(stderr, "test failed with %d errors\n", errors);
+  } else {
+    printf("test complete with no errors\n");
+  }
+  return errors;
+}
+
+#endif